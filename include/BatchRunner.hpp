@@ -0,0 +1,59 @@
+// *************************************************
+// *
+// * BatchRunner.hpp
+// *
+// ***********************************
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include "Machine.hpp"
+
+class BatchRunner
+{
+    public:
+        using Job = std::function<void(Machine&)>;
+
+        BatchRunner(int threads = 0);       // 0: one worker per hardware thread
+        ~BatchRunner() {};
+
+        void Add(Job job);                  // queue a job for the next Run()
+        void Run();                         // run every queued job, returns when all are done
+        int Threads()                       { return (int)_workers.size(); }
+
+    private:
+
+        // one job queue per worker thread
+        struct WORKER {
+            std::mutex mutex;
+            std::deque<Job> jobs;
+        };
+        std::vector<std::unique_ptr<WORKER>> _workers;
+        int _next = 0;                      // worker that receives the next Add()
+
+        // helpers
+        bool _pop(int index, Job& job);     // own queue first, then steal from the others
+        void _workerProc(int index);
+};
+
+
+/**** NOTES *******************************************************************************
+ *
+ *  Every job runs on a fresh headless Machine created on the worker thread that picked
+ *      the job up, and the Machine is destroyed when the job returns. A job typically
+ *      loads a program, feeds it input, clocks it with Run() or RunFrames() and reads
+ *      back the results. Its banked memory has no 'paged.mem' behind it (see MemBank)
+ *      and starts as zeros:
+ *
+ *          BatchRunner runner;
+ *          for (auto& script : scripts)
+ *              runner.Add([&](Machine& m) { m.LoadHex("game.hex"); ... });
+ *          runner.Run();
+ *
+ *  Jobs are dealt round robin onto the per worker queues. A worker takes jobs from the
+ *      back of its own queue and, once that is empty, steals from the front of the
+ *      others, so long running jobs do not leave the remaining workers idle.
+ *
+ **** NOTES *******************************************************************************/
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <thread>
 #include "IDevice.hpp"
 
@@ -20,40 +22,59 @@ class FileIO;
 class Math;
 class MemBank;
 class Memory;
+class Dma;
+class Capture;
 
 class Bus : public IDevice
 {
     friend class C6809;     // This is cheating? Maybe not, but it does make me feel a bit dirty.
     friend class Debug;     // Again, this feels so wrong!
+    friend class Machine;   // headless instances
+    friend class FileIO;    // binds its I/O thread to the bus
 
     private:
-        Bus();
-
-        // private statics
-        inline static bool s_bIsRunning = true; 
-        inline static bool s_bIsDirty = true;
-        inline static bool s_b_SDL_WasInit = false;
-
-        inline static int _fps = 0;
-
-		inline static float s_avg_cpu_cycle_time = 0;
-		inline static Byte _clock_div = 0;				// SYS_CLOCK_DIV (Byte) 60 hz Clock Divider  (Read Only) 
-		inline static Word _clock_timer = 0;			// SYS_TIMER	(R/W Word) increments at 0.46875 hz
-		inline static Word _sys_cpu_speed = 0;			// SYS_SPEED	(Read Byte) register
-
-        inline static std::thread s_cpuThread;
-
-        inline static GfxCore* s_gfx_core = nullptr;
-        inline static Gfx* s_gfx = nullptr;
-        inline static Debug* s_debug = nullptr;
-        inline static C6809* s_c6809 = nullptr;
-        inline static Mouse* s_mouse = nullptr;
-        inline static Keyboard* s_keyboard = nullptr;
-        inline static Gamepad* s_gamepad = nullptr;
-        inline static FileIO* s_fileio = nullptr;
-        inline static Math* s_math = nullptr;
-        inline static MemBank* s_membank = nullptr;
-        inline static Memory* s_memory = nullptr;
+        Bus(bool headless = false, const std::string& paged_file = PAGED_MEMORY_FILENAME);
+
+        // the bus bound to this thread (see Machine)
+        inline static thread_local Bus* s_current = nullptr;
+        Bus* _prev_current = nullptr;
+
+        // machine state
+        std::atomic<bool> _bIsRunning{true};    // shared with the CPU thread
+        std::atomic<bool> _bIsDirty{true};
+        bool _bIsHeadless = false;
+        bool _b_SDL_WasInit = false;
+
+        int _fps = 0;
+
+		QWord _speed_cycles = 0;			// CPU cycle count at the last SYS_SPEED update
+		Byte _clock_div = 0;				// SYS_CLOCK_DIV (Byte) 60 hz Clock Divider  (Read Only) 
+		Word _clock_timer = 0;			// SYS_TIMER	(R/W Word) increments at 0.46875 hz
+		Word _sys_cpu_speed = 0;			// SYS_SPEED	(Read Byte) register
+
+        // wall clock timing (OnUpdate)
+        std::chrono::system_clock::time_point _div_before[8];  // last toggle of each SYS_CLOCK_DIV bit
+        std::chrono::system_clock::time_point _update_tp;      // time of the last OnUpdate
+        int _frame_count = 0;               // frames counted toward _fps
+        float _frame_acc = 0.0f;            // seconds counted toward _fps
+        // emulated timing (headless machines, see _clockHeadless)
+        int _tick_acc = 0;                  // 120 hz ticks over the CPU clock rate
+
+        std::thread _cpuThread;
+
+        GfxCore* _gfx_core = nullptr;
+        Gfx* _gfx = nullptr;
+        Debug* _debug = nullptr;
+        C6809* _c6809 = nullptr;
+        Mouse* _mouse = nullptr;
+        Keyboard* _keyboard = nullptr;
+        Gamepad* _gamepad = nullptr;
+        FileIO* _fileio = nullptr;
+        Math* _math = nullptr;
+        MemBank* _membank = nullptr;
+        Memory* _memory = nullptr;
+        Dma* _dma = nullptr;
+        Capture* _capture = nullptr;
 
     public:
 		~Bus();									// destructor
@@ -64,6 +85,8 @@ class Bus : public IDevice
 			//Bus& operator=(Bus&&) = delete;		// move assignment operator
 		static Bus& Inst() 						
 		{ 
+            if (s_current)
+                return *s_current;
 			static Bus inst; 
 			return inst; 
 		}        
@@ -81,10 +104,17 @@ class Bus : public IDevice
 		void OnUpdate(float fNullTime) override;
 		void OnRender() override;
 
-        Byte read(Word offset, bool debug = false) override;
-        void write(Word offset, Byte data, bool debug = false) override;
-        Word read_word(Word offset, bool debug = false) override;
-        void write_word(Word offset, Word data, bool debug = false)  override;
+        // final, so calls through a Bus* (the CPU's) skip the virtual dispatch
+        Byte read(Word offset, bool debug = false) override final;
+        void write(Word offset, Byte data, bool debug = false) override final;
+        Word read_word(Word offset, bool debug = false) override final;
+        void write_word(Word offset, Word data, bool debug = false)  override final;
+
+        // backing store of plain RAM (or ROM, for reading) at offset, with the number
+        // of bytes left in that device in len. nullptr for any other device.
+        Byte* MemPtr(Word offset, Word& len, bool write);
+        // len bytes stored straight into device memory from offset, as debug writes
+        void write_block(Word offset, const Byte* buf, DWord len);
 
 		static Byte Read(Word offset, bool debug = false);
 		static void Write(Word offset, Byte data, bool debug = false);
@@ -96,31 +126,45 @@ class Bus : public IDevice
 
         // inline static GfxCore* gfx_core() { return s_gfx_core; }    // to non-enforced singleton
         // inline static Gfx* gfx() { return s_gfx; }                  // to non-enforced singleton
-        inline static bool IsDirty() { return s_bIsDirty; }
-        inline static void IsDirty(bool dirty) { s_bIsDirty = dirty; }
-        inline static bool IsRunning() { return s_bIsRunning; }
-        inline static void IsRunning(bool _r) { s_bIsRunning = _r; }
-
-        inline static Gfx* GetGfx() { return s_gfx; }
-        inline static Debug* GetDebug() { return s_debug; }
-        inline static C6809* GetC6809() { return s_c6809; }
-        inline static Mouse* GetMouse() { return s_mouse; }
-        inline static Keyboard* GetKeyboard() { return s_keyboard; }
-        inline static Gamepad* GetGamepad() { return s_gamepad; }
-        inline static FileIO* GetFileIO() { return s_fileio; }
-        inline static Math* GetMath() { return s_math; }
-        inline static MemBank* GetMemBank() { return s_membank; }
-        inline static Memory* GetMemory() { return s_memory; }
-
-        void load_hex(const char* filename);
+        inline static bool IsDirty() { return Inst()._bIsDirty; }
+        inline static void IsDirty(bool dirty) { Inst()._bIsDirty = dirty; }
+        inline static bool IsRunning() { return Inst()._bIsRunning; }
+        inline static void IsRunning(bool _r) { Inst()._bIsRunning = _r; }
+        inline static bool IsHeadless() { return Inst()._bIsHeadless; }
+
+        inline static Gfx* GetGfx() { return Inst()._gfx; }
+        inline static Debug* GetDebug() { return Inst()._debug; }
+        inline static C6809* GetC6809() { return Inst()._c6809; }
+        inline static Mouse* GetMouse() { return Inst()._mouse; }
+        inline static Keyboard* GetKeyboard() { return Inst()._keyboard; }
+        inline static Gamepad* GetGamepad() { return Inst()._gamepad; }
+        inline static FileIO* GetFileIO() { return Inst()._fileio; }
+        inline static Math* GetMath() { return Inst()._math; }
+        inline static MemBank* GetMemBank() { return Inst()._membank; }
+        inline static Memory* GetMemory() { return Inst()._memory; }
+        inline static Dma* GetDma() { return Inst()._dma; }
+        inline static Capture* GetCapture() { return Inst()._capture; }
+
+        // Intel HEX, S-records, or a raw binary stored from bin_addr (Loader.hpp)
+        void load_hex(const char* filename, Word bin_addr = 0);
+
+        // the device writes the CPU makes, in order, until LogWrites(nullptr)
+        // (tools/boot_snapshot.cpp records the kernel's boot with it)
+        void LogWrites(std::vector<std::pair<Word, Byte>>* log) { _write_log = log; }
 
     private:
         int _lastAddress = 0;
-        inline static std::vector<IDevice*> _memoryNodes;		
+        std::vector<IDevice*> _memoryNodes;		
+
+        void load_kernel();         // the embedded ROM (KERNEL_ROM_EMBEDDED) or KERNEL_ROM_FILENAME
+        void restore_boot();        // the embedded boot snapshot (KERNEL_BOOT_SNAPSHOT)
+        std::vector<std::pair<Word, Byte>>* _write_log = nullptr;
+        int _write_log_depth = 0;   // writes a device makes while handling one are not logged
 
         // helpers
         Byte clock_div(Byte& cl_div, int bit);
         void clockDivider();
+        void _clockHeadless();      // one CPU clock of emulated time (Machine::Run)
 
         struct mem_def_node
         {
@@ -128,15 +172,12 @@ class Bus : public IDevice
             int offset;
             std::string comment;
         };
-        inline static std::vector<mem_def_node> vec_mem_def;
-        inline static void def_push(std::string label, int offset, std::string comment) 
+        std::vector<mem_def_node> vec_mem_def;
+        void def_push(std::string label, int offset, std::string comment) 
         {    
             // offset == -1 (none)            
             vec_mem_def.push_back({label, offset, comment});
         }	
 
-        Byte _fread_hex_byte(std::ifstream& ifs);
-        Word _fread_hex_word(std::ifstream& ifs);
-
 };
 
@@ -12,9 +12,13 @@
 #pragma once
 #include "Bus.hpp"
 #include "types.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <string>
 #include <list>
 #include <unordered_map>
+#include <vector>
 
 // class Bus;
 // class Device;
@@ -38,9 +42,10 @@ public:
 	C6809(Bus* p_bus);
 	~C6809();
 	void Init();
+	void Init6309();	// HD6309 opcodes and native mode cycles (CPU_HD6309)
 
 	// Device type registers
-	inline static int s_sys_state = 0;		// system speed 0-15
+	int _sys_state = 0;		// system speed 0-15
     										// 	0x00 = 25 khz
     										// 	0x01 = 50 khz
     										// 	0x02 = 100 khz
@@ -60,16 +65,48 @@ public:
 
 
 	private:
-		inline static bool s_bCpuEnabled = false;
+		// CPU thread control (see ThreadProc)
+		std::mutex _ctrl_mutex;
+		std::condition_variable _ctrl_cv;
+		std::atomic<int> _steps{0};			// instructions left to run, -1: free running, 0: paused
+		std::atomic<int> _run_until{-1};	// pause when PC reaches this address, -1: none
+		bool _bParked = false;				// CPU thread is blocked (guarded by _ctrl_mutex)
+		bool _bThreadActive = false;		// CPU thread is in ThreadProc (guarded by _ctrl_mutex)
+		bool _isHeld();						// nothing to run at this clock (CPU thread only)
+		void _waitParked();					// block until the CPU thread is parked or gone
+		// nominal clock rate (hz) for each _sys_state
+		inline static constexpr int s_clock_rate[16] = {
+			25000, 50000, 100000, 200000, 333000, 416000, 500000, 625000,
+			769000, 833000, 1000000, 1400000, 2000000, 3300000, 5000000, 10000000 };
 
 	
 	public:
-		inline static void IsCpuEnabled(bool b)	{ s_bCpuEnabled = b; }
-		inline static bool IsCpuEnabled()		{ return s_bCpuEnabled; }
+		// CPU thread control. Pause() and Stop() return once the CPU thread has
+		// acknowledged, which gives the caller a quiescent machine to work on.
+		void Pause();						// park at the next instruction boundary
+		void Resume();						// free run
+		void Step(int count = 1);			// run count instructions, then park
+		void RunUntil(Word addr);			// free run, park when PC reaches addr
+		void Stop();						// end the CPU thread
+		void Wake();						// run conditions changed elsewhere (e.g. the debugger)
+		bool IsPaused();
+		int ClockRate()				{ return s_clock_rate[_sys_state & 0x0F]; }
+
+		// kernel HLE (CPU_KERNEL_HLE, see KernelHle.cpp)
+		void Hle(bool enable)		{ _hle_enabled = enable; }
+		bool Hle()					{ return _hle_enabled; }
+		void HleCycles(Byte cycles)	{ _hle_cycles = cycles; }
+
+		// instruction mix profile (see OpMix.cpp)
+		void Profile(bool enable);						// start counting from zero, or stop
+		bool Profile()				{ return _profile; }
+		QWord ProfileCount(Word op);					// times op was run
+		QWord ProfileCount(Word first, Word second);	// times second directly followed first
+		bool SaveProfile(const std::string& filename);	// CSV, most frequent first
 
 		
 
-	static void ThreadProc();
+	static void ThreadProc(Bus* bus);
 
 inline static auto hex(uint32_t n, Byte d)
 {
@@ -102,16 +139,24 @@ inline static auto hex(uint32_t n, Byte d)
 	Byte getA() { return A; }
 	Byte getB() { return B; }
 	Word getD() { return D; }
-	Byte getCC() { return CC.all; }
-	bool getCC_E() { return CC.bit.E != 0; }
-	bool getCC_F() { return CC.bit.F != 0; }
-	bool getCC_H() { return CC.bit.H != 0; }
-	bool getCC_I() { return CC.bit.I != 0; }
-	bool getCC_N() { return CC.bit.N != 0; }
-	bool getCC_Z() { return CC.bit.Z != 0; }
-	bool getCC_V() { return CC.bit.V != 0; }
-	bool getCC_C() { return CC.bit.C != 0; }
-	Byte getCycles() { return cycles; }
+	Byte getCC() { return lazy_op ? (CC.all & ~s_lazy_mask[lazy_op]) | lazy_flags() : CC.all; }
+	bool getCC_E() { return getCC() & 0x80; }
+	bool getCC_F() { return getCC() & 0x40; }
+	bool getCC_H() { return getCC() & 0x20; }
+	bool getCC_I() { return getCC() & 0x10; }
+	bool getCC_N() { return getCC() & 0x08; }
+	bool getCC_Z() { return getCC() & 0x04; }
+	bool getCC_V() { return getCC() & 0x02; }
+	bool getCC_C() { return getCC() & 0x01; }
+	DWord getCycles() { return cycles; }
+	QWord getCycleCount() { return cycle_count.load(std::memory_order_relaxed); }	// clocks since power on
+	// HD6309 registers
+	Byte getE() { return E; }
+	Byte getF() { return F; }
+	Word getW() { return W; }
+	DWord getQ() { return ((DWord)D << 16) | W; }
+	Word getV() { return V; }
+	Byte getMD() { return MD; }
 
 	//Bus* getBus() { return bus; }
 
@@ -123,16 +168,27 @@ inline static auto hex(uint32_t n, Byte d)
 	void setD(Word pD) { D = pD; }
 	void setA(Byte pA) { A = pA; }
 	void setB(Byte pB) { B = pB; }
-	void setCC(Byte pCC) { CC.all = pCC; }
-	void setCC_E(bool bSet) { CC.bit.E = bSet; }
-	void setCC_F(bool bSet) { CC.bit.F = bSet; }
-	void setCC_H(bool bSet) { CC.bit.H = bSet; }
-	void setCC_I(bool bSet) { CC.bit.I = bSet; }
-	void setCC_N(bool bSet) { CC.bit.N = bSet; }
-	void setCC_Z(bool bSet) { CC.bit.Z = bSet; }
-	void setCC_V(bool bSet) { CC.bit.V = bSet; }
-	void setCC_C(bool bSet) { CC.bit.C = bSet; }
+	void setCC(Byte pCC) { lazy_op = LAZY_NONE; CC.all = pCC; }
+	void setCC_E(bool bSet) { cc_sync(); CC.bit.E = bSet; }
+	void setCC_F(bool bSet) { cc_sync(); CC.bit.F = bSet; }
+	void setCC_H(bool bSet) { cc_sync(); CC.bit.H = bSet; }
+	void setCC_I(bool bSet) { cc_sync(); CC.bit.I = bSet; }
+	void setCC_N(bool bSet) { cc_sync(); CC.bit.N = bSet; }
+	void setCC_Z(bool bSet) { cc_sync(); CC.bit.Z = bSet; }
+	void setCC_V(bool bSet) { cc_sync(); CC.bit.V = bSet; }
+	void setCC_C(bool bSet) { cc_sync(); CC.bit.C = bSet; }
 	void setDP(Byte pDP) { DP = pDP; }
+	void setE(Byte pE) { E = pE; }
+	void setF(Byte pF) { F = pF; }
+	void setW(Word pW) { W = pW; }
+	void setQ(DWord pQ) { D = pQ >> 16; W = (Word)pQ; }
+	void setV(Word pV) { V = pV; }
+	void setMD(Byte pMD) { MD = pMD; }
+
+	// the whole register file (the boot snapshot, Bus::restore_boot)
+	struct REGS { Word pc, u, s, x, y, d, w, v; Byte dp, cc, md; };
+	REGS getRegs() { return { PC, U, S, X, Y, D, W, V, DP, getCC(), MD }; }
+	void setRegs(const REGS& r);		// at an instruction boundary, with S loaded
 
 	// addressing modes:
 
@@ -144,7 +200,12 @@ inline static auto hex(uint32_t n, Byte d)
 	Word idx();		// INDEXED
 	Word relb();	// RELATIVE 8-BIT
 	Word relw();	// RELATIVE 16-BIT
+	Word immq();	// IMMEDIATE 32-BIT (HD6309)
 	Word nula();	// invalid addressing mode
+	Word ea() { return (this->*opMap[opcode].addrmode)(); }	// addressing mode from the opMap
+
+	void switch_core();	// execute the current opcode without the opMap (CPU_SWITCH_CORE)
+	void table_core();	// execute the current opcode through the opMap
 
 	// opcodes:
 	void abx(void);		void adca(void);	void adcb(void);	void adda(void);
@@ -182,6 +243,29 @@ inline static auto hex(uint32_t n, Byte d)
 	void bvc(void);		void lbvc(void);	void bvs(void);		void lbvs(void);
 	void pg2(void);		void pg3(void);		void null();
 
+	// HD6309 opcodes:
+	void adcd(void);	void add_r(void);	void adc_r(void);	void adde(void);
+	void addf(void);	void addw(void);	void aim(void);		void and_r(void);
+	void andd(void);	void asld(void);	void asrd(void);	void band(void);
+	void beor(void);	void biand(void);	void bieor(void);	void bior(void);
+	void bitd(void);	void bitmd(void);	void bor(void);		void clrd(void);
+	void clre(void);	void clrf(void);	void clrw(void);	void cmp_r(void);
+	void cmpe(void);	void cmpf(void);	void cmpw(void);	void comd(void);
+	void come(void);	void comf(void);	void comw(void);	void decd(void);
+	void dece(void);	void decf(void);	void decw(void);	void divd(void);
+	void divq(void);	void eim(void);		void eor_r(void);	void eord(void);
+	void incd(void);	void ince(void);	void incf(void);	void incw(void);
+	void ldbt(void);	void lde(void);		void ldf(void);		void ldmd(void);
+	void ldq(void);		void ldw(void);		void lsrd(void);	void lsrw(void);
+	void muld(void);	void negd(void);	void oim(void);		void or_r(void);
+	void ord(void);		void pshsw(void);	void pshuw(void);	void pulsw(void);
+	void puluw(void);	void rold(void);	void rolw(void);	void rord(void);
+	void rorw(void);	void sbc_r(void);	void sbcd(void);	void sexw(void);
+	void stbt(void);	void ste(void);		void stf(void);		void stq(void);
+	void stw(void);		void sub_r(void);	void sube(void);	void subf(void);
+	void subw(void);	void tfm(void);		void tim(void);		void tstd(void);
+	void tste(void);	void tstf(void);	void tstw(void);
+
 	// memory access
 
 	Byte fetch_byte() { Byte data = read(PC); PC++; return data; }
@@ -191,17 +275,17 @@ inline static auto hex(uint32_t n, Byte d)
 	{ 
 		// if (offset == CSR_PAL_INDX)
 		// 	Byte debug_test = 0;
-		Byte d = Bus::Read(offset);
+		Byte d = m_bus->read(offset);
 		return d; 
 	}
 	void write(Word offset, Byte data)			
 	{ 
 		// if (offset == CSR_PAL_INDX)
 		// 	Byte debug_test = 0;
-		Bus::Write(offset, data);
+		m_bus->write(offset, data);
 	}
-	Word read_word(Word offset)					{ return Bus::Read_Word(offset); }
-	void write_word(Word offset, Word data)		{ Bus::Write_Word(offset, data); }
+	Word read_word(Word offset)					{ return m_bus->read_word(offset); }
+	void write_word(Word offset, Word data)		{ m_bus->write_word(offset, data); }
 
 	Byte debug_read(Word offset)				{ return Bus::Read(offset, true);}
 	void debug_write(Word offset, Byte data)	{ Bus::Write(offset, data, true); }
@@ -224,6 +308,25 @@ inline static auto hex(uint32_t n, Byte d)
 	Byte& A;
 	Byte& B;
 	Word& D;
+	union {
+		Word W;
+		struct {
+			Byte F;
+			Byte E;
+		} byte;
+	} accw;		// HD6309: W = E:F, Q = D:W
+	Byte& E;
+	Byte& F;
+	Word& W;
+	Word V = 0;		// HD6309 transfer value register
+	Byte MD = 0;	// HD6309 mode register
+	enum MD_BITS : Byte {
+		MD_NM = 0x01,	// native mode
+		MD_FM = 0x02,	// FIRQ stacks the entire state
+		MD_IL = 0x40,	// an illegal instruction trapped
+		MD_DZ = 0x80,	// a division by zero trapped
+	};
+	bool native() { return CPU_HD6309 && (MD & MD_NM); }
 	union {
 		Byte all;
 		struct {
@@ -244,10 +347,51 @@ inline static auto hex(uint32_t n, Byte d)
 		Word(C6809::* addrmode)(void) = nullptr;	// the address_mode function
 		Byte cycles = 0;			// base cycles (not including internal increases)
 		Byte size = 0;				// how many bytes long is this instruction?
+		Byte cycles_nm = 0;			// base cycles in HD6309 native mode
 	};
 
 	Word* ptrReg[4] = { &X, &Y, &U, &S };
 
+	// lazy condition codes: the flag setting helpers record their operation here
+	// and the H/N/Z/V/C bits it owns are only computed when something reads CC
+	enum LAZY_OP : Byte {
+		LAZY_NONE,		// CC.all is current
+		LAZY_LOGIC8,	// N Z V	8-bit result, V=0	(AND OR EOR BIT LD ST TST)
+		LAZY_LOGIC16,	// N Z V	16-bit result, V=0	(LD ST)
+		LAZY_ADD8,		// H N Z V C	(ADD ADC)
+		LAZY_ADD16,		// H N Z V C	(ADDD)
+		LAZY_SUB8,		// N Z V C	(SUB SBC CMP NEG)
+		LAZY_SUB16,		// N Z V C	(SUBD)
+		LAZY_CMP16,		// N Z V C	(CMPD CMPX CMPY CMPU CMPS)
+		LAZY_INC8,		// N Z V	(INC)
+		LAZY_DEC8,		// N Z V	(DEC)
+		LAZY_MAX
+	};
+	inline static constexpr Byte s_lazy_mask[LAZY_MAX] = {
+		0x00, 0x0e, 0x0e, 0x2f, 0x2f, 0x0f, 0x0f, 0x0f, 0x0e, 0x0e };
+	Byte lazy_op = LAZY_NONE;	// pending operation
+	Word lazy_x = 0;			// left operand
+	Word lazy_m = 0;			// right operand
+	Word lazy_r = 0;			// result (before truncation)
+	Byte lazy_c = 0;			// carry in
+
+	Byte lazy_flags();			// the CC bits owned by the pending operation
+	void cc_sync() {
+		if (lazy_op) {
+			CC.all = (CC.all & ~s_lazy_mask[lazy_op]) | lazy_flags();
+			lazy_op = LAZY_NONE;
+		}
+	}
+	void set_flags(Byte op, Word x, Word m, Word r, Byte c = 0) {
+		// bits the new operation leaves alone still belong to the old one
+		if (s_lazy_mask[lazy_op] & ~s_lazy_mask[op])
+			cc_sync();
+		lazy_op = op;	lazy_x = x;		lazy_m = m;		lazy_r = r;		lazy_c = c;
+		if constexpr (!CPU_LAZY_FLAGS)
+			cc_sync();
+	}
+	Byte carry() { cc_sync(); return CC.bit.C; }
+
 	// HELPER FUNCTIONS
 
 	// 8 bit operations
@@ -284,17 +428,34 @@ inline static auto hex(uint32_t n, Byte d)
 	void do_psh(Word& sp, Byte val);	void do_psh(Word& sp, Word val);
 	void do_pul(Word& sp, Byte& val);	void do_pul(Word& sp, Word& val);
 
-	void do_adc(Byte& x);	void do_add(Byte& x);	void do_add(Word& x);
-	void do_and(Byte& x);
-	void do_asl(Byte& x);	void do_asr(Byte& x);	void do_bit(Byte& x);
-	void do_clr(Byte& x);	void do_cmp(Byte x);	void do_cmp(Word x);
-	void do_com(Byte& x);	void do_dec(Byte& x);	void do_eor(Byte& x);
-	void do_inc(Byte& x);	void do_ld(Byte& x);	void do_ld(Word& x);
-	void do_lsr(Byte& x);	void do_neg(Byte& x);	void do_or(Byte& x);
-	void do_rol(Byte& x);	void do_ror(Byte& x);	void do_sbc(Byte& x);
-	void do_st(Byte x);		void do_st(Word x);		void do_sub(Byte& x);	void do_sub(Word& x);
+	// helpers taking an effective address are handed it by the caller
+	void do_adc(Byte& x, Word addr);	void do_add(Byte& x, Word addr);	void do_add(Word& x, Word addr);
+	void do_and(Byte& x, Word addr);	void do_bit(Byte& x, Word addr);
+	void do_cmp(Byte x, Word addr);		void do_cmp(Word x, Word addr);		void do_eor(Byte& x, Word addr);
+	void do_ld(Byte& x, Word addr);		void do_ld(Word& x, Word addr);		void do_or(Byte& x, Word addr);
+	void do_sbc(Byte& x, Word addr);	void do_st(Byte x, Word addr);		void do_st(Word x, Word addr);
+	void do_sub(Byte& x, Word addr);	void do_sub(Word& x, Word addr);
+	void do_asl(Byte& x);	void do_asr(Byte& x);	void do_clr(Byte& x);
+	void do_com(Byte& x);	void do_dec(Byte& x);	void do_inc(Byte& x);
+	void do_lsr(Byte& x);	void do_neg(Byte& x);	void do_rol(Byte& x);
+	void do_ror(Byte& x);
 	void do_tst(Byte& x);	void do_br(bool test);	void do_lbr(bool test);
 
+	// HD6309 helpers
+	enum ALU_OP : Byte { ALU_ADD, ALU_ADC, ALU_SUB, ALU_SBC, ALU_AND, ALU_OR, ALU_EOR, ALU_CMP };
+	Word do_alu(Byte op, Word x, Word m, bool wide);
+	void do_asl(Word& x);	void do_asr(Word& x);	void do_clr(Word& x);
+	void do_com(Word& x);	void do_dec(Word& x);	void do_inc(Word& x);
+	void do_lsr(Word& x);	void do_neg(Word& x);	void do_rol(Word& x);
+	void do_ror(Word& x);	void do_tst(Word& x);
+	void do_bitop(Byte op);	void do_mim(Byte op);	void do_reg_op(Byte op);
+	Word get_reg(Byte code);				// TFR/EXG register code, 8-bit registers in both halves
+	void set_reg(Byte code, Word data);		// 8-bit registers take their own half
+	void psh_all();			// stack the entire state (W too in native mode)
+	void pul_all();			// unstack everything but CC
+	void trap(Byte reason);	// illegal instruction / division by zero trap ($FFF0)
+	bool tfm_active = false;	// a TFM is part way through its block
+
 protected:
 
 	// interrupts
@@ -311,13 +472,68 @@ protected:
 	void do_irq();
 	bool do_interrupts();
 
+	// kernel HLE: the ROM routines that run natively while their software
+	// vectors (and those of the routines they call) hold the ROM defaults
+	enum HLE_ROUTINE : Byte {
+		HLE_CLS, HLE_CHROUT, HLE_NEWLINE, HLE_LINEOUT, HLE_CSRPOS, HLE_SCROLL,
+		HLE_CMPSTR, HLE_TBLSEARCH, HLE_MAX
+	};
+	struct HLE_TRAP {
+		Word vector = 0;			// VEC_ software vector
+		Word deps = 0;				// HLE_ROUTINEs reached through their vectors (self included)
+		void (C6809::* call)(void) = nullptr;
+		Word entry = 0;				// 'jmp [vector]' in the ROM, 0 if not found
+	};
+	HLE_TRAP _hle[HLE_MAX];
+	Word _hle_lo = 0xffff;			// lowest trapped entry point
+	Word _hle_hi = 0x0000;			// highest trapped entry point
+	std::atomic<bool> _hle_enabled{CPU_KERNEL_HLE};
+	Byte _hle_cycles = CPU_HLE_CYCLES;
+
+	// instruction mix profile: page 1, 2 and 3 opcodes index 0x000, 0x100 and 0x200
+	static constexpr int MIX_OPS = 0x300;
+	static constexpr int mix_index(Word op) { return (op >> 8) ? ((op >> 8) - 0x0f) * 0x100 + (op & 0xff) : op; }
+	std::atomic<bool> _profile{false};
+	std::vector<QWord> _mix;			// per opcode counts
+	std::vector<QWord> _mix_pairs;		// MIX_OPS x MIX_OPS adjacent pair counts
+	int _mix_last = -1;					// index of the previous opcode, -1: none
+	void profile_op();
+
+	void hle_scan();				// find the entry points in the kernel ROM
+	bool hle_trap();				// run the routine at PC natively, false if there is none
+	bool hle_default(int routine) { return read_word(_hle[routine].vector) == _hle[routine].entry + 4; }
+	// native routines
+	void hle_cls();		void hle_chrout();	void hle_newline();		void hle_lineout();
+	void hle_csrpos();	void hle_scroll();	void hle_cmpstr();		void hle_tblsearch();
+	// shared bodies
+	Word do_csrpos();
+	void do_chrout(Byte a);
+	void do_scroll();
+	int do_cmpstr(Word& x, Word& y);
+
+	// memset/memcpy loops run as block operations (CPU_BLOCK_LOOPS, see BlockLoops.cpp)
+	static constexpr bool loop_head(Byte op) {
+		return op == 0x6f || op == 0xa6 || op == 0xa7 || op == 0xe6 || op == 0xe7 || op == 0xec || op == 0xed;
+	}
+	bool block_loop();				// run the loop starting at PC-1, false if it is not one
+	Byte idx_cycles(Byte post);		// extra cycles of an indexed postbyte
+
+	// hot instruction pairs run in a single dispatch (CPU_FUSE_PAIRS, see OpMix.cpp)
+	void fuse_pair();				// run the instruction at PC as well, when it pairs with opcode
+	bool branch_taken(Byte op);		// condition of the short branch op
+
 protected:
 
 	std::unordered_map<Word, INSTRUCTION> opMap;
+	// the opMap base cycles by [native mode][op_index()], filled in by Init()
+	Byte op_cycles[2][0x300] = {};
+	static constexpr int op_index(Word op) { return (op >> 8) ? ((op >> 8) - 0x0f) * 256 + (op & 0xff) : op; }
+	Byte base_cycles(Word op) { return op_cycles[native()][op_index(op)]; }
 
 	Word opcode = 0x0000;
 	Byte post = 0x00;
-	Byte cycles = 0;
+	DWord cycles = 0;							// clocks left in the current instruction
+	std::atomic<QWord> cycle_count{0};			// every clock, including stolen and waiting ones
 
 	Bus* m_bus = nullptr;
 	// GfxDebug* debug = nullptr;
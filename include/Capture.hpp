@@ -0,0 +1,131 @@
+// *************************************************
+// *
+// * Capture.hpp
+// *
+// ***********************************
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include "IDevice.hpp"
+
+class Capture : public IDevice
+{
+    public:
+        Capture() { _deviceName = "Capture"; }
+        Capture(std::string sName) : IDevice(sName) {}
+        ~Capture() { _stopWriter(); };
+
+        // CAP_CTRL bits
+        enum CAP_FLAGS : Byte {
+            CAP_SNAPSHOT = 0x80,    // write: capture the next frame,  read: still pending
+            CAP_STREAM   = 0x40,    // 1:append every frame to the stream file
+            CAP_PNG      = 0x20,    // still image format  0:PPM, 1:PNG
+            CAP_Y4M      = 0x10,    // stream format  0:raw RGB24, 1:Y4M (4:4:4)
+            CAP_HASH     = 0x08,    // 1:hash every frame and check it against the golden log
+        };
+
+        // pure virtuals
+		Word OnAttach(Word nextAddr) override;
+		void OnInit() override;
+		void OnQuit() override;
+		void OnActivate() override;
+		void OnDeactivate() override;
+		void OnRender() override;
+
+        // unused virtuals
+		void OnEvent(SDL_Event* evnt) override {}
+		void OnUpdate(float fElapsedTime) override {}
+
+        // virtuals
+        Byte read(Word offset, bool debug = false) override;
+        void write(Word offset, Byte data, bool debug = false) override;
+
+        // emulation thread
+        void RasterFrame();             // a raster frame has just completed (Gfx::RasterClock)
+        QWord FrameHash(Byte gmode);    // hash of the display as drawn in gmode
+
+    private:
+
+        enum FRAME_TYPE : Byte { FRAME_STILL, FRAME_STREAM, FRAME_HASH, FRAME_HASH_START };
+
+        // a composed frame waiting on the writer thread
+        struct FRAME {
+            Byte type = FRAME_STILL;
+            Byte flags = 0;             // CAP_CTRL at the time of capture
+            Byte gmode = 0;             // GFX_MODE at the time of capture
+            DWord raster_frame = 0;     // emulated frame number
+            int width = 0;
+            int height = 0;
+            std::vector<Byte> rgb;      // RGB24 pixel data
+            QWord hash = 0;             // FRAME_HASH: the frame's hash
+        };
+
+        Byte _ctrl = 0;                 // CAP_CTRL
+        Byte _interval = 0;             // CAP_INTERVAL
+        Word _frames = 0;               // CAP_FRAMES
+        Word _dropped = 0;              // CAP_DROPPED
+        std::atomic<Word> _mismatch{0}; // CAP_MISMATCH (counted by the writer thread)
+        int _frame_count = 0;           // frames since the last interval capture
+        SDL_Texture* _capture_texture = nullptr;
+        std::vector<Uint16> _hash_pixels;   // FrameHash() scratch (emulation thread)
+
+        // writer thread
+        std::thread _writer;
+        std::mutex _mutex;
+        std::condition_variable _cv;
+        std::deque<FRAME> _queue;
+        bool _bWriterRunning = false;
+        FILE* _stream = nullptr;        // owned by the writer thread
+        int _stream_width = 0;
+        int _stream_height = 0;
+        int _stream_index = 0;
+        int _still_index = 0;
+        FILE* _hash_log = nullptr;      // owned by the writer thread
+        std::map<std::pair<DWord,Byte>, QWord> _golden;    // (raster frame, gmode) -> hash
+
+        // helpers
+        bool _grab(FRAME& frame);       // compose and read back the current frame
+        void _queueFrame(FRAME&& frame);
+        void _writerProc();
+        void _stopWriter();
+        void _writeStill(const FRAME& frame);
+        void _writeStream(const FRAME& frame);
+        void _writeHash(const FRAME& frame);
+        void _loadGolden();
+        bool _writePPM(const std::string& filename, const FRAME& frame);
+        bool _writePNG(const std::string& filename, const FRAME& frame);
+};
+
+
+/**** NOTES *******************************************************************************
+ *
+ *  Frames are composed at the native display resolution from the Gfx render target
+ *      and the Mouse cursor texture, read back, and handed to a writer thread. The
+ *      queue holds CAPTURE_QUEUE_MAX frames; when it is full the frame is dropped
+ *      (and counted in CAP_DROPPED) rather than stalling the render loop.
+ *
+ *  Still images are written to CAPTURE_DIRECTORY as frame_NNNNNN.ppm / .png. Streams
+ *      are written as stream_NNN.rgb or stream_NNN.y4m; a new stream file is started
+ *      whenever the display resolution changes.
+ *
+ *  With CAP_HASH set, every emulated frame is hashed on the emulation thread as the
+ *      raster beam completes it, so the same program hashes the same frames however
+ *      fast the host runs and whether or not anything is rendered. Gfx draws the
+ *      display without SDL (the mouse cursor is not included), and the RGB24 of that
+ *      is reduced to a 64-bit FNV-1a hash. The writer thread appends it to
+ *      CAPTURE_HASH_LOG as "<emulated frame> <gfx mode> <hash>". If CAPTURE_GOLDEN
+ *      exists (a trimmed copy of an earlier hash log), each hashed frame that has a
+ *      golden entry for the same emulated frame and graphics mode is checked against
+ *      it, and CAP_MISMATCH counts the frames that differ. FrameHash() hashes any of
+ *      the graphics modes on demand; tests/golden_frames.cpp checks a set of scripted
+ *      runs with it.
+ *
+ *  Capture only uses offscreen render targets, so it also works with the SDL dummy
+ *      video driver (SDL_VIDEODRIVER=dummy) for headless soak tests.
+ *
+ **** NOTES *******************************************************************************/
@@ -6,6 +6,7 @@
 #pragma once
 
 // #include <map>
+#include <atomic>
 #include <unordered_map>
 #include <list>
 #include "IDevice.hpp" 
@@ -31,9 +32,11 @@ class Debug : public IDevice
         Byte read(Word offset, bool debug = false) override;
         void write(Word offset, Byte data, bool debug = false) override;
 
-        inline static Uint32 GetWindowID() { return SDL_GetWindowID(sdl_debug_window); }
-        inline static SDL_Window* GetSDLWindow() { return sdl_debug_window; }
-        inline static bool IsActive() { return s_bIsDebugActive; }
+        static Uint32 GetWindowID();        // the debugger window of the current bus
+        static SDL_Window* GetSDLWindow();
+        bool IsActive() { return _bIsDebugActive; }
+        bool IsStepping() { return _bSingleStep; }
+        bool IsBreakpoint(Word addr);
 
         bool IsCursorVisible() { return bIsCursorVisible; }
 
@@ -153,13 +156,14 @@ class Debug : public IDevice
         Word reg_brk_addr = 0x0000;	    // break point hardware register
         Byte reg_flags = 0x00;			// debug flags hardware register
 
-        inline static SDL_Window* sdl_debug_window = nullptr;
-        inline static SDL_Renderer* sdl_debug_renderer = nullptr;
-        inline static SDL_Texture* sdl_debug_target_texture = nullptr;
+        SDL_Window* sdl_debug_window = nullptr;
+        SDL_Renderer* sdl_debug_renderer = nullptr;
+        SDL_Texture* sdl_debug_target_texture = nullptr;
 
-        inline static bool s_bIsDebugActive = DEBUG_STARTS_ACTIVE;
-        inline static bool s_bSingleStep = DEBUG_SINGLE_STEP;
-        inline static bool s_bIsStepPaused = true;        
+        // shared with the CPU thread, call C6809::Wake() after releasing the CPU
+        std::atomic<bool> _bIsDebugActive{DEBUG_STARTS_ACTIVE};
+        std::atomic<bool> _bSingleStep{DEBUG_SINGLE_STEP};
+        std::atomic<bool> _bIsStepPaused{true};        
 
 
         Uint32 sdl_debug_renderer_flags = SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE;
@@ -0,0 +1,151 @@
+// *************************************************
+// *
+// * DiskImage.hpp
+// *
+// ***********************************
+#pragma once
+
+#include <array>
+#include <list>
+#include <unordered_map>
+#include "Vfs.hpp"
+
+class ImageVfs;
+
+// a file inside a disk image
+class ImageFile : public VfsFile
+{
+    public:
+        ImageFile(ImageVfs& vfs, int node, bool writing, bool append);
+        ~ImageFile();
+        ImageFile(const ImageFile&) = delete;
+        ImageFile& operator=(const ImageFile&) = delete;
+
+        DWord Read(Byte* buf, DWord len) override;
+        DWord Write(const Byte* buf, DWord len) override;
+        bool Seek(long offset, int whence) override;
+        DWord Tell() override       { return _pos; }
+        bool Eof() override         { return _eof; }
+
+    private:
+        ImageVfs& _vfs;
+        int _node;                  // the file's ImageVfs::NODE
+        bool _writing = false;      // opened "wb" or "ab"
+        bool _append = false;       // opened "ab"
+        bool _eof = false;          // the last read ran past the end
+        DWord _pos = 0;             // file position seen by the 6809
+        DWord _cur_index = 0;       // the last block reached along the file's chain,
+        DWord _cur_block = 0;       //      so sequential access does not walk it again
+};
+
+// the file system of a single disk image file
+class ImageVfs : public Vfs
+{
+    friend class ImageFile;
+
+    public:
+        ImageVfs(FILE_STATS& stats) : _stats(stats) {}
+        ~ImageVfs();
+        ImageVfs(const ImageVfs&) = delete;
+        ImageVfs& operator=(const ImageVfs&) = delete;
+
+        // an image that does not exist yet is formatted with DISK_IMAGE_BLOCKS blocks
+        bool Mount(const std::string& image, bool write_back);
+        void Flush();               // write the dirty blocks, the FAT and the superblock
+
+        std::unique_ptr<VfsFile> Open(const std::string& path, const char* mode) override;
+        bool Stat(const std::string& path, bool& folder, DWord& length) override;
+        bool MakeDir(const std::string& path) override;
+        bool ChangeDir(const std::string& path) override;
+        std::string CurrentDir() override       { return _cwd; }
+        std::string Resolve(const std::string& path) override;
+
+        bool OpenDir(const std::string& path) override;
+        bool NextEntry(std::string& name, bool& folder) override;
+
+    private:
+        // the whole directory tree, read once at Mount()
+        struct NODE {
+            std::string name;
+            bool folder = false;
+            DWord first = 0;        // first block, 0 while empty
+            DWord length = 0;       // bytes (the folder entries of a folder)
+            int parent = -1;        // the root has none
+            DWord slot = 0;         // offset of its DIRENT in the parent folder
+            std::vector<int> children;
+        };
+        std::vector<NODE> _nodes;                       // [0] is the root
+        std::unordered_map<std::string, int> _index;    // full path to node
+
+        struct BLOCK {
+            std::array<Byte, DISK_BLOCK_SIZE> data;
+            bool dirty = false;
+            std::list<DWord>::iterator lru;
+        };
+        std::unordered_map<DWord, BLOCK> _cache;        // block number to block
+        std::list<DWord> _lru;                          // most recently used first
+
+        int _find(const std::string& path);             // -1 if there is no such file
+        int _create(const std::string& path, bool folder);
+        std::string _path(int node);
+        void _loadFolder(int node, std::vector<bool>& claimed, int depth);
+        bool _claimChain(DWord first, DWord length, std::vector<bool>& claimed);
+        bool _saveEntry(int node);                      // its DIRENT (the root's is in the superblock)
+        void _truncate(int node);
+
+        bool _isData(DWord block) { return block > _fat_blocks && block < _block_count; }
+        Byte* _block(DWord block, bool write, bool fresh = false);  // fresh: not read from the image
+        DWord _chain(int node, DWord index, DWord& cur_index, DWord& cur_block, bool grow);
+        DWord _alloc();
+        void _setFat(DWord block, DWord next);
+        DWord _io(int node, DWord pos, Byte* buf, DWord len, bool write, DWord& cur_index, DWord& cur_block);
+        bool _writeBlock(DWord block, const Byte* data);
+        void _format(DWord blocks);
+
+        FILE_STATS& _stats;
+        FILE* _fp = nullptr;
+        bool _write_back = true;    // dirty blocks go to the image file, or stay in memory
+        DWord _block_count = 0;
+        DWord _fat_blocks = 0;
+        std::vector<DWord> _fat;    // the next block of each block's chain
+        std::vector<bool> _fat_dirty;   // FAT blocks changed since the last Flush()
+        DWord _next_free = 1;       // where _alloc() starts to look
+        std::string _cwd = "/";
+        int _list_node = -1;        // the folder being listed
+        size_t _list_pos = 0;
+};
+
+
+/**** NOTES *******************************************************************************
+ *
+ *  A disk image is a single host file of 512 byte blocks:
+ *
+ *      block 0         superblock: "A6809DSK", then as little-endian DWords the version
+ *                      (1), the block count, the first FAT block, the FAT block count
+ *                      and the first block and length of the root folder
+ *      FAT blocks      a DWord per block: 0 if free, the next block of its chain, or
+ *                      $FFFFFFFF at the end of a chain (and for the reserved blocks)
+ *      data blocks     file contents and folders
+ *
+ *      A folder's contents are 64 byte entries: the name (up to 51 characters, null
+ *      padded to 52 bytes), the type (0 unused, 1 file, 2 folder), three unused bytes
+ *      and then the first block and the length as DWords. Paths within the image are
+ *      separated with '/' and start at its root.
+ *
+ *  The directory tree and the FAT are read into memory when the image is mounted, so
+ *      names are looked up without touching the image. File blocks go through an LRU
+ *      cache of DISK_CACHE_BLOCKS blocks whose hits and misses count in FILE_STATS.
+ *      Dirty blocks are written when they leave the cache, and everything is written
+ *      back when a file opened for writing is closed and when the image is unmounted.
+ *
+ *  Mount() checks what it reads. The blocks that hold an entry's length must all be
+ *      data blocks, and no block may belong to two entries, which also rules out chains
+ *      and folders that loop back on themselves. An entry that fails, or a folder nested
+ *      deeper than DISK_FOLDER_DEPTH, is left out of the tree. A bad root, or a superblock
+ *      that claims more blocks than the image file holds, fails the mount.
+ *
+ *  Mounted without write_back the image file is only ever read. Changes stay in memory
+ *      and are gone at unmount, so any number of machines can run from the same image
+ *      at once and always start from the same files.
+ *
+ **** NOTES *******************************************************************************/
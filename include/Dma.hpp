@@ -0,0 +1,111 @@
+// *************************************************
+// *
+// * Dma.hpp
+// *
+// ***********************************
+#pragma once
+
+#include "IDevice.hpp"
+
+constexpr int DMA_CHANNELS = 4;     // number of independent DMA channels
+
+class Dma : public IDevice
+{
+    public:
+        Dma() { _deviceName = "Dma"; }
+        Dma(std::string sName) : IDevice(sName) {}
+        ~Dma() {};
+
+        // transfer end points (DMA_SRC_TYPE / DMA_DST_TYPE)
+        enum DMA_TARGET {
+            TARGET_CPU=0,       // CPU address space (through the Bus)
+            TARGET_EXT,         // extended memory (Memory::ext_memory)
+            TARGET_BANK,        // any MemBank page (page * 8K + address)
+            TARGET_PALETTE,     // Gfx color palette (two bytes per entry, MSB first)
+            TARGET_GLYPH,       // Gfx glyph table (eight bytes per glyph)
+            TARGET_MAX          // Count of these enumerated types
+        };
+        // DMA_CONTROL bits
+        enum DMA_CTRL : Byte {
+            CTRL_START  = 0x80, // write: start transfer,  read: channel busy
+            CTRL_INT    = 0x40, // raise an interrupt on completion
+            CTRL_FIRQ   = 0x20, // 0:IRQ,  1:FIRQ
+            CTRL_STEAL  = 0x10, // 0:instant,  1:cycle-stealing (one byte per CPU clock)
+        };
+        struct CHANNEL {
+            Byte control = 0;
+            Byte src_type = TARGET_CPU;
+            Byte src_page = 0;
+            Word src_addr = 0;
+            Byte dst_type = TARGET_CPU;
+            Byte dst_page = 0;
+            Word dst_addr = 0;
+            Word length = 0;
+            // transfer state
+            DWord pos = 0;                  // bytes transferred so far
+            std::vector<Byte> buffer;       // source data latched at start
+        };
+
+        // pure virtuals
+		Word OnAttach(Word nextAddr) override;
+		void OnInit() override;
+		void OnQuit() override;
+
+        // unused virtuals
+		void OnActivate() override {}
+		void OnDeactivate() override {}
+		void OnEvent(SDL_Event* evnt) override {}
+		void OnUpdate(float fElapsedTime) override {}
+		void OnRender() override {}
+
+        // virtuals
+        Byte read(Word offset, bool debug = false) override;
+        void write(Word offset, Byte data, bool debug = false) override;
+
+        // called by the CPU once per clock. Returns true when a
+        // cycle-stealing channel has taken the bus for this clock.
+        inline bool StealCycle() { return _steal_mask ? _steal_cycle() : false; }
+        bool Stealing() { return _steal_mask != 0; }
+
+        // called by the CPU before it samples the interrupt lines. A completed
+        // channel holds its IRQ or FIRQ until DMA_STATUS acknowledges it.
+        inline void HoldInterrupts() { if (_status) _hold_interrupts(); }
+
+        // block access to any DMA_TARGET (FileIO block transfers use these too)
+        void read_block(Byte type, Byte page, Word addr, Byte* buf, DWord len);
+        void write_block(Byte type, Byte page, Word addr, const Byte* buf, DWord len);
+
+    private:
+
+        Byte _channel = 0;          // DMA_CHANNEL register
+        Byte _status = 0;           // completion flags (bits 0-3)
+        Byte _busy_mask = 0;        // channels currently transferring
+        Byte _steal_mask = 0;       // busy channels in cycle-stealing mode
+        CHANNEL _channels[DMA_CHANNELS];
+
+        // helpers
+        void _start(int ch);
+        void _complete(int ch);
+        bool _steal_cycle();
+        void _hold_interrupts();
+};
+
+
+/**** NOTES *******************************************************************************
+ *
+ *  Programming a transfer:
+ *      1)  Write the channel number (0-3) to DMA_CHANNEL. All of the remaining
+ *          registers then refer to that channel.
+ *      2)  Set the source and destination types, pages and addresses, and the length.
+ *      3)  Write DMA_CONTROL with bit 7 set to start the transfer.
+ *
+ *  Instant transfers complete before the write to DMA_CONTROL returns. Cycle-stealing
+ *      transfers take the bus from the CPU for one clock per byte moved; channel 0 has
+ *      the highest priority. The source block is latched when the channel starts and
+ *      banked destinations are committed when the channel completes.
+ *
+ *  On completion the channel's bit in DMA_STATUS is set and, if enabled, an IRQ or
+ *      FIRQ is raised. Write a 1 to the channel's bit in DMA_STATUS to acknowledge.
+ *      Writing DMA_CONTROL with bit 7 clear aborts a busy channel.
+ *
+ **** NOTES *******************************************************************************/
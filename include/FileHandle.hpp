@@ -0,0 +1,135 @@
+// *************************************************
+// *
+// * FileHandle.hpp
+// *
+// ***********************************
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "types.hpp"
+
+// hit and miss counters shared by the handles and the stat cache of a FileIO
+struct FILE_STATS
+{
+    QWord hits = 0;             // reads and writes served from a handle's buffer
+    QWord misses = 0;           // ... that had to go to the host file
+    QWord flushes = 0;          // write-behind buffers written to the host
+    QWord stat_hits = 0;        // existence and length probes answered from the cache
+    QWord stat_misses = 0;      // ... that had to stat the host file
+    QWord mapped = 0;           // read-only opens served from a memory map
+};
+
+class FileStatCache;
+
+// an open FileIO stream, on whichever file system (Vfs) opened it
+class VfsFile
+{
+    public:
+        virtual ~VfsFile() {}
+
+        int GetC();                                 // EOF at the end of the file
+        int PutC(Byte c);                           // EOF when the write fails
+        virtual DWord Read(Byte* buf, DWord len) = 0;           // returns the bytes read
+        virtual DWord Write(const Byte* buf, DWord len) = 0;    // returns the bytes written
+        virtual bool Seek(long offset, int whence) = 0;         // SEEK_SET or SEEK_END
+        virtual DWord Tell() = 0;
+        virtual bool Eof() = 0;                     // the last read ran past the end
+};
+
+// a host file
+class FileHandle : public VfsFile
+{
+    public:
+        // a write handle forgets its path in stat_cache when it closes
+        FileHandle(FILE_STATS& stats, FileStatCache* stat_cache = nullptr)
+            : _stats(stats), _stat_cache(stat_cache) {}
+        ~FileHandle() { Close(); }
+        FileHandle(const FileHandle&) = delete;
+        FileHandle& operator=(const FileHandle&) = delete;
+
+        bool Open(const std::string& path, const char* mode);   // "rb", "wb" or "ab"
+        void Close();
+
+        DWord Read(Byte* buf, DWord len) override;
+        DWord Write(const Byte* buf, DWord len) override;
+        bool Seek(long offset, int whence) override;
+        DWord Tell() override       { return _pos; }
+        bool Eof() override         { return _eof; }
+        bool IsMapped()             { return _map != nullptr; }
+
+    private:
+        bool _fill();               // read ahead from _pos
+        bool _flush();              // write the write-behind buffer
+        DWord _length();
+        DWord _mapped();            // bytes of the map the file still backs
+
+        FILE_STATS& _stats;
+        FileStatCache* _stat_cache = nullptr;
+        std::string _path;
+        FILE* _fp = nullptr;
+        bool _writing = false;      // opened "wb" or "ab"
+        bool _append = false;       // opened "ab"
+        bool _eof = false;          // the last read ran past the end
+        DWord _pos = 0;             // file position seen by the 6809
+
+        // read-ahead or write-behind window of the file
+        std::vector<Byte> _buf;
+        DWord _buf_start = 0;       // file offset of _buf[0]
+        DWord _buf_len = 0;         // valid (or dirty) bytes in _buf
+
+        // a whole file mapped for reading
+        const Byte* _map = nullptr;
+        DWord _map_len = 0;
+};
+
+// existence and length of host files, without opening them to find out
+class FileStatCache
+{
+    public:
+        FileStatCache(FILE_STATS& stats) : _stats(stats) {}
+
+        bool Exists(const std::string& path);
+        bool Stat(const std::string& path, bool& folder, DWord& length);   // false if there is no such file
+        void Invalidate(const std::string& path)    { _cache.erase(path); }
+        void Clear()                                { _cache.clear(); }
+
+    private:
+        struct ENTRY {
+            bool exists = false;
+            bool folder = false;
+            DWord length = 0;
+            std::chrono::steady_clock::time_point when;    // when it was looked up
+        };
+        const ENTRY& _lookup(const std::string& path);
+
+        FILE_STATS& _stats;
+        std::unordered_map<std::string, ENTRY> _cache;
+};
+
+
+/**** NOTES *******************************************************************************
+ *
+ *  A FileHandle stands behind each open FileIO stream. A read-only handle reads
+ *      FILE_READ_AHEAD bytes at a time (pread on Linux), or, with FILE_MMAP_READS on
+ *      Linux, maps the whole file once and copies straight out of the map. Touching a
+ *      mapped page the file no longer backs faults the process, and a program can
+ *      truncate a file it is still reading (FC_OPENREAD, then FC_OPENWRITE on the
+ *      same path), so each copy is clamped to the file's size as fstat reports it,
+ *      and FILE_MMAP_READS is off by default. A write handle collects
+ *      up to FILE_WRITE_BEHIND consecutive bytes and writes them to the host when the
+ *      buffer fills, when a write lands anywhere else or when it closes. Seeks only
+ *      move the position, so a read after a seek is still a hit when it falls inside
+ *      the buffered window.
+ *
+ *  FileStatCache answers FC_FILEEXISTS and FC_GETLENGTH for the host folders (HostVfs).
+ *      It is keyed by the full path, a path is forgotten when HostVfs opens it for
+ *      writing and again when that handle closes, and any entry older than FILE_STAT_TTL milliseconds is looked up again
+ *      so changes made by other programs show up.
+ *
+ *  Both count their hits and misses in the FileIO's FILE_STATS (FileIO::Stats()).
+ *
+ **** NOTES *******************************************************************************/
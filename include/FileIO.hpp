@@ -9,14 +9,22 @@
  ************************************/
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include "IDevice.hpp" 
+#include "Loader.hpp"
+#include "Vfs.hpp"
 
 class FileIO : public IDevice
 {
     public:
         FileIO() { _deviceName = "FileIO"; }
         FileIO(std::string sName) : IDevice(sName) {}
-        ~FileIO() {};
+        ~FileIO() { _stopWorker(); }
 
         // pure virtuals
 		Word OnAttach(Word nextAddr) override;
@@ -44,8 +52,36 @@ class FileIO : public IDevice
             FE_BAD_CMD,     //  $06: invalid command
             FE_BADSTREAM    //  $07: invalid file stream
         };
+        // FIO_STATUS bits
+        enum FIO_STAT : Byte {
+            STAT_BUSY   = 0x80, // read: a queued command is running
+            STAT_DONE   = 0x40, // read: a queued command has finished, write 1 to acknowledge
+            STAT_ASYNC  = 0x04, // queue commands to the I/O thread
+            STAT_INT    = 0x02, // raise an interrupt when a queued command finishes
+            STAT_FIRQ   = 0x01, // 0:IRQ,  1:FIRQ
+        };
+
+        // called by the CPU before it samples the interrupt lines: finishes a queued
+        // command, and holds its interrupt until STAT_DONE is acknowledged
+        inline void Complete()
+        {
+            if (_finished) _complete();
+            if ((_status & (STAT_DONE | STAT_INT)) == (STAT_DONE | STAT_INT)) _hold_interrupt();
+        }
+
+        // file handle and stat cache counters (reported with the Alt+P profile)
+        const FILE_STATS& Stats()   { return _stats; }
+        void ResetStats()           { _stats = FILE_STATS(); }
+
+        // work on a disk image (DiskImage.hpp) instead of the host folders, or
+        // on the host folders again with an empty image name
+        bool Mount(const std::string& image, bool write_back = true);
 
     private:
+        bool _run(Byte cmd);            // run a command now, false if there is no such command
+        bool _command(Byte cmd);        // its file work, on the CPU or the I/O thread
+        void _fetch(Byte cmd);          // CPU thread: the memory it writes to a file
+        void _apply();                  // CPU thread: its memory and Math results
         // File IO System Commands
         void _cmd_reset();
         void _cmd_system_shutdown();
@@ -72,16 +108,23 @@ class FileIO : public IDevice
         void _cmd_seek_end();
         void _cmd_set_seek_position();
         void _cmd_get_seek_position();
-        Byte _fread_hex_byte(std::ifstream& ifs);
-        Word _fread_hex_word(std::ifstream& ifs);
+        void _cmd_read_block();
+        void _cmd_write_block();
+        void _cmd_load_binary();
+        void _cmd_save_binary();
+        void _cmd_read_directory();
 
 
         int _FindOpenFileSlot();    // return a handle to an open file stream slot
         bool _bFileExists(const char* file);    // checks to see if a file exists
         void _openFile(const char* mode);       // file open helper
+        VfsFile* _handleStream();               // stream of FIO_HANDLE, nullptr (FE_NOTOPEN) if none
+        DWord _blkCapacity();                   // bytes from FIO_BLK_ADDR to the end of its memory
 
         Byte _fileHandle = 0;      // file stream index (HANDLE)
-        std::vector<FILE*> _vecFileStreams; // vector of file streams
+        std::vector<std::unique_ptr<VfsFile>> _vecFileStreams; // vector of file streams
+        FILE_STATS _stats;                  // handle and stat cache counters
+        std::unique_ptr<Vfs> _vfs;          // the host folders or a disk image
 
         // Byte fio_err_flags = 0;     // error flags (deprecated)
         FILE_ERROR fio_error_code = FILE_ERROR::FE_NOERROR;    // current error code
@@ -89,9 +132,105 @@ class FileIO : public IDevice
         Byte path_char_pos = 0;   // active character position within the file path string
         std::string filePath = "";  // the current file path
 
-        int dir_data_pos = 0;     // position within the dir_data string
-        std::string dir_data;       // directory filename list container
+        int dir_data_pos = 0;     // position within the dir_data line
+        std::string dir_data;       // the directory listing line being read
+
+        // directory listing (FC_LISTDIR), formatted a line at a time
+        std::string _dir_entry;     // the name of the entry being formatted
+        std::string _dir_name;      // wildcard filter: the whole name,
+        std::string _dir_stem;      //      the stem,
+        std::string _dir_ext;       //      and the extension
+        bool _dir_filter = false;   // matching files only, or the whole folder
+        bool _dir_open = false;     // the Vfs still has entries to list
+        void _dirNextLine();
+        bool _dirFormat(const std::string& name, bool folder);
 
         Byte  _io_data = 0;     // data to read / write
         DWord _seek_pos = 0;    // file seek position
+
+        // block transfers (FC_READBLOCK, FC_WRITEBLOCK, FC_LOADBIN, FC_SAVEBIN)
+        Byte  _blk_type = 0;    // memory type (Dma::DMA_TARGET)
+        Byte  _blk_page = 0;    // page of a banked memory transfer
+        Word  _blk_addr = 0;    // memory address
+        Word  _blk_len = 0;     // bytes to move, 0: the command's maximum
+        DWord _blk_count = 0;   // bytes moved by the last block command
+
+        // a command's view of the rest of the machine, latched by _fetch() before it
+        // runs and stored by _apply() after, so the I/O thread never touches the Bus
+        std::vector<Byte> _xfer;        // block data from memory, or for memory
+        DWord _xfer_cap = 0;            // FC_LOADBIN: room from FIO_BLK_ADDR onward
+        Byte  _xfer_type = 0;           // where _apply() stores _xfer
+        Byte  _xfer_page = 0;
+        Word  _xfer_addr = 0;
+        bool  _xfer_store = false;
+        DWord _acr = 0;                 // FC_GETLENGTH: for MATH_ACR_INT
+        bool  _acr_store = false;
+        Loader _loader;                 // FC_LOADHEX: the parsed records
+        bool  _loader_store = false;
+        void _storeXfer(Byte type, Byte page, Word addr);
+
+        // asynchronous commands (FIO_STATUS)
+        Byte _status = 0;                   // STAT_DONE and the control bits
+        std::thread _worker;
+        std::mutex _mutex;
+        std::condition_variable _cv;
+        Byte _queued = 0;                   // command waiting for the I/O thread
+        bool _bQueued = false;              // (guarded by _mutex)
+        bool _bWorkerRunning = false;       // (guarded by _mutex)
+        std::atomic<bool> _busy{false};     // a queued command has not completed yet
+        std::atomic<bool> _finished{false}; // the I/O thread is done with it
+
+        void _waitCommand();                // block until a queued command completes
+        void _queueCommand(Byte cmd);
+        void _complete();                   // CPU thread: STAT_DONE
+        void _hold_interrupt();             // CPU thread: assert the IRQ or FIRQ line
+        void _workerProc();
+        void _stopWorker();
 };
+
+
+/**** NOTES *******************************************************************************
+ *
+ *  Block transfers move data between a file and memory in a single command instead of
+ *      one FC_READBYTE or FC_WRITEBYTE per byte. The memory side is FIO_BLK_TYPE,
+ *      FIO_BLK_PAGE and FIO_BLK_ADDR, using the DMA_TYPE_<type> values: the CPU address
+ *      space, extended memory or any banked memory page. It defaults to FIO_BUFFER.
+ *
+ *      FC_READBLOCK    reads up to FIO_BLK_LEN bytes (256 at most, 0 for 256) from the
+ *                      FIO_HANDLE file, and sets FE_EOF when the file runs out first
+ *      FC_WRITEBLOCK   writes FIO_BLK_LEN bytes (256 at most, 0 for 256) to FIO_HANDLE
+ *      FC_LOADBIN      loads the whole file named by the path, and sets FE_OVERRUN when
+ *                      it does not fit between FIO_BLK_ADDR and the end of the memory
+ *      FC_SAVEBIN      saves FIO_BLK_LEN bytes (0 for 64K) to the file named by the path
+ *
+ *  Each command leaves the number of bytes actually moved in FIO_BLK_COUNT. The Word
+ *      and DWord block registers are MSB first, as the DMA registers are.
+ *
+ *  Paths name files in the mounted Vfs: the host folders, relative to this FileIO's own
+ *      current folder, or the folders of a disk image when one is mounted.
+ *
+ *  FC_LISTDIR opens the folder and FIO_DIR_DATA formats its entries one line at a time
+ *      as they are read, so a large folder costs nothing up front. The lines come in
+ *      the host's directory order rather than sorted. FC_READDIR copies the next 255
+ *      bytes (or fewer) of the same listing into FIO_BUFFER with a null after them,
+ *      leaves the count in FIO_BLK_COUNT and sets FE_EOF once the listing runs out.
+ *
+ *  Commands normally run to completion inside the write to FIO_COMMAND. With STAT_ASYNC
+ *      set in FIO_STATUS they are handed to an I/O thread instead and the CPU carries
+ *      on: FIO_STATUS reads STAT_BUSY until the command is done, then STAT_DONE, and
+ *      with STAT_INT set an IRQ (or FIRQ with STAT_FIRQ) is raised at that instruction
+ *      boundary. Writing FIO_STATUS sets the three control bits, and a 1 in STAT_DONE
+ *      acknowledges the command, so a handler writes STAT_DONE with the control bits
+ *      it wants to keep. As with the DMA channels the line is held until then, so a
+ *      command that finishes while the interrupt is masked is taken once it is not.
+ *
+ *  While a command is busy the rest of the FileIO registers belong to it: reads return
+ *      zero and writes are ignored. The I/O thread only does the host file work: the
+ *      memory a command writes out (FC_WRITEBLOCK, FC_SAVEBIN) is read when it is
+ *      issued, and what it loads into memory, FIO_BUFFER or MATH_ACR_INT is stored
+ *      on the CPU thread as it completes. A second command written to FIO_COMMAND
+ *      waits for the first one to finish. FC_RESET and FC_SHUTDOWN always run at once.
+ *      Completion times depend on the host, so programs that need repeatable runs
+ *      leave STAT_ASYNC clear.
+ *
+ **** NOTES *******************************************************************************/
@@ -14,6 +14,8 @@ class Gfx : public IDevice
     friend class Debug; 
     friend class Mouse;
     friend class Memory;
+    friend class Dma;
+    friend class Capture;
 
     public:
         Gfx() { _deviceName = "Gfx"; }
@@ -66,12 +68,16 @@ class Gfx : public IDevice
         Uint8 alf(Uint8 index) { Uint8 c = _palette[index].a;  return c; }  
 
         // public accessors
-        inline static Byte GetGlyphData(Byte index, Byte row) { return _gfx_glyph_data[index][row]; }
-        inline static void Present() { SDL_RenderPresent(sdl_renderer); }
+        Byte GetGlyphData(Byte index, Byte row) { return _gfx_glyph_data[index][row]; }
+        void Present() { SDL_RenderPresent(sdl_renderer); }
         bool VerifyGmode(Byte gmode);
+        void RasterClock();     // advance the raster beam one CPU clock
+        DWord GetRasterFrame() { return _raster_frame; }   // emulated frames since power on
+        DWord GmodeCount() { return (DWord)vec_gmodes.size(); }
+        void RenderFrame(Byte gmode, std::vector<Uint16>& pixels, Word& width, Word& height);
 
-        inline static Uint32 GetWindowID() { return SDL_GetWindowID(sdl_window); }
-        inline static SDL_Window* GetSDLWindow() { return sdl_window; }
+        static Uint32 GetWindowID();        // the main window of the current bus
+        static SDL_Window* GetSDLWindow();
 
         Word GetTimingWidth();
         Word GetTimingHeight();
@@ -80,15 +86,15 @@ class Gfx : public IDevice
 
     private:
 
-        // internal registers (do these really need to be statics?)
-        inline static Byte s_gfx_mode   = 0x0E;     // defaults: 0x03 = 40x25 text   0x0E = 32x15 text (16:9)
-        inline static Byte s_gfx_emu    = 0x00;     // default: 0 = windowed... primary monitor
-        inline static Byte _gfx_pal_idx = 0x00;     // GFX_PAL_IDX
-        inline static Byte _gfx_glyph_idx = 0x00;         // GFX_GLYPH_IDX
-        inline static Byte _gfx_glyph_data[256][8]{0};    // GFX_GLYPH_DATA (Customizeable)
-        inline static SDL_Window* sdl_window = nullptr;
-        inline static SDL_Renderer* sdl_renderer = nullptr;
-        inline static SDL_Texture* sdl_target_texture = nullptr;
+        // internal registers
+        Byte _gfx_mode   = 0x0E;     // defaults: 0x03 = 40x25 text   0x0E = 32x15 text (16:9)
+        Byte _gfx_emu    = 0x00;     // default: 0 = windowed... primary monitor
+        Byte _gfx_pal_idx = 0x00;     // GFX_PAL_IDX
+        Byte _gfx_glyph_idx = 0x00;         // GFX_GLYPH_IDX
+        Byte _gfx_glyph_data[256][8]{0};    // GFX_GLYPH_DATA (Customizeable)
+        SDL_Window* sdl_window = nullptr;
+        SDL_Renderer* sdl_renderer = nullptr;
+        SDL_Texture* sdl_target_texture = nullptr;
         Word gfx_vid_end = VIDEO_END;
 
         Uint32 sdl_renderer_flags = 0;
@@ -101,6 +107,16 @@ class Gfx : public IDevice
         Word res_height = 0;
         Byte bits_per_pixel = 1;
 
+        // raster interrupts (driven by the CPU thread)
+        Byte _irq_ctrl = 0;             // GFX_IRQ_CTRL
+        Byte _irq_status = 0;           // GFX_IRQ_STATUS
+        Word _raster_cmp = 0;           // GFX_RASTER_CMP
+        Word _raster_line = 0;          // GFX_SCANLINE
+        Word _raster_visible = 480;     // visible lines per frame
+        Word _raster_lines = 525;       // total lines per frame
+        int _raster_acc = 0;            // fractional line accumulator
+        DWord _raster_frame = 0;        // completed raster frames
+
         std::vector<GTIMING> vec_timings;
         std::vector<GMODE> vec_gmodes;   
 
@@ -108,6 +124,9 @@ class Gfx : public IDevice
         void _init_tests();
         void _init_gmodes();
         void _decode_gmode();
+        void _decode_resolution(Byte gmode);
+        static Byte _fitGmode(Byte gmode, int width, int height);
+        static Byte _gmodeBpp(Byte gmode) { return (gmode & 0x80) ? 1<<((gmode & 0x60)>>5) : 0; }
  		void _setPixel(int x, int y, Byte color_index, 	
 						SDL_Texture* _texture, bool bIgnoreAlpha = false);
         void _setPixel_unlocked(void* pixels, int pitch, int x, int y, 
@@ -115,6 +134,9 @@ class Gfx : public IDevice
         void _updateTextScreen();        
         void _updateBitmapScreen();    
         void _updateExtendedBitmapScreen();
+        void _drawTextScreen(void* pixels, int pitch, int width, int height);
+        void _drawBitmapScreen(void* pixels, int pitch, int width, int height, Byte bpp);
+        void _drawExtendedBitmapScreen(void* pixels, int pitch, int width, int height);
 };
 
 
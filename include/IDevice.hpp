@@ -42,6 +42,7 @@ class IDevice
         void Name(std::string n) { _deviceName = n; }
         Byte _memory(Word ofs) { return m_memory[ofs]; }
         void _memory(Word ofs, Byte data) { m_memory[ofs] = data; }
+        Byte* _data() { return m_memory.data(); }
 
     protected:
         std::string _deviceName = "??DEV??";
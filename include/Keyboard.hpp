@@ -10,6 +10,7 @@
 
 #include <unordered_map>
 #include <queue>
+#include <deque>
 #include <array>
 
 #include "IDevice.hpp" 
@@ -36,7 +37,7 @@ class Keyboard : public IDevice
 		void OnQuit() override {};
 		void OnActivate() override {};
 		void OnDeactivate() override {};
-		void OnUpdate(float fElapsedTime) override {};
+		void OnUpdate(float fElapsedTime) override;
 		void OnRender() override {};
 
         // virtuals
@@ -47,6 +48,7 @@ class Keyboard : public IDevice
         int charQueueLen();
         Byte charScanQueue();
         Byte charPopQueue();
+        void Type(const std::string& text);    // scripted keystrokes (headless machines)
         XKey::XK TranslateSDLtoXKey(SDL_Scancode k);
         XKey::XK AscToXKey(Byte asc);
         char XKeyToAscii(XKey::XK xKey);
@@ -57,6 +59,7 @@ private:
 	std::unordered_map<XKey::XK, int> keyMap;
 	std::vector<std::tuple<XKey::XK, char, char>> xkToAsciiMap;
 	std::queue <Byte> charQueue;		// ascii character queue
+	std::deque <Byte> _typed;			// scripted keystrokes not yet typed
 	std::array <Byte, EDIT_BUFFER_SIZE> editBuffer;	// internal line edit character buffer
 	Byte edt_bfr_csr = 0;				// internal edit character buffer cursor position
 	std::string _str_edt_buffer = "";
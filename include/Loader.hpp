@@ -0,0 +1,56 @@
+// *************************************************
+// *
+// * Loader.hpp
+// *
+// ***********************************
+#pragma once
+
+#include <string>
+#include <vector>
+#include "types.hpp"
+
+// program files (Intel HEX, Motorola S-records or raw binary) parsed into runs of
+// contiguous bytes and stored into the bus a run at a time
+class Loader
+{
+    public:
+        enum FORMAT { FMT_HEX, FMT_SREC, FMT_BIN };
+        static FORMAT Format(const std::string& filename);     // by its extension
+        static bool ReadFile(const std::string& filename, std::vector<Byte>& data);
+
+        // false on a malformed record or a bad checksum, nothing is kept then
+        bool Parse(const Byte* data, DWord len, FORMAT format, Word bin_addr = 0);
+        void Store();               // into the memory of Bus::Inst(), as debug writes
+        DWord Bytes()               { return (DWord)_bytes.size(); }
+        DWord Runs()                { return (DWord)_runs.size(); }
+
+    private:
+        struct RUN {
+            Word addr;
+            DWord start;            // offset in _bytes
+            DWord length;
+        };
+        std::vector<RUN> _runs;
+        std::vector<Byte> _bytes;
+
+        void _add(Word addr, const Byte* data, DWord len);
+        bool _hex(const Byte* data, DWord len);
+        bool _srec(const Byte* data, DWord len);
+};
+
+
+/**** NOTES *******************************************************************************
+ *
+ *  Bus::load_hex() (the kernel ROM and Machine::LoadHex()) and FC_LOADHEX share the
+ *      Loader. The whole file is read at once, every record's checksum is checked
+ *      before anything is stored, and records that follow on from the one before are
+ *      joined into a single run. Store() copies each run straight into the memory of
+ *      the devices it covers (Bus::write_block), exactly as the byte at a time debug
+ *      writes did, so a ROM image lands in ROM.
+ *
+ *  Intel HEX data (00) and end of file (01) records are used, the address and start
+ *      records (02 to 05) are skipped. Of the S-records S1, S2 and S3 carry data
+ *      (S2 and S3 must stay below $10000), S7 to S9 end the file and S0, S5 and S6
+ *      are skipped. A raw binary is stored from bin_addr, wrapping past $FFFF.
+ *
+ **** NOTES *******************************************************************************/
@@ -0,0 +1,72 @@
+// *************************************************
+// *
+// * Machine.hpp
+// *
+// ***********************************
+#pragma once
+
+#include "Bus.hpp"
+
+class Machine
+{
+    public:
+        Machine(const std::string& paged_file = PAGED_MEMORY_FILENAME);   // "" keeps banked memory in RAM
+        ~Machine();
+        Machine(const Machine&) = delete;
+        Machine& operator=(const Machine&) = delete;
+
+        Bus& GetBus()               { return *_bus; }
+        C6809* GetC6809()           { return _bus->_c6809; }
+        bool IsRunning()            { return _bus->_bIsRunning; }
+        void Stop()                 { _bus->_bIsRunning = false; }
+
+        void LoadHex(const std::string& filename, Word bin_addr = 0);  // .hex, .s19 or .bin at bin_addr
+        bool MountDisk(const std::string& image, bool write_back = true);  // "" for the host folders
+        void Reset();                           // reset the CPU through the RESET vector
+        QWord Run(QWord clocks);                // returns the number of clocks actually run
+        DWord RunFrames(DWord frames);          // run whole emulated raster frames
+        QWord Cycles();                         // CPU clocks run since the Machine was built
+        void Type(const std::string& text);     // type keystrokes, one per frame, '\n' for RETURN
+        QWord FrameHash(Byte gmode);            // hash of the display as drawn in gmode (see Capture)
+
+        Byte Read(Word offset)                  { return Bus::Read(offset); }
+        void Write(Word offset, Byte data)      { Bus::Write(offset, data); }
+
+    private:
+        Bus* _bus = nullptr;
+};
+
+
+/**** NOTES *******************************************************************************
+ *
+ *  A Machine is a complete headless computer: its own Bus, CPU and devices, with no
+ *      SDL window, no debugger window and no CPU thread. The owner clocks it with
+ *      Run() or RunFrames() instead.
+ *
+ *  Devices still reach their bus through Bus::Inst(). Constructing a Machine binds its
+ *      bus to the calling thread until the Machine is destroyed, so each thread can
+ *      host one Machine at a time and a Machine must only be used from the thread
+ *      that created it. Threads with no Machine bound see the interactive bus.
+ *
+ *  Each Machine's FileIO keeps its own current folder, but the host folders themselves
+ *      are shared. MountDisk() gives a machine a disk image instead; mounted without
+ *      write_back the image is never written, so parallel runs can share one image
+ *      and each start from the same files. Machines that use banked memory
+ *      concurrently should each be given their own paged_file, or "" for banked
+ *      memory that lives only in RAM.
+ *
+ *  With no wall clock to follow, Run() and RunFrames() advance SYS_CLOCK_DIV, SYS_TIMER
+ *      and SYS_SPEED from the emulated cycle count and update the devices once per
+ *      emulated 60 hz frame, so timed programs behave the same however fast the host
+ *      runs them. Updates that only draw to a window are skipped. Type() feeds the
+ *      keyboard as these updates run, a key each time the last one has been taken.
+ *
+ *  The kernel ROM is compiled in from kernel_f000.hex (tools/embed_kernel.cmake), so
+ *      building a Machine reads no files for it; with KERNEL_ROM_EMBEDDED off it is
+ *      loaded from KERNEL_ROM_FILENAME instead. Built with KERNEL_BOOT_SNAPSHOT, every
+ *      bus starts where the kernel's boot leaves it, stopped at KRNL_LINEEDIT: the
+ *      boot's device writes are replayed, RAM and the CPU registers are restored, and
+ *      the cycle count starts from zero. tools/boot_snapshot.cpp makes the snapshot at
+ *      build time by booting a Machine. Reset() still boots through the RESET vector.
+ *
+ **** NOTES *******************************************************************************/
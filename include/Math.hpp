@@ -29,39 +29,38 @@ class Math : public IDevice
         void write(Word offset, Byte data, bool debug = false) override;
 
     private:
-        // ACA:  Float Accumilator A
-        float aca_float = 0.0f;		// the ACA working float
-        Byte aca_pos = 0;			// character position within ACA string
-        std::string aca_string = "";	// internal ACA float string
-        DWord aca_raw = 0;			// internal ACA raw float data
-        DWord aca_int = 0;			// internal ACA integer data
-
-        // ACB:  Float Accumilator B
-        float acb_float = 0.0f;		// the ACB working float
-        Byte acb_pos = 0;			// character position within ACB string
-        std::string acb_string = "";	// internal ACB float string
-        DWord acb_raw = 0;			// internal ACB raw float data
-        DWord acb_int = 0;			// internal ACB integer data
-
-        // ACR:  Float Accumilator R (return)
-        float acr_float = 0.0f;		// the ACR working float
-        Byte acr_pos = 0;			// character position within ACR string
-        std::string acr_string = "";	// internal ACR float string
-        DWord acr_raw = 0;			// internal ACR raw float data
-        DWord acr_int = 0;			// internal ACR integer data
+        // a float accumulator and its register forms
+        struct ACCUMULATOR {
+            float value = 0.0f;         // the working float
+            DWord raw = 0;              // MATH_ACx_RAW: the float's bits
+            DWord integer = 0;          // MATH_ACx_INT
+            Byte pos = 0;               // character position within the string
+            Byte length = 0;
+            bool stale = false;         // the string is made from the value when it is next used
+            char string[64] = "";       // MATH_ACx_DATA: the float string
+        };
+        ACCUMULATOR aca;            // ACA:  Float Accumilator A
+        ACCUMULATOR acb;            // ACB:  Float Accumilator B
+        ACCUMULATOR acr;            // ACR:  Float Accumilator R (return)
 
         // MATH_OPERATION
         Byte math_operation = 0;	// Operation 'command' 
         DWord math_random_seed = 0;	// random seed
 
         // HELPERS
-        Byte _read_acc(Word offset, Word reg, Byte& _pos, 
-                float& _float, std::string& _string, DWord& _raw, DWord& _int);
-        Byte _write_acc(Word offset, Byte data, Word reg, Byte& _pos, 
-                float& _float, std::string& _string, DWord& _raw, DWord& _int);
-        void _update_regs_from_float(float f_data, float& _float,
-                Byte& _pos, std::string& _string, DWord& _raw, DWord& _int);
+        Byte _read_acc(Word offset, Word reg, ACCUMULATOR& acc);
+        Byte _write_acc(Word offset, Byte data, Word reg, ACCUMULATOR& acc);
+        void _update_regs_from_float(float f_data, ACCUMULATOR& acc);
+        void _string_from_float(ACCUMULATOR& acc);     // when the string is stale
 };
 
 
-
+/**** NOTES *******************************************************************************
+ *
+ *  Operations and MATH_ACx_RAW / MATH_ACx_INT writes only set the value, the raw bits
+ *      and the integer. The float string, formatted as std::to_string() did ("%f"), is
+ *      made in the accumulator's own buffer the first time MATH_ACx_POS or
+ *      MATH_ACx_DATA is used after a change, so programs that never read the string
+ *      never pay for it.
+ *
+ **** NOTES *******************************************************************************/
@@ -5,6 +5,12 @@
 // ***********************************
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 #include "IDevice.hpp" 
 
 class MemBank : public IDevice
@@ -12,7 +18,7 @@ class MemBank : public IDevice
     public:
         MemBank() { _deviceName = "MemBank"; }
         MemBank(std::string sName) : IDevice(sName) {}
-        ~MemBank() {};
+        ~MemBank() { _stopFlusher(); }
 
         // structures used
 
@@ -27,13 +33,20 @@ class MemBank : public IDevice
             DWord seek_pos;     // byte position of this bank data within the file
         };
         struct BANK_HEADER {
+            char id_string[7] = {"M_BANK"};
+            float version = 0.0f;
+            Word bank_1_index = 0;
+            Word bank_2_index = 1;
+            Word exec_vector = 0;
+            DWord page_count = 0;   // the BANK_NODEs that follow the header
+        };
+        struct BANK_HEADER_V1 {     // versions 0 and 1: 256 pages
             char id_string[7] = {"M_BANK"};
             float version = 0.0f;
             Byte bank_1_index = 0;
             Byte bank_2_index = 1;
             Word exec_vector = 0;
             BANK_NODE bank_node[256] ;
-            // Byte bank_data[256][8192];
         };
 
         // pure virtuals
@@ -53,23 +66,76 @@ class MemBank : public IDevice
         void write(Word offset, Byte data, bool debug = false) override;
 
         // public methods
-        void set_bank_1_page(Byte page);
-        void set_bank_2_page(Byte page);
-        Byte get_bank_1_page()                  { return _bank_header.bank_1_index; }
-        Byte get_bank_2_page()                  { return _bank_header.bank_2_index; }
-        void set_bank_1_type(BANK_TYPE type)    { _bank_header.bank_node[get_bank_1_page()].type = type; }
-        void set_bank_2_type(BANK_TYPE type)    { _bank_header.bank_node[get_bank_2_page()].type = type; }
-        BANK_TYPE get_bank_1_type()             { return _bank_header.bank_node[get_bank_1_page()].type; }
-        BANK_TYPE get_bank_2_type()             { return _bank_header.bank_node[get_bank_2_page()].type; }
+        void set_bank_1_page(Word page);
+        void set_bank_2_page(Word page);
+        void Filename(const std::string& filename)  { _filename = filename; }   // before OnInit(), "" for no file
+        Word get_bank_1_page()                  { return _bank_header.bank_1_index; }
+        Word get_bank_2_page()                  { return _bank_header.bank_2_index; }
+        DWord PageCount()                       { return (DWord)_bank_nodes.size(); }
+        void set_bank_1_type(BANK_TYPE type)    { _setBankType(0, type); }
+        void set_bank_2_type(BANK_TYPE type)    { _setBankType(1, type); }
+        BANK_TYPE get_bank_1_type()             { return _bank_nodes[get_bank_1_page()].type; }
+        BANK_TYPE get_bank_2_type()             { return _bank_nodes[get_bank_2_page()].type; }
+
+        // block access to any page, mapped or not (linear = page * 8K + offset)
+        void read_block(DWord linear, Byte* buf, DWord len);
+        void write_block(DWord linear, const Byte* buf, DWord len);
+
+        // the bank buffers were written around write() (Bus debug writes and write_block)
+        void Touched(Word offset, DWord len);
 
     private:
 
+        static constexpr float PAGED_VERSION = 2.0f;    // a BANK_NODE per page, pages in PAGED_SLOT slots
+        static constexpr DWord PAGED_SLOT = sizeof(DWord) + PAGED_MEMORY_BANKSIZE;
+        static constexpr DWord PAGED_MAX_PAGES = 65536;
+        static_assert(PAGED_MEMORY_BANKS >= 2 && PAGED_MEMORY_BANKS <= PAGED_MAX_PAGES,
+            "PAGED_MEMORY_BANKS is out of range");
+
         BANK_HEADER _bank_header;
+        std::vector<BANK_NODE> _bank_nodes;     // one for each page
+        bool _nodes_dirty = false;              // (guarded by _mutex)
+        std::string _filename = PAGED_MEMORY_FILENAME;  // backing 'paged.mem' file, "" for none
+        FILE* _fp = nullptr;            // 'paged.mem', open from OnInit() to OnQuit()
 
+        // pages recently switched out, most recently used first
+        struct PAGE {
+            std::vector<Byte> data;
+            bool dirty = false;         // not yet written to 'paged.mem'
+            std::list<Word>::iterator lru;
+        };
+        std::unordered_map<Word, PAGE> _cache;
+        std::list<Word> _lru;
+        std::atomic<bool> _bank_dirty[2] = { {false}, {false} };  // bank one or two written since it was mapped
+        bool _header_dirty = false;
+
+        // background write-back of dirty pages and the header
+        std::thread _flusher;
+        std::mutex _mutex;              // the cache and the header
+        std::mutex _file_mutex;         // _fp (taken after _mutex, never before it)
+        std::condition_variable _cv;
+        bool _bFlusherRunning = false;  // (guarded by _mutex)
+
+        void _setBankPage(int bank, Word page);
+        void _setBankType(int bank, BANK_TYPE type);
+        Byte* _bank(int bank)           { return _data() + (bank ? 0xD000 : 0xB000) - Base(); }
+        Word& _bankIndex(int bank)      { return bank ? _bank_header.bank_2_index : _bank_header.bank_1_index; }
+        static DWord _slotPos(DWord page)   // where a page is stored in the file
+            { return sizeof(BANK_HEADER) + PAGED_MAX_PAGES * sizeof(BANK_NODE) + page * PAGED_SLOT; }
+        void _addPages(DWord count);    // grow the file's index to count pages
+        void _storePage(Word page, const Byte* data, bool dirty);  // into the cache
+        bool _readPage(Word page, Byte* buf, DWord ofs, DWord len);
+        bool _writePage(Word page, const Byte* buf, DWord ofs, DWord len);
+        void _flush(std::unique_lock<std::mutex>& lock);   // dirty cached pages, then the header, each synced to disk
+        void _flusherProc();
+        void _stopFlusher();
+
+        Word _mappedAddress(Word page); // CPU address of a mapped page, 0 if not mapped
         bool _fileExists(const std::string& filename);  // returns true if the file exists
         bool _newDefaultFile();         // create a new 'paged.mem' bank file if not exists
+        bool _upgradeFile();            // convert a version 0 or 1 'paged.mem' file
         bool _loadHeader();             // load the header info from the 'paged.mem' file
-        bool _saveHeader();             // save the header info to the 'paged.mem' file
+        bool _saveHeader(const BANK_HEADER& header, const std::vector<BANK_NODE>* nodes);  // to the 'paged.mem' file
         FILE* _fopen(const std::string filename);       // open a file with error handling
 
 };
@@ -78,10 +144,47 @@ class MemBank : public IDevice
 /**** NOTES *******************************************************************************
  * 
  *  Interface: 
- *          set_bank_1_page(page_index)     // set bank ones page (0-255)
- *          set_bank_2_page(page_index)     // set bank twos page (0-255)
+ *          set_bank_1_page(page_index)     // set bank ones page (0 to PageCount()-1)
+ *          set_bank_2_page(page_index)     // set bank twos page (0 to PageCount()-1)
  *  
  *          set_bank_1_type(BANK_TYPE)      // set bank ones type to ROM, RAM, or PERSIST
  *          set_bank_2_type(BANK_TYPE)      // set bank ones type to ROM, RAM, or PERSIST
  * 
+ *          read_block(linear, buf, len)    // copy from any page (mapped pages come from RAM)
+ *          write_block(linear, buf, len)   // copy to any page (READ_ONLY pages are skipped)
+ * 
+ *  A page switched out of a bank goes into a cache of the last MEMBANK_CACHE_PAGES
+ *      pages, and a page switched in comes from that cache when it can, so switching
+ *      between the same few pages does no file I/O. Only pages written since they were
+ *      loaded (a dirty bit per bank, set by write()) are written back to 'paged.mem':
+ *      when they leave the cache, every MEMBANK_FLUSH_MS by a background thread, and
+ *      at OnQuit(). Each flush writes the dirty pages and syncs them to disk before
+ *      the header is written in one piece and synced, so the header never names
+ *      bank contents that have not reached the file. The flush copies the dirty pages
+ *      and the header while it holds _mutex and does the writing and syncing after
+ *      releasing it, holding only _file_mutex, so the CPU only waits on a flush when
+ *      it needs the file itself.
+ *
+ *      Switching pages only changes the bank indices in the header, which is not
+ *      marked dirty for it: the indices are saved at OnQuit() (or with the next header
+ *      write), so a switch between cached pages does no I/O at all.
+ * 
+ *  'paged.mem' is the BANK_HEADER, a BANK_NODE for each of its page_count pages (room
+ *      is left for PAGED_MAX_PAGES of them), then a slot of PAGED_SLOT bytes for each
+ *      page at its BANK_NODE seek_pos. A slot starts with the page's stored length as
+ *      a DWord: 0 for a page of zeros, PAGED_MEMORY_BANKSIZE for a raw page, or less
+ *      for a page packed with the run length encoding in MemBank.cpp (when
+ *      MEMBANK_COMPRESS is set). The rest of the slot is never written, so a new file
+ *      is only its header and the file system keeps holes for the pages that are
+ *      still zeros, however many pages there are.
+ *
+ *      PAGED_MEMORY_BANKS sets the page count, up to 65536 pages (512 MB). An existing
+ *      file is grown to it, never shrunk. Files of the 256 page layouts (version 0,
+ *      each page stored raw 8K apart, and version 1) are converted the first time
+ *      they are opened.
+ *
+ *  With an empty Filename() there is no 'paged.mem' at all: the pages start as zeros,
+ *      live in the cache (which then never evicts) and are gone at OnQuit(). Headless
+ *      machines run side by side use this, so none of them shares a file.
+ * 
  **** NOTES *******************************************************************************/
\ No newline at end of file
@@ -12,6 +12,7 @@
 class Memory : public IDevice
 {
     friend class Gfx;   // for private access to 'ext_memory' and 'memory_btm'
+    friend class Dma;   // for private access to 'ext_memory'
 
     public:
         Memory() { _deviceName = "Memory"; }
@@ -43,10 +44,14 @@ class Memory : public IDevice
 
     private:
 
+        Word reg_bank_page[2] = { 0, 0 };   // MEM_BANK1_PAGE and MEM_BANK2_PAGE
+        void _latchBankPages();             // reload them from the banks
         Byte reg_dsp_flags = 0;     // extended display flags register
         Word reg_addr = 0;          // address register
         Word reg_pitch = 1;         // pitch register
         Word reg_width = 1;         // width register
+        Word _ext_width = 0;        // bytes left in the current MEM_EXT_DATA row
+        bool _bExtWidthInit = false;
         std::array<Byte, 65536> ext_memory = {0};
 
         Word reg_size = 0;          // dynamic memory size register
@@ -54,6 +59,7 @@ class Memory : public IDevice
         Word reg_avail = 0;         // amount of available dynamic memory
         std::map<Word, Word> dyn_heap;    // first = address, second = size
         int memory_btm = 0x0000;    // bottom of the memory heap (AKA display buffer size)
+        int _lastAddr = 0xFFFF;     // lowest heap address handed out so far
 
         // helpers
         Word _findFirstBlockOfSize(Word size);  // find an available block of SIZE
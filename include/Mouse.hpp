@@ -33,6 +33,8 @@ class Mouse : public IDevice
         Uint8 blu(Uint8 index) { Uint8 c = _csr_palette[index].b;  return c; }
         Uint8 alf(Uint8 index) { Uint8 c = _csr_palette[index].a;  return c; }        
 
+        SDL_Texture* GetCursorTexture() { return _cursor_texture; }
+
     private:
         // palette stuff
         union PALETTE {
@@ -80,6 +82,9 @@ class Mouse : public IDevice
         Uint8 mouse_y_offset = 0;	// mouse cursor offset y
         Byte button_flags = 0;		// bits 0-4: button states, bit 5: cursor enable, bits 6-7: number of clicks
         bool _bCsrIsDirty = true;		// internal flag
+        bool _bCsrWasShown = false;		// cursor state when the pointer left the main window
+        Byte _buttons = 0;				// SDL buttons held down
+        bool _bCsrWasCleared = false;	// the cursor texture has been cleared since the cursor was last drawn
         // bool _bUseSdlCursor = ENABLE_SDL_MOUSE_CURSOR;  // was _bCsrIsVisible
 
         // cursor stuff
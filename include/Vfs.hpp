@@ -0,0 +1,66 @@
+// *************************************************
+// *
+// * Vfs.hpp
+// *
+// ***********************************
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include "FileHandle.hpp"
+
+// the file system a FileIO works on
+class Vfs
+{
+    public:
+        virtual ~Vfs() {}
+
+        // nullptr if the file cannot be opened with mode ("rb", "wb" or "ab")
+        virtual std::unique_ptr<VfsFile> Open(const std::string& path, const char* mode) = 0;
+        virtual bool Stat(const std::string& path, bool& folder, DWord& length) = 0;  // false if there is no such file
+        virtual bool MakeDir(const std::string& path) = 0;
+        virtual bool ChangeDir(const std::string& path) = 0;
+        virtual std::string CurrentDir() = 0;
+        virtual std::string Resolve(const std::string& path) = 0;   // the full path, "" for the current folder
+
+        // folder listing, an entry at a time
+        virtual bool OpenDir(const std::string& path) = 0;
+        virtual bool NextEntry(std::string& name, bool& folder) = 0;    // false at the end
+};
+
+// the folders of the host
+class HostVfs : public Vfs
+{
+    public:
+        HostVfs(FILE_STATS& stats);
+
+        std::unique_ptr<VfsFile> Open(const std::string& path, const char* mode) override;
+        bool Stat(const std::string& path, bool& folder, DWord& length) override;
+        bool MakeDir(const std::string& path) override;
+        bool ChangeDir(const std::string& path) override;
+        std::string CurrentDir() override       { return _cwd; }
+        std::string Resolve(const std::string& path) override;
+
+        bool OpenDir(const std::string& path) override;
+        bool NextEntry(std::string& name, bool& folder) override;
+
+    private:
+        FILE_STATS& _stats;
+        FileStatCache _stat_cache;
+        std::string _cwd;                               // this FileIO's current folder
+        std::filesystem::directory_iterator _dir_it;    // the folder being listed
+};
+
+
+/**** NOTES *******************************************************************************
+ *
+ *  FileIO reaches files only through its Vfs. HostVfs works on the host folders, and
+ *      ImageVfs (DiskImage.hpp) on a single disk image file. Machine::MountDisk() or
+ *      DISK_IMAGE_FILENAME chooses between them.
+ *
+ *  HostVfs keeps its own current folder. FC_CHANGEDIR changes it without touching the
+ *      working directory of the emulator, so several machines in one process each
+ *      see their own current folder.
+ *
+ **** NOTES *******************************************************************************/
@@ -89,12 +89,32 @@ enum MEMMAP
         //     array represents the top line of 8 pixels. Each array entry represents
         //     a row of 8 pixels. 
         
-    GFX_END          = 0xFE14, //  End of Graphics Hardware Registers
+    GFX_IRQ_CTRL     = 0xFE14, //  (Byte) Raster Interrupt Control
+        //           - bit 7     = 1:interrupt at the start of vertical blank
+        //           - bit 6     = 1:interrupt when GFX_SCANLINE == GFX_RASTER_CMP
+        //           - bit 5     = vertical blank 0:IRQ, 1:FIRQ
+        //           - bit 4     = raster line 0:IRQ, 1:FIRQ
+        
+    GFX_IRQ_STATUS   = 0xFE15, //  (Byte) Raster Interrupt Status
+        //           - bit 7     = vertical blank interrupt pending
+        //           - bit 6     = raster line interrupt pending
+        //           - bit 0     = 1:beam is in the vertical blank (read only)
+        // Note: Write a 1 to bits 6 or 7 to acknowledge the interrupt. The 
+        //     interrupt line is held until it has been acknowledged.
+        
+    GFX_RASTER_CMP   = 0xFE16, //  (Word) Raster Line Interrupt Compare
+        
+    GFX_SCANLINE     = 0xFE18, //  (Word Read Only) Current Raster Line
+        // Note: Lines 0 to VRES-1 are visible pixel rows, the rest of the frame
+        //     is vertical blank. The beam is timed by the CPU clock at 60 frames
+        //     per emulated second.
+        
+    GFX_END          = 0xFE1A, //  End of Graphics Hardware Registers
         
         // System Hardware Registers:
         
-    SYS_BEGIN        = 0xFE14, //  Start of System Hardware Registers
-    SYS_STATE        = 0xFE14, //  (Byte) System State Register
+    SYS_BEGIN        = 0xFE1A, //  Start of System Hardware Registers
+    SYS_STATE        = 0xFE1A, //  (Byte) System State Register
         // SYS_STATE: ABCD.SSSS
         //      A:0   = Error: Standard Buffer Overflow 
         //      B:0   = Error: Extended Buffer Overflow 
@@ -117,8 +137,8 @@ enum MEMMAP
         //      S:$E  = CPU Clock 5.0 mhz.
         //      S:$F  = CPU Clock ~10.0 mhz. (unmetered)
         
-    SYS_SPEED        = 0xFE15, //  (Word) Approx. Average CPU Clock Speed
-    SYS_CLOCK_DIV    = 0xFE17, //  (Byte) 60 hz Clock Divider Register (Read Only) 
+    SYS_SPEED        = 0xFE1B, //  (Word) Approx. Average CPU Clock Speed
+    SYS_CLOCK_DIV    = 0xFE1D, //  (Byte) 60 hz Clock Divider Register (Read Only) 
         // SYS_CLOCK_DIV:
         //      bit 7: 0.46875 hz
         //      bit 6: 0.9375 hz
@@ -129,13 +149,13 @@ enum MEMMAP
         //      bit 1: 30.0 hz
         //      bit 0: 60.0 hz
         
-    SYS_TIMER        = 0xFE18, //  (Word) Increments at 0.46875 hz
-    SYS_END          = 0xFE1A, //  End of System Hardware Registers
+    SYS_TIMER        = 0xFE1E, //  (Word) Increments at 0.46875 hz
+    SYS_END          = 0xFE20, //  End of System Hardware Registers
         
         // Debug Hardware Registers:
-    DBG_BEGIN        = 0xFE1A, //  start of debugger hardware registers
-    DBG_BRK_ADDR     = 0xFE1A, //    (Word) Address of current breakpoint
-    DBG_FLAGS        = 0xFE1C, //    (Byte) Debug Specific Hardware Flags:
+    DBG_BEGIN        = 0xFE20, //  start of debugger hardware registers
+    DBG_BRK_ADDR     = 0xFE20, //    (Word) Address of current breakpoint
+    DBG_FLAGS        = 0xFE22, //    (Byte) Debug Specific Hardware Flags:
         //     bit 7: Debug Enable
         //     bit 6: Single Step Enable
         //     bit 5: Clear All Breakpoints
@@ -144,59 +164,59 @@ enum MEMMAP
         //     bit 2: IRQ   (on low to high edge)
         //     bit 1: NMI   (on low to high edge)
         //     bit 0: RESET (on low to high edge)
-    DBG_END          = 0xFE1D, // End Debug Registers
+    DBG_END          = 0xFE23, // End Debug Registers
         
         // Mouse Cursor Hardware Registers:
-    CSR_BEGIN        = 0xFE1D, //  Start of Mouse Cursor Hardware Registers
-    CSR_XPOS         = 0xFE1D, //  (Word) horizontal mouse cursor coordinate
-    CSR_YPOS         = 0xFE1F, //  (Word) vertical mouse cursor coordinate
-    CSR_XOFS         = 0xFE21, //  (Byte) horizontal mouse cursor offset
-    CSR_YOFS         = 0xFE22, //  (Byte) vertical mouse cursor offset
-    CSR_SCROLL       = 0xFE23, //  (Signed) MouseWheel Scroll: -1, 0, 1
-    CSR_FLAGS        = 0xFE24, //  (Byte) mouse button flags:
+    CSR_BEGIN        = 0xFE23, //  Start of Mouse Cursor Hardware Registers
+    CSR_XPOS         = 0xFE23, //  (Word) horizontal mouse cursor coordinate
+    CSR_YPOS         = 0xFE25, //  (Word) vertical mouse cursor coordinate
+    CSR_XOFS         = 0xFE27, //  (Byte) horizontal mouse cursor offset
+    CSR_YOFS         = 0xFE28, //  (Byte) vertical mouse cursor offset
+    CSR_SCROLL       = 0xFE29, //  (Signed) MouseWheel Scroll: -1, 0, 1
+    CSR_FLAGS        = 0xFE2A, //  (Byte) mouse button flags:
         //  CSR_FLAGS:
         //       bits 0-4: button states
         //       bits 5-6: number of clicks
         //       bits 7:   cursor enable
-    CSR_BMP_INDX     = 0xFE25, //  (Byte) mouse cursor bitmap pixel offset
-    CSR_BMP_DATA     = 0xFE26, //  (Byte) mouse cursor bitmap pixel index color
-    CSR_PAL_INDX     = 0xFE27, //  (Byte) mouse cursor color palette index (0-15)
-    CSR_PAL_DATA     = 0xFE28, //  (Word) mouse cursor color palette data RGBA4444
-    CSR_END          = 0xFE2A, // End Mouse Registers
+    CSR_BMP_INDX     = 0xFE2B, //  (Byte) mouse cursor bitmap pixel offset
+    CSR_BMP_DATA     = 0xFE2C, //  (Byte) mouse cursor bitmap pixel index color
+    CSR_PAL_INDX     = 0xFE2D, //  (Byte) mouse cursor color palette index (0-15)
+    CSR_PAL_DATA     = 0xFE2E, //  (Word) mouse cursor color palette data RGBA4444
+    CSR_END          = 0xFE30, // End Mouse Registers
         
         // Keyboard Hardware Registers:
-    KEY_BEGIN        = 0xFE2A, // Start of the Keyboard Register space
-    CHAR_Q_LEN       = 0xFE2A, //   (Byte) # of characters waiting in queue        (Read Only)
-    CHAR_SCAN        = 0xFE2B, //   (Byte) read next character in queue (not popped when read)
-    CHAR_POP         = 0xFE2C, //   (Byte) read next character in queue (popped when read)
-    XKEY_BUFFER      = 0xFE2D, //   (128 bits) 16 bytes for XK_KEY data buffer     (Read Only)
-    EDT_BFR_CSR      = 0xFE3D, //   (Byte) cursor position within edit buffer     (Read/Write)
-    EDT_ENABLE       = 0xFE3E, //   (Byte) line editor enable flag                 (Read/Write)
-    EDT_BFR_LEN      = 0xFE3F, //   (Byte) Limit the line editor to this length   (Read/Write)
-    EDT_BUFFER       = 0xFE40, //   line editing character buffer                 (Read Only)
-    KEY_END          = 0xFF40, // End of the Keyboard Register space
-        
-    JOYS_BEGIN       = 0xFF40, // Start of the Game Controller Register space
-    JOYS_1_BTN       = 0xFF40, //   (Word) button bits: room for up to 16 buttons  (realtime)
-    JOYS_1_DBND      = 0xFF42, //   (Byte) PAD 1 analog deadband; default is 5   (read/write)
-    JOYS_1_LTX       = 0xFF43, //   (char) PAD 1 LThumb-X position (-128 _ +127)   (realtime)
-    JOYS_1_LTY       = 0xFF44, //   (char) PAD 1 LThumb-Y position (-128 _ +127)   (realtime)
-    JOYS_1_RTX       = 0xFF45, //   (char) PAD 1 RThumb-X position (-128 _ +127)   (realtime)
-    JOYS_1_RTY       = 0xFF46, //   (char) PAD 1 RThumb-Y position (-128 _ +127)   (realtime)
-    JOYS_1_Z1        = 0xFF47, //   (char) PAD 1 left analog trigger (0 - 127)     (realtime)
-    JOYS_1_Z2        = 0xFF48, //   (char) PAD 1 right analog trigger (0 - 127)    (realtime)
-    JOYS_2_BTN       = 0xFF49, //   (Word) button bits: room for up to 16 buttons  (realtime)
-    JOYS_2_DBND      = 0xFF4B, //   (Byte) PAD 2 analog deadband; default is 5   (read/write)
-    JOYS_2_LTX       = 0xFF4C, //   (char) PAD 2 LThumb-X position (-128 _ +127)   (realtime)
-    JOYS_2_LTY       = 0xFF4D, //   (char) PAD 2 LThumb-Y position (-128 _ +127)   (realtime)
-    JOYS_2_RTX       = 0xFF4E, //   (char) PAD 2 RThumb-X position (-128 _ +127)   (realtime)
-    JOYS_2_RTY       = 0xFF4F, //   (char) PAD 2 RThumb-Y position (-128 _ +127)   (realtime)
-    JOYS_2_Z1        = 0xFF50, //   (char) PAD 2 left analog trigger (0 - 127)     (realtime)
-    JOYS_2_Z2        = 0xFF51, //   (char) PAD 2 right analog trigger (0 - 127)    (realtime)
-    JOYS_END         = 0xFF52, // End of the Game Controller Register space
-        
-    FIO_BEGIN        = 0xFF52, // Start of the FileIO register space
-    FIO_ERROR        = 0xFF52, // (Byte) FILE_ERROR enumeration result
+    KEY_BEGIN        = 0xFE30, // Start of the Keyboard Register space
+    CHAR_Q_LEN       = 0xFE30, //   (Byte) # of characters waiting in queue        (Read Only)
+    CHAR_SCAN        = 0xFE31, //   (Byte) read next character in queue (not popped when read)
+    CHAR_POP         = 0xFE32, //   (Byte) read next character in queue (popped when read)
+    XKEY_BUFFER      = 0xFE33, //   (128 bits) 16 bytes for XK_KEY data buffer     (Read Only)
+    EDT_BFR_CSR      = 0xFE43, //   (Byte) cursor position within edit buffer     (Read/Write)
+    EDT_ENABLE       = 0xFE44, //   (Byte) line editor enable flag                 (Read/Write)
+    EDT_BFR_LEN      = 0xFE45, //   (Byte) Limit the line editor to this length   (Read/Write)
+    EDT_BUFFER       = 0xFE46, //   line editing character buffer                 (Read Only)
+    KEY_END          = 0xFF46, // End of the Keyboard Register space
+        
+    JOYS_BEGIN       = 0xFF46, // Start of the Game Controller Register space
+    JOYS_1_BTN       = 0xFF46, //   (Word) button bits: room for up to 16 buttons  (realtime)
+    JOYS_1_DBND      = 0xFF48, //   (Byte) PAD 1 analog deadband; default is 5   (read/write)
+    JOYS_1_LTX       = 0xFF49, //   (char) PAD 1 LThumb-X position (-128 _ +127)   (realtime)
+    JOYS_1_LTY       = 0xFF4A, //   (char) PAD 1 LThumb-Y position (-128 _ +127)   (realtime)
+    JOYS_1_RTX       = 0xFF4B, //   (char) PAD 1 RThumb-X position (-128 _ +127)   (realtime)
+    JOYS_1_RTY       = 0xFF4C, //   (char) PAD 1 RThumb-Y position (-128 _ +127)   (realtime)
+    JOYS_1_Z1        = 0xFF4D, //   (char) PAD 1 left analog trigger (0 - 127)     (realtime)
+    JOYS_1_Z2        = 0xFF4E, //   (char) PAD 1 right analog trigger (0 - 127)    (realtime)
+    JOYS_2_BTN       = 0xFF4F, //   (Word) button bits: room for up to 16 buttons  (realtime)
+    JOYS_2_DBND      = 0xFF51, //   (Byte) PAD 2 analog deadband; default is 5   (read/write)
+    JOYS_2_LTX       = 0xFF52, //   (char) PAD 2 LThumb-X position (-128 _ +127)   (realtime)
+    JOYS_2_LTY       = 0xFF53, //   (char) PAD 2 LThumb-Y position (-128 _ +127)   (realtime)
+    JOYS_2_RTX       = 0xFF54, //   (char) PAD 2 RThumb-X position (-128 _ +127)   (realtime)
+    JOYS_2_RTY       = 0xFF55, //   (char) PAD 2 RThumb-Y position (-128 _ +127)   (realtime)
+    JOYS_2_Z1        = 0xFF56, //   (char) PAD 2 left analog trigger (0 - 127)     (realtime)
+    JOYS_2_Z2        = 0xFF57, //   (char) PAD 2 right analog trigger (0 - 127)    (realtime)
+    JOYS_END         = 0xFF58, // End of the Game Controller Register space
+        
+    FIO_BEGIN        = 0xFF58, // Start of the FileIO register space
+    FIO_ERROR        = 0xFF58, // (Byte) FILE_ERROR enumeration result
         // Begin FILE_ERROR enumeration
     FE_NOERROR       = 0x0000, //      $00: no error, condition normal
     FE_NOTFOUND      = 0x0001, //      $01: file or folder not found
@@ -208,7 +228,7 @@ enum MEMMAP
     FE_BADSTREAM     = 0x0007, //      $07: invalid file stream
         // End FILE_ERROR enumeration
         
-    FIO_COMMAND      = 0xFF53, // (Byte) OnWrite, execute a file command (FC_<cmd>)
+    FIO_COMMAND      = 0xFF59, // (Byte) OnWrite, execute a file command (FC_<cmd>)
         // Begin FIO_COMMANDS
     FC_RESET         = 0x0000, //        Reset
     FC_SHUTDOWN      = 0x0001, //        SYSTEM: Shutdown
@@ -235,36 +255,53 @@ enum MEMMAP
     FC_SEEKEND       = 0x0016, //      * Seek End
     FC_SET_SEEK      = 0x0017, //      * Set Seek Position (from FIO_IOWORD)
     FC_GET_SEEK      = 0x0018, //      * Get Seek Position (into FIO_IOWORD)
+    FC_READBLOCK     = 0x0019, //        Read Block (FIO_HANDLE into FIO_BLK_ADDR)
+    FC_WRITEBLOCK    = 0x001A, //        Write Block (FIO_BLK_ADDR into FIO_HANDLE)
+    FC_LOADBIN       = 0x001B, //        Load Binary File (into FIO_BLK_ADDR)
+    FC_SAVEBIN       = 0x001C, //        Save Binary File (from FIO_BLK_ADDR)
+    FC_READDIR       = 0x001D, //        Read Directory Listing (into FIO_BUFFER)
         // End FIO_COMMANDS
         
-    FIO_HANDLE       = 0xFF54, // (Byte) current file stream HANDLE 0=NONE
-    FIO_SEEKPOS      = 0xFF55, // (DWord) file seek position
-    FIO_IODATA       = 0xFF59, // (Byte) input / output character
-    FIO_PATH_LEN     = 0xFF5A, // (Byte) length of the filepath
-    FIO_PATH_POS     = 0xFF5B, // (Byte) character position within the filepath
-    FIO_PATH_DATA    = 0xFF5C, // (Byte) data at the character position of the path
-    FIO_DIR_DATA     = 0xFF5D, // (Byte) a series of null-terminated filenames
+    FIO_HANDLE       = 0xFF5A, // (Byte) current file stream HANDLE 0=NONE
+    FIO_SEEKPOS      = 0xFF5B, // (DWord) file seek position
+    FIO_IODATA       = 0xFF5F, // (Byte) input / output character
+    FIO_PATH_LEN     = 0xFF60, // (Byte) length of the filepath
+    FIO_PATH_POS     = 0xFF61, // (Byte) character position within the filepath
+    FIO_PATH_DATA    = 0xFF62, // (Byte) data at the character position of the path
+    FIO_DIR_DATA     = 0xFF63, // (Byte) a series of null-terminated filenames
         //     NOTES: Current read-position is reset to the beginning following a 
         //             List Directory command. The read-position is automatically 
         //             advanced on read from this register. Each filename is 
         //             $0a-terminated. The list itself is null-terminated.
-    FIO_END          = 0xFF5E, // End of the FileIO register space
+    FIO_BLK_TYPE     = 0xFF64, // (Byte) block transfer memory type (DMA_TYPE_<type>)
+    FIO_BLK_PAGE     = 0xFF65, // (Byte) block transfer page (DMA_TYPE_BANK)
+    FIO_BLK_ADDR     = 0xFF66, // (Word) block transfer address (FIO_BUFFER on reset)
+    FIO_BLK_LEN      = 0xFF68, // (Word) bytes to transfer (0: the command maximum)
+    FIO_BLK_COUNT    = 0xFF6A, // (DWord) bytes moved by the last block command
+    FIO_STATUS       = 0xFF6E, // (Byte) asynchronous command status
+        //      bit 7:    1=a queued command is busy (read only)
+        //      bit 6:    1=done, write 1 to acknowledge
+        //      bits 3-5: reserved
+        //      bit 2:    1=queue commands to the I/O thread
+        //      bit 1:    1=raise an interrupt on completion
+        //      bit 0:    interrupt type: 0=IRQ, 1=FIRQ
+    FIO_END          = 0xFF6F, // End of the FileIO register space
         
         // Math Co-Processor Hardware Registers:
-    MATH_BEGIN       = 0xFF5E, //  start of math co-processor  hardware registers
-    MATH_ACA_POS     = 0xFF5E, //  (Byte) character position within the ACA float string
-    MATH_ACA_DATA    = 0xFF5F, //  (Byte) ACA float string character port
-    MATH_ACA_RAW     = 0xFF60, //  (4-Bytes) ACA raw float data
-    MATH_ACA_INT     = 0xFF64, //  (4-Bytes) ACA integer data
-    MATH_ACB_POS     = 0xFF68, //  (Byte) character position within the ACB float string
-    MATH_ACB_DATA    = 0xFF69, //  (Byte) ACB float string character port
-    MATH_ACB_RAW     = 0xFF6A, //  (4-Bytes) ACB raw float data
-    MATH_ACB_INT     = 0xFF6E, //  (4-Bytes) ACB integer data
-    MATH_ACR_POS     = 0xFF72, //  (Byte) character position within the ACR float string
-    MATH_ACR_DATA    = 0xFF73, //  (Byte) ACR float string character port
-    MATH_ACR_RAW     = 0xFF74, //  (4-Bytes) ACR raw float data
-    MATH_ACR_INT     = 0xFF78, //  (4-Bytes) ACR integer data
-    MATH_OPERATION   = 0xFF7C, //  (Byte) Operation 'command' to be issued
+    MATH_BEGIN       = 0xFF6F, //  start of math co-processor  hardware registers
+    MATH_ACA_POS     = 0xFF6F, //  (Byte) character position within the ACA float string
+    MATH_ACA_DATA    = 0xFF70, //  (Byte) ACA float string character port
+    MATH_ACA_RAW     = 0xFF71, //  (4-Bytes) ACA raw float data
+    MATH_ACA_INT     = 0xFF75, //  (4-Bytes) ACA integer data
+    MATH_ACB_POS     = 0xFF79, //  (Byte) character position within the ACB float string
+    MATH_ACB_DATA    = 0xFF7A, //  (Byte) ACB float string character port
+    MATH_ACB_RAW     = 0xFF7B, //  (4-Bytes) ACB raw float data
+    MATH_ACB_INT     = 0xFF7F, //  (4-Bytes) ACB integer data
+    MATH_ACR_POS     = 0xFF83, //  (Byte) character position within the ACR float string
+    MATH_ACR_DATA    = 0xFF84, //  (Byte) ACR float string character port
+    MATH_ACR_RAW     = 0xFF85, //  (4-Bytes) ACR raw float data
+    MATH_ACR_INT     = 0xFF89, //  (4-Bytes) ACR integer data
+    MATH_OPERATION   = 0xFF8D, //  (Byte) Operation 'command' to be issued
         // Begin MATH_OPERATION's (MOPS)
     MOP_RANDOM       = 0x0000, //        ACA, ACB, and ACR are set to randomized values
     MOP_RND_SEED     = 0x0001, //        MATH_ACA_INT seeds the pseudo-random number generator
@@ -325,44 +362,92 @@ enum MEMMAP
     MOP_COPYSIGN     = 0x0038, //        ACR = std::copysign(ACA, ACB);
     MOP_LASTOP       = 0x0038, //        last implemented math operation 
         // End MATH_OPERATION's (MOPS)
-    MATH_END         = 0xFF7D, // end of math co-processor registers
+    MATH_END         = 0xFF8E, // end of math co-processor registers
         
         // Memory Device Hardware Registers
-    MEM_BEGIN        = 0xFF7D, // Start of Memory Device Hardware Registers
-    MEM_BANK1_SELECT = 0xFF7E, // (Byte) select 8k page for bank 1 (0-255)
-    MEM_BANK2_SELECT = 0xFF7F, // (Byte) select 8k page for bank 2 (0-255)
-    MEM_BANK1_TYPE   = 0xFF80, // (Byte) memory bank 1 type
-    MEM_BANK2_TYPE   = 0xFF81, // (Byte) memory bank 2 type
+    MEM_BEGIN        = 0xFF8E, // Start of Memory Device Hardware Registers
+    MEM_BANK1_SELECT = 0xFF8F, // (Byte) select 8k page for bank 1 (0-255)
+    MEM_BANK2_SELECT = 0xFF90, // (Byte) select 8k page for bank 2 (0-255)
+    MEM_BANK1_TYPE   = 0xFF91, // (Byte) memory bank 1 type
+    MEM_BANK2_TYPE   = 0xFF92, // (Byte) memory bank 2 type
     MEM_TYPE_RAM     = 0x0000, //      random access memory (RAM)
     MEM_TYPE_PERSIST = 0x0001, //      persistent memory (saved RAM)
     MEM_TYPE_ROM     = 0x0002, //      read only memory (ROM)
+    MEM_BANK1_PAGE   = 0xFF93, // (Word) select 8k page for bank 1 (0-65535)
+    MEM_BANK2_PAGE   = 0xFF95, // (Word) select 8k page for bank 2 (0-65535)
+        //      Notes: The page is selected when the 
+        //             least-significant byte is written.
+        //             The MSB reads back as written until then.
+        //             A page past MEM_BANK_MAX is ignored.
+    MEM_BANK_MAX     = 0xFF97, // (Word) highest page number (read only)
         
-    MEM_DSP_FLAGS    = 0xFF82, // (Byte) Extended Graphics Display Flags
+    MEM_DSP_FLAGS    = 0xFF99, // (Byte) Extended Graphics Display Flags
         //      bit 7:    1=extended bitmap enabled, 0=disabled 
         //      bit 6:    1=standard modes enabled,  0=disabled
         //      bits 2-5: reserved (possibly for tilemap/sprites)
         //      bits 0-1: extended bitmap color depth:  
         //                0:2-color, 1:4-color, 2:16-color, 3:256-color
-    MEM_DSPLY_SIZE   = 0xFF83, // (Word) Extended Graphics Buffer Size
+    MEM_DSPLY_SIZE   = 0xFF9A, // (Word) Extended Graphics Buffer Size
         
-    MEM_EXT_ADDR     = 0xFF85, // (Word) Extended Memory Address Port
-    MEM_EXT_PITCH    = 0xFF87, // (Word) number of bytes per line
-    MEM_EXT_WIDTH    = 0xFF89, // (Word) width before skipping to next line
-    MEM_EXT_DATA     = 0xFF8B, // (Byte) External Memory Data Port
+    MEM_EXT_ADDR     = 0xFF9C, // (Word) Extended Memory Address Port
+    MEM_EXT_PITCH    = 0xFF9E, // (Word) number of bytes per line
+    MEM_EXT_WIDTH    = 0xFFA0, // (Word) width before skipping to next line
+    MEM_EXT_DATA     = 0xFFA2, // (Byte) External Memory Data Port
         
-    MEM_DYN_SIZE     = 0xFF8C, // (Word) dynamic memory block size
+    MEM_DYN_SIZE     = 0xFFA3, // (Word) dynamic memory block size
         //      Notes: Memory allocation occurs when the 
         //             least-significant byte is written.
         //             Reads as total number of bytes allocated
         //             or freed. When $0000 is written to this 
         //             port, memory node at MEM_DYN_ADDR is freed.
-    MEM_DYN_ADDR     = 0xFF8E, // (Word) address of a dynamic memory node
-    MEM_DYN_AVAIL    = 0xFF90, // (Word) number of non-allocated bytes
-    MEM_END          = 0xFF92, // End of Memory Device Hardware Registers
+    MEM_DYN_ADDR     = 0xFFA5, // (Word) address of a dynamic memory node
+    MEM_DYN_AVAIL    = 0xFFA7, // (Word) number of non-allocated bytes
+    MEM_END          = 0xFFA9, // End of Memory Device Hardware Registers
+        
+        // DMA Controller Hardware Registers
+    DMA_BEGIN        = 0xFFA9, // Start of DMA Controller Hardware Registers
+    DMA_CHANNEL      = 0xFFA9, // (Byte) selects the active DMA channel (0-3)
+    DMA_CONTROL      = 0xFFAA, // (Byte) control register for the active channel
+        //      bit 7:    write 1=start transfer, read 1=busy
+        //      bit 6:    1=raise an interrupt on completion
+        //      bit 5:    interrupt type: 0=IRQ, 1=FIRQ
+        //      bit 4:    0=instant, 1=cycle-stealing
+        //      bits 0-3: reserved
+    DMA_STATUS       = 0xFFAB, // (Byte) channel status flags
+        //      bits 4-7: channel busy (read only)
+        //      bits 0-3: channel complete (write 1 to acknowledge)
+    DMA_SRC_TYPE     = 0xFFAC, // (Byte) source type
+    DMA_TYPE_CPU     = 0x0000, //      CPU address space
+    DMA_TYPE_EXT     = 0x0001, //      extended memory
+    DMA_TYPE_BANK    = 0x0002, //      banked memory page
+    DMA_TYPE_PALETTE = 0x0003, //      color palette (two bytes per color)
+    DMA_TYPE_GLYPH   = 0x0004, //      glyph table (eight bytes per glyph)
+    DMA_SRC_PAGE     = 0xFFAD, // (Byte) source page (DMA_TYPE_BANK)
+    DMA_SRC_ADDR     = 0xFFAE, // (Word) source address
+    DMA_DST_TYPE     = 0xFFB0, // (Byte) destination type
+    DMA_DST_PAGE     = 0xFFB1, // (Byte) destination page (DMA_TYPE_BANK)
+    DMA_DST_ADDR     = 0xFFB2, // (Word) destination address
+    DMA_LENGTH       = 0xFFB4, // (Word) number of bytes to transfer
+    DMA_END          = 0xFFB6, // End of DMA Controller Hardware Registers
+        
+        // Frame Capture Hardware Registers
+    CAP_BEGIN        = 0xFFB6, // Start of Frame Capture Hardware Registers
+    CAP_CTRL         = 0xFFB6, // (Byte) frame capture control
+        //      bit 7:    write 1=capture the next frame, read 1=pending
+        //      bit 6:    1=stream every frame, 0=stream closed
+        //      bit 5:    still image format: 0=PPM, 1=PNG
+        //      bit 4:    stream format: 0=raw RGB24, 1=Y4M
+        //      bit 3:    1=hash every frame, check against the golden log
+        //      bits 0-2: reserved
+    CAP_INTERVAL     = 0xFFB7, // (Byte) capture a still every N frames (0=off)
+    CAP_FRAMES       = 0xFFB8, // (Word Read Only) frames written
+    CAP_DROPPED      = 0xFFBA, // (Word Read Only) frames dropped (queue full)
+    CAP_MISMATCH     = 0xFFBC, // (Word Read Only) hashed frames that differ from golden
+    CAP_END          = 0xFFBE, // End of Frame Capture Hardware Registers
         
         // Reserved for Future Hardware Devices
-    RSRVD_DEVICE_MEM = 0xFF92, 
-        // 94 bytes in reserve
+    RSRVD_DEVICE_MEM = 0xFFBE, 
+        // 50 bytes in reserve
         
         // Hardware Interrupt Vectors:
     ROM_VECTS        = 0xFFF0, 
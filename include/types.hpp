@@ -30,7 +30,19 @@
     #ifndef DWord
         #define DWord Uint32
     #endif
+    #ifndef QWord
+        #define QWord Uint64
+    #endif
   
+// C6809 CPU Constants:
+constexpr bool CPU_LAZY_FLAGS = true;   // defer condition code evaluation until CC is read
+constexpr bool CPU_SWITCH_CORE = true;  // dispatch opcodes through a switch instead of the opMap
+constexpr bool CPU_HD6309 = false;      // Hitachi HD6309: E/F/W/V/MD registers, extra opcodes and native mode
+constexpr bool CPU_KERNEL_HLE = true;   // run the default kernel console and string routines natively
+constexpr Byte CPU_HLE_CYCLES = 20;     // cycles charged for each natively run kernel call
+constexpr bool CPU_BLOCK_LOOPS = true;  // run recognized memset/memcpy loops as block operations
+constexpr bool CPU_FUSE_PAIRS = true;   // run hot instruction pairs in a single dispatch
+
 // Graphics System Device Constants:
 constexpr Word VID_BUFFER_SIZE = 15 * 1024;      // standard video buffer size
 constexpr int MAIN_MONITOR = 0;
@@ -53,11 +65,37 @@ constexpr bool ENABLE_SDL_MOUSE_CURSOR = true;  // when the SDL cursor is displa
 
 // FileIO Device Constants:
 constexpr Word FILEHANDLESMAX = 256;
+constexpr DWord FILE_READ_AHEAD = 4096;     // bytes a read handle fetches from the host at a time
+constexpr DWord FILE_WRITE_BEHIND = 4096;   // bytes a write handle holds before writing them
+constexpr bool FILE_MMAP_READS = false;     // map files opened for reading into memory (Linux)
+constexpr Uint32 FILE_STAT_TTL = 1000;      // milliseconds a cached exists/length result is trusted
+const std::string DISK_IMAGE_FILENAME = ""; // disk image to mount at start up, "" for the host folders
+constexpr DWord DISK_BLOCK_SIZE = 512;
+constexpr DWord DISK_IMAGE_BLOCKS = 16384;  // blocks of a newly formatted disk image (8 MB)
+constexpr DWord DISK_CACHE_BLOCKS = 256;    // disk image blocks held in memory
+
+// Kernel ROM, when it is not compiled in (cmake -DKERNEL_ROM_EMBEDDED=OFF):
+const std::string KERNEL_ROM_FILENAME = "kernel_f000.hex";
+// start from the boot snapshot, when one is compiled in (cmake -DKERNEL_BOOT_SNAPSHOT=ON)
+constexpr bool KERNEL_BOOT_SNAPSHOT_ENABLE = true;
 
 // Paged memory file:
 // const std::string PAGED_MEMORY_FILENAME = "/home/jay/Documents/GitHub/alpha_6809/build/usb_drive/paged.mem";
 const std::string PAGED_MEMORY_FILENAME = "./build/usb_drive/paged.mem";
 constexpr DWord PAGED_MEMORY_BANKSIZE = 8192;
+constexpr DWord PAGED_MEMORY_BANKS = 256;   // 8K pages in the paged memory file (2 to 65536)
+constexpr DWord MEMBANK_CACHE_PAGES = 32;   // switched out pages held in memory (256K)
+constexpr DWord MEMBANK_FLUSH_MS = 1000;    // how often dirty pages are written back
+constexpr bool MEMBANK_COMPRESS = true;     // run length encode the pages in the paged memory file
+
+// Frame Capture Device Constants:
+const std::string CAPTURE_DIRECTORY = "./build/capture/";
+constexpr int CAPTURE_QUEUE_MAX = 8;    // frames waiting on the writer thread before dropping
+const std::string CAPTURE_HASH_LOG = CAPTURE_DIRECTORY + "frames.log";
+const std::string CAPTURE_GOLDEN = CAPTURE_DIRECTORY + "golden.log";
+
+// Instruction Mix Profile (Alt+P starts it, and stops and saves it):
+const std::string PROFILE_FILENAME = "./build/opmix.csv";
 
 // Testing
 // const std::string TESTING_BITMAP = "/home/jay/Documents/GitHub/alpha_6809/build/scene_c.bmp";
@@ -0,0 +1,76 @@
+// *************************************************
+// *
+// * BatchRunner.cpp
+// *
+// ***********************************
+
+#include <thread>
+#include "BatchRunner.hpp"
+
+BatchRunner::BatchRunner(int threads)
+{
+    if (threads <= 0)
+        threads = std::thread::hardware_concurrency();
+    if (threads <= 0)
+        threads = 1;
+    for (int t=0; t<threads; t++)
+        _workers.push_back(std::make_unique<WORKER>());
+}
+
+void BatchRunner::Add(Job job)
+{
+    WORKER& w = *_workers[_next];
+    _next = (_next + 1) % _workers.size();
+    std::lock_guard<std::mutex> lock(w.mutex);
+    w.jobs.push_back(std::move(job));
+}
+
+void BatchRunner::Run()
+{
+    std::vector<std::thread> threads;
+    for (int t=0; t<Threads(); t++)
+        threads.emplace_back(&BatchRunner::_workerProc, this, t);
+    for (auto& t : threads)
+        t.join();
+    _next = 0;
+}
+
+bool BatchRunner::_pop(int index, Job& job)
+{
+    // newest job from our own queue
+    {
+        WORKER& w = *_workers[index];
+        std::lock_guard<std::mutex> lock(w.mutex);
+        if (!w.jobs.empty())
+        {
+            job = std::move(w.jobs.back());
+            w.jobs.pop_back();
+            return true;
+        }
+    }
+    // oldest job from someone else's
+    for (int t=1; t<Threads(); t++)
+    {
+        WORKER& w = *_workers[(index + t) % Threads()];
+        std::lock_guard<std::mutex> lock(w.mutex);
+        if (!w.jobs.empty())
+        {
+            job = std::move(w.jobs.front());
+            w.jobs.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void BatchRunner::_workerProc(int index)
+{
+    // no job adds more jobs, so empty queues everywhere means we are done
+    Job job;
+    while (_pop(index, job))
+    {
+        // banked memory in RAM, so no two jobs share a 'paged.mem'
+        Machine machine("");
+        job(machine);
+    }
+}
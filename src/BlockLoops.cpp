@@ -0,0 +1,229 @@
+/**************************
+* BlockLoops.cpp
+*
+* Memset and memcpy loops run as block operations (CPU_BLOCK_LOOPS)
+*
+* Copyright (C) 2023 by Jay Faries
+**************************************/
+
+#include <algorithm>
+#include <cstring>
+
+#include "types.hpp"
+#include "Bus.hpp"
+#include "C6809.hpp"
+#include "Debug.hpp"
+#include "Dma.hpp"
+
+// iterations run at a time while an IRQ or FIRQ can still be taken
+constexpr DWord LOOP_IRQ_SLICE = 64;
+
+// the outcome of a short branch (0x22..0x2F) after a 16-bit compare
+static bool loop_branch(Byte op, Word x, Word m)
+{
+	long t = (long)x - (long)m;
+	bool n = t & 0x8000;
+	bool z = !(t & 0xffff);
+	bool v = (x ^ m ^ t ^ (t >> 1)) & 0x8000;
+	bool c = t & 0x10000;
+	switch (op)
+	{
+		case 0x22: return !c && !z;			// BHI
+		case 0x23: return c || z;			// BLS
+		case 0x24: return !c;				// BCC
+		case 0x25: return c;				// BCS
+		case 0x26: return !z;				// BNE
+		case 0x27: return z;				// BEQ
+		case 0x28: return !v;				// BVC
+		case 0x29: return v;				// BVS
+		case 0x2a: return !n;				// BPL
+		case 0x2b: return n;				// BMI
+		case 0x2c: return n == v;			// BGE
+		case 0x2d: return n != v;			// BLT
+		case 0x2e: return !z && n == v;		// BGT
+		case 0x2f: return z || n != v;		// BLE
+	}
+	return false;
+}
+
+bool C6809::block_loop()
+{
+	// the debugger steps through the loop, and DMA steals the bus mid loop
+	Debug* debug = m_bus->_debug;
+	if (debug->IsActive() || debug->IsStepping() || m_bus->_dma->Stealing() || _steps > 0 || _run_until >= 0)
+		return false;
+
+	// the loop code itself, read straight from RAM or ROM
+	const Word start = PC - 1;
+	Word avail = 0;
+	const Byte* code = m_bus->MemPtr(start, avail, false);
+	if (!code || avail < 10)
+		return false;
+
+	// [ld ,src+]  st ,dst+  cmp #end  bcc start
+	Word pos = 0;
+	Byte ld = 0, st = code[pos];
+	Byte ld_post = 0, st_post = 0;
+	if (st == 0xa6 || st == 0xe6 || st == 0xec)
+	{
+		ld = st;
+		ld_post = code[pos + 1];
+		pos += 2;
+		st = code[pos];
+		if (st != ld + 1)
+			return false;
+	}
+	st_post = code[pos + 1];
+	pos += 2;
+	const Word size = (st == 0xec || st == 0xed) ? 2 : 1;
+	const Byte inc = (size == 2) ? 0x81 : 0x80;		// ,R++ or ,R+
+	if ((st_post & 0x9f) != inc || ((st_post >> 5) & 3) == 3)
+		return false;
+	if (ld && ((ld_post & 0x9f) != inc || ((ld_post >> 5) & 3) == 3 || (ld_post & 0x60) == (st_post & 0x60)))
+		return false;
+	const Byte dst_reg = (st_post >> 5) & 3;
+	const Byte src_reg = (ld_post >> 5) & 3;
+
+	Word cmp = code[pos];
+	if (cmp == 0x10 || cmp == 0x11)
+		cmp = (cmp << 8) | code[++pos];
+	pos++;
+	Byte cmp_reg;
+	switch (cmp)
+	{
+		case 0x008c: cmp_reg = 0; break;	// CMPX #
+		case 0x108c: cmp_reg = 1; break;	// CMPY #
+		case 0x1183: cmp_reg = 2; break;	// CMPU #
+		default: return false;
+	}
+	if (cmp_reg != dst_reg && !(ld && cmp_reg == src_reg))
+		return false;
+	const Word imm = (code[pos] << 8) | code[pos + 1];
+	pos += 2;
+	const Byte br = code[pos];
+	if (br < 0x22 || br > 0x2f || (Word)(start + pos + 2 + (Sint8)code[pos + 1]) != start)
+		return false;
+	const Word length = pos + 2;
+	// a breakpoint anywhere in the loop stops it on that instruction
+	for (Word i = 0; i < length; i++)
+		if (debug->IsBreakpoint(start + i))
+			return false;
+
+	// how many passes until the branch falls through
+	const Word c0 = *ptrReg[cmp_reg];
+	DWord limit = 0x10000 / size;
+	if (!CC.bit.I || !CC.bit.F)
+		limit = LOOP_IRQ_SLICE;
+	DWord count = 0;
+	bool done = false;
+	while (count < limit)
+	{
+		count++;
+		if (!loop_branch(br, c0 + count * size, imm))
+		{
+			done = true;
+			break;
+		}
+	}
+	const DWord total = count * size;
+
+	// both ranges must be plain memory that neither wraps nor rewrites the loop
+	auto plain = [&](Word base, bool write) {
+		if (base + total > 0x10000)
+			return false;
+		for (DWord a = base; a < base + total; )
+		{
+			Word len = 0;
+			if (!m_bus->MemPtr(a, len, write))
+				return false;
+			a += len;
+		}
+		return true;
+	};
+	const Word d = *ptrReg[dst_reg];
+	const Word s = ld ? *ptrReg[src_reg] : 0;
+	if (!plain(d, true) || (d < start + length && start < d + total))
+		return false;
+	if (ld && (!plain(s, false) || (s < d && d < s + total)))
+		return false;
+
+	// the stores, a chunk of contiguous memory at a time
+	for (DWord i = 0; i < total; )
+	{
+		Word dlen = 0, slen = 0;
+		Byte* dp = m_bus->MemPtr(d + i, dlen, true);
+		DWord n = std::min<DWord>(dlen, total - i);
+		if (ld)
+		{
+			Byte* sp = m_bus->MemPtr(s + i, slen, false);
+			n = std::min<DWord>(n, slen);
+			memmove(dp, sp, n);
+		}
+		else if (st == 0x6f)
+			memset(dp, 0, n);
+		else if (st == 0xa7)
+			memset(dp, A, n);
+		else if (st == 0xe7)
+			memset(dp, B, n);
+		else
+			for (DWord k = 0; k < n; k++)
+				dp[k] = ((i + k) & 1) ? B : A;
+		i += n;
+	}
+
+	// registers, flags and cycles as the last pass leaves them
+	if (ld)
+	{
+		Word last = d + total - size;
+		if (size == 2)
+			D = m_bus->read_word(last);
+		else if (ld == 0xa6)
+			A = m_bus->read(last);
+		else
+			B = m_bus->read(last);
+	}
+	*ptrReg[dst_reg] += total;
+	if (ld)
+		*ptrReg[src_reg] += total;
+	const Word c = *ptrReg[cmp_reg];
+	set_flags(LAZY_CMP16, c, imm, c - imm);
+	PC = done ? start + length : start;
+
+	DWord pass = base_cycles(st) + idx_cycles(st_post) + base_cycles(cmp) + base_cycles(br);
+	if (ld)
+		pass += base_cycles(ld) + idx_cycles(ld_post);
+	cycles = count * pass;
+	return true;
+}
+
+
+/**** NOTES *******************************************************************************
+ *
+ *  When an instruction boundary lands on one of these loops, the loop runs here as a
+ *      single block operation:
+ *
+ *          clr ,x+         sta ,x+         std ,x++        lda ,x+         ldd ,u++
+ *          cmpx #end       cmpx #end       cmpx #end       sta ,y+         std ,x++
+ *          bne loop        blo loop        blo loop        cmpy #end       cmpx #end
+ *                                                          bne loop        blo loop
+ *
+ *      A stb/ldb pair works as the A versions do. The pointers are any two of X, Y and
+ *      U, the compare is CMPX, CMPY or CMPU immediate against one of them, and any
+ *      short conditional branch back to the first instruction closes the loop.
+ *
+ *  Memory, registers, condition codes and the cycle count end up exactly as the
+ *      interpreted passes leave them. The cycles are charged to the first instruction,
+ *      so the raster and the timers still see every clock go by.
+ *
+ *  The loop is left to the interpreter unless every byte it writes is plain RAM,
+ *      every byte it reads is RAM or ROM, neither range wraps past $FFFF, the stores
+ *      miss the loop code and a copy does not overlap its own destination ahead of
+ *      the source. Device registers and the banked memory window always go through
+ *      the interpreter, as does everything while the debugger is open or single
+ *      stepping, a step count or run to address is pending, a breakpoint is set on
+ *      any byte of the loop or DMA is stealing cycles.
+ *
+ *  While IRQ or FIRQ is unmasked only LOOP_IRQ_SLICE passes run at a time and PC is
+ *      left on the loop, so an interrupt waits at most one slice for its boundary.
+ *
+ **** NOTES *******************************************************************************/
@@ -4,6 +4,8 @@
 //
 /////////////
 
+#include <algorithm>
+#include <cstring>
 #include <chrono>
 #include <sstream>
 #include <fstream>
@@ -18,23 +20,45 @@
 #include "Math.hpp"
 #include "MemBank.hpp"
 #include "Memory.hpp"
-
-Bus::Bus()
+#include "Dma.hpp"
+#include "Capture.hpp"
+#include "Loader.hpp"
+#if defined(KERNEL_ROM_EMBEDDED)
+    #include "kernel_rom.hpp"       // generated by tools/embed_kernel.cmake
+#endif
+#if defined(KERNEL_BOOT_SNAPSHOT)
+    #include "boot_snapshot.hpp"    // generated by tools/boot_snapshot.cpp
+#endif
+
+Bus::Bus(bool headless, const std::string& paged_file)
 {
     // std::cout << Name() << "::Bus()\n";
 
     _deviceName = "Bus";
+    _bIsHeadless = headless;
+
+    // the devices below reach their bus through Bus::Inst()
+    _prev_current = s_current;
+    s_current = this;
 
-    // initialize SDL
-    if (SDL_Init(SDL_INIT_EVERYTHING) < 0)
+    // the wall clock timers count from construction
+    for (auto& before : _div_before)
+        before = std::chrono::system_clock::now();
+    _update_tp = std::chrono::system_clock::now();
+
+    // initialize SDL (headless machines never open a window)
+    if (!headless)
     {
-        std::stringstream ss;
-        ss << "SDL_Init() failed!\n" << SDL_GetError() << std::endl;
-        Bus::Error(ss.str());
-        s_bIsRunning = false;
-        return;     // no need to continue if SDL_Init fails
-    }    
-    s_b_SDL_WasInit = true;
+        if (SDL_Init(SDL_INIT_EVERYTHING) < 0)
+        {
+            std::stringstream ss;
+            ss << "SDL_Init() failed!\n" << SDL_GetError() << std::endl;
+            Bus::Error(ss.str());
+            _bIsRunning = false;
+            return;     // no need to continue if SDL_Init fails
+        }    
+        _b_SDL_WasInit = true;
+    }
 
     if (COMPILE_MEMORY_MAP)
     {
@@ -121,8 +145,9 @@ Bus::Bus()
     addr += Attach(dev, uram_size);    
 
 	// paged MEMORY
-    s_membank = new MemBank("MEM_BANK");
-    addr += Attach(s_membank);    
+    _membank = new MemBank("MEM_BANK");
+    _membank->Filename(paged_file);
+    addr += Attach(_membank);    
 
 	// KERNEL ROM
     dev->DisplayEnum("",0, "");
@@ -139,39 +164,47 @@ Bus::Bus()
     dev->DisplayEnum("",0, "HARDWARE REGISTERS (0.5K)");
 
     // base graphics device
-    s_gfx = new Gfx();  // non-enforced singleton
-    addr += Attach(s_gfx);
+    _gfx = new Gfx();  // non-enforced singleton
+    addr += Attach(_gfx);
 
     // attach the debug device (also SYS devices)
-    s_debug = new Debug();
-    addr += Attach(s_debug);
+    _debug = new Debug();
+    addr += Attach(_debug);
 
     // attach the mouse device
-    s_mouse = new Mouse();
-    addr += Attach(s_mouse);
+    _mouse = new Mouse();
+    addr += Attach(_mouse);
 
     // attach the keyboard device
-    s_keyboard = new Keyboard();
-    addr += Attach(s_keyboard);
+    _keyboard = new Keyboard();
+    addr += Attach(_keyboard);
 
     // attach the gamepad device
-    s_gamepad = new Gamepad();
-    addr += Attach(s_gamepad);
+    _gamepad = new Gamepad();
+    addr += Attach(_gamepad);
 
     // attach the FileIO device
-    s_fileio = new FileIO();
-    addr += Attach(s_fileio);
+    _fileio = new FileIO();
+    addr += Attach(_fileio);
 
     // attach the math device
-    s_math = new Math();
-    addr += Attach(s_math);
+    _math = new Math();
+    addr += Attach(_math);
 
     // NOTE: the MemBank Paged Memory device
     //      was allocated / attached earlier
 
     // attach the memory device
-    s_memory = new Memory();
-    addr += Attach(s_memory);
+    _memory = new Memory();
+    addr += Attach(_memory);
+
+    // attach the DMA controller
+    _dma = new Dma();
+    addr += Attach(_dma);
+
+    // attach the frame capture device
+    _capture = new Capture();
+    addr += Attach(_capture);
 
 
 
@@ -224,23 +257,31 @@ Bus::Bus()
     }
 
     // Load the Kernal ROM
-    load_hex("kernel_f000.hex");
+    load_kernel();
 
     // Call OnInit() before attaching the CPU Device
     OnInit();   // One time initialization
 
 	// Install the CPU and start its thread
-	s_c6809 = new C6809(this);
+	_c6809 = new C6809(this);
+
+	// start at the Ready prompt rather than booting the kernel
+	if (KERNEL_BOOT_SNAPSHOT_ENABLE)
+		restore_boot();
+
+	// headless machines are clocked by their owner (see Machine::Run)
+	if (headless)
+		return;
 
 	// start the CPU thread
 	try 
 	{
-		s_cpuThread = std::thread(&C6809::ThreadProc);
+		_cpuThread = std::thread(&C6809::ThreadProc, this);
 	} 
 	catch (const std::exception& e)
 	{
-		if (s_cpuThread.joinable())
-			s_cpuThread.join();		
+		if (_cpuThread.joinable())
+			_cpuThread.join();		
 		Bus::Error("Unable to start the CPU thread");
 		Bus::IsRunning(false);
 		std::cout << e.what() << std::endl;
@@ -252,51 +293,58 @@ Bus::~Bus()
 {
     // std::cout << "~" << Name() << "::Bus()\n";
 
-    // shutdown the CPU thread
-	if (s_cpuThread.joinable())
-    	s_cpuThread.join();
+    // shutdown the CPU thread (it may be parked)
+	if (_cpuThread.joinable())
+	{
+		_c6809->Stop();
+    	_cpuThread.join();
+	}
 
     // Remove the CPU device
-    if (s_c6809)
+    if (_c6809)
 	{
-		delete s_c6809;
-		s_c6809 = nullptr;
+		delete _c6809;
+		_c6809 = nullptr;
 	}
 
     // delete all of the attached devices
-    for (auto& d : Bus::_memoryNodes)
+    for (auto& d : _memoryNodes)
         delete d;
+    _memoryNodes.clear();
 
     // close SDL
-    if (s_b_SDL_WasInit)
+    if (_b_SDL_WasInit)
     {
         SDL_Quit();
     }
+
+    // unbind from this thread
+    if (s_current == this)
+        s_current = _prev_current;
 }
 
 
 void Bus::Run()
 {    
     // Application Main Loop:
-    if (s_bIsRunning)
+    if (_bIsRunning)
     {
         // terminate the app when the 'isRunning' flag is no longer true
-        while (s_bIsRunning)
+        while (_bIsRunning)
         {
             // something changed (is dirty). rebuild the environment
-            if (s_bIsDirty)
+            if (_bIsDirty)
             {
-                // stop the CPU from running while updating system
-                C6809::IsCpuEnabled(false);
+                // park the CPU between instructions while updating system
+                _c6809->Pause();
+                // no longer dirty
+                _bIsDirty = false;            
                 // shutdown the old environment
                 OnDeactivate();
                 // create a new environment
                 OnActivate();
-                // wait 25 milliseconds to re-enable the CPU 
-                SDL_Delay(25);
-                C6809::IsCpuEnabled(true);
-                // no longer dirty
-                s_bIsDirty = false;            
+                // let the CPU run again
+                _c6809->Resume();
             }
             // update all of the attached devices
             OnUpdate(0.0f);
@@ -305,8 +353,10 @@ void Bus::Run()
             // render all of the devices to the screen buffers
             OnRender();      
             // only a present for GfxCore            
-            Gfx::Present();
+            _gfx->Present();
         }
+        // wait for the CPU thread to finish before tearing anything down
+        _c6809->Stop();
         // shutdown the environment
         OnDeactivate();    
         // close down all of the attached devices
@@ -326,27 +376,27 @@ Word Bus::OnAttach(Word nextAddr)
 void Bus::OnInit()
 {
     // std::cout << Name() << "::OnInit()\n";
-	for (auto &d : Bus::_memoryNodes)
+	for (auto &d : _memoryNodes)
 		d->OnInit();    
 }
 
 void Bus::OnQuit()
 {
     // std::cout << Name() << "::OnQuit()\n";
-	for (auto &d : Bus::_memoryNodes)
+	for (auto &d : _memoryNodes)
 		d->OnQuit();    
 }
 
 void Bus::OnActivate()
 {
     // std::cout << Name() << "::OnActivate()\n";
-	for (auto &d : Bus::_memoryNodes)
+	for (auto &d : _memoryNodes)
 		d->OnActivate();    
 }
 void Bus::OnDeactivate()
 {
     // std::cout << Name() << "::OnDeactivate()\n";
-    for (auto &d : Bus::_memoryNodes)
+    for (auto &d : _memoryNodes)
 		d->OnDeactivate();
 }
 
@@ -364,7 +414,7 @@ void Bus::OnEvent(SDL_Event* null_event)
                 // handling of close button 
                 //          (this only works for single window applications. 
                 //          Use SDL_WINDOWEVENT_CLOSE instead.)
-                s_bIsRunning = false;
+                _bIsRunning = false;
                 break;
 
             case SDL_KEYDOWN:
@@ -374,18 +424,18 @@ void Bus::OnEvent(SDL_Event* null_event)
                 if (mod & KMOD_SHIFT)
                 {
                     if (evnt.key.keysym.sym == SDLK_ESCAPE)
-                        s_bIsRunning = false;
+                        _bIsRunning = false;
                 }                
                 if (mod & KMOD_ALT)
                 {
                     if (evnt.key.keysym.sym == SDLK_x)
-                        s_bIsRunning = false;
+                        _bIsRunning = false;
                 }
                 break;                
             }
         }
         // OnEvent(evnt)
-        for (auto &d : Bus::_memoryNodes)
+        for (auto &d : _memoryNodes)
             d->OnEvent(&evnt);		
     }        
 }
@@ -407,41 +457,12 @@ Byte Bus::clock_div(Byte& cl_div, int bit)
 
     using clock = std::chrono::system_clock;
     using sec = std::chrono::duration<double, std::milli>;
-    static auto before0 = clock::now();
-    static auto before1 = clock::now();
-    static auto before2 = clock::now();
-    static auto before3 = clock::now();
-    static auto before4 = clock::now();
-    static auto before5 = clock::now();
-    static auto before6 = clock::now();
-    static auto before7 = clock::now();
-    static auto before = clock::now();
-    switch (bit)
-    {
-    case 0: before = before0; break;
-    case 1: before = before1; break;
-    case 2: before = before2; break;
-    case 3: before = before3; break;
-    case 4: before = before4; break;
-    case 5: before = before5; break;
-    case 6: before = before6; break;
-    case 7: before = before7; break;
-    }
-    const sec duration = clock::now() - before;
+    const sec duration = clock::now() - _div_before[bit];
     if (duration.count() > count[bit])
     {
-        before = clock::now();
-        switch (bit)
-        {
-        case 0: before0 = clock::now();   _clock_timer++;  break;
-        case 1: before1 = clock::now();  break;
-        case 2: before2 = clock::now();  break;
-        case 3: before3 = clock::now();  break;
-        case 4: before4 = clock::now();  break;
-        case 5: before5 = clock::now();  break;
-        case 6: before6 = clock::now();  break;
-        case 7: before7 = clock::now();  break;
-        }
+        _div_before[bit] = clock::now();
+        if (bit == 0)
+            _clock_timer++;
         cl_div = (cl_div & (0x01 << bit)) ? cl_div & ~(0x01 << bit) : cl_div | (0x01 << bit);
     }
     return cl_div;
@@ -463,40 +484,67 @@ void Bus::OnUpdate(float fNullTime)
     clockDivider();
 
 	// Handle Timing
-    static std::chrono::time_point<std::chrono::system_clock> tp1 = std::chrono::system_clock::now();
-    static std::chrono::time_point<std::chrono::system_clock> tp2 = std::chrono::system_clock::now();
-
-    tp2 = std::chrono::system_clock::now();
-    std::chrono::duration<float> elapsedTime = tp2 - tp1;
-    tp1 = tp2;
+    auto tp2 = std::chrono::system_clock::now();
+    std::chrono::duration<float> elapsedTime = tp2 - _update_tp;
+    _update_tp = tp2;
     // Our time per frame coefficient
     float fElapsedTime = elapsedTime.count();
 
     // count frames per second
-    static int frame_count = 0;
-    static float frame_acc = fElapsedTime;
-    frame_count++;
-    frame_acc += fElapsedTime;    
+    _frame_count++;
+    _frame_acc += fElapsedTime;    
 
-    if (frame_acc > 0.25f + fElapsedTime)
+    if (_frame_acc > 0.25f + fElapsedTime)
     {
-        frame_acc -= 0.25f;
-		_fps = frame_count * 4;
-		frame_count = 0;
+        _frame_acc -= 0.25f;
+		_fps = _frame_count * 4;
+		_frame_count = 0;
 		std::string sTitle = "Retro 6809";
 		sTitle += "  FPS: ";		
 		sTitle += std::to_string(_fps);
-        _sys_cpu_speed = (int)(1.0f / (s_avg_cpu_cycle_time / 1000000.0f));
+        // cycles run over the last quarter second, in khz
+        QWord cycles = _c6809->getCycleCount();
+        _sys_cpu_speed = (Word)((cycles - _speed_cycles) / 250);
+        _speed_cycles = cycles;
         sTitle += "   CPU_SPEED: " + std::to_string(_sys_cpu_speed) + " khz.";
     }    
 	// update the devices
-	for (auto &d : Bus::_memoryNodes)
+	for (auto &d : _memoryNodes)
 		d->OnUpdate(fElapsedTime);	    
 }
 
+// Headless machines have no wall clock to follow: each CPU clock advances SYS_CLOCK_DIV
+//      and SYS_TIMER by its share of emulated time, and the devices update once per
+//      emulated 60 hz frame, so a run reads the same timers however fast it goes.
+void Bus::_clockHeadless()
+{
+    // 120 hz ticks (bit 0 of SYS_CLOCK_DIV toggles at each) over clocks per second
+    _tick_acc += 120;
+    int rate = _c6809->ClockRate();
+    while (_tick_acc >= rate)
+    {
+        _tick_acc -= rate;
+        _clock_div++;
+        _clock_timer++;
+        if (_clock_div & 0x01)
+            continue;
+        // a 60 hz frame
+        if (++_frame_count == 15)
+        {   // a quarter second: cycles run in khz
+            _frame_count = 0;
+            _fps = 60;
+            QWord cycles = _c6809->getCycleCount();
+            _sys_cpu_speed = (Word)((cycles - _speed_cycles) / 250);
+            _speed_cycles = cycles;
+        }
+        for (auto &d : _memoryNodes)
+            d->OnUpdate(1.0f / 60.0f);
+    }
+}
+
 void Bus::OnRender()
 {
-	for (auto &d : Bus::_memoryNodes)
+	for (auto &d : _memoryNodes)
 		d->OnRender();    
 }
 
@@ -511,7 +559,7 @@ Word Bus::Attach(IDevice* dev, Word size)
         dev->Base(_lastAddress);
         dev->Size(size);
         _lastAddress += size;               
-        Bus::_memoryNodes.push_back(dev);
+        _memoryNodes.push_back(dev);
     }
     if (size > 65536)
         Bus::Error("Memory allocation beyond 64k boundary!");
@@ -523,35 +571,16 @@ void Bus::Error(const std::string& sErr)
 	std::cout << "\n    ERROR: " << sErr << " -- " << SDL_GetError() << "\n\n";
 
     // if SDL has been initialized, use a message box too
-    if (s_b_SDL_WasInit)
+    Bus& bus = Inst();
+    if (bus._b_SDL_WasInit)
         SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "ERROR:", sErr.c_str(), nullptr);
 
-    s_bIsRunning = false;
+    bus._bIsRunning = false;
 }
 
 Byte Bus::read(Word offset, bool debug) 
 {
-	return Bus::Read(offset, debug);
-}
-
-void Bus::write(Word offset, Byte data, bool debug) 
-{
-	Bus::Write(offset, data, debug);
-}
-
-Word Bus::read_word(Word offset, bool debug) 
-{
-	return Bus::Read_Word(offset, debug);
-}
-
-void Bus::write_word(Word offset, Word data, bool debug)
-{
-	Bus::Write_Word(offset, data, debug);
-}
-
-Byte Bus::Read(Word offset, bool debug)
-{
-    for (auto& a : Bus::_memoryNodes)
+    for (auto& a : _memoryNodes)
     {
         if (offset - a->Base() < a->Size())
         {
@@ -564,9 +593,9 @@ Byte Bus::Read(Word offset, bool debug)
     return 0xCC;
 }
 
-void Bus::Write(Word offset, Byte data, bool debug)
+void Bus::write(Word offset, Byte data, bool debug) 
 {
-    for (auto& a : Bus::_memoryNodes)
+    for (auto& a : _memoryNodes)
     {
         if (offset - a->Base() < a->Size())
         {
@@ -574,6 +603,16 @@ void Bus::Write(Word offset, Byte data, bool debug)
             {
                 if (offset - a->Base() < a->Size())
                     a->_memory((Word)(offset - a->Base()), data);
+                if (a == _membank)
+                    _membank->Touched(offset, 1);
+                return;
+            }
+            if (_write_log && !dynamic_cast<RAM*>(a))
+            {
+                if (_write_log_depth++ == 0)
+                    _write_log->push_back({ offset, data });
+                a->write(offset, data, debug);
+                _write_log_depth--;
                 return;
             }
             a->write(offset, data, debug);
@@ -581,6 +620,74 @@ void Bus::Write(Word offset, Byte data, bool debug)
         }
     }
 }
+
+Byte* Bus::MemPtr(Word offset, Word& len, bool write)
+{
+    for (auto& a : _memoryNodes)
+    {
+        if (offset - a->Base() < a->Size())
+        {
+            if (!dynamic_cast<RAM*>(a) && (write || !dynamic_cast<ROM*>(a)))
+                return nullptr;
+            len = a->Size() - (offset - a->Base());
+            return a->_data() + (offset - a->Base());
+        }
+    }
+    return nullptr;
+}
+
+void Bus::write_block(Word offset, const Byte* buf, DWord len)
+{
+    while (len)
+    {
+        IDevice* node = nullptr;
+        for (auto& a : _memoryNodes)
+        {
+            if (offset - a->Base() < a->Size())
+            {
+                node = a;
+                break;
+            }
+        }
+        if (!node)
+        {
+            // unmapped, as a debug write to it is
+            offset++;
+            buf++;
+            len--;
+            continue;
+        }
+        Word ofs = offset - node->Base();
+        DWord n = std::min<DWord>({ len, (DWord)node->Size() - ofs, 0x10000u - offset });
+        memcpy(node->_data() + ofs, buf, n);
+        if (node == _membank)
+            _membank->Touched(offset, n);
+        offset += n;
+        buf += n;
+        len -= n;
+    }
+}
+
+Word Bus::read_word(Word offset, bool debug) 
+{
+    return (read(offset) << 8) | read(offset + 1);
+}
+
+void Bus::write_word(Word offset, Word data, bool debug)
+{
+    write(offset, (data >> 8) & 0xFF);
+    write(offset + 1, data & 0xFF);
+}
+
+Byte Bus::Read(Word offset, bool debug)
+{
+    return Inst().read(offset, debug);
+}
+
+void Bus::Write(Word offset, Byte data, bool debug)
+{
+    Inst().write(offset, data, debug);
+}
 Word Bus::Read_Word(Word offset, bool debug)
 {
     Word ret = (Bus::Read(offset) << 8) | Bus::Read(offset + 1);
@@ -609,38 +716,49 @@ void Bus::Write_DWord(Word offset, DWord data, bool debug)
     Bus::Write(offset+3, (data>> 0) & 0xFF);
 }
 
-// load_hex helpers
-Byte Bus::_fread_hex_byte(std::ifstream& ifs)
+void Bus::load_kernel()
 {
-	char str[3];
-	long l;
-	ifs.get(str[0]);
-	ifs.get(str[1]);
-	str[2] = '\0';	
-	l = strtol(str, NULL, 16);
-	return (Byte)(l & 0xff);	
+#if defined(KERNEL_ROM_EMBEDDED)
+	const Byte* data = KERNEL_ROM_DATA;
+	for (auto& run : KERNEL_ROM_RUNS)
+	{
+		write_block(run[0], data, run[1]);
+		data += run[1];
+	}
+#else
+	load_hex(KERNEL_ROM_FILENAME.c_str());
+#endif
 }
-Word Bus::_fread_hex_word(std::ifstream& ifs)
+
+void Bus::restore_boot()
 {
-	Word ret;
-	ret = _fread_hex_byte(ifs);
-	ret <<= 8;
-	ret |= _fread_hex_byte(ifs);
-	return ret;				
+#if defined(KERNEL_BOOT_SNAPSHOT)
+	// the devices see the boot's writes again, then RAM is put back as it was
+	for (auto& w : BOOT_SNAPSHOT_WRITES)
+		write(w[0], (Byte)w[1]);
+	for (DWord a = 0; a < 0x10000; )
+	{
+		Word len = 1;
+		Byte* ram = MemPtr(a, len, true);
+		if (ram)
+			memset(ram, 0, len);
+		a += len;
+	}
+	const Byte* data = BOOT_SNAPSHOT_RAM;
+	for (auto& run : BOOT_SNAPSHOT_RAM_RUNS)
+	{
+		write_block(run[0], data, run[1]);
+		data += run[1];
+	}
+	const Word* r = BOOT_SNAPSHOT_REGS;
+	_c6809->setRegs({ r[0], r[1], r[2], r[3], r[4], r[5], r[6], r[7], (Byte)r[8], (Byte)r[9], (Byte)r[10] });
+#endif
 }
-void Bus::load_hex(const char* filename)
+
+void Bus::load_hex(const char* filename, Word bin_addr)
 {
-	// // lambda to convert integer to hex string
-	// auto hex = [](uint32_t n, uint8_t digits)
-	// {
-	// 	std::string s(digits, '0');
-	// 	for (int i = digits - 1; i >= 0; i--, n >>= 4)
-	// 		s[i] = "0123456789ABCDEF"[n & 0xF];
-	// 	return s;
-	// };
-
-	std::ifstream ifs(filename);
-	if (!ifs.is_open())
+	std::vector<Byte> data;
+	if (!Loader::ReadFile(filename, data))
 	{
         std::stringstream ss;
         ss << "Unable to open file: " << filename;
@@ -648,39 +766,15 @@ void Bus::load_hex(const char* filename)
 
 		return;
 	}
-	bool done = false;
-	char c;	
-	while (!done)
+	Loader loader;
+	if (!loader.Parse(data.data(), (DWord)data.size(), Loader::Format(filename), bin_addr))
 	{
-		Byte n, t;
-		Word addr;	
-		Byte b;
-		ifs.get(c);	// skip the leading ":"
-		n = _fread_hex_byte(ifs);		// byte count for this line
-		addr = _fread_hex_word(ifs);	// fetch the begin address		
-		t = _fread_hex_byte(ifs);		// record type
-		if (t == 0x00) 
-		{
-			while (n--) 
-			{
-				b = _fread_hex_byte(ifs);
-				// std::cout << "0x" << hex(addr,4) << ":";
-				// std::cout << "0x" << hex(b, 2) << std::endl;
-				Bus::Write(addr, b, true);
-				++addr;
-			}
-			// Read and discard checksum byte
-			(void)_fread_hex_byte(ifs);	
-			// skip the junk at the end of the line	
-			if (ifs.peek() == '\r')	ifs.get(c);
-			if (ifs.peek() == '\n')	ifs.get(c);
-		}
-		else if (t == 0x01) 
-			done = true;
+        std::stringstream ss;
+        ss << "Bad record or checksum in file: " << filename;
+        Bus::Error(ss.str());
+
+		return;
 	}
-	// close and return
-	ifs.close();
-	
-	return;
+	loader.Store();
 }
 
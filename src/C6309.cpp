@@ -0,0 +1,694 @@
+/**************************
+* C6309.CPP
+*
+* Hitachi HD6309 extensions to the C6809 core (CPU_HD6309)
+*
+* Copyright (C) 2023 by Jay Faries
+**************************************/
+
+#include <utility>
+
+#include "types.hpp"
+#include "Bus.hpp"
+#include "C6809.hpp"
+
+///// INITIALIZATION ////////////////////////////////////////////////////
+
+// Adds the HD6309 opcodes to the opMap and fills in the native mode cycle
+// counts. The new rows carry their native cycles as the last field; the
+// 6809 rows keep their emulation mode count and only the opcodes the
+// HD6309 runs faster in native mode are listed below
+// (docs/6x09_Instruction_Sets.pdf, Part III).
+void C6809::Init6309()
+{
+	using C = C6809;
+
+	for (auto& op : opMap)
+		op.second.cycles_nm = op.second.cycles;
+	static const std::pair<Word, Byte> native[] = {
+		{0x0000,5}, {0x0003,5}, {0x0004,5}, {0x0006,5}, {0x0007,5}, {0x0008,5}, {0x0009,5}, {0x000a,5},
+		{0x000c,5}, {0x000d,4}, {0x000e,2}, {0x000f,5}, {0x0012,1}, {0x0016,4}, {0x0017,7}, {0x0019,1},
+		{0x001a,2}, {0x001d,1}, {0x001e,5}, {0x001f,4}, {0x0034,4}, {0x0035,4}, {0x0036,4}, {0x0037,4},
+		{0x0039,4}, {0x003a,1}, {0x003d,10}, {0x003f,21}, {0x0040,1}, {0x0043,1}, {0x0044,1}, {0x0046,1},
+		{0x0047,1}, {0x0048,1}, {0x0049,1}, {0x004a,1}, {0x004c,1}, {0x004d,1}, {0x004f,1}, {0x0050,1},
+		{0x0053,1}, {0x0054,1}, {0x0056,1}, {0x0057,1}, {0x0058,1}, {0x0059,1}, {0x005a,1}, {0x005c,1},
+		{0x005d,1}, {0x005f,1}, {0x006d,5}, {0x0070,6}, {0x0073,6}, {0x0074,6}, {0x0076,6}, {0x0077,6},
+		{0x0078,6}, {0x0079,6}, {0x007a,6}, {0x007c,6}, {0x007d,5}, {0x007e,3}, {0x007f,6}, {0x0083,3},
+		{0x008c,3}, {0x008d,6}, {0x0090,3}, {0x0091,3}, {0x0092,3}, {0x0093,4}, {0x0094,3}, {0x0095,3},
+		{0x0096,3}, {0x0097,3}, {0x0098,3}, {0x0099,3}, {0x009a,3}, {0x009b,3}, {0x009c,4}, {0x009d,6},
+		{0x009e,4}, {0x009f,4}, {0x00a3,5}, {0x00ac,5}, {0x00ad,6}, {0x00b0,4}, {0x00b1,4}, {0x00b2,4},
+		{0x00b3,5}, {0x00b4,4}, {0x00b5,4}, {0x00b6,4}, {0x00b7,4}, {0x00b8,4}, {0x00b9,4}, {0x00ba,4},
+		{0x00bb,4}, {0x00bc,5}, {0x00bd,7}, {0x00be,5}, {0x00bf,5}, {0x00c3,3}, {0x00d0,3}, {0x00d1,3},
+		{0x00d2,3}, {0x00d3,4}, {0x00d4,3}, {0x00d5,3}, {0x00d6,3}, {0x00d7,3}, {0x00d8,3}, {0x00d9,3},
+		{0x00da,3}, {0x00db,3}, {0x00dc,4}, {0x00dd,4}, {0x00de,4}, {0x00df,4}, {0x00e3,5}, {0x00f0,4},
+		{0x00f1,4}, {0x00f2,4}, {0x00f3,5}, {0x00f4,4}, {0x00f5,4}, {0x00f6,4}, {0x00f7,4}, {0x00f8,4},
+		{0x00f9,4}, {0x00fa,4}, {0x00fb,4}, {0x00fc,5}, {0x00fd,5}, {0x00fe,5}, {0x00ff,5}, {0x103f,22},
+		{0x1083,4}, {0x108c,4}, {0x1093,5}, {0x109c,5}, {0x109e,5}, {0x109f,5}, {0x10a3,6}, {0x10ac,6},
+		{0x10b3,6}, {0x10bc,6}, {0x10be,6}, {0x10bf,6}, {0x10de,5}, {0x10df,5}, {0x10fe,6}, {0x10ff,6},
+		{0x113f,22}, {0x1183,4}, {0x118c,4}, {0x1193,5}, {0x119c,5}, {0x11a3,6}, {0x11ac,6}, {0x11b3,6},
+		{0x11bc,6}
+	};
+	for (auto& n : native)
+		opMap[n.first].cycles_nm = n.second;
+
+	opMap[0x0001] = { "OIM",	&C::oim,	&C::dir,	6, 3, 6 };
+	opMap[0x0002] = { "AIM",	&C::aim,	&C::dir,	6, 3, 6 };
+	opMap[0x0005] = { "EIM",	&C::eim,	&C::dir,	6, 3, 6 };
+	opMap[0x000b] = { "TIM",	&C::tim,	&C::dir,	6, 3, 6 };
+	opMap[0x0014] = { "SEXW",	&C::sexw,	&C::inh,	4, 1, 4 };
+	opMap[0x0061] = { "OIM",	&C::oim,	&C::idx,	7, 3, 7 };
+	opMap[0x0062] = { "AIM",	&C::aim,	&C::idx,	7, 3, 7 };
+	opMap[0x0065] = { "EIM",	&C::eim,	&C::idx,	7, 3, 7 };
+	opMap[0x006b] = { "TIM",	&C::tim,	&C::idx,	7, 3, 7 };
+	opMap[0x0071] = { "OIM",	&C::oim,	&C::ext,	7, 4, 7 };
+	opMap[0x0072] = { "AIM",	&C::aim,	&C::ext,	7, 4, 7 };
+	opMap[0x0075] = { "EIM",	&C::eim,	&C::ext,	7, 4, 7 };
+	opMap[0x007b] = { "TIM",	&C::tim,	&C::ext,	7, 4, 7 };
+	opMap[0x00cd] = { "LDQ",	&C::ldq,	&C::immq,	5, 5, 5 };
+
+	// page 2
+
+	opMap[0x1030] = { "ADDR",	&C::add_r,	&C::immb,	4, 3, 4 };
+	opMap[0x1031] = { "ADCR",	&C::adc_r,	&C::immb,	4, 3, 4 };
+	opMap[0x1032] = { "SUBR",	&C::sub_r,	&C::immb,	4, 3, 4 };
+	opMap[0x1033] = { "SBCR",	&C::sbc_r,	&C::immb,	4, 3, 4 };
+	opMap[0x1034] = { "ANDR",	&C::and_r,	&C::immb,	4, 3, 4 };
+	opMap[0x1035] = { "ORR",	&C::or_r,	&C::immb,	4, 3, 4 };
+	opMap[0x1036] = { "EORR",	&C::eor_r,	&C::immb,	4, 3, 4 };
+	opMap[0x1037] = { "CMPR",	&C::cmp_r,	&C::immb,	4, 3, 4 };
+	opMap[0x1038] = { "PSHSW",	&C::pshsw,	&C::inh,	6, 2, 6 };
+	opMap[0x1039] = { "PULSW",	&C::pulsw,	&C::inh,	6, 2, 6 };
+	opMap[0x103a] = { "PSHUW",	&C::pshuw,	&C::inh,	6, 2, 6 };
+	opMap[0x103b] = { "PULUW",	&C::puluw,	&C::inh,	6, 2, 6 };
+	opMap[0x1040] = { "NEGD",	&C::negd,	&C::inh,	3, 2, 2 };
+	opMap[0x1043] = { "COMD",	&C::comd,	&C::inh,	3, 2, 2 };
+	opMap[0x1044] = { "LSRD",	&C::lsrd,	&C::inh,	3, 2, 2 };
+	opMap[0x1046] = { "RORD",	&C::rord,	&C::inh,	3, 2, 2 };
+	opMap[0x1047] = { "ASRD",	&C::asrd,	&C::inh,	3, 2, 2 };
+	opMap[0x1048] = { "ASLD",	&C::asld,	&C::inh,	3, 2, 2 };
+	opMap[0x1049] = { "ROLD",	&C::rold,	&C::inh,	3, 2, 2 };
+	opMap[0x104a] = { "DECD",	&C::decd,	&C::inh,	3, 2, 2 };
+	opMap[0x104c] = { "INCD",	&C::incd,	&C::inh,	3, 2, 2 };
+	opMap[0x104d] = { "TSTD",	&C::tstd,	&C::inh,	3, 2, 2 };
+	opMap[0x104f] = { "CLRD",	&C::clrd,	&C::inh,	3, 2, 2 };
+	opMap[0x1053] = { "COMW",	&C::comw,	&C::inh,	3, 2, 2 };
+	opMap[0x1054] = { "LSRW",	&C::lsrw,	&C::inh,	3, 2, 2 };
+	opMap[0x1056] = { "RORW",	&C::rorw,	&C::inh,	3, 2, 2 };
+	opMap[0x1059] = { "ROLW",	&C::rolw,	&C::inh,	3, 2, 2 };
+	opMap[0x105a] = { "DECW",	&C::decw,	&C::inh,	3, 2, 2 };
+	opMap[0x105c] = { "INCW",	&C::incw,	&C::inh,	3, 2, 2 };
+	opMap[0x105d] = { "TSTW",	&C::tstw,	&C::inh,	3, 2, 2 };
+	opMap[0x105f] = { "CLRW",	&C::clrw,	&C::inh,	3, 2, 2 };
+	opMap[0x1080] = { "SUBW",	&C::subw,	&C::immw,	5, 4, 4 };
+	opMap[0x1081] = { "CMPW",	&C::cmpw,	&C::immw,	5, 4, 4 };
+	opMap[0x1082] = { "SBCD",	&C::sbcd,	&C::immw,	5, 4, 4 };
+	opMap[0x1084] = { "ANDD",	&C::andd,	&C::immw,	5, 4, 4 };
+	opMap[0x1085] = { "BITD",	&C::bitd,	&C::immw,	5, 4, 4 };
+	opMap[0x1086] = { "LDW",	&C::ldw,	&C::immw,	4, 4, 4 };
+	opMap[0x1088] = { "EORD",	&C::eord,	&C::immw,	5, 4, 4 };
+	opMap[0x1089] = { "ADCD",	&C::adcd,	&C::immw,	5, 4, 4 };
+	opMap[0x108a] = { "ORD",	&C::ord,	&C::immw,	5, 4, 4 };
+	opMap[0x108b] = { "ADDW",	&C::addw,	&C::immw,	5, 4, 4 };
+	opMap[0x1090] = { "SUBW",	&C::subw,	&C::dir,	7, 3, 5 };
+	opMap[0x1091] = { "CMPW",	&C::cmpw,	&C::dir,	7, 3, 5 };
+	opMap[0x1092] = { "SBCD",	&C::sbcd,	&C::dir,	7, 3, 5 };
+	opMap[0x1094] = { "ANDD",	&C::andd,	&C::dir,	7, 3, 5 };
+	opMap[0x1095] = { "BITD",	&C::bitd,	&C::dir,	7, 3, 5 };
+	opMap[0x1096] = { "LDW",	&C::ldw,	&C::dir,	6, 3, 5 };
+	opMap[0x1097] = { "STW",	&C::stw,	&C::dir,	6, 3, 5 };
+	opMap[0x1098] = { "EORD",	&C::eord,	&C::dir,	7, 3, 5 };
+	opMap[0x1099] = { "ADCD",	&C::adcd,	&C::dir,	7, 3, 5 };
+	opMap[0x109a] = { "ORD",	&C::ord,	&C::dir,	7, 3, 5 };
+	opMap[0x109b] = { "ADDW",	&C::addw,	&C::dir,	7, 3, 5 };
+	opMap[0x10a0] = { "SUBW",	&C::subw,	&C::idx,	7, 3, 6 };
+	opMap[0x10a1] = { "CMPW",	&C::cmpw,	&C::idx,	7, 3, 6 };
+	opMap[0x10a2] = { "SBCD",	&C::sbcd,	&C::idx,	7, 3, 6 };
+	opMap[0x10a4] = { "ANDD",	&C::andd,	&C::idx,	7, 3, 6 };
+	opMap[0x10a5] = { "BITD",	&C::bitd,	&C::idx,	7, 3, 6 };
+	opMap[0x10a6] = { "LDW",	&C::ldw,	&C::idx,	6, 3, 6 };
+	opMap[0x10a7] = { "STW",	&C::stw,	&C::idx,	6, 3, 6 };
+	opMap[0x10a8] = { "EORD",	&C::eord,	&C::idx,	7, 3, 6 };
+	opMap[0x10a9] = { "ADCD",	&C::adcd,	&C::idx,	7, 3, 6 };
+	opMap[0x10aa] = { "ORD",	&C::ord,	&C::idx,	7, 3, 6 };
+	opMap[0x10ab] = { "ADDW",	&C::addw,	&C::idx,	7, 3, 6 };
+	opMap[0x10b0] = { "SUBW",	&C::subw,	&C::ext,	8, 4, 6 };
+	opMap[0x10b1] = { "CMPW",	&C::cmpw,	&C::ext,	8, 4, 6 };
+	opMap[0x10b2] = { "SBCD",	&C::sbcd,	&C::ext,	8, 4, 6 };
+	opMap[0x10b4] = { "ANDD",	&C::andd,	&C::ext,	8, 4, 6 };
+	opMap[0x10b5] = { "BITD",	&C::bitd,	&C::ext,	8, 4, 6 };
+	opMap[0x10b6] = { "LDW",	&C::ldw,	&C::ext,	7, 4, 6 };
+	opMap[0x10b7] = { "STW",	&C::stw,	&C::ext,	7, 4, 6 };
+	opMap[0x10b8] = { "EORD",	&C::eord,	&C::ext,	8, 4, 6 };
+	opMap[0x10b9] = { "ADCD",	&C::adcd,	&C::ext,	8, 4, 6 };
+	opMap[0x10ba] = { "ORD",	&C::ord,	&C::ext,	8, 4, 6 };
+	opMap[0x10bb] = { "ADDW",	&C::addw,	&C::ext,	8, 4, 6 };
+	opMap[0x10dc] = { "LDQ",	&C::ldq,	&C::dir,	8, 3, 7 };
+	opMap[0x10dd] = { "STQ",	&C::stq,	&C::dir,	8, 3, 7 };
+	opMap[0x10ec] = { "LDQ",	&C::ldq,	&C::idx,	8, 3, 8 };
+	opMap[0x10ed] = { "STQ",	&C::stq,	&C::idx,	8, 3, 8 };
+	opMap[0x10fc] = { "LDQ",	&C::ldq,	&C::ext,	9, 4, 8 };
+	opMap[0x10fd] = { "STQ",	&C::stq,	&C::ext,	9, 4, 8 };
+
+	// page 3
+
+	opMap[0x1130] = { "BAND",	&C::band,	&C::dir,	7, 4, 6 };
+	opMap[0x1131] = { "BIAND",	&C::biand,	&C::dir,	7, 4, 6 };
+	opMap[0x1132] = { "BOR",	&C::bor,	&C::dir,	7, 4, 6 };
+	opMap[0x1133] = { "BIOR",	&C::bior,	&C::dir,	7, 4, 6 };
+	opMap[0x1134] = { "BEOR",	&C::beor,	&C::dir,	7, 4, 6 };
+	opMap[0x1135] = { "BIEOR",	&C::bieor,	&C::dir,	7, 4, 6 };
+	opMap[0x1136] = { "LDBT",	&C::ldbt,	&C::dir,	7, 4, 6 };
+	opMap[0x1137] = { "STBT",	&C::stbt,	&C::dir,	8, 4, 7 };
+	opMap[0x1138] = { "TFM",	&C::tfm,	&C::immb,	6, 3, 6 };
+	opMap[0x1139] = { "TFM",	&C::tfm,	&C::immb,	6, 3, 6 };
+	opMap[0x113a] = { "TFM",	&C::tfm,	&C::immb,	6, 3, 6 };
+	opMap[0x113b] = { "TFM",	&C::tfm,	&C::immb,	6, 3, 6 };
+	opMap[0x113c] = { "BITMD",	&C::bitmd,	&C::immb,	4, 3, 4 };
+	opMap[0x113d] = { "LDMD",	&C::ldmd,	&C::immb,	5, 3, 5 };
+	opMap[0x1143] = { "COME",	&C::come,	&C::inh,	3, 2, 2 };
+	opMap[0x114a] = { "DECE",	&C::dece,	&C::inh,	3, 2, 2 };
+	opMap[0x114c] = { "INCE",	&C::ince,	&C::inh,	3, 2, 2 };
+	opMap[0x114d] = { "TSTE",	&C::tste,	&C::inh,	3, 2, 2 };
+	opMap[0x114f] = { "CLRE",	&C::clre,	&C::inh,	3, 2, 2 };
+	opMap[0x1153] = { "COMF",	&C::comf,	&C::inh,	3, 2, 2 };
+	opMap[0x115a] = { "DECF",	&C::decf,	&C::inh,	3, 2, 2 };
+	opMap[0x115c] = { "INCF",	&C::incf,	&C::inh,	3, 2, 2 };
+	opMap[0x115d] = { "TSTF",	&C::tstf,	&C::inh,	3, 2, 2 };
+	opMap[0x115f] = { "CLRF",	&C::clrf,	&C::inh,	3, 2, 2 };
+	opMap[0x1180] = { "SUBE",	&C::sube,	&C::immb,	3, 3, 3 };
+	opMap[0x1181] = { "CMPE",	&C::cmpe,	&C::immb,	3, 3, 3 };
+	opMap[0x1186] = { "LDE",	&C::lde,	&C::immb,	3, 3, 3 };
+	opMap[0x118b] = { "ADDE",	&C::adde,	&C::immb,	3, 3, 3 };
+	opMap[0x118d] = { "DIVD",	&C::divd,	&C::immb,	25, 3, 25 };
+	opMap[0x118e] = { "DIVQ",	&C::divq,	&C::immw,	34, 4, 34 };
+	opMap[0x118f] = { "MULD",	&C::muld,	&C::immw,	28, 4, 28 };
+	opMap[0x1190] = { "SUBE",	&C::sube,	&C::dir,	5, 3, 4 };
+	opMap[0x1191] = { "CMPE",	&C::cmpe,	&C::dir,	5, 3, 4 };
+	opMap[0x1196] = { "LDE",	&C::lde,	&C::dir,	5, 3, 4 };
+	opMap[0x1197] = { "STE",	&C::ste,	&C::dir,	5, 3, 4 };
+	opMap[0x119b] = { "ADDE",	&C::adde,	&C::dir,	5, 3, 4 };
+	opMap[0x119d] = { "DIVD",	&C::divd,	&C::dir,	27, 3, 26 };
+	opMap[0x119e] = { "DIVQ",	&C::divq,	&C::dir,	36, 3, 35 };
+	opMap[0x119f] = { "MULD",	&C::muld,	&C::dir,	30, 3, 29 };
+	opMap[0x11a0] = { "SUBE",	&C::sube,	&C::idx,	5, 3, 5 };
+	opMap[0x11a1] = { "CMPE",	&C::cmpe,	&C::idx,	5, 3, 5 };
+	opMap[0x11a6] = { "LDE",	&C::lde,	&C::idx,	5, 3, 5 };
+	opMap[0x11a7] = { "STE",	&C::ste,	&C::idx,	5, 3, 5 };
+	opMap[0x11ab] = { "ADDE",	&C::adde,	&C::idx,	5, 3, 5 };
+	opMap[0x11ad] = { "DIVD",	&C::divd,	&C::idx,	27, 3, 27 };
+	opMap[0x11ae] = { "DIVQ",	&C::divq,	&C::idx,	36, 3, 36 };
+	opMap[0x11af] = { "MULD",	&C::muld,	&C::idx,	30, 3, 30 };
+	opMap[0x11b0] = { "SUBE",	&C::sube,	&C::ext,	6, 4, 5 };
+	opMap[0x11b1] = { "CMPE",	&C::cmpe,	&C::ext,	6, 4, 5 };
+	opMap[0x11b6] = { "LDE",	&C::lde,	&C::ext,	6, 4, 5 };
+	opMap[0x11b7] = { "STE",	&C::ste,	&C::ext,	6, 4, 5 };
+	opMap[0x11bb] = { "ADDE",	&C::adde,	&C::ext,	6, 4, 5 };
+	opMap[0x11bd] = { "DIVD",	&C::divd,	&C::ext,	28, 4, 27 };
+	opMap[0x11be] = { "DIVQ",	&C::divq,	&C::ext,	37, 4, 36 };
+	opMap[0x11bf] = { "MULD",	&C::muld,	&C::ext,	31, 4, 30 };
+	opMap[0x11c0] = { "SUBF",	&C::subf,	&C::immb,	3, 3, 3 };
+	opMap[0x11c1] = { "CMPF",	&C::cmpf,	&C::immb,	3, 3, 3 };
+	opMap[0x11c6] = { "LDF",	&C::ldf,	&C::immb,	3, 3, 3 };
+	opMap[0x11cb] = { "ADDF",	&C::addf,	&C::immb,	3, 3, 3 };
+	opMap[0x11d0] = { "SUBF",	&C::subf,	&C::dir,	5, 3, 4 };
+	opMap[0x11d1] = { "CMPF",	&C::cmpf,	&C::dir,	5, 3, 4 };
+	opMap[0x11d6] = { "LDF",	&C::ldf,	&C::dir,	5, 3, 4 };
+	opMap[0x11d7] = { "STF",	&C::stf,	&C::dir,	5, 3, 4 };
+	opMap[0x11db] = { "ADDF",	&C::addf,	&C::dir,	5, 3, 4 };
+	opMap[0x11e0] = { "SUBF",	&C::subf,	&C::idx,	5, 3, 5 };
+	opMap[0x11e1] = { "CMPF",	&C::cmpf,	&C::idx,	5, 3, 5 };
+	opMap[0x11e6] = { "LDF",	&C::ldf,	&C::idx,	5, 3, 5 };
+	opMap[0x11e7] = { "STF",	&C::stf,	&C::idx,	5, 3, 5 };
+	opMap[0x11eb] = { "ADDF",	&C::addf,	&C::idx,	5, 3, 5 };
+	opMap[0x11f0] = { "SUBF",	&C::subf,	&C::ext,	6, 4, 5 };
+	opMap[0x11f1] = { "CMPF",	&C::cmpf,	&C::ext,	6, 4, 5 };
+	opMap[0x11f6] = { "LDF",	&C::ldf,	&C::ext,	6, 4, 5 };
+	opMap[0x11f7] = { "STF",	&C::stf,	&C::ext,	6, 4, 5 };
+	opMap[0x11fb] = { "ADDF",	&C::addf,	&C::ext,	6, 4, 5 };
+}
+
+
+///// HD6309 OPERATION CODES ////////////////////////////////////////////
+
+// 16-bit accumulator arithmetic
+void C6809::addw() { Word m = read_word(ea()); W = do_alu(ALU_ADD, W, m, true); }
+void C6809::adcd() { Word m = read_word(ea()); D = do_alu(ALU_ADC, D, m, true); }
+void C6809::subw() { Word m = read_word(ea()); W = do_alu(ALU_SUB, W, m, true); }
+void C6809::sbcd() { Word m = read_word(ea()); D = do_alu(ALU_SBC, D, m, true); }
+void C6809::andd() { Word m = read_word(ea()); D = do_alu(ALU_AND, D, m, true); }
+void C6809::bitd() { Word m = read_word(ea()); do_alu(ALU_AND, D, m, true); }
+void C6809::eord() { Word m = read_word(ea()); D = do_alu(ALU_EOR, D, m, true); }
+void C6809::ord()  { Word m = read_word(ea()); D = do_alu(ALU_OR, D, m, true); }
+void C6809::cmpw() { Word m = read_word(ea()); do_alu(ALU_CMP, W, m, true); }
+void C6809::ldw() { do_ld(W, ea()); }
+void C6809::stw() { Word r = W; do_st(r, ea()); }
+
+// E and F accumulators
+void C6809::adde() { do_add(E, ea()); }
+void C6809::addf() { do_add(F, ea()); }
+void C6809::sube() { do_sub(E, ea()); }
+void C6809::subf() { do_sub(F, ea()); }
+void C6809::cmpe() { Byte r = E; do_cmp(r, ea()); }
+void C6809::cmpf() { Byte r = F; do_cmp(r, ea()); }
+void C6809::lde() { do_ld(E, ea()); }
+void C6809::ldf() { do_ld(F, ea()); }
+void C6809::ste() { Byte r = E; do_st(r, ea()); }
+void C6809::stf() { Byte r = F; do_st(r, ea()); }
+void C6809::come() { do_com(E); }
+void C6809::comf() { do_com(F); }
+void C6809::dece() { do_dec(E); }
+void C6809::decf() { do_dec(F); }
+void C6809::ince() { do_inc(E); }
+void C6809::incf() { do_inc(F); }
+void C6809::tste() { do_tst(E); }
+void C6809::tstf() { do_tst(F); }
+void C6809::clre() { do_clr(E); }
+void C6809::clrf() { do_clr(F); }
+
+// D and W inherent
+void C6809::negd() { do_neg(D); }
+void C6809::comd() { do_com(D); }
+void C6809::comw() { do_com(W); }
+void C6809::lsrd() { do_lsr(D); }
+void C6809::lsrw() { do_lsr(W); }
+void C6809::rord() { do_ror(D); }
+void C6809::rorw() { do_ror(W); }
+void C6809::asrd() { do_asr(D); }
+void C6809::asld() { do_asl(D); }
+void C6809::rold() { do_rol(D); }
+void C6809::rolw() { do_rol(W); }
+void C6809::decd() { do_dec(D); }
+void C6809::decw() { do_dec(W); }
+void C6809::incd() { do_inc(D); }
+void C6809::incw() { do_inc(W); }
+void C6809::tstd() { do_tst(D); }
+void C6809::tstw() { do_tst(W); }
+void C6809::clrd() { do_clr(D); }
+void C6809::clrw() { do_clr(W); }
+void C6809::sexw() {
+	D = btst(W, 15) ? 0xffff : 0x0000;
+	cc_sync();
+	CC.bit.N = btst(W, 15);
+	CC.bit.Z = !W;
+}
+void C6809::pshsw() { do_psh(S, W); }
+void C6809::pshuw() { do_psh(U, W); }
+void C6809::pulsw() { do_pul(S, W); }
+void C6809::puluw() { do_pul(U, W); }
+
+// Q = D:W
+void C6809::ldq() {
+	Word addr = ea();
+	D = read_word(addr);
+	W = read_word(addr + 2);
+	cc_sync();
+	CC.bit.N = btst(D, 15);
+	CC.bit.Z = !D && !W;
+	CC.bit.V = 0;
+}
+void C6809::stq() {
+	Word addr = ea();
+	write_word(addr, D);
+	write_word(addr + 2, W);
+	cc_sync();
+	CC.bit.N = btst(D, 15);
+	CC.bit.Z = !D && !W;
+	CC.bit.V = 0;
+}
+void C6809::muld() {
+	Sint32 q = (Sint16)D * (Sint16)read_word(ea());
+	setQ((DWord)q);
+	cc_sync();
+	CC.bit.N = (q < 0);
+	CC.bit.Z = (q == 0);
+}
+void C6809::divd() {
+	Sint8 m = (Sint8)read(ea());
+	if (m == 0) {
+		trap(MD_DZ);
+		return;
+	}
+	int q = (Sint16)D / m;
+	int r = (Sint16)D % m;
+	cc_sync();
+	if (q < -256 || q > 255) {
+		// range overflow: the accumulators are left alone
+		CC.bit.N = CC.bit.Z = CC.bit.C = 0;
+		CC.bit.V = 1;
+		cycles -= 13;
+		return;
+	}
+	A = (Byte)r;
+	B = (Byte)q;
+	CC.bit.V = (q < -128 || q > 127);
+	CC.bit.N = btst(B, 7);
+	CC.bit.Z = !B;
+	CC.bit.C = btst(B, 0);
+}
+void C6809::divq() {
+	Sint16 m = (Sint16)read_word(ea());
+	if (m == 0) {
+		trap(MD_DZ);
+		return;
+	}
+	Sint64 q = (Sint64)(Sint32)getQ() / m;
+	Sint64 r = (Sint64)(Sint32)getQ() % m;
+	cc_sync();
+	if (q < -65536 || q > 65535) {
+		// range overflow: the accumulators are left alone
+		CC.bit.N = CC.bit.Z = CC.bit.C = 0;
+		CC.bit.V = 1;
+		cycles -= 21;
+		return;
+	}
+	D = (Word)r;
+	W = (Word)q;
+	CC.bit.V = (q < -32768 || q > 32767);
+	CC.bit.N = btst(W, 15);
+	CC.bit.Z = !W;
+	CC.bit.C = btst(W, 0);
+}
+
+// memory immediate
+void C6809::oim() { do_mim(ALU_OR); }
+void C6809::aim() { do_mim(ALU_AND); }
+void C6809::eim() { do_mim(ALU_EOR); }
+void C6809::tim() {
+	Byte imm = fetch_byte();
+	Byte m = read(ea()) & imm;
+	set_flags(LAZY_LOGIC8, 0, 0, m);
+}
+
+// inter-register
+void C6809::add_r() { do_reg_op(ALU_ADD); }
+void C6809::adc_r() { do_reg_op(ALU_ADC); }
+void C6809::sub_r() { do_reg_op(ALU_SUB); }
+void C6809::sbc_r() { do_reg_op(ALU_SBC); }
+void C6809::and_r() { do_reg_op(ALU_AND); }
+void C6809::or_r()  { do_reg_op(ALU_OR); }
+void C6809::eor_r() { do_reg_op(ALU_EOR); }
+void C6809::cmp_r() { do_reg_op(ALU_CMP); }
+
+// single bit transfers between a register and direct memory
+void C6809::band()  { do_bitop(0); }
+void C6809::biand() { do_bitop(1); }
+void C6809::bor()   { do_bitop(2); }
+void C6809::bior()  { do_bitop(3); }
+void C6809::beor()  { do_bitop(4); }
+void C6809::bieor() { do_bitop(5); }
+void C6809::ldbt()  { do_bitop(6); }
+void C6809::stbt()  { do_bitop(7); }
+
+// mode register
+void C6809::ldmd() {
+	Byte n = read(immb());
+	MD = (MD & ~(MD_NM | MD_FM)) | (n & (MD_NM | MD_FM));
+}
+void C6809::bitmd() {
+	Byte n = read(immb()) & (MD_IL | MD_DZ);
+	cc_sync();
+	CC.bit.Z = !(MD & n);
+	MD &= ~n;		// the tested trap bits are cleared
+}
+
+// Block transfer of W bytes. One byte moves per pass and the PC is wound
+// back over the instruction until W reaches zero, so the CPU takes its
+// interrupts between bytes and resumes the transfer on return, as the
+// real part does. 6 cycles to start, then 3 per byte.
+void C6809::tfm() {
+	Byte post = read(immb());
+	Byte r0 = post >> 4;
+	Byte r1 = post & 0x0f;
+	if (r0 > 4 || r1 > 4) {
+		trap(MD_IL);
+		return;
+	}
+	if (W == 0) {
+		tfm_active = false;
+		return;
+	}
+	cycles = tfm_active ? 3 : cycles + 3;
+	Word& src = r0 ? *ptrReg[r0 - 1] : D;
+	Word& dst = r1 ? *ptrReg[r1 - 1] : D;
+	write(dst, read(src));
+	switch (opcode & 0x03)
+	{
+		case 0:	src++;	dst++;	break;	// TFM r0+,r1+
+		case 1:	src--;	dst--;	break;	// TFM r0-,r1-
+		case 2:	src++;			break;	// TFM r0+,r1
+		case 3:			dst++;	break;	// TFM r0,r1+
+	}
+	W--;
+	tfm_active = (W != 0);
+	if (tfm_active)
+		PC -= 3;
+}
+
+
+///// HD6309 HELPER FUNCTIONS ///////////////////////////////////////////
+
+// 8/16-bit ALU for the HD6309 instructions. The flags are set as the part
+// does (16-bit N Z V C for the wide forms) rather than through the lazy
+// flags, and H is left alone.
+Word C6809::do_alu(Byte op, Word x, Word m, bool wide)
+{
+	const DWord mask = wide ? 0xffff : 0x00ff;
+	const DWord sign = wide ? 0x8000 : 0x0080;
+	DWord r = 0;
+	cc_sync();
+	Byte c = CC.bit.C;
+	switch (op)
+	{
+		case ALU_ADD:
+			c = 0;
+			[[fallthrough]];
+		case ALU_ADC:
+			r = (DWord)x + m + c;
+			CC.bit.C = (r > mask);
+			CC.bit.V = ((x ^ r) & (m ^ r) & sign) != 0;
+			break;
+		case ALU_SUB:
+		case ALU_CMP:
+			c = 0;
+			[[fallthrough]];
+		case ALU_SBC:
+			r = (DWord)x - m - c;
+			CC.bit.C = ((DWord)x < (DWord)m + c);
+			CC.bit.V = ((x ^ m) & (x ^ r) & sign) != 0;
+			break;
+		case ALU_AND:	r = x & m;	CC.bit.V = 0;	break;
+		case ALU_OR:	r = x | m;	CC.bit.V = 0;	break;
+		case ALU_EOR:	r = x ^ m;	CC.bit.V = 0;	break;
+	}
+	r &= mask;
+	CC.bit.N = (r & sign) != 0;
+	CC.bit.Z = (r == 0);
+	return (Word)r;
+}
+
+void C6809::do_asl(Word& x) {
+	cc_sync();
+	CC.bit.C = btst(x, 15);
+	CC.bit.V = btst(x, 15) ^ btst(x, 14);
+	x <<= 1;
+	CC.bit.N = btst(x, 15);
+	CC.bit.Z = !x;
+}
+void C6809::do_asr(Word& x) {
+	cc_sync();
+	CC.bit.C = btst(x, 0);
+	x = (x >> 1) | (x & 0x8000);
+	CC.bit.N = btst(x, 15);
+	CC.bit.Z = !x;
+}
+void C6809::do_clr(Word& x) {
+	cc_sync();
+	CC.all &= 0xf0;
+	CC.all |= 0x04;
+	x = 0;
+}
+void C6809::do_com(Word& x) {
+	cc_sync();
+	x = ~x;
+	CC.bit.C = 1;
+	CC.bit.V = 0;
+	CC.bit.N = btst(x, 15);
+	CC.bit.Z = !x;
+}
+void C6809::do_dec(Word& x) {
+	cc_sync();
+	CC.bit.V = (x == 0x8000);
+	x--;
+	CC.bit.N = btst(x, 15);
+	CC.bit.Z = !x;
+}
+void C6809::do_inc(Word& x) {
+	cc_sync();
+	CC.bit.V = (x == 0x7fff);
+	x++;
+	CC.bit.N = btst(x, 15);
+	CC.bit.Z = !x;
+}
+void C6809::do_lsr(Word& x) {
+	cc_sync();
+	CC.bit.C = btst(x, 0);
+	x >>= 1;
+	CC.bit.N = 0;
+	CC.bit.Z = !x;
+}
+void C6809::do_neg(Word& x) { x = do_alu(ALU_SUB, 0, x, true); }
+void C6809::do_rol(Word& x) {
+	bool oc = carry();
+	CC.bit.V = btst(x, 15) ^ btst(x, 14);
+	CC.bit.C = btst(x, 15);
+	x = (x << 1) | (oc ? 0x0001 : 0);
+	CC.bit.N = btst(x, 15);
+	CC.bit.Z = !x;
+}
+void C6809::do_ror(Word& x) {
+	bool oc = carry();
+	CC.bit.C = btst(x, 0);
+	x = (x >> 1) | (oc ? 0x8000 : 0);
+	CC.bit.N = btst(x, 15);
+	CC.bit.Z = !x;
+}
+void C6809::do_tst(Word& x) {
+	set_flags(LAZY_LOGIC16, 0, 0, x);
+}
+
+// OIM AIM EIM: the immediate byte comes before the address
+void C6809::do_mim(Byte op)
+{
+	Byte imm = fetch_byte();
+	Word addr = ea();
+	Byte m = read(addr);
+	switch (op)
+	{
+		case ALU_OR:	m |= imm;	break;
+		case ALU_AND:	m &= imm;	break;
+		case ALU_EOR:	m ^= imm;	break;
+	}
+	write(addr, m);
+	set_flags(LAZY_LOGIC8, 0, 0, m);
+}
+
+// ADDR..CMPR: the destination register sets the size. A wide destination
+// takes D for an A or B source, W for E or F, 0:CC and DP:0; a narrow one
+// takes the low byte of a wide source.
+void C6809::do_reg_op(Byte op)
+{
+	Byte post = read(immb());
+	Byte src = post >> 4;
+	Byte dst = post & 0x0f;
+	bool wide = (dst < 8);
+	Word m = get_reg(src);
+	if (wide)
+	{
+		switch (src)
+		{
+			case 0x8: case 0x9:	m = D;			break;
+			case 0xe: case 0xf:	m = W;			break;
+			case 0xa:			m &= 0x00ff;	break;
+			case 0xb:			m &= 0xff00;	break;
+		}
+	}
+	Word x = get_reg(dst);
+	if (!wide)
+	{
+		m &= 0x00ff;
+		x &= 0x00ff;
+	}
+	Word r = do_alu(op, x, m, wide);
+	if (op != ALU_CMP)
+		set_reg(dst, wide ? r : (r << 8) | r);
+}
+
+// BAND..STBT postbyte: register (bits 7-6: CC, A, B), source bit (bits 5-3)
+// and destination bit (bits 2-0), followed by a direct page address
+void C6809::do_bitop(Byte op)
+{
+	Byte post = fetch_byte();
+	Word addr = dir();
+	Byte m = read(addr);
+	int sbit = (post >> 3) & 0x07;
+	int dbit = post & 0x07;
+	Byte* reg = nullptr;
+	cc_sync();
+	switch (post >> 6)
+	{
+		case 0:	reg = &CC.all;	break;
+		case 1:	reg = &A;		break;
+		case 2:	reg = &B;		break;
+		default:
+			trap(MD_IL);
+			return;
+	}
+	bool bit = (op == 7) ? btst(*reg, sbit) : btst(m, sbit);
+	if (op < 6 && (op & 1))
+		bit = !bit;		// BIAND BIOR BIEOR use the inverted memory bit
+	switch (op)
+	{
+		case 0: case 1:	if (!bit) bclr(*reg, dbit);		break;	// BAND BIAND
+		case 2: case 3:	if (bit) bset(*reg, dbit);		break;	// BOR BIOR
+		case 4: case 5:	if (bit) *reg ^= (1 << dbit);	break;	// BEOR BIEOR
+		case 6:	if (bit) bset(*reg, dbit); else bclr(*reg, dbit);	break;	// LDBT
+		case 7:	if (bit) bset(m, dbit); else bclr(m, dbit);		// STBT
+			write(addr, m);
+			break;
+	}
+}
+
+// TFR, EXG and the inter-register postbyte codes
+Word C6809::get_reg(Byte code)
+{
+	switch (code & 0x0f)
+	{
+		case 0x0:	return D;
+		case 0x1:	return X;
+		case 0x2:	return Y;
+		case 0x3:	return U;
+		case 0x4:	return S;
+		case 0x5:	return PC;
+		case 0x6:	return W;
+		case 0x7:	return V;
+		case 0x8:	return (A << 8) | A;
+		case 0x9:	return (B << 8) | B;
+		case 0xa:	cc_sync();	return (CC.all << 8) | CC.all;
+		case 0xb:	return (DP << 8) | DP;
+		case 0xe:	return (E << 8) | E;
+		case 0xf:	return (F << 8) | F;
+	}
+	return 0;	// the zero registers ($C, $D)
+}
+void C6809::set_reg(Byte code, Word data)
+{
+	switch (code & 0x0f)
+	{
+		case 0x0:	D = data;	break;
+		case 0x1:	X = data;	break;
+		case 0x2:	Y = data;	break;
+		case 0x3:	U = data;	break;
+		case 0x4:	S = data;	break;
+		case 0x5:	PC = data;	break;
+		case 0x6:	W = data;	break;
+		case 0x7:	V = data;	break;
+		case 0x8:	A = (Byte)(data >> 8);		break;
+		case 0x9:	B = (Byte)data;				break;
+		case 0xa:	setCC((Byte)data);			break;
+		case 0xb:	DP = (Byte)(data >> 8);		break;
+		case 0xe:	E = (Byte)(data >> 8);		break;
+		case 0xf:	F = (Byte)data;				break;
+	}
+}
+
+// illegal instruction and division by zero both stack the machine and
+// vector through $FFF0, leaving the reason in MD bits 6 and 7
+void C6809::trap(Byte reason)
+{
+	MD |= reason;
+	cc_sync();
+	CC.bit.E = 1;
+	psh_all();
+	CC.bit.F = CC.bit.I = 1;
+	PC = read_word(0xfff0);
+}
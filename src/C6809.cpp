@@ -6,6 +6,7 @@
 * Copyright (C) 2023 by Jay Faries
 **************************************/
 
+#include <array>
 #include <chrono>
 #include <thread>
 #include <map>
@@ -14,8 +15,12 @@
 #include "Bus.hpp"
 #include "C6809.hpp"
 #include "Debug.hpp"
+#include "Dma.hpp"
+#include "FileIO.hpp"
+#include "Gfx.hpp"
 
-C6809::C6809(Bus* p_bus) : A(acc.byte.A = 0), B(acc.byte.B = 0), D(acc.D = 0)
+C6809::C6809(Bus* p_bus) : A(acc.byte.A = 0), B(acc.byte.B = 0), D(acc.D = 0),
+	E(accw.byte.E = 0), F(accw.byte.F = 0), W(accw.W = 0)
 {
 	//_deviceName = "CPU";
 	
@@ -39,20 +44,41 @@ C6809::~C6809()
 	opMap.clear();
 }
 
-void C6809::ThreadProc()
+void C6809::ThreadProc(Bus* bus)
 {
-    while (Bus::IsRunning())
+    // run against the bus that started this thread
+    Bus::s_current = bus;
+    C6809* cpu = bus->_c6809;
     {
+        std::lock_guard<std::mutex> lock(cpu->_ctrl_mutex);
+        cpu->_bThreadActive = true;
+    }
+
+    using clock = std::chrono::system_clock;
+    using sec = std::chrono::duration<double, std::nano>;
+    auto before_CPU = clock::now();
+
+    while (bus->_bIsRunning)
+    {
+        // block (rather than spin) while there is nothing to run
+        if (cpu->_isHeld())
+        {
+            std::unique_lock<std::mutex> lock(cpu->_ctrl_mutex);
+            cpu->_bParked = true;
+            cpu->_ctrl_cv.notify_all();         // acknowledge Pause()
+            cpu->_ctrl_cv.wait(lock, [&]{ return !bus->_bIsRunning || !cpu->_isHeld(); });
+            cpu->_bParked = false;
+            before_CPU = clock::now();
+            continue;
+        }
+
         // main CPU clock
-        using clock = std::chrono::system_clock;
-        using sec = std::chrono::duration<double, std::nano>;
-        static auto before_CPU = clock::now();
         const sec duration = clock::now() - before_CPU;
 
         // 1000.f = 1mhz, 500.0f = 2mhz, etc...
         float cycle_time = 8000.0f;     // in nanohertz
         // int cpu_speed = Bus::Inst()._sys_state;
-        int cpu_speed = s_sys_state;
+        int cpu_speed = cpu->_sys_state;
         switch (cpu_speed)
         {
             case 0x00: cycle_time = 39900.0f;   break;      // 25 khz
@@ -77,18 +103,95 @@ void C6809::ThreadProc()
             if (duration.count() > cycle_time)
             {
                 before_CPU = clock::now();
-                //if (!C6809::s_bHalted)
-                if (s_bCpuEnabled)
-                {
-                    Bus::GetC6809()->clock_input();
-                    //Bus::Inst()._avg_cpu_cycle_time = duration.count();
-                    Bus::s_avg_cpu_cycle_time = duration.count();
-                }
+                cpu->clock_input();
             }
         }
     }
+
+    // acknowledge Stop()
+    std::lock_guard<std::mutex> lock(cpu->_ctrl_mutex);
+    cpu->_bThreadActive = false;
+    cpu->_ctrl_cv.notify_all();
+}
+
+// true when the CPU thread has nothing to run at this clock
+bool C6809::_isHeld()
+{
+    // the debugger is holding the CPU mid single step
+    if (!m_bus->_debug->SingleStep())
+        return true;
+    // otherwise only stop between instructions
+    if (cycles)
+        return false;
+    if (PC == _run_until)
+    {
+        _run_until = -1;
+        _steps = 0;
+    }
+    return _steps == 0;
+}
+
+void C6809::_waitParked()
+{
+    std::unique_lock<std::mutex> lock(_ctrl_mutex);
+    // the CPU thread would wait on itself
+    if (m_bus->_cpuThread.get_id() == std::this_thread::get_id())
+        return;
+    _ctrl_cv.wait(lock, [&]{ return _bParked || !_bThreadActive; });
+}
+
+void C6809::Pause()
+{
+    _run_until = -1;
+    _steps = 0;
+    _waitParked();
+}
+
+void C6809::Resume()
+{
+    _run_until = -1;
+    _steps = -1;
+    Wake();
+}
+
+void C6809::Step(int count)
+{
+    _run_until = -1;
+    _steps = count;
+    Wake();
+}
+
+void C6809::RunUntil(Word addr)
+{
+    _run_until = addr;
+    _steps = -1;
+    Wake();
+}
+
+void C6809::Stop()
+{
+    m_bus->_bIsRunning = false;
+    Wake();
+    std::unique_lock<std::mutex> lock(_ctrl_mutex);
+    if (m_bus->_cpuThread.get_id() == std::this_thread::get_id())
+        return;
+    _ctrl_cv.wait(lock, [&]{ return !_bThreadActive; });
+}
+
+void C6809::Wake()
+{
+    std::lock_guard<std::mutex> lock(_ctrl_mutex);
+    _ctrl_cv.notify_all();
 }
 
+bool C6809::IsPaused()
+{
+    std::lock_guard<std::mutex> lock(_ctrl_mutex);
+    return _bParked;
+}
+
+
+
 
 
 void C6809::clock_input()
@@ -97,42 +200,67 @@ void C6809::clock_input()
 	// Bus& bus = Bus::Inst();
 	// Gfx* gfx = bus.m_gfx;
 	// GfxDebug* debug = gfx->m_debug;
-    Debug* debug = Bus::GetDebug();
+    Debug* debug = m_bus->_debug;
 
 	// if (s_bHalted)	return;
 	// if (s_bHalted)	return;
 
 	if (debug->SingleStep())
 	{
-		if (do_interrupts())
+		// the raster beam is timed by the CPU clock
+		m_bus->_gfx->RasterClock();
+		// single writer, so a plain load and store is enough for the readers
+		cycle_count.store(cycle_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		// a cycle-stealing DMA channel has the bus for this clock
+		if (m_bus->_dma->StealCycle())
+			return;
+		// still within the current instruction or interrupt entry
+		if (cycles)
 		{
-			if (cycles == 0)
+			cycles--;
+			return;
+		}
+		// a queued file command that has finished completes here, and holds its interrupt
+		m_bus->_fileio->Complete();
+		// completed DMA channels hold their interrupt until acknowledged
+		m_bus->_dma->HoldInterrupts();
+		// interrupts are only taken between instructions
+		if (!do_interrupts())
+			return;
+		if (cycles == 0)
+		{
+			// a kernel routine run natively counts as one instruction
+			if (!(CPU_KERNEL_HLE && _hle_enabled && PC >= _hle_lo && PC <= _hle_hi && hle_trap()))
 			{
 				// read the opcode
 				opcode = read(PC);
 				PC++;
-				if (opcode == 0x10 || opcode == 0x11) {
-					opcode <<= 8;
-					opcode |= read(PC);
-					PC++;
-				}
-				// seed the cycles
-				cycles = opMap[opcode].cycles;
-				// run the instruction
-				if (this->opMap[opcode].operation)
-					(this->*opMap[opcode].operation)();
-				else
+				// a recognized memset/memcpy loop runs as one block operation
+				if (!(CPU_BLOCK_LOOPS && !_profile && loop_head(opcode) && block_loop()))
 				{
-					std::string er = "Invalid Instruction at $";
-					er += C6809::hex(PC, 4);
-					Bus::Error(er.c_str());
+					if (opcode == 0x10 || opcode == 0x11) {
+						opcode <<= 8;
+						opcode |= read(PC);
+						PC++;
+					}
+					if (_profile)
+						profile_op();
+					if (CPU_SWITCH_CORE)
+						switch_core();
+					else
+						table_core();
+					if (CPU_FUSE_PAIRS)
+						fuse_pair();
 				}
-				 if (!waiting_cwai && !waiting_sync)
-				 	debug->ContinueSingleStep();
-				return;
 			}
-			cycles--;
+			 if (!waiting_cwai && !waiting_sync)
+			 	debug->ContinueSingleStep();
+			if (_steps > 0)
+				_steps--;
 		}
+		// this clock was the first of the instruction (or interrupt entry)
+		if (cycles)
+			cycles--;
 	}
 }
 
@@ -147,26 +275,43 @@ void C6809::firq() {
 }
 
 
+// Interrupt entry cycles: 19 to stack the entire state and fetch the vector
+// (21 in HD6309 native mode, which also stacks W), 10 for a FIRQ that only
+// stacks PC and CC, and 7 when CWAI has already stacked the state and only
+// the vector fetch remains.
 void C6809::do_nmi() {
+	cycles = 7;
 	if (!waiting_cwai) {
 		CC.bit.E = 1;
-		psh_post(0xff, S, U);
+		psh_all();
+		cycles = native() ? 21 : 19;
 	}
 	CC.bit.F = CC.bit.I = 1;
 	PC = read_word(0xfffc);
 }
 void C6809::do_firq() {
+	cycles = 7;
 	if (!waiting_cwai) {
-		CC.bit.E = 0;
-		psh_post(0x81, S, U);
+		if (CPU_HD6309 && (MD & MD_FM)) {
+			CC.bit.E = 1;
+			psh_all();
+			cycles = native() ? 21 : 19;
+		}
+		else {
+			CC.bit.E = 0;
+			psh_post(0x81, S, U);
+			cycles = 10;
+		}
 	}
 	CC.bit.F = CC.bit.I = 1;
 	PC = read_word(0xfff6);
 }
 void C6809::do_irq() {
+	cycles = 7;
 	if (!waiting_cwai) {
 		CC.bit.E = 1;
-		psh_post(0xff, S, U);
+		psh_all();
+		cycles = native() ? 21 : 19;
 	}
 	CC.bit.F = CC.bit.I = 1;
 	PC = read_word(0xfff8);
@@ -218,6 +363,18 @@ bool C6809::do_interrupts() {
 	return true;
 }
 
+void C6809::setRegs(const REGS& r)
+{
+	PC = r.pc;	U = r.u;	S = r.s;	X = r.x;	Y = r.y;
+	D = r.d;	W = r.w;	V = r.v;	DP = r.dp;	MD = r.md;
+	setCC(r.cc);
+	cycles = 0;
+	tfm_active = false;
+	waiting_sync = false;
+	waiting_cwai = false;
+	nmi_disabled = false;
+}
+
 void C6809::reset() {
 	PC = read_word(0xfffe);
 
@@ -229,6 +386,9 @@ void C6809::reset() {
 	U = 0x0000;
 	S = 0x0000;
 	CC.all = 0x00;
+	lazy_op = LAZY_NONE;
+	MD = 0x00;		// HD6309 starts in emulation mode
+	tfm_active = false;
 	CC.bit.I = 1;	// IRQ not active
 	CC.bit.F = 1;	// FIRQ not active
 	waiting_sync = false;	// not not in SYNC
@@ -239,6 +399,9 @@ void C6809::reset() {
 	NMI = true;
 	IRQ = true;
 	FIRQ = true;
+
+	if constexpr (CPU_KERNEL_HLE)
+		hle_scan();
 }
 
 
@@ -270,115 +433,127 @@ Word C6809::dir() {
 	Word addr = (DP << 8) | (fetch_byte());
 	return addr;
 }
-// indexed
-Word C6809::idx() {
-	Byte val = fetch_byte();
-	Word r, * pR = nullptr;
-	pR = ptrReg[(val >> 5) & 0x03];	 // pR: pointer to the Register we're dealing with
-	if (!(val & 0x80))
-	{								// n4, R
-		r = *pR + ext5(val);
-		cycles++;
+// indexed postbyte decode table (built at compile time)
+enum IDX_KIND : Byte {
+	IDX_N5,			// n5,R
+	IDX_INC1,		// ,R+
+	IDX_INC2,		// ,R++
+	IDX_DEC1,		// ,-R
+	IDX_DEC2,		// ,--R
+	IDX_ZERO,		// ,R
+	IDX_B,			// B,R
+	IDX_A,			// A,R
+	IDX_N8,			// n7,R
+	IDX_N16,		// n15,R
+	IDX_D,			// D,R
+	IDX_PC8,		// n7,PC
+	IDX_PC16,		// n15,PC
+	IDX_EXT,		// [n]
+	IDX_E,			// E,R		(HD6309)
+	IDX_F,			// F,R		(HD6309)
+	IDX_W,			// W,R		(HD6309)
+	IDX_W0,			// ,W		(HD6309)
+	IDX_W16,		// n15,W	(HD6309)
+	IDX_WINC2,		// ,W++		(HD6309)
+	IDX_WDEC2,		// ,--W		(HD6309)
+	IDX_INVALID		// illegal postbyte
+};
+struct IDX_DECODE {
+	Byte kind = IDX_INVALID;
+	Byte reg = 0;			// index into ptrReg[]
+	Sint8 n5 = 0;			// sign extended 5-bit offset (IDX_N5)
+	bool indirect = false;
+	Byte cycles = 0;		// extra cycles, indirection included
+	Byte cycles_nm = 0;		// extra cycles in HD6309 native mode
+};
+static constexpr std::array<IDX_DECODE, 256> idx_decode_table(bool hd6309)
+{
+	// kind and extra cycles for the low five bits of a postbyte with bit 7 set
+	Byte kinds[32] = {
+		IDX_INC1, IDX_INC2, IDX_DEC1, IDX_DEC2, IDX_ZERO, IDX_B, IDX_A, IDX_INVALID,
+		IDX_N8, IDX_N16, IDX_INVALID, IDX_D, IDX_PC8, IDX_PC16, IDX_INVALID, IDX_INVALID,
+		IDX_INVALID, IDX_INC2, IDX_INVALID, IDX_DEC2, IDX_ZERO, IDX_B, IDX_A, IDX_INVALID,
+		IDX_N8, IDX_N16, IDX_INVALID, IDX_D, IDX_PC8, IDX_PC16, IDX_INVALID, IDX_EXT };
+	constexpr Byte extra[IDX_INVALID + 1] = {
+		1, 2, 3, 2, 3, 0, 1, 1, 1, 4, 4, 1, 5, 2,	1, 1, 1, 0, 2, 1, 1,	0 };
+	constexpr Byte extra_nm[IDX_INVALID + 1] = {
+		1, 1, 2, 1, 2, 0, 1, 1, 1, 3, 2, 1, 3, 1,	1, 1, 1, 0, 2, 1, 1,	0 };
+	// the W based modes take the RR bits as a sub mode of 01111 and [10000]
+	constexpr Byte w_kinds[4] = { IDX_W0, IDX_W16, IDX_WINC2, IDX_WDEC2 };
+	if (hd6309)
+	{
+		kinds[0x07] = kinds[0x17] = IDX_E;
+		kinds[0x0a] = kinds[0x1a] = IDX_F;
+		kinds[0x0e] = kinds[0x1e] = IDX_W;
 	}
-	else
+
+	std::array<IDX_DECODE, 256> table{};
+	for (int val = 0; val < 256; val++)
 	{
-		switch (val & 0x1f)
-		{
-		case 0x00:				// , R+
-		{
-			r = *pR;
-			(*pR)++;
-			cycles += 2;
-			break;
-		}
-		case 0x01: case 0x11:	// , R++
-		{
-			r = *pR;
-			*pR += 2;
-			cycles += 3;
-			break;
-		}
-		case 0x02:				// ,-R
-		{
-			(*pR)--;
-			r = *pR;
-			cycles += 2;
-			break;
-		}
-		case 0x03: case 0x13:	// ,--R
-		{
-			*pR -= 2;
-			r = *pR;
-			cycles += 3;
-			break;
-		}
-		case 0x04: case 0x14:	// ,R
-		{
-			r = *pR;
-			break;
-		}
-		case 0x05: case 0x15:	// B,R
-		{
-			r = *pR + ext8(B);
-			cycles++;
-			break;
-		}
-		case 0x06: case 0x16:	// A,R
-		{
-			r = *pR + ext8(A);
-			cycles++;
-			break;
-		}
-		case 0x08: case 0x18:	// n7,R
-		{
-			r = *pR + ext8(fetch_byte());
-			cycles++;
-			break;
-		}
-		case 0x09: case 0x19:	// n15,R
+		IDX_DECODE& d = table[val];
+		d.reg = (val >> 5) & 0x03;
+		if (!(val & 0x80))
 		{
-			r = *pR + (Sint16)fetch_word();
-			cycles += 4;
-			break;
-		}
-		case 0x0B: case 0x1B:	// D,R
-		{
-			r = *pR + (Sint16)D;
-			cycles += 4;
-			break;
-		}
-		case 0x0C: case 0x1C:	// n7,PC
-		{
-			r = PC + ext8(fetch_byte());
-			cycles += 1;
-			break;
-		}
-		case 0x0D: case 0x1D:	// n15,PC
-		{
-			r = PC + (Sint16)fetch_word();
-			cycles += 5;
-			break;
-		}
-		case 0x1f:				// [n]
-		{
-			r = fetch_word();
-			cycles += 2;
-			break;
+			d.kind = IDX_N5;
+			d.n5 = (val & 0x10) ? (val & 0x1f) - 0x20 : (val & 0x1f);
+			d.cycles = extra[IDX_N5];
+			d.cycles_nm = extra_nm[IDX_N5];
+			continue;
 		}
+		d.kind = kinds[val & 0x1f];
+		d.indirect = (val & 0x10);
+		if (hd6309 && ((val & 0x1f) == 0x0f || (val & 0x1f) == 0x10))
+			d.kind = w_kinds[d.reg];
+		d.cycles = extra[d.kind] + (d.indirect ? 3 : 0);
+		d.cycles_nm = extra_nm[d.kind] + (d.indirect ? 3 : 0);
+	}
+	return table;
+}
+static constexpr std::array<IDX_DECODE, 256> s_idx_decode = idx_decode_table(CPU_HD6309);
+
+Byte C6809::idx_cycles(Byte post) {
+	const IDX_DECODE& d = s_idx_decode[post];
+	return native() ? d.cycles_nm : d.cycles;
+}
+// indexed
+Word C6809::idx() {
+	const IDX_DECODE& d = s_idx_decode[fetch_byte()];
+	Word& R = *ptrReg[d.reg];
+	Word r;
+	cycles += native() ? d.cycles_nm : d.cycles;
+	switch (d.kind)
+	{
+		case IDX_N5:	return R + d.n5;
+		case IDX_INC1:	r = R;	R += 1;		break;
+		case IDX_INC2:	r = R;	R += 2;		break;
+		case IDX_DEC1:	R -= 1;	r = R;		break;
+		case IDX_DEC2:	R -= 2;	r = R;		break;
+		case IDX_ZERO:	r = R;				break;
+		case IDX_B:		r = R + ext8(B);	break;
+		case IDX_A:		r = R + ext8(A);	break;
+		case IDX_N8:	r = R + ext8(fetch_byte());			break;
+		case IDX_N16:	r = R + (Sint16)fetch_word();		break;
+		case IDX_D:		r = R + (Sint16)D;					break;
+		case IDX_PC8:	r = PC + ext8(fetch_byte());		break;
+		case IDX_PC16:	r = PC + (Sint16)fetch_word();		break;
+		case IDX_EXT:	r = fetch_word();					break;
+		case IDX_E:		r = R + ext8(E);	break;
+		case IDX_F:		r = R + ext8(F);	break;
+		case IDX_W:		r = R + W;			break;
+		case IDX_W0:	r = W;				break;
+		case IDX_W16:	r = W + fetch_word();		break;
+		case IDX_WINC2:	r = W;	W += 2;		break;
+		case IDX_WDEC2:	W -= 2;	r = W;		break;
 		default:
 		{
 			std::string er = "Invalid Postbyte at $";
 			er += C6809::hex(PC, 4);
-			Bus::Error(er.c_str());			
+			Bus::Error(er.c_str());
 			r = 0;
 		}
-		}
-		if (val & 0x10)				// [ INDIRECTION ]
-		{
-			r = read_word(r);
-			cycles += 3;
-		}
 	}
+	if (d.indirect)				// [ INDIRECTION ]
+		r = read_word(r);
 	return r;
 }
 // relative 8-bit
@@ -395,6 +570,12 @@ Word C6809::relw() {
 	Word addr = PC + ofs;
 	return addr;
 }
+// immediate 32-bit (HD6309 LDQ)
+Word C6809::immq() {
+	Word addr = PC;
+	PC += 4;
+	return addr;
+}
 // invalid addressing mode
 Word C6809::nula()
 {
@@ -409,17 +590,22 @@ Word C6809::nula()
 
 
 void C6809::null() {
+	if constexpr (CPU_HD6309)
+	{
+		trap(MD_IL);
+		return;
+	}
 	std::string er = "Invalid Opcode at $";
 	er += C6809::hex(PC, 4);
 	Bus::Error(er.c_str());				
 }
 
 void C6809::abx() { X += B; }
-void C6809::adca() { do_adc(A); }
-void C6809::adcb() { do_adc(B); }
-void C6809::adda() { do_add(A); }
-void C6809::addb() { do_add(B); }
-void C6809::addd() { do_add(D); }
+void C6809::adca() { do_adc(A, ea()); }
+void C6809::adcb() { do_adc(B, ea()); }
+void C6809::adda() { do_add(A, ea()); }
+void C6809::addb() { do_add(B, ea()); }
+void C6809::addd() { do_add(D, ea()); }
 //	Word m = fetch_word();	// post;
 //	Word t = (D & 0x7fff) + (m & 0x7fff);
 //	CC.bit.V = btst(t, 15);
@@ -430,13 +616,13 @@ void C6809::addd() { do_add(D); }
 //	CC.bit.N = btst(D, 15);
 //	CC.bit.Z = !D;	
 //}
-void C6809::anda() { do_and(A); }
-void C6809::andb() { do_and(B); }
-void C6809::andc() { CC.all &= fetch_byte(); }
+void C6809::anda() { do_and(A, ea()); }
+void C6809::andb() { do_and(B, ea()); }
+void C6809::andc() { cc_sync(); CC.all &= fetch_byte(); }
 void C6809::asla() { do_asl(A); }
 void C6809::aslb() { do_asl(B); }
 void C6809::asl() {
-	Word addr = (this->*opMap[opcode].addrmode)();
+	Word addr = ea();
 	Byte m = read(addr);
 	do_asl(m);
 	write(addr, m);
@@ -444,43 +630,44 @@ void C6809::asl() {
 void C6809::asra() { do_asr(A); }
 void C6809::asrb() { do_asr(B); }
 void C6809::asr() {
-	Word addr = (this->*opMap[opcode].addrmode)();
+	Word addr = ea();
 	Byte m = read(addr);
 	do_asr(m);
 	write(addr, m);
 }
-void C6809::bita() { do_bit(A); }
-void C6809::bitb() { do_bit(B); }
+void C6809::bita() { do_bit(A, ea()); }
+void C6809::bitb() { do_bit(B, ea()); }
 void C6809::clra() { do_clr(A); }
 void C6809::clrb() { do_clr(B); }
 void C6809::clr() {
-	Word addr = (this->*opMap[opcode].addrmode)();
+	Word addr = ea();
 	Byte m = read(addr);
 	do_clr(m);
 	write(addr, m);
 }
-void C6809::cmpa() { do_cmp(A); }
-void C6809::cmpb() { do_cmp(B); }
-void C6809::cmpd() { do_cmp(D); }
-void C6809::cmps() { do_cmp(S); }
-void C6809::cmpu() { do_cmp(U); }
-void C6809::cmpx() { do_cmp(X); }
-void C6809::cmpy() { do_cmp(Y); }
+void C6809::cmpa() { do_cmp(A, ea()); }
+void C6809::cmpb() { do_cmp(B, ea()); }
+void C6809::cmpd() { do_cmp(D, ea()); }
+void C6809::cmps() { Word r = S; do_cmp(r, ea()); }
+void C6809::cmpu() { Word r = U; do_cmp(r, ea()); }
+void C6809::cmpx() { Word r = X; do_cmp(r, ea()); }
+void C6809::cmpy() { Word r = Y; do_cmp(r, ea()); }
 void C6809::coma() { do_com(A); }
 void C6809::comb() { do_com(B); }
 void C6809::com() {
-	Word addr = (this->*opMap[opcode].addrmode)();
+	Word addr = ea();
 	Byte m = read(addr);
 	do_com(m);
 	write(addr, m);
 }
 void C6809::cwai()
 {
-	Word addr = (this->*opMap[opcode].addrmode)();
+	Word addr = immb();
 	Byte n = read(addr);
+	cc_sync();
 	CC.all &= n;
 	CC.bit.E = 1;
-	psh_post(0xff, S, U);
+	psh_all();
 	waiting_cwai = true;
 }
 void C6809::daa()
@@ -488,6 +675,7 @@ void C6809::daa()
 	Byte c = 0;
 	Byte lsn = (A & 0x0f);
 	Byte msn = (A & 0xf0) >> 4;
+	cc_sync();
 	if (CC.bit.H || (lsn > 9)) {
 		c |= 0x06;
 	}
@@ -505,18 +693,26 @@ void C6809::daa()
 void C6809::deca() { do_dec(A); }
 void C6809::decb() { do_dec(B); }
 void C6809::dec() {
-	Word addr = (this->*opMap[opcode].addrmode)();
+	Word addr = ea();
 	Byte m = read(addr);
 	do_dec(m);
 	write(addr, m);
 }
-void C6809::eora() { do_eor(A); }
-void C6809::eorb() { do_eor(B); }
+void C6809::eora() { do_eor(A, ea()); }
+void C6809::eorb() { do_eor(B, ea()); }
 void C6809::exg()
 {
 	Byte post = fetch_byte();
 	int r1 = (post & 0xf0) >> 4;
 	int r2 = (post & 0x0f);
+	if constexpr (CPU_HD6309)
+	{
+		Word t1 = get_reg(r1);
+		Word t2 = get_reg(r2);
+		set_reg(r1, t2);
+		set_reg(r2, t1);
+		return;
+	}
 	// 16-bit registers?
 	if (r1 < 6 && r2 < 6)
 	{
@@ -556,6 +752,7 @@ void C6809::exg()
 	// 8- bit register
 	else if (r1 >= 8 && r1 < 12 && r2 >= 8 && r2 < 12)
 	{
+		cc_sync();
 		// source (left register)
 		Byte tmp = 0;
 		Byte r3 = r1;
@@ -592,89 +789,103 @@ void C6809::exg()
 void C6809::inca() { do_inc(A); }
 void C6809::incb() { do_inc(B); }
 void C6809::inc() {
-	Word addr = (this->*opMap[opcode].addrmode)();
+	Word addr = ea();
 	Byte m = read(addr);
 	do_inc(m);
 	write(addr, m);
 }
-void C6809::jmp() { Word addr_abs = (this->*opMap[opcode].addrmode)(); PC = addr_abs; }
-void C6809::jsr() { Word addr_abs = (this->*opMap[opcode].addrmode)(); do_psh(S, PC); PC = addr_abs; }
-void C6809::lda() { do_ld(A); }
-void C6809::ldb() { do_ld(B); }
-void C6809::ldd() { do_ld(D); }
-void C6809::lds() { do_ld(S);  nmi_disabled = false; }
-void C6809::ldu() { do_ld(U); }
-void C6809::ldx() { do_ld(X); }
-void C6809::ldy() { do_ld(Y); }
+void C6809::jmp() { Word addr_abs = ea(); PC = addr_abs; }
+void C6809::jsr() { Word addr_abs = ea(); do_psh(S, PC); PC = addr_abs; }
+void C6809::lda() { do_ld(A, ea()); }
+void C6809::ldb() { do_ld(B, ea()); }
+void C6809::ldd() { do_ld(D, ea()); }
+void C6809::lds() { do_ld(S, ea());  nmi_disabled = false; }
+void C6809::ldu() { do_ld(U, ea()); }
+void C6809::ldx() { do_ld(X, ea()); }
+void C6809::ldy() { do_ld(Y, ea()); }
 void C6809::leas() {
 	//S = fetch_indexed_address();
-	S = (this->*opMap[opcode].addrmode)();
+	S = idx();
+	cc_sync();
 	CC.bit.Z = !S;
 }
 void C6809::leau() {
 	//U = fetch_indexed_address();
-	U = (this->*opMap[opcode].addrmode)();
+	U = idx();
+	cc_sync();
 	CC.bit.Z = !U;
 }
 void C6809::leax() {
 	//X = fetch_indexed_address();
-	X = (this->*opMap[opcode].addrmode)();
+	X = idx();
+	cc_sync();
 	CC.bit.Z = !X;
 }
 void C6809::leay() {
 	//Y = fetch_indexed_address();
-	Y = (this->*opMap[opcode].addrmode)();
+	Y = idx();
+	cc_sync();
 	CC.bit.Z = !Y;
 }
 void C6809::lsra() { do_lsr(A); }
 void C6809::lsrb() { do_lsr(B); }
 void C6809::lsr()
 {
-	Word addr = (this->*opMap[opcode].addrmode)();	Byte m = read(addr);
+	Word addr = ea();	Byte m = read(addr);
 	do_lsr(m);
 	write(addr, m);
 }
 void C6809::mul() {
 	D = A * B;
+	cc_sync();
 	CC.bit.C = btst(B, 7);
 	CC.bit.Z = !D;
 }
 void C6809::nega() { do_neg(A); }
 void C6809::negb() { do_neg(B); }
 void C6809::neg() {
-	Word addr = (this->*opMap[opcode].addrmode)();	//fetch_word();
+	Word addr = ea();	//fetch_word();
 	Byte m = read(addr);
 	do_neg(m);
 	write(addr, m);
 }
 void C6809::nop() { }
-void C6809::ora() { do_or(A); }
-void C6809::orb() { do_or(B); }
-void C6809::orcc() { CC.all |= fetch_byte(); }
+void C6809::ora() { do_or(A, ea()); }
+void C6809::orb() { do_or(B, ea()); }
+void C6809::orcc() { cc_sync(); CC.all |= fetch_byte(); }
+// one extra cycle for each byte moved
+static inline Byte post_bytes(Byte post) {
+	static constexpr Byte nib[16] = { 0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4 };
+	return nib[post & 0x0f] + 2 * nib[post >> 4];
+}
 void C6809::pshs() {
-	Word addr_abs = (this->*opMap[opcode].addrmode)();
+	Word addr_abs = immb();
 	Byte p = read(addr_abs);
+	cycles += post_bytes(p);
 	psh_post(p, S, U);
 }
 void C6809::pshu() {
-	Word addr_abs = (this->*opMap[opcode].addrmode)();
+	Word addr_abs = immb();
 	Byte p = read(addr_abs);
+	cycles += post_bytes(p);
 	psh_post(p, U, S);
 }
 void C6809::puls() {
-	Word addr_abs = (this->*opMap[opcode].addrmode)();
+	Word addr_abs = immb();
 	Byte p = read(addr_abs);
+	cycles += post_bytes(p);
 	pul_post(p, S, U);
 }
 void C6809::pulu() {
-	Word addr_abs = (this->*opMap[opcode].addrmode)();
+	Word addr_abs = immb();
 	Byte p = read(addr_abs);
+	cycles += post_bytes(p);
 	pul_post(p, U, S);
 }
 void C6809::rola() { do_rol(A); }
 void C6809::rolb() { do_rol(B); }
 void C6809::rol() {
-	Word addr = (this->*opMap[opcode].addrmode)();
+	Word addr = ea();
 	Byte m = read(addr);
 	do_rol(m);
 	write(addr, m);
@@ -682,7 +893,7 @@ void C6809::rol() {
 void C6809::rora() { do_ror(A); }
 void C6809::rorb() { do_ror(B); }
 void C6809::ror() {
-	Word addr = (this->*opMap[opcode].addrmode)();
+	Word addr = ea();
 	Byte m = read(addr);
 	do_ror(m);
 	write(addr, m);
@@ -694,7 +905,8 @@ void C6809::rti() {
 			FIRQ = true;
 		if (!CC.bit.I)
 			IRQ = true;
-		pul_post(0xfe, S, U);
+		pul_all();
+		cycles += native() ? 11 : 9;	// the entire state: 15 (17 native)
 	}
 	else {
 		pul_post(0x80, S, U);
@@ -705,37 +917,38 @@ void C6809::rti() {
 	NMI = true;
 }
 void C6809::rts() { do_pul(S, PC); }
-void C6809::sbca() { do_sbc(A); }
-void C6809::sbcb() { do_sbc(B); }
+void C6809::sbca() { do_sbc(A, ea()); }
+void C6809::sbcb() { do_sbc(B, ea()); }
 void C6809::sex() {
+	cc_sync();
 	CC.bit.N = btst(B, 7);
 	CC.bit.Z = (bool)!B;
 	A = CC.bit.N ? 255 : 0;
 }
-void C6809::sta() { do_st(A); }
-void C6809::stb() { do_st(B); }
-void C6809::std() { do_st(D); }
-void C6809::sts() { do_st(S); }
-void C6809::stu() { do_st(U); }
-void C6809::stx() { do_st(X); }
-void C6809::sty() { do_st(Y); }
-void C6809::suba() { do_sub(A); }
-void C6809::subb() { do_sub(B); }
-void C6809::subd() { do_sub(D); }
+void C6809::sta() { do_st(A, ea()); }
+void C6809::stb() { do_st(B, ea()); }
+void C6809::std() { do_st(D, ea()); }
+void C6809::sts() { Word r = S; do_st(r, ea()); }
+void C6809::stu() { Word r = U; do_st(r, ea()); }
+void C6809::stx() { Word r = X; do_st(r, ea()); }
+void C6809::sty() { Word r = Y; do_st(r, ea()); }
+void C6809::suba() { do_sub(A, ea()); }
+void C6809::subb() { do_sub(B, ea()); }
+void C6809::subd() { do_sub(D, ea()); }
 void C6809::swi() {
 	CC.bit.E = 1;
-	psh_post(0xff, S, U);
+	psh_all();
 	CC.bit.F = CC.bit.I = 1;
 	PC = read_word(0xfffa);
 }
 void C6809::swi2() {
 	CC.bit.E = 1;
-	psh_post(0xff, S, U);
+	psh_all();
 	PC = read_word(0xfff4);
 }
 void C6809::swi3() {
 	CC.bit.E = 1;
-	psh_post(0xff, S, U);
+	psh_all();
 	PC = read_word(0xfff2);
 }
 void C6809::sync() {
@@ -744,10 +957,15 @@ void C6809::sync() {
 
 void C6809::tfr()
 {
-	Word addr_abs = (this->*opMap[opcode].addrmode)();
+	Word addr_abs = immb();
 	Byte post = read(addr_abs);
 	int r1 = (post & 0xf0) >> 4;
 	int r2 = (post & 0x0f);
+	if constexpr (CPU_HD6309)
+	{
+		set_reg(r2, get_reg(r1));
+		return;
+	}
 	// 16-bit registers?
 	if (r1 < 6 && r2 < 6)
 	{
@@ -776,6 +994,7 @@ void C6809::tfr()
 	// 8- bit register
 	else if (r1 >= 8 && r1 < 12 && r2 >= 8 && r2 < 12)
 	{
+		cc_sync();
 		// source (left register)
 		switch (r1 & 0x0f)
 		{
@@ -802,54 +1021,54 @@ void C6809::tfr()
 void C6809::tsta() { do_tst(A); }
 void C6809::tstb() { do_tst(B); }
 void C6809::tst() {
-	Word addr = (this->*opMap[opcode].addrmode)();
+	Word addr = ea();
 	Byte m = read(addr);
 	do_tst(m);
 	write(addr, m);
 }
 
 // branch instructions
-void C6809::bcc() { do_br(!CC.bit.C); }		// Branch if Carry Clear:
-void C6809::lbcc() { do_br(!CC.bit.C); }		// 			(C != 0)
-void C6809::bcs() { do_br(CC.bit.C); }		// Branch if Carry Set:
-void C6809::lbcs() { do_br(CC.bit.C); }		// 			(C == 0)
-void C6809::bne() { do_br(!CC.bit.Z); }		// Branch if Not Equal:
-void C6809::lbne() { do_lbr(!CC.bit.Z); }		//			(Z != 0)
-void C6809::beq() { do_br(CC.bit.Z); }		// Branch if Equal:
-void C6809::lbeq() { do_lbr(CC.bit.Z); }		// 			(Z == 0)
-void C6809::bvc() { do_br(!CC.bit.V); }		// Branch if N0 Overflow:
-void C6809::lbvc() { do_lbr(!CC.bit.V); }		// 			(V != 0)
-void C6809::bvs() { do_br(CC.bit.V); }		// Branch if Overflow:
-void C6809::lbvs() { do_lbr(CC.bit.V); }		// 			(V == 0)
-void C6809::bmi() { do_br(CC.bit.N); }		// Branch if Minus (negative):
-void C6809::lbmi() { do_lbr(CC.bit.N); }		// 			(N != 0)
-void C6809::bpl() { do_br(!CC.bit.N); }		// Branch if Plus (positive):
-void C6809::lbpl() { do_lbr(!CC.bit.N); }		// 			(N == 0)
+void C6809::bcc() { cc_sync(); do_br(!CC.bit.C); }		// Branch if Carry Clear:
+void C6809::lbcc() { cc_sync(); do_br(!CC.bit.C); }		// 			(C != 0)
+void C6809::bcs() { cc_sync(); do_br(CC.bit.C); }		// Branch if Carry Set:
+void C6809::lbcs() { cc_sync(); do_br(CC.bit.C); }		// 			(C == 0)
+void C6809::bne() { cc_sync(); do_br(!CC.bit.Z); }		// Branch if Not Equal:
+void C6809::lbne() { cc_sync(); do_lbr(!CC.bit.Z); }		//			(Z != 0)
+void C6809::beq() { cc_sync(); do_br(CC.bit.Z); }		// Branch if Equal:
+void C6809::lbeq() { cc_sync(); do_lbr(CC.bit.Z); }		// 			(Z == 0)
+void C6809::bvc() { cc_sync(); do_br(!CC.bit.V); }		// Branch if N0 Overflow:
+void C6809::lbvc() { cc_sync(); do_lbr(!CC.bit.V); }		// 			(V != 0)
+void C6809::bvs() { cc_sync(); do_br(CC.bit.V); }		// Branch if Overflow:
+void C6809::lbvs() { cc_sync(); do_lbr(CC.bit.V); }		// 			(V == 0)
+void C6809::bmi() { cc_sync(); do_br(CC.bit.N); }		// Branch if Minus (negative):
+void C6809::lbmi() { cc_sync(); do_lbr(CC.bit.N); }		// 			(N != 0)
+void C6809::bpl() { cc_sync(); do_br(!CC.bit.N); }		// Branch if Plus (positive):
+void C6809::lbpl() { cc_sync(); do_lbr(!CC.bit.N); }		// 			(N == 0)
 // signed conditional branches
-void C6809::bgt() { do_br(!(CC.bit.Z | (CC.bit.N ^ CC.bit.V))); }		// Branch if Greater Than (signed)
-void C6809::lbgt() { do_lbr(!(CC.bit.Z | (CC.bit.N ^ CC.bit.V))); }	// Branch if Greater Than (signed)
-void C6809::ble() { do_br(CC.bit.Z | (CC.bit.N ^ CC.bit.V)); }		// Branch if Less or Equal (signed)
-void C6809::lble() { do_lbr(CC.bit.Z | (CC.bit.N ^ CC.bit.V)); }		// Branch if Less or Equal (signed)
-void C6809::bge() { do_br(!CC.bit.N ^ CC.bit.V); }		// Branch if Greater or Equal (signed)
-void C6809::lbge() { do_lbr(!CC.bit.N ^ CC.bit.V); }		// Branch if Greater or Equal (signed)
-void C6809::blt() { do_br(CC.bit.N ^ CC.bit.V); }			// Branch if Less than (signed)
-void C6809::lblt() { do_lbr(CC.bit.N ^ CC.bit.V); }		// Branch if Less than (signed)
+void C6809::bgt() { cc_sync(); do_br(!(CC.bit.Z | (CC.bit.N ^ CC.bit.V))); }		// Branch if Greater Than (signed)
+void C6809::lbgt() { cc_sync(); do_lbr(!(CC.bit.Z | (CC.bit.N ^ CC.bit.V))); }	// Branch if Greater Than (signed)
+void C6809::ble() { cc_sync(); do_br(CC.bit.Z | (CC.bit.N ^ CC.bit.V)); }		// Branch if Less or Equal (signed)
+void C6809::lble() { cc_sync(); do_lbr(CC.bit.Z | (CC.bit.N ^ CC.bit.V)); }		// Branch if Less or Equal (signed)
+void C6809::bge() { cc_sync(); do_br(!CC.bit.N ^ CC.bit.V); }		// Branch if Greater or Equal (signed)
+void C6809::lbge() { cc_sync(); do_lbr(!CC.bit.N ^ CC.bit.V); }		// Branch if Greater or Equal (signed)
+void C6809::blt() { cc_sync(); do_br(CC.bit.N ^ CC.bit.V); }			// Branch if Less than (signed)
+void C6809::lblt() { cc_sync(); do_lbr(CC.bit.N ^ CC.bit.V); }		// Branch if Less than (signed)
 // unsigned conditional branches
-void C6809::bhi() { do_br(!(CC.bit.C | CC.bit.Z)); }		// Branch if Higher (unsigned)
-void C6809::lbhi() { do_lbr(!(CC.bit.C | CC.bit.Z)); }	// Branch if Higher (unsigned)
-void C6809::bls() { do_br(CC.bit.C | CC.bit.Z); }			// Branch if Lower or Same (unsigned)
-void C6809::lbls() { do_lbr(CC.bit.C | CC.bit.Z); }		// Branch if lower or Same (unsigned)
+void C6809::bhi() { cc_sync(); do_br(!(CC.bit.C | CC.bit.Z)); }		// Branch if Higher (unsigned)
+void C6809::lbhi() { cc_sync(); do_lbr(!(CC.bit.C | CC.bit.Z)); }	// Branch if Higher (unsigned)
+void C6809::bls() { cc_sync(); do_br(CC.bit.C | CC.bit.Z); }			// Branch if Lower or Same (unsigned)
+void C6809::lbls() { cc_sync(); do_lbr(CC.bit.C | CC.bit.Z); }		// Branch if lower or Same (unsigned)
 //void C6809::bhs() { do_br(!(CC.bit.Z | (CC.bit.N ^ CC.bit.V))); }		// Branch if Higher or Same (unsigned)
 //void C6809::lbhs() { do_lbr(!(CC.bit.Z | (CC.bit.N ^ CC.bit.V))); }	// Branch if Higher or Same (unsigned)
 //void C6809::blo() { do_br(CC.bit.N ^ CC.bit.V); }			// Branch if Lower (unsigned)
 //void C6809::lblo() { do_lbr(CC.bit.N ^ CC.bit.V); }		// Branch if Lower (unsigned)
 // simple branches
-void C6809::bsr() { Word addr_abs = (this->*opMap[opcode].addrmode)(); do_psh(S, PC); PC = addr_abs; }		// Branch to Subroutine
-void C6809::lbsr() { Word addr_abs = (this->*opMap[opcode].addrmode)(); do_psh(S, PC); PC = addr_abs; }		// Branch to Subroutine
+void C6809::bsr() { Word addr_abs = relb(); do_psh(S, PC); PC = addr_abs; }		// Branch to Subroutine
+void C6809::lbsr() { Word addr_abs = relw(); do_psh(S, PC); PC = addr_abs; }		// Branch to Subroutine
 void C6809::bra() { do_br(1); }							// Branch Always
-void C6809::lbra() { do_lbr(1); }							// Branch Always
+void C6809::lbra() { Sint16 ofs = fetch_word(); PC += ofs; }							// Branch Always
 void C6809::brn() { do_br(0); }							// Branch Never
-void C6809::lbrn() { do_lbr(0); }							// Branch Never
+void C6809::lbrn() { PC += 2; }							// Branch Never
 
 
 void C6809::pg2() { }
@@ -866,11 +1085,11 @@ void C6809::psh_post(Byte post, Word& s, Word& u) {
 	if (btst(post, 3)) do_psh(s, DP);
 	if (btst(post, 2)) do_psh(s, B);
 	if (btst(post, 1)) do_psh(s, A);
-	if (btst(post, 0)) do_psh(s, CC.all);
+	if (btst(post, 0)) { cc_sync(); do_psh(s, CC.all); }
 }
 void C6809::pul_post(Byte post, Word& s, Word& u) {
 	// as in pg 19 Motorola MC6809 Tech Sheet
-	if (btst(post, 0)) do_pul(s, CC.all);
+	if (btst(post, 0)) { lazy_op = LAZY_NONE; do_pul(s, CC.all); }
 	if (btst(post, 1)) do_pul(s, A);
 	if (btst(post, 2)) do_pul(s, B);
 	if (btst(post, 3)) do_pul(s, DP);
@@ -879,6 +1098,26 @@ void C6809::pul_post(Byte post, Word& s, Word& u) {
 	if (btst(post, 6)) do_pul(s, u);
 	if (btst(post, 7)) do_pul(s, PC);
 }
+// the entire state for interrupts, SWI and CWAI: HD6309 native mode
+// stacks W between DP and B
+void C6809::psh_all() {
+	if (native()) {
+		psh_post(0xf8, S, U);
+		do_psh(S, W);
+		psh_post(0x07, S, U);
+	}
+	else
+		psh_post(0xff, S, U);
+}
+void C6809::pul_all() {
+	if (native()) {
+		pul_post(0x06, S, U);
+		do_pul(S, W);
+		pul_post(0xf8, S, U);
+	}
+	else
+		pul_post(0xfe, S, U);
+}
 void C6809::do_psh(Word& sp, Byte val) {
 	write(--sp, val);
 }
@@ -894,61 +1133,116 @@ void C6809::do_pul(Word& sp, Word& val) {
 	val |= read(sp++);
 }
 
-void C6809::do_adc(Byte& x) {
-	Word data = (this->*opMap[opcode].addrmode)();
+// evaluate the flags of the pending operation exactly as the eager helpers
+// used to, returning only the bits listed in s_lazy_mask[lazy_op]
+Byte C6809::lazy_flags()
+{
+	decltype(CC) f;
+	f.all = 0;
+	switch (lazy_op)
+	{
+		case LAZY_LOGIC8:
+		case LAZY_INC8:
+		case LAZY_DEC8:
+		{
+			Byte r = (Byte)lazy_r;
+			f.bit.N = btst(r, 7);
+			f.bit.Z = (bool)!r;
+			if (lazy_op == LAZY_INC8)	f.bit.V = (lazy_x == 0x7f);
+			if (lazy_op == LAZY_DEC8)	f.bit.V = (lazy_x == 0x80);
+			break;
+		}
+		case LAZY_LOGIC16:
+			f.bit.N = btst(lazy_r, 15);
+			f.bit.Z = !lazy_r;
+			break;
+		case LAZY_ADD8:
+		{
+			Byte x = (Byte)lazy_x, m = (Byte)lazy_m;
+			Byte t = (x & 0x0f) + (m & 0x0f) + lazy_c;
+			f.bit.H = btst(t, 4);		// Half carry
+			t = (x & 0x7f) + (m & 0x7f) + lazy_c;
+			f.bit.V = btst(t, 7);		// Bit 7 carry in
+			f.bit.C = btst(lazy_r, 8);	// Bit 7 carry out
+			f.bit.V ^= f.bit.C;
+			f.bit.N = btst((Byte)lazy_r, 7);
+			f.bit.Z = (bool)!(Byte)lazy_r;
+			break;
+		}
+		case LAZY_ADD16:
+		{
+			Word t = (lazy_x & 0x0f) + (lazy_m & 0x0f);
+			f.bit.H = btst(t, 4);		// Half carry
+			t = (lazy_x & 0x7f) + (lazy_m & 0x7f);
+			f.bit.V = btst(t, 7);		// Bit 7 carry in
+			f.bit.C = btst(lazy_r, 8);	// Bit 7 carry out
+			f.bit.V ^= f.bit.C;
+			f.bit.N = btst(lazy_r, 7);
+			f.bit.Z = !lazy_r;
+			break;
+		}
+		case LAZY_SUB8:
+		{
+			Byte x = (Byte)lazy_x, m = (Byte)lazy_m;
+			int t = x - m - lazy_c;
+			f.bit.V = btst((Byte)(x ^ m ^ t ^ (t >> 1)), 7);
+			f.bit.C = btst((Word)t, 8);
+			f.bit.N = btst((Byte)t, 7);
+			f.bit.Z = !(t & 0xff);
+			break;
+		}
+		case LAZY_SUB16:
+		{
+			int t = lazy_x - lazy_m;
+			f.bit.V = btst((Byte)(lazy_x ^ lazy_m ^ t ^ (t >> 1)), 7);
+			f.bit.C = btst((Word)t, 8);
+			f.bit.N = btst((Byte)t, 7);
+			f.bit.Z = !(t & 0xffff);
+			break;
+		}
+		case LAZY_CMP16:
+		{
+			long t = lazy_x - lazy_m;
+			f.bit.V = btst((DWord)(lazy_x ^ lazy_m ^ t ^ (t >> 1)), 15);
+			f.bit.C = btst((DWord)t, 16);
+			f.bit.N = btst((DWord)t, 15);
+			f.bit.Z = !(t & 0xffff);
+			break;
+		}
+	}
+	return f.all;
+}
+
+void C6809::do_adc(Byte& x, Word data) {
 	Byte m = read(data);	// post;
 	//Byte m = fetch_byte();	// post;
-	Byte t = (x & 0x0f) + (m & 0x0f) + CC.bit.C;
-	CC.bit.H = btst(t, 4);		// Half carry
-	t = (x & 0x7f) + (m & 0x7f) + CC.bit.C;
-	CC.bit.V = btst(t, 7);		// Bit 7 carry in
-	Word wt = x + m + CC.bit.C;
-	CC.bit.C = btst(wt, 8);		// Bit 7 carry out
+	Byte c = carry();
+	Word wt = x + m + c;
+	set_flags(LAZY_ADD8, x, m, wt, c);
 	x = wt & 0xff;
-	CC.bit.V ^= CC.bit.C;
-	CC.bit.N = btst(x, 7);
-	CC.bit.Z = (bool)!x;
 }
-void C6809::do_add(Byte& x) {
-	Word data = (this->*opMap[opcode].addrmode)();
+void C6809::do_add(Byte& x, Word data) {
 	Byte m = read(data);	// post;
 	//Byte m = fetch_byte();	// post;
-	Byte t = (x & 0x0f) + (m & 0x0f);
-	CC.bit.H = btst(t, 4);		// Half carry
-	t = (x & 0x7f) + (m & 0x7f);
-	CC.bit.V = btst(t, 7);		// Bit 7 carry in
 	Word wt = x + m;
-	CC.bit.C = btst(wt, 8);		// Bit 7 carry out
+	set_flags(LAZY_ADD8, x, m, wt);
 	x = wt & 0xff;
-	CC.bit.V ^= CC.bit.C;
-	CC.bit.N = btst(x, 7);
-	CC.bit.Z = (bool)!x;
 }
-void C6809::do_add(Word& x) {
-	Word data = (this->*opMap[opcode].addrmode)();
+void C6809::do_add(Word& x, Word data) {
 	Word m = read_word(data);	// post;
-	Word t = (x & 0x0f) + (m & 0x0f);
-	CC.bit.H = btst(t, 4);		// Half carry
-	t = (x & 0x7f) + (m & 0x7f);
-	CC.bit.V = btst(t, 7);		// Bit 7 carry in
 	Word wt = x + m;
-	CC.bit.C = btst(wt, 8);		// Bit 7 carry out
+	set_flags(LAZY_ADD16, x, m, wt);
 	x = wt & 0xffff;
-	CC.bit.V ^= CC.bit.C;
-	CC.bit.N = btst(x, 7);
-	CC.bit.Z = !x;
 }
 
-void C6809::do_and(Byte& x) {
-	Word data = (this->*opMap[opcode].addrmode)();
+void C6809::do_and(Byte& x, Word data) {
 	x = x & read(data);
 	//	x = x & fetch_byte();	// post;
-	CC.bit.N = btst(x, 7);
-	CC.bit.Z = (bool)!x;
-	CC.bit.V = 0;
+	set_flags(LAZY_LOGIC8, 0, 0, x);
 }
 void C6809::do_asl(Byte& x)
 {
+	cc_sync();
 	CC.bit.C = btst(x, 7);
 	CC.bit.V = btst(x, 7) ^ btst(x, 6);
 	x <<= 1;
@@ -956,6 +1250,7 @@ void C6809::do_asl(Byte& x)
 	CC.bit.Z = (bool)!x;
 }
 void C6809::do_asr(Byte& x) {
+	cc_sync();
 	CC.bit.C = btst(x, 0);
 	x >>= 1;	/* Shift word right */
 	if ((CC.bit.N = btst(x, 6)) != 0) {
@@ -963,40 +1258,29 @@ void C6809::do_asr(Byte& x) {
 	}
 	CC.bit.Z = (bool)!x;
 }
-void C6809::do_bit(Byte& x)
+void C6809::do_bit(Byte& x, Word data)
 {
-	Word data = (this->*opMap[opcode].addrmode)();
 	Byte t = x & read(data);
 	//Byte t = x & fetch_byte();	// post;
-	CC.bit.N = btst(t, 7);
-	CC.bit.V = 0;
-	CC.bit.Z = (bool)!t;
+	set_flags(LAZY_LOGIC8, 0, 0, t);
 }
 void C6809::do_clr(Byte& x)
 {
+	cc_sync();
 	CC.all &= 0xf0;
 	CC.all |= 0x04;
 	x = 0;
 }
-void C6809::do_cmp(Byte x) {
-	Word addr_abs = (this->*opMap[opcode].addrmode)();
+void C6809::do_cmp(Byte x, Word addr_abs) {
 	Byte m = read(addr_abs);
-	int	t = x - m;
-	CC.bit.V = btst((Byte)(x ^ m ^ t ^ (t >> 1)), 7);
-	CC.bit.C = btst((Word)t, 8);
-	CC.bit.N = btst((Byte)t, 7);
-	CC.bit.Z = !(t & 0xff);
-}
-void C6809::do_cmp(Word x) {
-	Word addr_abs = (this->*opMap[opcode].addrmode)();
+	set_flags(LAZY_SUB8, x, m, (x - m) & 0xffff);
+}
+void C6809::do_cmp(Word x, Word addr_abs) {
 	Word m = read_word(addr_abs);
-	long t = x - m;
-	CC.bit.V = btst((DWord)(x ^ m ^ t ^ (t >> 1)), 15);
-	CC.bit.C = btst((DWord)t, 16);
-	CC.bit.N = btst((DWord)t, 15);
-	CC.bit.Z = !(t & 0xffff);
+	set_flags(LAZY_CMP16, x, m, x - m);
 }
 void C6809::do_com(Byte& x) {
+	cc_sync();
 	x = ~x;
 	CC.bit.C = 1;
 	CC.bit.V = 0;
@@ -1004,43 +1288,31 @@ void C6809::do_com(Byte& x) {
 	CC.bit.Z = (bool)!x;
 }
 void C6809::do_dec(Byte& x) {
-	CC.bit.V = (x == 0x80);
+	set_flags(LAZY_DEC8, x, 1, x - 1);
 	x = x - 1;
-	CC.bit.N = btst(x, 7);
-	CC.bit.Z = (bool)!x;
 }
-void C6809::do_eor(Byte& x) {
-	Word addr_abs = (this->*opMap[opcode].addrmode)();
+void C6809::do_eor(Byte& x, Word addr_abs) {
 	x = x ^ read(addr_abs);
-	CC.bit.V = 0;
-	CC.bit.N = btst(x, 7);
-	CC.bit.Z = (bool)!x;
+	set_flags(LAZY_LOGIC8, 0, 0, x);
 }
 void C6809::do_inc(Byte& x)
 {
-	CC.bit.V = (x == 0x7f);
+	set_flags(LAZY_INC8, x, 1, x + 1);
 	x = x + 1;
-	CC.bit.N = btst(x, 7);
-	CC.bit.Z = (bool)!x;
 }
-void C6809::do_ld(Byte& x)
+void C6809::do_ld(Byte& x, Word addr_abs)
 {
-	Word addr_abs = (this->*opMap[opcode].addrmode)();
 	x = read(addr_abs);
-	CC.bit.N = btst(x, 7);
-	CC.bit.V = 0;
-	CC.bit.Z = (bool)!x;
+	set_flags(LAZY_LOGIC8, 0, 0, x);
 }
-void C6809::do_ld(Word& x)
+void C6809::do_ld(Word& x, Word addr_abs)
 {
-	Word addr_abs = (this->*opMap[opcode].addrmode)();
 	x = read_word(addr_abs);
-	CC.bit.N = btst(x, 15);
-	CC.bit.V = 0;
-	CC.bit.Z = !x;
+	set_flags(LAZY_LOGIC16, 0, 0, x);
 }
 void C6809::do_lsr(Byte& x)
 {
+	cc_sync();
 	CC.bit.C = btst(x, 0);
 	x >>= 1;
 	CC.bit.N = 0;
@@ -1049,23 +1321,17 @@ void C6809::do_lsr(Byte& x)
 void C6809::do_neg(Byte& x)
 {
 	int	t = 0 - x;
-	CC.bit.V = btst((Byte)(x ^ t ^ (t >> 1)), 7);
-	CC.bit.C = btst((Word)t, 8);
-	CC.bit.N = btst((Byte)t, 7);
+	set_flags(LAZY_SUB8, 0, x, t & 0xffff);
 	x = t & 0xff;
-	CC.bit.Z = (bool)!x;
 }
-void C6809::do_or(Byte& x)
+void C6809::do_or(Byte& x, Word addr_abs)
 {
-	Word addr_abs = (this->*opMap[opcode].addrmode)();
 	x = x | read(addr_abs);
-	CC.bit.V = 0;
-	CC.bit.N = btst(x, 7);
-	CC.bit.Z = (bool)!x;
+	set_flags(LAZY_LOGIC8, 0, 0, x);
 }
 void C6809::do_rol(Byte& x)
 {
-	bool oc = CC.bit.C;
+	bool oc = carry();
 	CC.bit.V = btst(x, 7) ^ btst(x, 6);
 	CC.bit.C = btst(x, 7);
 	x = x << 1;
@@ -1075,89 +1341,377 @@ void C6809::do_rol(Byte& x)
 }
 void C6809::do_ror(Byte& x)
 {
-	bool oc = CC.bit.C;
+	bool oc = carry();
 	CC.bit.C = btst(x, 0);
 	x = x >> 1;
 	if (oc) bset(x, 7);
 	CC.bit.N = btst(x, 7);
 	CC.bit.Z = (bool)!x;
-	++cycles;
 }
-void C6809::do_sbc(Byte& x) {
-	Word addr_abs = (this->*opMap[opcode].addrmode)();
+void C6809::do_sbc(Byte& x, Word addr_abs) {
 	Byte m = read(addr_abs);
-	int t = x - m - CC.bit.C;
-	CC.bit.V = btst((Byte)(x ^ m ^ t ^ (t >> 1)), 7);
-	CC.bit.C = btst((Word)t, 8);
-	CC.bit.N = btst((Byte)t, 7);
+	Byte c = carry();
+	int t = x - m - c;
+	set_flags(LAZY_SUB8, x, m, t & 0xffff, c);
 	x = t & 0xff;
-	CC.bit.Z = (bool)!x;
 }
-void C6809::do_st(Byte x)
+void C6809::do_st(Byte x, Word addr_abs)
 {
-	Word addr_abs = (this->*opMap[opcode].addrmode)();
 	Word addr = addr_abs;
 	write(addr, x);
-	CC.bit.V = 0;
-	CC.bit.N = btst(x, 7);
-	CC.bit.Z = (bool)!x;
+	set_flags(LAZY_LOGIC8, 0, 0, x);
 }
-void C6809::do_st(Word x)
+void C6809::do_st(Word x, Word addr_abs)
 {
-	Word addr_abs = (this->*opMap[opcode].addrmode)();
 	Word addr = addr_abs;
 	write_word(addr, x);
-	CC.bit.V = 0;
-	CC.bit.N = btst(x, 15);
-	CC.bit.Z = !x;
+	set_flags(LAZY_LOGIC16, 0, 0, x);
 }
-void C6809::do_sub(Byte& x) {
-	Word addr_abs = (this->*opMap[opcode].addrmode)();
+void C6809::do_sub(Byte& x, Word addr_abs) {
 	Byte m = read(addr_abs);
 	int t = x - m;
-	CC.bit.V = btst((Byte)(x ^ m ^ t ^ (t >> 1)), 7);
-	CC.bit.C = btst((Word)t, 8);
-	CC.bit.N = btst((Byte)t, 7);
+	set_flags(LAZY_SUB8, x, m, t & 0xffff);
 	x = t & 0xff;
-	CC.bit.Z = (bool)!x;
 }
-void C6809::do_sub(Word& x) {
-	Word addr_abs = (this->*opMap[opcode].addrmode)();
+void C6809::do_sub(Word& x, Word addr_abs) {
 	//Byte m = read_word(addr_abs);
 	Word m = read_word(addr_abs);
 	int t = x - m;
-	CC.bit.V = btst((Byte)(x ^ m ^ t ^ (t >> 1)), 7);
-	CC.bit.C = btst((Word)t, 8);
-	CC.bit.N = btst((Byte)t, 7);
+	set_flags(LAZY_SUB16, x, m, t & 0xffff);
 	x = t & 0xffff;
-	CC.bit.Z = !x;
 }
 void C6809::do_tst(Byte& x) {
-	CC.bit.V = 0;
-	CC.bit.N = btst(x, 7);
-	CC.bit.Z = (bool)!x;
+	set_flags(LAZY_LOGIC8, 0, 0, x);
 }
 void C6809::do_br(bool test) {
 	if (test)
-		PC = (this->*opMap[opcode].addrmode)();	// +1;
+		PC = relb();	// +1;
 	else
 		PC++;
 }
+// long conditional branches take one more cycle when the branch is taken
 void C6809::do_lbr(bool test) {
 	if (test)
 	{
 		Sint16 ofs = fetch_word();
 		PC += ofs;
+		cycles++;
 	}
 	else
-	{
 		PC += 2;
-		cycles++;
-	}
 }
 
 //Word addr_abs = (this->*opMap[opcode].addrmode)(); do_psh(S, PC); PC = addr_abs;
 
+///// SWITCH CORE ///////////////////////////////////////////////////////
+
+// Runs the current opcode through one switch instead of the opMap member
+// function pointers. Every case runs the same operation as its opMap entry in
+// Init(), with the addressing mode called directly so the compiler can inline
+// it. The base cycles come from op_cycles, the same table table_core() uses.
+void C6809::switch_core()
+{
+	cycles = base_cycles(opcode);
+	switch (opcode)
+	{
+		case 0x0000:	{ Word a = dir(); Byte m = read(a); do_neg(m); write(a, m); }	break;	// NEG
+		case 0x0003:	{ Word a = dir(); Byte m = read(a); do_com(m); write(a, m); }	break;	// COM
+		case 0x0004:	{ Word a = dir(); Byte m = read(a); do_lsr(m); write(a, m); }	break;	// LSR
+		case 0x0006:	{ Word a = dir(); Byte m = read(a); do_ror(m); write(a, m); }	break;	// ROR
+		case 0x0007:	{ Word a = dir(); Byte m = read(a); do_asr(m); write(a, m); }	break;	// ASR
+		case 0x0008:	{ Word a = dir(); Byte m = read(a); do_asl(m); write(a, m); }	break;	// ASL
+		case 0x0009:	{ Word a = dir(); Byte m = read(a); do_rol(m); write(a, m); }	break;	// ROL
+		case 0x000A:	{ Word a = dir(); Byte m = read(a); do_dec(m); write(a, m); }	break;	// DEC
+		case 0x000C:	{ Word a = dir(); Byte m = read(a); do_inc(m); write(a, m); }	break;	// INC
+		case 0x000D:	{ Word a = dir(); Byte m = read(a); do_tst(m); write(a, m); }	break;	// TST
+		case 0x000E:	PC = dir();	break;	// JMP
+		case 0x000F:	{ Word a = dir(); Byte m = read(a); do_clr(m); write(a, m); }	break;	// CLR
+		case 0x0012:	nop();	break;	// NOP
+		case 0x0013:	sync();	break;	// SYNC
+		case 0x0016:	lbra();	break;	// LBRA
+		case 0x0017:	lbsr();	break;	// LBSR
+		case 0x0019:	daa();	break;	// DAA
+		case 0x001A:	orcc();	break;	// ORCC
+		case 0x001C:	andc();	break;	// ANDCC
+		case 0x001D:	sex();	break;	// SEX
+		case 0x001E:	exg();	break;	// EXG
+		case 0x001F:	tfr();	break;	// TFR
+		case 0x0020:	bra();	break;	// BRA
+		case 0x0021:	brn();	break;	// BRN
+		case 0x0022:	bhi();	break;	// BHI
+		case 0x0023:	bls();	break;	// BLS
+		case 0x0024:	bcc();	break;	// BCC
+		case 0x0025:	bcs();	break;	// BCS
+		case 0x0026:	bne();	break;	// BNE
+		case 0x0027:	beq();	break;	// BEQ
+		case 0x0028:	bvc();	break;	// BVC
+		case 0x0029:	bvs();	break;	// BVS
+		case 0x002A:	bpl();	break;	// BPL
+		case 0x002B:	bmi();	break;	// BMI
+		case 0x002C:	bge();	break;	// BGE
+		case 0x002D:	blt();	break;	// BLT
+		case 0x002E:	bgt();	break;	// BGT
+		case 0x002F:	ble();	break;	// BLE
+		case 0x0030:	leax();	break;	// LEAX
+		case 0x0031:	leay();	break;	// LEAY
+		case 0x0032:	leas();	break;	// LEAS
+		case 0x0033:	leau();	break;	// LEAU
+		case 0x0034:	pshs();	break;	// PSHS
+		case 0x0035:	puls();	break;	// PULS
+		case 0x0036:	pshu();	break;	// PSHU
+		case 0x0037:	pulu();	break;	// PULU
+		case 0x0039:	rts();	break;	// RTS
+		case 0x003A:	abx();	break;	// ABX
+		case 0x003B:	rti();	break;	// RTI
+		case 0x003C:	cwai();	break;	// CWAI
+		case 0x003D:	mul();	break;	// MUL
+		case 0x003F:	swi();	break;	// SWI
+		case 0x0040:	nega();	break;	// NEGA
+		case 0x0043:	coma();	break;	// COMA
+		case 0x0044:	lsra();	break;	// LSRA
+		case 0x0046:	rora();	break;	// RORA
+		case 0x0047:	asra();	break;	// ASRA
+		case 0x0048:	asla();	break;	// ASLA
+		case 0x0049:	rola();	break;	// ROLA
+		case 0x004A:	deca();	break;	// DECA
+		case 0x004C:	inca();	break;	// INCA
+		case 0x004D:	tsta();	break;	// TSTA
+		case 0x004F:	clra();	break;	// CLRA
+		case 0x0050:	negb();	break;	// NEGB
+		case 0x0053:	comb();	break;	// COMB
+		case 0x0054:	lsrb();	break;	// LSRB
+		case 0x0056:	rorb();	break;	// RORB
+		case 0x0057:	asrb();	break;	// ASRB
+		case 0x0058:	aslb();	break;	// ASLB
+		case 0x0059:	rolb();	break;	// ROLB
+		case 0x005A:	decb();	break;	// DECB
+		case 0x005C:	incb();	break;	// INCB
+		case 0x005D:	tstb();	break;	// TSTB
+		case 0x005F:	clrb();	break;	// CLRB
+		case 0x0060:	{ Word a = idx(); Byte m = read(a); do_neg(m); write(a, m); }	break;	// NEG
+		case 0x0063:	{ Word a = idx(); Byte m = read(a); do_com(m); write(a, m); }	break;	// COM
+		case 0x0064:	{ Word a = idx(); Byte m = read(a); do_lsr(m); write(a, m); }	break;	// LSR
+		case 0x0066:	{ Word a = idx(); Byte m = read(a); do_ror(m); write(a, m); }	break;	// ROR
+		case 0x0067:	{ Word a = idx(); Byte m = read(a); do_asr(m); write(a, m); }	break;	// ASR
+		case 0x0068:	{ Word a = idx(); Byte m = read(a); do_asl(m); write(a, m); }	break;	// ASL
+		case 0x0069:	{ Word a = idx(); Byte m = read(a); do_rol(m); write(a, m); }	break;	// ROL
+		case 0x006A:	{ Word a = idx(); Byte m = read(a); do_dec(m); write(a, m); }	break;	// DEC
+		case 0x006C:	{ Word a = idx(); Byte m = read(a); do_inc(m); write(a, m); }	break;	// INC
+		case 0x006D:	{ Word a = idx(); Byte m = read(a); do_tst(m); write(a, m); }	break;	// TST
+		case 0x006E:	PC = idx();	break;	// JMP
+		case 0x006F:	{ Word a = idx(); Byte m = read(a); do_clr(m); write(a, m); }	break;	// CLR
+		case 0x0070:	{ Word a = ext(); Byte m = read(a); do_neg(m); write(a, m); }	break;	// NEG
+		case 0x0073:	{ Word a = ext(); Byte m = read(a); do_com(m); write(a, m); }	break;	// COM
+		case 0x0074:	{ Word a = ext(); Byte m = read(a); do_lsr(m); write(a, m); }	break;	// LSR
+		case 0x0076:	{ Word a = ext(); Byte m = read(a); do_ror(m); write(a, m); }	break;	// ROR
+		case 0x0077:	{ Word a = ext(); Byte m = read(a); do_asr(m); write(a, m); }	break;	// ASR
+		case 0x0078:	{ Word a = ext(); Byte m = read(a); do_asl(m); write(a, m); }	break;	// ASL
+		case 0x0079:	{ Word a = ext(); Byte m = read(a); do_rol(m); write(a, m); }	break;	// ROL
+		case 0x007A:	{ Word a = ext(); Byte m = read(a); do_dec(m); write(a, m); }	break;	// DEC
+		case 0x007C:	{ Word a = ext(); Byte m = read(a); do_inc(m); write(a, m); }	break;	// INC
+		case 0x007D:	{ Word a = ext(); Byte m = read(a); do_tst(m); write(a, m); }	break;	// TST
+		case 0x007E:	PC = ext();	break;	// JMP
+		case 0x007F:	{ Word a = ext(); Byte m = read(a); do_clr(m); write(a, m); }	break;	// CLR
+		case 0x0080:	do_sub(A, immb());	break;	// SUBA
+		case 0x0081:	do_cmp(A, immb());	break;	// CMPA
+		case 0x0082:	do_sbc(A, immb());	break;	// SBCA
+		case 0x0083:	do_sub(D, immw());	break;	// SUBD
+		case 0x0084:	do_and(A, immb());	break;	// ANDA
+		case 0x0085:	do_bit(A, immb());	break;	// BITA
+		case 0x0086:	do_ld(A, immb());	break;	// LDA
+		case 0x0088:	do_eor(A, immb());	break;	// EORA
+		case 0x0089:	do_adc(A, immb());	break;	// ADCA
+		case 0x008A:	do_or(A, immb());	break;	// ORA
+		case 0x008B:	do_add(A, immb());	break;	// ADDA
+		case 0x008C:	{ Word r = X; do_cmp(r, immw()); }	break;	// CMPX
+		case 0x008D:	bsr();	break;	// BSR
+		case 0x008E:	do_ld(X, immw());	break;	// LDX
+		case 0x0090:	do_sub(A, dir());	break;	// SUBA
+		case 0x0091:	do_cmp(A, dir());	break;	// CMPA
+		case 0x0092:	do_sbc(A, dir());	break;	// SBCA
+		case 0x0093:	do_sub(D, dir());	break;	// SUBD
+		case 0x0094:	do_and(A, dir());	break;	// ANDA
+		case 0x0095:	do_bit(A, dir());	break;	// BITA
+		case 0x0096:	do_ld(A, dir());	break;	// LDA
+		case 0x0097:	do_st(A, dir());	break;	// STA
+		case 0x0098:	do_eor(A, dir());	break;	// EORA
+		case 0x0099:	do_adc(A, dir());	break;	// ADCA
+		case 0x009A:	do_or(A, dir());	break;	// ORA
+		case 0x009B:	do_add(A, dir());	break;	// ADDA
+		case 0x009C:	{ Word r = X; do_cmp(r, dir()); }	break;	// CMPX
+		case 0x009D:	{ Word a = dir(); do_psh(S, PC); PC = a; }	break;	// JSR
+		case 0x009E:	do_ld(X, dir());	break;	// LDX
+		case 0x009F:	{ Word r = X; do_st(r, dir()); }	break;	// STX
+		case 0x00A0:	do_sub(A, idx());	break;	// SUBA
+		case 0x00A1:	do_cmp(A, idx());	break;	// CMPA
+		case 0x00A2:	do_sbc(A, idx());	break;	// SBCA
+		case 0x00A3:	do_sub(D, idx());	break;	// SUBD
+		case 0x00A4:	do_and(A, idx());	break;	// ANDA
+		case 0x00A5:	do_bit(A, idx());	break;	// BITA
+		case 0x00A6:	do_ld(A, idx());	break;	// LDA
+		case 0x00A7:	do_st(A, idx());	break;	// STA
+		case 0x00A8:	do_eor(A, idx());	break;	// EORA
+		case 0x00A9:	do_adc(A, idx());	break;	// ADCA
+		case 0x00AA:	do_or(A, idx());	break;	// ORA
+		case 0x00AB:	do_add(A, idx());	break;	// ADDA
+		case 0x00AC:	{ Word r = X; do_cmp(r, idx()); }	break;	// CMPX
+		case 0x00AD:	{ Word a = idx(); do_psh(S, PC); PC = a; }	break;	// JSR
+		case 0x00AE:	do_ld(X, idx());	break;	// LDX
+		case 0x00AF:	{ Word r = X; do_st(r, idx()); }	break;	// STX
+		case 0x00B0:	do_sub(A, ext());	break;	// SUBA
+		case 0x00B1:	do_cmp(A, ext());	break;	// CMPA
+		case 0x00B2:	do_sbc(A, ext());	break;	// SBCA
+		case 0x00B3:	do_sub(D, ext());	break;	// SUBD
+		case 0x00B4:	do_and(A, ext());	break;	// ANDA
+		case 0x00B5:	do_bit(A, ext());	break;	// BITA
+		case 0x00B6:	do_ld(A, ext());	break;	// LDA
+		case 0x00B7:	do_st(A, ext());	break;	// STA
+		case 0x00B8:	do_eor(A, ext());	break;	// EORA
+		case 0x00B9:	do_adc(A, ext());	break;	// ADCA
+		case 0x00BA:	do_or(A, ext());	break;	// ORA
+		case 0x00BB:	do_add(A, ext());	break;	// ADDA
+		case 0x00BC:	{ Word r = X; do_cmp(r, ext()); }	break;	// CMPX
+		case 0x00BD:	{ Word a = ext(); do_psh(S, PC); PC = a; }	break;	// JSR
+		case 0x00BE:	do_ld(X, ext());	break;	// LDX
+		case 0x00BF:	{ Word r = X; do_st(r, ext()); }	break;	// STX
+		case 0x00C0:	do_sub(B, immb());	break;	// SUBB
+		case 0x00C1:	do_cmp(B, immb());	break;	// CMPB
+		case 0x00C2:	do_sbc(B, immb());	break;	// SBCB
+		case 0x00C3:	do_add(D, immw());	break;	// ADDD
+		case 0x00C4:	do_and(B, immb());	break;	// ANDB
+		case 0x00C5:	do_bit(B, immb());	break;	// BITB
+		case 0x00C6:	do_ld(B, immb());	break;	// LDB
+		case 0x00C8:	do_eor(B, immb());	break;	// EORB
+		case 0x00C9:	do_adc(B, immb());	break;	// ADCB
+		case 0x00CA:	do_or(B, immb());	break;	// ORB
+		case 0x00CB:	do_add(B, immb());	break;	// ADDB
+		case 0x00CC:	do_ld(D, immw());	break;	// LDD
+		case 0x00CE:	do_ld(U, immw());	break;	// LDU
+		case 0x00D0:	do_sub(B, dir());	break;	// SUBB
+		case 0x00D1:	do_cmp(B, dir());	break;	// CMPB
+		case 0x00D2:	do_sbc(B, dir());	break;	// SBCB
+		case 0x00D3:	do_add(D, dir());	break;	// ADDD
+		case 0x00D4:	do_and(B, dir());	break;	// ANDB
+		case 0x00D5:	do_bit(B, dir());	break;	// BITB
+		case 0x00D6:	do_ld(B, dir());	break;	// LDB
+		case 0x00D7:	do_st(B, dir());	break;	// STB
+		case 0x00D8:	do_eor(B, dir());	break;	// EORB
+		case 0x00D9:	do_adc(B, dir());	break;	// ADCB
+		case 0x00DA:	do_or(B, dir());	break;	// ORB
+		case 0x00DB:	do_add(B, dir());	break;	// ADDB
+		case 0x00DC:	do_ld(D, dir());	break;	// LDD
+		case 0x00DD:	do_st(D, dir());	break;	// STD
+		case 0x00DE:	do_ld(U, dir());	break;	// LDU
+		case 0x00DF:	{ Word r = U; do_st(r, dir()); }	break;	// STU
+		case 0x00E0:	do_sub(B, idx());	break;	// SUBB
+		case 0x00E1:	do_cmp(B, idx());	break;	// CMPB
+		case 0x00E2:	do_sbc(B, idx());	break;	// SBCB
+		case 0x00E3:	do_add(D, idx());	break;	// ADDD
+		case 0x00E4:	do_and(B, idx());	break;	// ANDB
+		case 0x00E5:	do_bit(B, idx());	break;	// BITB
+		case 0x00E6:	do_ld(B, idx());	break;	// LDB
+		case 0x00E7:	do_st(B, idx());	break;	// STB
+		case 0x00E8:	do_eor(B, idx());	break;	// EORB
+		case 0x00E9:	do_adc(B, idx());	break;	// ADCB
+		case 0x00EA:	do_or(B, idx());	break;	// ORB
+		case 0x00EB:	do_add(B, idx());	break;	// ADDB
+		case 0x00EC:	do_ld(D, idx());	break;	// LDD
+		case 0x00ED:	do_st(D, idx());	break;	// STD
+		case 0x00EE:	do_ld(U, idx());	break;	// LDU
+		case 0x00EF:	{ Word r = U; do_st(r, idx()); }	break;	// STU
+		case 0x00F0:	do_sub(B, ext());	break;	// SUBB
+		case 0x00F1:	do_cmp(B, ext());	break;	// CMPB
+		case 0x00F2:	do_sbc(B, ext());	break;	// SBCB
+		case 0x00F3:	do_add(D, ext());	break;	// ADDD
+		case 0x00F4:	do_and(B, ext());	break;	// ANDB
+		case 0x00F5:	do_bit(B, ext());	break;	// BITB
+		case 0x00F6:	do_ld(B, ext());	break;	// LDB
+		case 0x00F7:	do_st(B, ext());	break;	// STB
+		case 0x00F8:	do_eor(B, ext());	break;	// EORB
+		case 0x00F9:	do_adc(B, ext());	break;	// ADCB
+		case 0x00FA:	do_or(B, ext());	break;	// ORB
+		case 0x00FB:	do_add(B, ext());	break;	// ADDB
+		case 0x00FC:	do_ld(D, ext());	break;	// LDD
+		case 0x00FD:	do_st(D, ext());	break;	// STD
+		case 0x00FE:	do_ld(U, ext());	break;	// LDU
+		case 0x00FF:	{ Word r = U; do_st(r, ext()); }	break;	// STU
+
+		case 0x1021:	lbrn();	break;	// LBRN
+		case 0x1022:	lbhi();	break;	// LBHI
+		case 0x1023:	lbls();	break;	// LBLS
+		case 0x1024:	lbcc();	break;	// LBCC
+		case 0x1025:	lbcs();	break;	// LBCS
+		case 0x1026:	lbne();	break;	// LBNE
+		case 0x1027:	lbeq();	break;	// LBEQ
+		case 0x1028:	lbvc();	break;	// LBVC
+		case 0x1029:	lbvs();	break;	// LBVS
+		case 0x102A:	lbpl();	break;	// LBPL
+		case 0x102B:	lbmi();	break;	// LBMI
+		case 0x102C:	lbge();	break;	// LBGE
+		case 0x102D:	lblt();	break;	// LBLT
+		case 0x102E:	lbgt();	break;	// LBGT
+		case 0x102F:	lble();	break;	// LBLE
+		case 0x103F:	swi2();	break;	// SWI2
+		case 0x1083:	do_cmp(D, immw());	break;	// CMPD
+		case 0x108C:	{ Word r = Y; do_cmp(r, immw()); }	break;	// CMPY
+		case 0x108E:	do_ld(Y, immw());	break;	// LDY
+		case 0x1093:	do_cmp(D, dir());	break;	// CMPD
+		case 0x109C:	{ Word r = Y; do_cmp(r, dir()); }	break;	// CMPY
+		case 0x109E:	do_ld(Y, dir());	break;	// LDY
+		case 0x109F:	{ Word r = Y; do_st(r, dir()); }	break;	// STY
+		case 0x10A3:	do_cmp(D, idx());	break;	// CMPD
+		case 0x10AC:	{ Word r = Y; do_cmp(r, idx()); }	break;	// CMPY
+		case 0x10AE:	do_ld(Y, idx());	break;	// LDY
+		case 0x10AF:	{ Word r = Y; do_st(r, idx()); }	break;	// STY
+		case 0x10B3:	do_cmp(D, ext());	break;	// CMPD
+		case 0x10BC:	{ Word r = Y; do_cmp(r, ext()); }	break;	// CMPY
+		case 0x10BE:	do_ld(Y, ext());	break;	// LDY
+		case 0x10BF:	{ Word r = Y; do_st(r, ext()); }	break;	// STY
+		case 0x10CE:	do_ld(S, immw());	nmi_disabled = false;	break;	// LDS
+		case 0x10DE:	do_ld(S, dir());	nmi_disabled = false;	break;	// LDS
+		case 0x10DF:	{ Word r = S; do_st(r, dir()); }	break;	// STS
+		case 0x10EE:	do_ld(S, idx());	nmi_disabled = false;	break;	// LDS
+		case 0x10EF:	{ Word r = S; do_st(r, idx()); }	break;	// STS
+		case 0x10FE:	do_ld(S, ext());	nmi_disabled = false;	break;	// LDS
+		case 0x10FF:	{ Word r = S; do_st(r, ext()); }	break;	// STS
+
+		case 0x113F:	swi3();	break;	// SWI3
+		case 0x1183:	{ Word r = U; do_cmp(r, immw()); }	break;	// CMPU
+		case 0x118C:	{ Word r = S; do_cmp(r, immw()); }	break;	// CMPS
+		case 0x1193:	{ Word r = U; do_cmp(r, dir()); }	break;	// CMPU
+		case 0x119C:	{ Word r = S; do_cmp(r, dir()); }	break;	// CMPS
+		case 0x11A3:	{ Word r = U; do_cmp(r, idx()); }	break;	// CMPU
+		case 0x11AC:	{ Word r = S; do_cmp(r, idx()); }	break;	// CMPS
+		case 0x11B3:	{ Word r = U; do_cmp(r, ext()); }	break;	// CMPU
+		case 0x11BC:	{ Word r = S; do_cmp(r, ext()); }	break;	// CMPS
+
+
+		// unused opcodes (and the HD6309 extensions) go through the opMap
+		default:	table_core();	break;
+	}
+}
+
+// Runs the current opcode through its opMap entry. Used for every opcode
+// when CPU_SWITCH_CORE is off, and for the opcodes the switch core leaves
+// to its default case.
+void C6809::table_core()
+{
+	INSTRUCTION& inst = opMap[opcode];
+	// seed the cycles
+	cycles = base_cycles(opcode);
+	// run the instruction
+	if (inst.operation)
+		(this->*inst.operation)();
+	else if constexpr (CPU_HD6309)
+		trap(MD_IL);
+	else
+	{
+		std::string er = "Invalid Instruction at $";
+		er += C6809::hex(PC, 4);
+		Bus::Error(er.c_str());
+	}
+}
+
 ///// INITIALIZATION ////////////////////////////////////////////////////
 
 void C6809::Init()
@@ -1195,7 +1749,7 @@ void C6809::Init()
 	opMap[0x0017] = { "LBSR",	&C::lbsr,	&C::relw,	9, 3 };
 	opMap[0x0018] = { "?? ",	&C::null,	&C::nula,	2, 1 };
 	opMap[0x0019] = { "DAA",	&C::daa,	&C::inh	,	2, 1 };
-	opMap[0x001a] = { "ORCC",	&C::orcc,	&C::immb,	2, 1 };
+	opMap[0x001a] = { "ORCC",	&C::orcc,	&C::immb,	3, 1 };
 	opMap[0x001b] = { "?? ",	&C::null,	&C::nula,	2, 1 };
 	opMap[0x001c] = { "ANDCC",	&C::andc,	&C::immb,	3, 2 };
 	opMap[0x001d] = { "SEX",	&C::sex,	&C::inh,	2, 1 };
@@ -1467,7 +2021,7 @@ void C6809::Init()
 	opMap[0x103f] = { "SWI2",	&C::swi2,	&C::inh ,	20, 2 };
 	opMap[0x1083] = { "CMPD",	&C::cmpd,	&C::immw ,	5, 4 };
 	opMap[0x108c] = { "CMPY",	&C::cmpy,	&C::immw ,	5, 4 };
-	opMap[0x108e] = { "LDY",	&C::ldy,	&C::immw ,	5, 4 };
+	opMap[0x108e] = { "LDY",	&C::ldy,	&C::immw ,	4, 4 };
 	opMap[0x1093] = { "CMPD",	&C::cmpd,	&C::dir ,	7, 3 };
 	opMap[0x109c] = { "CMPY",	&C::cmpy,	&C::dir ,	7, 3 };
 	opMap[0x109e] = { "LDY",	&C::ldy,	&C::dir ,	6, 3 };
@@ -1503,6 +2057,18 @@ void C6809::Init()
 	//for (int a = 0x0000; a < 0x1200; a++) {
 	//	printf("$%04x %s\n", a, opMap[a].mnem.c_str());
 	//}
+
+	if constexpr (CPU_HD6309)
+		Init6309();
+
+	// one flat copy of the base cycles for both cores
+	for (auto& op : opMap)
+	{
+		if (op.first > 0x11ff || (op.first > 0x00ff && op.first < 0x1000))
+			continue;
+		op_cycles[0][op_index(op.first)] = op.second.cycles;
+		op_cycles[1][op_index(op.first)] = CPU_HD6309 ? op.second.cycles_nm : op.second.cycles;
+	}
 }
 
 
@@ -1549,6 +2115,20 @@ std::string C6809::disasm(Word addr, Word& next)
 	addr += ofs;
 	// disasemble the operand
 
+	// HD6309 operand prefixes
+	const std::string& mnem = opMap[opcode].mnem;
+	if (mnem == "OIM" || mnem == "AIM" || mnem == "EIM" || mnem == "TIM")
+	{	// the immediate byte comes before the address
+		sOperand += "#$" + hex(read(addr), 2) + ","; addr++;
+	}
+	else if (opcode >= 0x1130 && opcode <= 0x1137)
+	{	// bit transfer postbyte: register, source bit, destination bit
+		const char* R[] = { "CC", "A", "B", "??" };
+		Byte data = read(addr++);
+		sOperand += std::string(R[data >> 6]) + "," + std::to_string((data >> 3) & 7) + ",";
+		sOperand += std::to_string(data & 7) + ",";
+	}
+
 	// inherent addressing
 	if (opMap[opcode].addrmode == &C6809::inh) {
 	}
@@ -1557,14 +2137,25 @@ std::string C6809::disasm(Word addr, Word& next)
 		//sOperand += hex(read(addr), 2);
 
 		// handle special case opcodes: EXG, TFR, PSH, and PUL
-		if (opcode == 0x001e || opcode == 0x001f)
-		{	// EXG or TFR
+		if (opcode == 0x001e || opcode == 0x001f ||
+			(opcode >= 0x1030 && opcode <= 0x1037) || (opcode >= 0x1138 && opcode <= 0x113b))
+		{	// EXG or TFR (and the HD6309 inter-register and TFM instructions)
 			std::map<Byte, std::string> R;
 			R[0x00] = "D";  R[0x01] = "X"; R[0x02] = "Y"; R[0x03] = "U";  R[0x04] = "S";
 			R[0x05] = "PC"; R[0x08] = "A"; R[0x09] = "B"; R[0x0a] = "CC"; R[0x0b] = "DP";
+			if (CPU_HD6309) {
+				R[0x06] = "W";  R[0x07] = "V"; R[0x0c] = "0"; R[0x0d] = "0";
+				R[0x0e] = "E";  R[0x0f] = "F";
+			}
 			Byte data = read(addr++);
 			std::string src = R[data >> 4];
 			std::string dst = R[data & 0x0f];
+			if (opcode >= 0x1138)
+			{	// TFM r0+,r1+  r0-,r1-  r0+,r1  r0,r1+
+				const char* step[4][2] = { {"+","+"}, {"-","-"}, {"+",""}, {"","+"} };
+				src += step[opcode & 3][0];
+				dst += step[opcode & 3][1];
+			}
 			sOperand += src + "," + dst;
 		}
 		else if (opcode >= 0x0034 && opcode <= 0x0037)
@@ -1593,6 +2184,11 @@ std::string C6809::disasm(Word addr, Word& next)
 		sOperand += "#$" + hex(read(addr), 2); addr++;
 		sOperand += hex(read(addr), 2); addr++;
 	}
+	// 32-bit immediate
+	else if (opMap[opcode].addrmode == &C6809::immq) {
+		sOperand += "#$" + hex(read_word(addr), 4); addr += 2;
+		sOperand += hex(read_word(addr), 4); addr += 2;
+	}
 	// extended
 	else if (opMap[opcode].addrmode == &C6809::ext) {
 		// Extended has two post bytes $
@@ -1618,6 +2214,20 @@ std::string C6809::disasm(Word addr, Word& next)
 			char ofs = (char)(post & 0x1f);
 			sOperand += "$" + hex(ofs, 4) + "," + regs[rInd];
 		}
+		// HD6309 E,R  F,R  W,R
+		else if (CPU_HD6309 && ((post & 0x0f) == 0x07 || (post & 0x0f) == 0x0a || (post & 0x0f) == 0x0e)) {
+			std::string acc = ((post & 0x0f) == 0x07) ? "E" : ((post & 0x0f) == 0x0a) ? "F" : "W";
+			std::string ea = acc + "," + regs[rInd];
+			sOperand += (post & 0x10) ? "[" + ea + "]" : ea;
+		}
+		// HD6309 ,W  n15,W  ,W++  ,--W
+		else if (CPU_HD6309 && ((post & 0x1f) == 0x0f || (post & 0x1f) == 0x10)) {
+			std::string ea = ",W";
+			if (rInd == 1)	{ ea = "$" + hex(read_word(addr), 4) + ",W"; addr += 2; }
+			if (rInd == 2)	ea = ",W++";
+			if (rInd == 3)	ea = ",--W";
+			sOperand += (post & 0x10) ? "[" + ea + "]" : ea;
+		}
 		else {
 			switch (post & 0x1f) {
 			case 0x00:					// R+
@@ -0,0 +1,482 @@
+// *************************************************
+// *
+// * Capture.cpp
+// *
+// ***********************************
+
+#include <array>
+#include <filesystem>
+#include <sstream>
+#include <iomanip>
+#include "Bus.hpp"
+#include "Capture.hpp"
+#include "Gfx.hpp"
+#include "Mouse.hpp"
+
+Byte Capture::read(Word offset, bool debug)
+{
+    Byte data = IDevice::read(offset);
+    // printf("%s::read($%04X) = $%02X\n", Name().c_str(), offset,  data);
+
+    switch (offset)
+    {
+        case CAP_CTRL:          data = _ctrl;   break;
+        case CAP_INTERVAL:      data = _interval;   break;
+        case CAP_FRAMES+0:      data = (_frames >> 8) & 0xFF;   break;
+        case CAP_FRAMES+1:      data = _frames & 0xFF;  break;
+        case CAP_DROPPED+0:     data = (_dropped >> 8) & 0xFF;  break;
+        case CAP_DROPPED+1:     data = _dropped & 0xFF; break;
+        case CAP_MISMATCH+0:    data = (_mismatch >> 8) & 0xFF; break;
+        case CAP_MISMATCH+1:    data = _mismatch & 0xFF;    break;
+    }
+
+    IDevice::write(offset,data);   // update any internal changes too
+    return data;
+}
+
+void Capture::write(Word offset, Byte data, bool debug)
+{
+    // printf("%s::write($%04X, $%02X)\n", Name().c_str(), offset, data);
+
+    switch (offset)
+    {
+        case CAP_CTRL:
+        {
+            // closing the stream... let the writer thread finish the file
+            if ((_ctrl & CAP_STREAM) && !(data & CAP_STREAM))
+            {
+                FRAME close;
+                close.type = FRAME_STREAM;
+                _queueFrame(std::move(close));
+            }
+            // starting a hash run... reload the golden log and reset the count
+            if (!(_ctrl & CAP_HASH) && (data & CAP_HASH))
+            {
+                FRAME open;
+                open.type = FRAME_HASH_START;
+                _queueFrame(std::move(open));
+            }
+            _ctrl = data & 0xF8;
+            data = _ctrl;
+            break;
+        }
+        case CAP_INTERVAL:      _interval = data;  _frame_count = 0;  break;
+        case CAP_FRAMES+0:      break;  // read only
+        case CAP_FRAMES+1:      break;  // read only
+        case CAP_DROPPED+0:     break;  // read only
+        case CAP_DROPPED+1:     break;  // read only
+        case CAP_MISMATCH+0:    break;  // read only
+        case CAP_MISMATCH+1:    break;  // read only
+    }
+
+    IDevice::write(offset,data);   // update any internal changes too
+}
+
+Word Capture::OnAttach(Word nextAddr)
+{
+    // printf("%s::OnAttach()\n", Name().c_str());
+    Word old_addr = nextAddr;
+
+    DisplayEnum("", 0,                          "Frame Capture Hardware Registers");
+    DisplayEnum("CAP_BEGIN",        nextAddr,   "Start of Frame Capture Hardware Registers");
+    DisplayEnum("CAP_CTRL",         nextAddr,   "(Byte) frame capture control");                 nextAddr++;
+	DisplayEnum("",                         0,  "     bit 7:    write 1=capture the next frame, read 1=pending");
+	DisplayEnum("",                         0,  "     bit 6:    1=stream every frame, 0=stream closed");
+	DisplayEnum("",                         0,  "     bit 5:    still image format: 0=PPM, 1=PNG");
+	DisplayEnum("",                         0,  "     bit 4:    stream format: 0=raw RGB24, 1=Y4M");
+	DisplayEnum("",                         0,  "     bit 3:    1=hash every frame, check against the golden log");
+	DisplayEnum("",                         0,  "     bits 0-2: reserved");
+    DisplayEnum("CAP_INTERVAL",     nextAddr,   "(Byte) capture a still every N frames (0=off)"); nextAddr++;
+    DisplayEnum("CAP_FRAMES",       nextAddr,   "(Word Read Only) frames written");              nextAddr+=2;
+    DisplayEnum("CAP_DROPPED",      nextAddr,   "(Word Read Only) frames dropped (queue full)"); nextAddr+=2;
+    DisplayEnum("CAP_MISMATCH",     nextAddr,   "(Word Read Only) hashed frames that differ from golden"); nextAddr+=2;
+    DisplayEnum("CAP_END", nextAddr,            "End of Frame Capture Hardware Registers");
+    DisplayEnum("", 0, "");
+
+    return nextAddr - old_addr;
+}
+
+void Capture::OnInit()
+{
+    // printf("%s::OnInit()\n", Name().c_str());
+
+    // start the writer thread
+    _bWriterRunning = true;
+    _writer = std::thread(&Capture::_writerProc, this);
+}
+
+void Capture::OnQuit()
+{
+    // printf("%s::OnQuit()\n", Name().c_str());
+
+    _stopWriter();
+}
+
+void Capture::OnActivate()
+{
+    // printf("%s::OnActivate()\n", Name().c_str());
+    Gfx* gfx = Bus::GetGfx();
+
+    // create the offscreen composition texture
+    if (_capture_texture == nullptr)
+    {
+        _capture_texture = SDL_CreateTexture(gfx->sdl_renderer, SDL_PIXELFORMAT_ARGB8888,
+            SDL_TEXTUREACCESS_TARGET, gfx->res_width, gfx->res_height);
+        if (!_capture_texture)
+            Bus::Error("Error Creating _capture_texture");
+    }
+}
+
+void Capture::OnDeactivate()
+{
+    // printf("%s::OnDeactivate()\n", Name().c_str());
+    if (_capture_texture)
+    {
+        SDL_DestroyTexture(_capture_texture);
+        _capture_texture = nullptr;
+    }
+}
+
+void Capture::OnRender()
+{
+    // printf("%s::OnRender()\n", Name().c_str());
+
+    bool bStill = (_ctrl & CAP_SNAPSHOT);
+    bool bStream = (_ctrl & CAP_STREAM);
+    if (_interval && ++_frame_count >= _interval)
+    {
+        _frame_count = 0;
+        bStill = true;
+    }
+    if (!bStill && !bStream)
+        return;
+
+    Gfx* gfx = Bus::GetGfx();
+    FRAME frame;
+    frame.flags = _ctrl;
+    frame.gmode = Bus::Read(GFX_MODE);
+    frame.raster_frame = gfx->GetRasterFrame();
+    if (!_grab(frame))
+        return;
+    _ctrl &= ~CAP_SNAPSHOT;
+    if (bStream)
+    {
+        FRAME copy = frame;
+        copy.type = FRAME_STREAM;
+        _queueFrame(std::move(copy));
+    }
+    if (bStill)
+        _queueFrame(std::move(frame));
+}
+
+// hash each completed frame in the current graphics mode, on the emulation thread
+void Capture::RasterFrame()
+{
+    if (!(_ctrl & CAP_HASH))
+        return;
+    Gfx* gfx = Bus::GetGfx();
+    FRAME frame;
+    frame.type = FRAME_HASH;
+    frame.gmode = gfx->_gfx_mode;
+    frame.raster_frame = gfx->GetRasterFrame();
+    frame.hash = FrameHash(frame.gmode);
+    _queueFrame(std::move(frame));
+}
+
+// FNV-1a over the RGB24 of the display as Gfx draws it in gmode
+QWord Capture::FrameHash(Byte gmode)
+{
+    Word width, height;
+    Bus::GetGfx()->RenderFrame(gmode, _hash_pixels, width, height);
+    QWord hash = 0xCBF29CE484222325ull;
+    for (Uint16 argb : _hash_pixels)
+    {
+        // 4 bits per channel to 8
+        hash = (hash ^ (((argb >> 8) & 0x0F) * 0x11)) * 0x00000100000001B3ull;
+        hash = (hash ^ (((argb >> 4) & 0x0F) * 0x11)) * 0x00000100000001B3ull;
+        hash = (hash ^ (((argb >> 0) & 0x0F) * 0x11)) * 0x00000100000001B3ull;
+    }
+    return hash;
+}
+
+// compose the Gfx render target and the mouse cursor at the native
+// display resolution and read the result back as RGB24
+bool Capture::_grab(FRAME& frame)
+{
+    Gfx* gfx = Bus::GetGfx();
+    SDL_Renderer* renderer = gfx->sdl_renderer;
+    if (!_capture_texture || !gfx->sdl_target_texture)
+        return false;
+
+    frame.width = gfx->res_width;
+    frame.height = gfx->res_height;
+    frame.rgb.resize(frame.width * frame.height * 3);
+
+    SDL_SetRenderTarget(renderer, _capture_texture);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0xFF);
+    SDL_RenderClear(renderer);
+    SDL_RenderCopy(renderer, gfx->sdl_target_texture, NULL, NULL);
+    SDL_Texture* cursor = Bus::GetMouse()->GetCursorTexture();
+    if (cursor)
+        SDL_RenderCopy(renderer, cursor, NULL, NULL);
+    int ret = SDL_RenderReadPixels(renderer, NULL, SDL_PIXELFORMAT_RGB24,
+                                    frame.rgb.data(), frame.width * 3);
+    SDL_SetRenderTarget(renderer, NULL);
+    return (ret == 0);
+}
+
+// hand a frame to the writer thread... never blocks, drops the frame when full
+void Capture::_queueFrame(FRAME&& frame)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        // empty stream and hash frames are commands and are never dropped
+        if (_queue.size() >= (size_t)CAPTURE_QUEUE_MAX && !frame.rgb.empty())
+        {
+            _dropped++;
+            return;
+        }
+        _queue.push_back(std::move(frame));
+    }
+    _cv.notify_one();
+}
+
+void Capture::_writerProc()
+{
+    while (true)
+    {
+        FRAME frame;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _cv.wait(lock, [this] { return !_queue.empty() || !_bWriterRunning; });
+            if (_queue.empty())
+                break;      // stopped and fully drained
+            frame = std::move(_queue.front());
+            _queue.pop_front();
+        }
+        switch (frame.type)
+        {
+            case FRAME_STILL:   _writeStill(frame);     break;
+            case FRAME_STREAM:  _writeStream(frame);    break;
+            case FRAME_HASH:
+            case FRAME_HASH_START:  _writeHash(frame);  break;
+        }
+    }
+    if (_stream)
+    {
+        fclose(_stream);
+        _stream = nullptr;
+    }
+    if (_hash_log)
+    {
+        fclose(_hash_log);
+        _hash_log = nullptr;
+    }
+}
+
+// drain the queue and stop the writer thread
+void Capture::_stopWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _bWriterRunning = false;
+    }
+    _cv.notify_all();
+    if (_writer.joinable())
+        _writer.join();
+}
+
+void Capture::_writeStill(const FRAME& frame)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(CAPTURE_DIRECTORY, ec);
+
+    std::stringstream ss;
+    ss << CAPTURE_DIRECTORY << "frame_" << std::setw(6) << std::setfill('0') << _still_index++;
+    bool ok;
+    if (frame.flags & CAP_PNG)
+        ok = _writePNG(ss.str() + ".png", frame);
+    else
+        ok = _writePPM(ss.str() + ".ppm", frame);
+    if (ok)
+        _frames++;
+}
+
+void Capture::_writeStream(const FRAME& frame)
+{
+    // close the stream when asked to, or when the resolution changes
+    if (_stream && (frame.rgb.empty() || frame.width != _stream_width || frame.height != _stream_height))
+    {
+        fclose(_stream);
+        _stream = nullptr;
+    }
+    if (frame.rgb.empty())
+        return;
+
+    bool bY4M = (frame.flags & CAP_Y4M);
+    if (!_stream)
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(CAPTURE_DIRECTORY, ec);
+        std::stringstream ss;
+        ss << CAPTURE_DIRECTORY << "stream_" << std::setw(3) << std::setfill('0') << _stream_index++;
+        ss << (bY4M ? ".y4m" : ".rgb");
+        _stream = fopen(ss.str().c_str(), "wb");
+        if (!_stream)
+            return;
+        _stream_width = frame.width;
+        _stream_height = frame.height;
+        if (bY4M)
+            fprintf(_stream, "YUV4MPEG2 W%d H%d F60:1 Ip A1:1 C444\n", frame.width, frame.height);
+    }
+
+    if (bY4M)
+    {
+        // BT.601 studio swing, three full resolution planes
+        int count = frame.width * frame.height;
+        std::vector<Byte> planes(count * 3);
+        for (int t = 0; t < count; t++)
+        {
+            int r = frame.rgb[t*3+0];
+            int g = frame.rgb[t*3+1];
+            int b = frame.rgb[t*3+2];
+            planes[t]           = (( 66*r + 129*g +  25*b + 128) >> 8) + 16;
+            planes[count + t]   = ((-38*r -  74*g + 112*b + 128) >> 8) + 128;
+            planes[count*2 + t] = ((112*r -  94*g -  18*b + 128) >> 8) + 128;
+        }
+        fputs("FRAME\n", _stream);
+        fwrite(planes.data(), sizeof(Byte), planes.size(), _stream);
+    }
+    else
+        fwrite(frame.rgb.data(), sizeof(Byte), frame.rgb.size(), _stream);
+    _frames++;
+}
+
+// log a frame's hash and check it against the golden entry
+void Capture::_writeHash(const FRAME& frame)
+{
+    // start a new run
+    if (frame.type == FRAME_HASH_START)
+    {
+        if (_hash_log)
+            fclose(_hash_log);
+        std::error_code ec;
+        std::filesystem::create_directories(CAPTURE_DIRECTORY, ec);
+        _hash_log = fopen(CAPTURE_HASH_LOG.c_str(), "w");
+        _loadGolden();
+        _mismatch = 0;
+        return;
+    }
+
+    if (_hash_log)
+        fprintf(_hash_log, "%u %02X %016llX\n", frame.raster_frame, frame.gmode, (unsigned long long)frame.hash);
+    auto itr = _golden.find({ frame.raster_frame, frame.gmode });
+    if (itr != _golden.end() && itr->second != frame.hash)
+        _mismatch++;
+}
+
+void Capture::_loadGolden()
+{
+    _golden.clear();
+    FILE* fp = fopen(CAPTURE_GOLDEN.c_str(), "r");
+    if (!fp)
+        return;
+    unsigned int raster_frame, gmode;
+    unsigned long long hash;
+    while (fscanf(fp, "%u %x %llx", &raster_frame, &gmode, &hash) == 3)
+        _golden[{ (DWord)raster_frame, (Byte)gmode }] = hash;
+    fclose(fp);
+}
+
+bool Capture::_writePPM(const std::string& filename, const FRAME& frame)
+{
+    FILE* fp = fopen(filename.c_str(), "wb");
+    if (!fp)
+        return false;
+    fprintf(fp, "P6\n%d %d\n255\n", frame.width, frame.height);
+    fwrite(frame.rgb.data(), sizeof(Byte), frame.rgb.size(), fp);
+    fclose(fp);
+    return true;
+}
+
+// the PNG chunk CRC-32 (reflected 0xEDB88320)
+static constexpr std::array<DWord, 256> crc_table()
+{
+    std::array<DWord, 256> table{};
+    for (DWord n = 0; n < 256; n++)
+    {
+        DWord c = n;
+        for (int k = 0; k < 8; k++)
+            c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : (c >> 1);
+        table[n] = c;
+    }
+    return table;
+}
+static constexpr std::array<DWord, 256> s_crc = crc_table();
+
+// minimal PNG encoder: RGB8, no filtering, stored (uncompressed) deflate blocks
+bool Capture::_writePNG(const std::string& filename, const FRAME& frame)
+{
+    auto put32 = [](std::vector<Byte>& v, DWord n) {
+        v.push_back(n >> 24);  v.push_back(n >> 16);  v.push_back(n >> 8);  v.push_back(n);
+    };
+    auto chunk = [&](FILE* fp, const char* type, const std::vector<Byte>& data) {
+        std::vector<Byte> buf;
+        put32(buf, data.size());
+        buf.insert(buf.end(), type, type + 4);
+        buf.insert(buf.end(), data.begin(), data.end());
+        DWord crc = 0xFFFFFFFF;
+        for (size_t t = 4; t < buf.size(); t++)
+            crc = s_crc[(crc ^ buf[t]) & 0xFF] ^ (crc >> 8);
+        put32(buf, crc ^ 0xFFFFFFFF);
+        fwrite(buf.data(), sizeof(Byte), buf.size(), fp);
+    };
+
+    FILE* fp = fopen(filename.c_str(), "wb");
+    if (!fp)
+        return false;
+    const Byte signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    fwrite(signature, sizeof(Byte), 8, fp);
+
+    // IHDR: width, height, 8 bits, RGB, deflate, no filter, no interlace
+    std::vector<Byte> ihdr;
+    put32(ihdr, frame.width);
+    put32(ihdr, frame.height);
+    ihdr.insert(ihdr.end(), { 8, 2, 0, 0, 0 });
+    chunk(fp, "IHDR", ihdr);
+
+    // scanlines, each prefixed with filter type 0
+    std::vector<Byte> raw;
+    int stride = frame.width * 3;
+    raw.reserve((stride + 1) * frame.height);
+    for (int y = 0; y < frame.height; y++)
+    {
+        raw.push_back(0);
+        raw.insert(raw.end(), frame.rgb.begin() + y * stride, frame.rgb.begin() + (y + 1) * stride);
+    }
+
+    // zlib stream of stored blocks
+    std::vector<Byte> idat = { 0x78, 0x01 };
+    size_t pos = 0;
+    do {
+        size_t len = std::min<size_t>(65535, raw.size() - pos);
+        bool final = (pos + len == raw.size());
+        idat.push_back(final ? 1 : 0);
+        idat.push_back(len & 0xFF);     idat.push_back(len >> 8);
+        idat.push_back(~len & 0xFF);    idat.push_back((~len >> 8) & 0xFF);
+        idat.insert(idat.end(), raw.begin() + pos, raw.begin() + pos + len);
+        pos += len;
+    } while (pos < raw.size());
+    DWord a = 1, b = 0;
+    for (Byte c : raw)
+    {
+        a = (a + c) % 65521;
+        b = (b + a) % 65521;
+    }
+    put32(idat, (b << 16) | a);
+    chunk(fp, "IDAT", idat);
+    chunk(fp, "IEND", {});
+
+    fclose(fp);
+    return true;
+}
@@ -4,13 +4,24 @@
 // *
 // ***********************************
 
+#include <iostream>
 #include <sstream>
 #include "Bus.hpp"
 #include "Gfx.hpp"
 #include "Debug.hpp"
 #include "C6809.hpp"
+#include "FileIO.hpp"
 #include "font8x8_system.hpp"
 
+Uint32 Debug::GetWindowID()
+{
+    return SDL_GetWindowID(Bus::GetDebug()->sdl_debug_window);
+}
+SDL_Window* Debug::GetSDLWindow()
+{
+    return Bus::GetDebug()->sdl_debug_window;
+}
+
 Byte Debug::read(Word offset, bool debug) 
 {
     Byte data = IDevice::read(offset);
@@ -21,24 +32,25 @@ Byte Debug::read(Word offset, bool debug)
         // system registers
 		case SYS_STATE: 
         {
-			Byte err = C6809::s_sys_state & 0xF0;
-			C6809::s_sys_state &= 0x0F;
-			data = C6809::s_sys_state | err; 
+			C6809* cpu = Bus::GetC6809();
+			Byte err = cpu->_sys_state & 0xF0;
+			cpu->_sys_state &= 0x0F;
+			data = cpu->_sys_state | err; 
 			break;
 		}        
-		case SYS_SPEED + 0:		data = Bus::_sys_cpu_speed >> 8; break;
-		case SYS_SPEED + 1:		data = Bus::_sys_cpu_speed & 0xFF; break;
-		case SYS_CLOCK_DIV:		data = Bus::_clock_div; break;
-		case SYS_TIMER + 0:		data = Bus::_clock_timer >> 8; break;
-		case SYS_TIMER + 1:		data = Bus::_clock_timer & 0xff; break;
+		case SYS_SPEED + 0:		data = Bus::Inst()._sys_cpu_speed >> 8; break;
+		case SYS_SPEED + 1:		data = Bus::Inst()._sys_cpu_speed & 0xFF; break;
+		case SYS_CLOCK_DIV:		data = Bus::Inst()._clock_div; break;
+		case SYS_TIMER + 0:		data = Bus::Inst()._clock_timer >> 8; break;
+		case SYS_TIMER + 1:		data = Bus::Inst()._clock_timer & 0xff; break;
 
         // debug registers
         case DBG_BRK_ADDR + 0: data = reg_brk_addr >> 8;   break;
         case DBG_BRK_ADDR + 1: data = reg_brk_addr & 0xFF; break;
         case DBG_FLAGS: 
         {
-            (s_bIsDebugActive) ? reg_flags |= 0x80 : reg_flags &= ~0x80; // Enable
-            (s_bSingleStep)     ? reg_flags |= 0x40 : reg_flags &= ~0x40; // Single-Step
+            (_bIsDebugActive) ? reg_flags |= 0x80 : reg_flags &= ~0x80; // Enable
+            (_bSingleStep)     ? reg_flags |= 0x40 : reg_flags &= ~0x40; // Single-Step
             reg_flags &= ~0x20;     // zero for Clear all Breakpoints
             (mapBreakpoints[reg_brk_addr]) ? reg_flags |= 0x10 : reg_flags &= ~0x10;
             reg_flags &= ~0x08;     // FIRQ
@@ -62,15 +74,17 @@ void Debug::write(Word offset, Byte data, bool debug)
     {
         // system registers
 		case SYS_STATE: { 
-			C6809::s_sys_state = data;
+			Bus::GetC6809()->_sys_state = data;
 			break;
 		}        
 		case SYS_TIMER + 0: {
-			Bus::_clock_timer = (data << 8) | (Bus::_clock_timer & 0x0f);
+			Word& timer = Bus::Inst()._clock_timer;
+			timer = (data << 8) | (timer & 0x0f);
 			break;
 		}
 		case SYS_TIMER + 1: {
-			Bus::_clock_timer = (data << 0) | (Bus::_clock_timer & 0xf0);
+			Word& timer = Bus::Inst()._clock_timer;
+			timer = (data << 0) | (timer & 0xf0);
 			break;
 		}
 
@@ -79,8 +93,9 @@ void Debug::write(Word offset, Byte data, bool debug)
         case DBG_BRK_ADDR + 1: reg_brk_addr = (reg_brk_addr & 0xff00) | (data << 0); break;
         case DBG_FLAGS: {
             reg_flags = data;
-            (reg_flags & 0x80) ? s_bIsDebugActive = true : s_bIsDebugActive = false;
-            (reg_flags & 0x40) ? s_bSingleStep = true : s_bSingleStep = false;
+            (reg_flags & 0x80) ? _bIsDebugActive = true : _bIsDebugActive = false;
+            (reg_flags & 0x40) ? _bSingleStep = true : _bSingleStep = false;
+            Bus::GetC6809()->Wake();
             if (reg_flags & 0x20)  cbClearBreaks();
             (reg_flags & 0x10) ? mapBreakpoints[reg_brk_addr] = true : mapBreakpoints[reg_brk_addr] = false;
             if (reg_flags & 0x08)   cbFIRQ();
@@ -88,7 +103,7 @@ void Debug::write(Word offset, Byte data, bool debug)
             if (reg_flags & 0x02)   cbNMI();
             if (reg_flags & 0x01)   cbReset();
             // activate or deactivate the debugger
-            if (s_bIsDebugActive)   // activate
+            if (_bIsDebugActive)   // activate
             {
                 SDL_ShowWindow(sdl_debug_window);
                 SDL_RaiseWindow(Debug::GetSDLWindow());
@@ -188,20 +203,28 @@ void Debug::OnInit()
 
     // start up conditions
     reg_flags = 0;
-    s_bIsDebugActive = false;
-    s_bSingleStep = false;
+    _bIsDebugActive = false;
+    _bSingleStep = false;
     debug_window_flags = SDL_WINDOW_RESIZABLE | SDL_WINDOW_HIDDEN;
     if (DEBUG_STARTS_ACTIVE | DEBUG_SINGLE_STEP)    
     { 
-        s_bIsDebugActive = true;  
+        _bIsDebugActive = true;  
         reg_flags |= 0x80; 
         debug_window_flags = SDL_WINDOW_RESIZABLE; 
     }
     if (DEBUG_SINGLE_STEP)      
     { 
-        s_bSingleStep = true;     
+        _bSingleStep = true;     
         reg_flags |= 0x40; 
     }
+    // headless machines have no debugger window and never stop to single step
+    if (Bus::IsHeadless())
+    {
+        reg_flags = 0;
+        _bIsDebugActive = false;
+        _bSingleStep = false;
+        return;
+    }
     /***********************************************************************
      * Attempting to stop the screen flicker when creating the SDL window  *
      ***********************************************************************/
@@ -210,7 +233,7 @@ void Debug::OnInit()
     #endif        
 
     // set the default monitor
-    Gfx::s_gfx_emu |= (DEBUG_MONITOR & 0x07)<<3;
+    Bus::GetGfx()->_gfx_emu |= (DEBUG_MONITOR & 0x07)<<3;
 
     sdl_debug_window = SDL_CreateWindow("alpha_6809 Debugger",
             SDL_WINDOWPOS_CENTERED_DISPLAY(DEBUG_MONITOR),  
@@ -271,8 +294,8 @@ void Debug::OnInit()
 void Debug::OnActivate()
 {
     // move (and resize) the window to the correct display monitor
-    static int s_monitor = (Gfx::s_gfx_emu & 0x38) >> 3;;
-    int DebugMonitor = (Gfx::s_gfx_emu & 0x38) >> 3;
+    static int s_monitor = (Bus::GetGfx()->_gfx_emu & 0x38) >> 3;;
+    int DebugMonitor = (Bus::GetGfx()->_gfx_emu & 0x38) >> 3;
     if (s_monitor != DebugMonitor)
     {
         s_monitor = DebugMonitor;
@@ -343,12 +366,12 @@ void Debug::OnEvent(SDL_Event* evnt)
                     Bus::Write(DBG_FLAGS, data);
                     bIsCursorVisible = false;
                     bMouseWheelActive = false;
-                    if (s_bIsDebugActive)
+                    if (_bIsDebugActive)
                         SDL_ShowWindow(Debug::GetSDLWindow());
                     else
                         SDL_HideWindow(Debug::GetSDLWindow());
                     
-                    // if (s_bIsDebugActive) // enable the cursor during debug
+                    // if (_bIsDebugActive) // enable the cursor during debug
                     // {
                     //     Byte data = Bus::Read(CSR_FLAGS);
                     //     data |= 0x20;
@@ -357,9 +380,32 @@ void Debug::OnEvent(SDL_Event* evnt)
                 }
                 if (evnt->key.keysym.sym == SDLK_r)
                 {
-                    s_bSingleStep = !s_bSingleStep;
+                    _bSingleStep = !_bSingleStep;
+                    Bus::GetC6809()->Wake();
                     bMouseWheelActive = false;
                 }
+                if (evnt->key.keysym.sym == SDLK_p)
+                {
+                    // start the instruction mix profile, or stop it and save it
+                    C6809* cpu = Bus::GetC6809();
+                    bool paused = cpu->IsPaused();
+                    cpu->Pause();
+                    cpu->Profile(!cpu->Profile());
+                    FileIO* fileio = Bus::GetFileIO();
+                    if (cpu->Profile())
+                        fileio->ResetStats();
+                    else
+                    {
+                        if (!cpu->SaveProfile(PROFILE_FILENAME))
+                            std::cout << "Unable to save " << PROFILE_FILENAME << "\n";
+                        const FILE_STATS& fs = fileio->Stats();
+                        std::cout << "FileIO: " << fs.hits << " buffer hits, " << fs.misses << " misses, "
+                                  << fs.flushes << " flushes, " << fs.mapped << " mapped opens, "
+                                  << fs.stat_hits << " stat hits, " << fs.stat_misses << " stat misses\n";
+                    }
+                    if (!paused)
+                        cpu->Resume();
+                }
             }
             // // [F10] or [SPACE] == Step Over
             // if (evnt->key.keysym.sym == SDLK_F10 || evnt->key.keysym.sym == SDLK_SPACE)
@@ -388,19 +434,19 @@ void Debug::OnEvent(SDL_Event* evnt)
             {
                 case SDL_WINDOWEVENT_CLOSE:
                 {
-                    s_bIsDebugActive = false;
+                    _bIsDebugActive = false;
                     SDL_HideWindow(sdl_debug_window);
                     SDL_RaiseWindow(Gfx::GetSDLWindow());
                     break;
                 }                
                 case SDL_WINDOWEVENT_MINIMIZED:
                 {
-                    s_bIsDebugActive = false;
+                    _bIsDebugActive = false;
                     break;
                 }
                 case SDL_WINDOWEVENT_RESTORED:
                 {
-                    s_bIsDebugActive = true;
+                    _bIsDebugActive = true;
                     break;
                 }
                 case SDL_WINDOWEVENT_ENTER:
@@ -433,7 +479,7 @@ void Debug::OnEvent(SDL_Event* evnt)
             // ****************************
 
             // perform debug enabled specific events
-            if (s_bIsDebugActive)
+            if (_bIsDebugActive)
             {
                 if (evnt->key.keysym.sym == SDLK_ESCAPE)
                     bIsCursorVisible = false;
@@ -569,7 +615,7 @@ bool Debug::EditRegister(float fElapsedTime)
         case EDIT_X:	data = cpu->getX(); break;
         case EDIT_Y:	data = cpu->getY(); break;
         case EDIT_U:	data = cpu->getU(); break;
-        case EDIT_PC:	data = cpu->getPC(); s_bSingleStep = true;  break;
+        case EDIT_PC:	data = cpu->getPC(); _bSingleStep = true;  break;
         case EDIT_S:	data = cpu->getS(); break;
         case EDIT_DP:	data = (Word)cpu->getDP() << 8; break;
         case EDIT_BREAK: data = new_breakpoint; break;
@@ -795,7 +841,7 @@ void Debug::DrawButtons()
     // C6809* cpu = Bus::GetC6809();
 
     // change the run/stop according to the single step state
-    if (s_bSingleStep)
+    if (_bSingleStep)
     {
         vButton[5].text = " RUN!";
         vButton[5].x_min = 17;
@@ -1000,6 +1046,19 @@ void Debug::DrawCpu(int x, int y)
     RamX += OutText(RamX, RamY, " DP:$", 0xB0);
     RamX += OutText(RamX, RamY, _hex(cpu->getDP(), 2), 0xC0);
     RamX = x; RamY++;	// carraige return(ish)
+    if (CPU_HD6309)
+    {
+        // W = (E<<8) | F & 0x00FF
+        RamX += OutText(RamX, RamY, " W:$", 0xB0);
+        RamX += OutText(RamX, RamY, _hex(cpu->getW(), 4), 0xC0);
+        // V
+        RamX += OutText(RamX, RamY, " V:$", 0xB0);
+        RamX += OutText(RamX, RamY, _hex(cpu->getV(), 4), 0xC0);
+        // MD
+        RamX += OutText(RamX, RamY, " MD:$", 0xB0);
+        RamX += OutText(RamX, RamY, _hex(cpu->getMD(), 2), 0xC0);
+        RamX = x; RamY++;	// carraige return(ish)
+    }
 }
 
 
@@ -1186,7 +1245,7 @@ void Debug::MouseStuff()
                 mousewheel_offset = -25;
                 bMouseWheelActive = true;
             }
-            s_bSingleStep = true;	// scrollwheel enters into single step mode
+            _bSingleStep = true;	// scrollwheel enters into single step mode
             nRegisterBeingEdited.reg = Debug::EDIT_REGISTER::EDIT_NONE;	// cancel any register edits
             mousewheel_offset -= mouse_wheel * 1;		// slow scroll
             if (SDL_GetModState() & KMOD_CTRL)	// is CTRL down?
@@ -1266,7 +1325,7 @@ void Debug::MouseStuff()
         if (!bFound)
             nRegisterBeingEdited.reg = EDIT_NONE;
         // left-click on code line toggles breakpoint
-        if (mx > 38 && mx < 64 && my > 5 && my < 30 && s_bSingleStep)
+        if (mx > 38 && mx < 64 && my > 5 && my < 30 && _bSingleStep)
         {
             Word offset = sDisplayedAsm[my - 6];
             (mapBreakpoints[offset]) ?
@@ -1298,19 +1357,23 @@ void Debug::MouseStuff()
         // on PC register
         if (my == 4 && mx > 42 && mx < 47)
         {
-            s_bSingleStep = !s_bSingleStep;
-            if (!s_bSingleStep)
+            _bSingleStep = !_bSingleStep;
+            Bus::GetC6809()->Wake();
+            if (!_bSingleStep)
                 nRegisterBeingEdited.reg = Debug::EDIT_REGISTER::EDIT_NONE;	// cancel any register edits
         }
         // right-click on code line toggles breakpoint and resumes execution
-        if (mx > 38 && mx < 64 && my > 5 && my < 30 && s_bSingleStep)
+        if (mx > 38 && mx < 64 && my > 5 && my < 30 && _bSingleStep)
         {
             Word offset = sDisplayedAsm[my - 6];
             (mapBreakpoints[offset]) ?
                 mapBreakpoints[offset] = false :
                 mapBreakpoints[offset] = true;
             if (mapBreakpoints[offset] == true)
-                s_bSingleStep = false;
+            {
+                _bSingleStep = false;
+                Bus::GetC6809()->Wake();
+            }
         }
     }
     last_RMB = (btns & 4);
@@ -1447,7 +1510,7 @@ void Debug::_updateDebugScreen()
 				for (int h = 0; h < 8; h++)
 				{
 					int color = bg;
-                    Byte gd = Gfx::GetGlyphData(ch, v);                    
+                    Byte gd = Bus::GetGfx()->GetGlyphData(ch, v);                    
 					if (gd & (1 << (7 - h)))
 						color = fg;
 					_setPixel_unlocked(pixels, pitch, x + h, y + v, color);
@@ -1465,10 +1528,10 @@ void Debug::_updateDebugScreen()
 bool Debug::SingleStep()
 {
     // do nothing if singlestep is disabled
-    if (!s_bSingleStep)
+    if (!_bSingleStep)
         return true;
     // wait for space
-    if (s_bIsStepPaused)
+    if (_bIsStepPaused)
         return false;
     return true;
 }
@@ -1479,11 +1542,17 @@ void Debug::ContinueSingleStep() {
     // if breakpoint reached... enable singlestep
     if (mapBreakpoints[cpu->getPC()] == true)
     {
-        s_bIsDebugActive = true;
-        s_bSingleStep = true;
+        _bIsDebugActive = true;
+        _bSingleStep = true;
     }
     // continue from paused state?
-    s_bIsStepPaused = s_bSingleStep;
+    _bIsStepPaused = _bSingleStep.load();
+}
+
+bool Debug::IsBreakpoint(Word addr)
+{
+    auto bp = mapBreakpoints.find(addr);
+    return bp != mapBreakpoints.end() && bp->second;
 }
 
 
@@ -1510,55 +1579,62 @@ void Debug::cbReset()
     cpu->reset();
     mousewheel_offset = 0;
     bMouseWheelActive = false;
-    s_bSingleStep = true;
-    s_bIsStepPaused = true;
+    _bSingleStep = true;
+    _bIsStepPaused = true;
 }
 void Debug::cbNMI()
 {
     C6809* cpu = Bus::GetC6809();
     cpu->nmi();
-    s_bIsStepPaused = false;
+    _bIsStepPaused = false;
+    cpu->Wake();
 }
 void Debug::cbIRQ()
 {
     C6809* cpu = Bus::GetC6809();
     cpu->irq();
-    s_bIsStepPaused = false;
+    _bIsStepPaused = false;
+    cpu->Wake();
 }
 void Debug::cbFIRQ()
 {    
     C6809* cpu = Bus::GetC6809();
     cpu->firq();
-    s_bIsStepPaused = false;
+    _bIsStepPaused = false;
+    cpu->Wake();
 }
 void Debug::cbRunStop()
 {
-    (s_bSingleStep) ? s_bSingleStep = false : s_bSingleStep = true;
-    s_bIsStepPaused = s_bSingleStep;
+    (_bSingleStep) ? _bSingleStep = false : _bSingleStep = true;
+    _bIsStepPaused = _bSingleStep.load();
+    Bus::GetC6809()->Wake();
     nRegisterBeingEdited.reg = Debug::EDIT_REGISTER::EDIT_NONE;	// cancel any register edits
     bMouseWheelActive = false;
 }
 void Debug::cbHide()
 {
     bMouseWheelActive = false;
-    s_bSingleStep = false;
-    s_bIsStepPaused = s_bSingleStep;
+    _bSingleStep = false;
+    _bIsStepPaused = _bSingleStep.load();
+    Bus::GetC6809()->Wake();
     nRegisterBeingEdited.reg = Debug::EDIT_REGISTER::EDIT_NONE;	// cancel any register edits
 
-    s_bIsDebugActive = false;
+    _bIsDebugActive = false;
     SDL_MinimizeWindow(Debug::GetSDLWindow());
 }
 void Debug::cbStepIn()  //F11
 {
-    s_bSingleStep = true;
-    s_bIsStepPaused = false;
+    _bSingleStep = true;
+    _bIsStepPaused = false;
+    Bus::GetC6809()->Wake();
     nRegisterBeingEdited.reg = Debug::EDIT_REGISTER::EDIT_NONE;	// cancel any register edits
     bMouseWheelActive = false;
 }
 void Debug::cbStepOver() //F10
 {
-    s_bSingleStep = true;
-    s_bIsStepPaused = false;
+    _bSingleStep = true;
+    _bIsStepPaused = false;
+    Bus::GetC6809()->Wake();
     nRegisterBeingEdited.reg = Debug::EDIT_REGISTER::EDIT_NONE;	// cancel any register edits
     bMouseWheelActive = false;
 }
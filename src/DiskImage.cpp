@@ -0,0 +1,552 @@
+// *************************************************
+// *
+// * DiskImage.cpp
+// *
+// ***********************************
+
+#include <algorithm>
+#include <cstring>
+#include "DiskImage.hpp"
+
+constexpr char DISK_MAGIC[8] = { 'A', '6', '8', '0', '9', 'D', 'S', 'K' };
+constexpr DWord DISK_VERSION = 1;
+constexpr DWord FAT_END = 0xFFFFFFFF;               // the end of a chain, or a reserved block
+constexpr DWord FAT_PER_BLOCK = DISK_BLOCK_SIZE / 4;
+constexpr DWord DIRENT_SIZE = 64;
+constexpr DWord DIRENT_NAME = 52;                   // name bytes, the null included
+constexpr int DISK_FOLDER_DEPTH = 64;               // deepest folder loaded at mount
+
+enum DIRENT_TYPE : Byte { DT_FREE = 0, DT_FILE, DT_FOLDER };
+
+static DWord get32(const Byte* p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((DWord)p[3] << 24);
+}
+static void put32(Byte* p, DWord v)
+{
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+///// ImageFile /////////////////////////////////////////////////////////
+
+ImageFile::ImageFile(ImageVfs& vfs, int node, bool writing, bool append)
+    : _vfs(vfs), _node(node), _writing(writing), _append(append)
+{
+}
+
+ImageFile::~ImageFile()
+{
+    if (_writing)
+    {
+        _vfs._saveEntry(_node);
+        _vfs.Flush();
+    }
+}
+
+DWord ImageFile::Read(Byte* buf, DWord len)
+{
+    if (_writing)
+        return 0;
+    DWord done = _vfs._io(_node, _pos, buf, len, false, _cur_index, _cur_block);
+    _pos += done;
+    _eof = (done < len);
+    return done;
+}
+
+DWord ImageFile::Write(const Byte* buf, DWord len)
+{
+    if (!_writing)
+        return 0;
+    // appends always land at the end of the file
+    if (_append)
+        _pos = _vfs._nodes[_node].length;
+    DWord done = _vfs._io(_node, _pos, (Byte*)buf, len, true, _cur_index, _cur_block);
+    _pos += done;
+    return done;
+}
+
+bool ImageFile::Seek(long offset, int whence)
+{
+    long target = offset;
+    if (whence == SEEK_END)
+        target += _vfs._nodes[_node].length;
+    if (target < 0)
+        return false;
+    _pos = (DWord)target;
+    _eof = false;
+    return true;
+}
+
+///// MOUNT /////////////////////////////////////////////////////////////
+
+bool ImageVfs::Mount(const std::string& image, bool write_back)
+{
+    _write_back = write_back;
+    _fp = fopen(image.c_str(), write_back ? "r+b" : "rb");
+    if (!_fp)
+    {
+        // a new image, or a blank one in memory when nothing may be written
+        if (write_back && !(_fp = fopen(image.c_str(), "w+b")))
+            return false;
+        _format(DISK_IMAGE_BLOCKS);
+        return true;
+    }
+
+    Byte data[DISK_BLOCK_SIZE];
+    bool ok = fread(data, 1, DISK_BLOCK_SIZE, _fp) == DISK_BLOCK_SIZE &&
+              memcmp(data, DISK_MAGIC, sizeof(DISK_MAGIC)) == 0 &&
+              get32(data + 8) == DISK_VERSION && get32(data + 16) == 1;
+    _block_count = get32(data + 12);
+    _fat_blocks = get32(data + 20);
+    // the image file holds every block it claims to have
+    fseek(_fp, 0, SEEK_END);
+    QWord size = ftell(_fp);
+    if (!ok || _block_count < 2 || (QWord)_fat_blocks * FAT_PER_BLOCK < _block_count ||
+        _fat_blocks >= _block_count || (QWord)_block_count * DISK_BLOCK_SIZE > size)
+    {
+        fclose(_fp);
+        _fp = nullptr;
+        return false;
+    }
+    NODE root;
+    root.folder = true;
+    root.first = get32(data + 24);
+    root.length = get32(data + 28);
+
+    // the FAT stays in memory
+    _fat.assign(_block_count, FAT_END);
+    _fat_dirty.assign(_fat_blocks, false);
+    for (DWord t = 0; t < _fat_blocks; t++)
+    {
+        fseek(_fp, (long)(1 + t) * DISK_BLOCK_SIZE, SEEK_SET);
+        if (fread(data, 1, DISK_BLOCK_SIZE, _fp) != DISK_BLOCK_SIZE)
+            break;
+        for (DWord e = 0; e < FAT_PER_BLOCK && t * FAT_PER_BLOCK + e < _block_count; e++)
+            _fat[t * FAT_PER_BLOCK + e] = get32(data + e * 4);
+    }
+
+    // and so does the directory tree
+    std::vector<bool> claimed(_block_count, false);
+    if (!_claimChain(root.first, root.length, claimed))
+    {
+        fclose(_fp);
+        _fp = nullptr;
+        return false;
+    }
+    _nodes.assign(1, root);
+    _index = { { "/", 0 } };
+    _loadFolder(0, claimed, 0);
+    return true;
+}
+
+ImageVfs::~ImageVfs()
+{
+    Flush();
+    if (_fp)
+        fclose(_fp);
+}
+
+void ImageVfs::_format(DWord blocks)
+{
+    _block_count = blocks;
+    _fat_blocks = (blocks + FAT_PER_BLOCK - 1) / FAT_PER_BLOCK;
+    _fat.assign(blocks, 0);
+    for (DWord t = 0; t <= _fat_blocks; t++)
+        _fat[t] = FAT_END;      // the superblock and the FAT itself
+    _fat_dirty.assign(_fat_blocks, true);
+    NODE root;
+    root.folder = true;
+    _nodes.assign(1, root);
+    _index = { { "/", 0 } };
+
+    // the image file takes its full size up front
+    if (_write_back && _fp)
+    {
+        Byte zero[DISK_BLOCK_SIZE] = {};
+        _writeBlock(blocks - 1, zero);
+    }
+    Flush();
+}
+
+void ImageVfs::Flush()
+{
+    if (!_write_back || !_fp)
+        return;
+    for (auto& [number, b] : _cache)
+    {
+        if (b.dirty && _writeBlock(number, b.data.data()))
+            b.dirty = false;
+    }
+    Byte data[DISK_BLOCK_SIZE];
+    for (DWord t = 0; t < _fat_blocks; t++)
+    {
+        if (!_fat_dirty[t])
+            continue;
+        for (DWord e = 0; e < FAT_PER_BLOCK; e++)
+        {
+            DWord i = t * FAT_PER_BLOCK + e;
+            put32(data + e * 4, i < _block_count ? _fat[i] : FAT_END);
+        }
+        if (_writeBlock(1 + t, data))
+            _fat_dirty[t] = false;
+    }
+    memset(data, 0, sizeof(data));
+    memcpy(data, DISK_MAGIC, sizeof(DISK_MAGIC));
+    put32(data + 8, DISK_VERSION);
+    put32(data + 12, _block_count);
+    put32(data + 16, 1);
+    put32(data + 20, _fat_blocks);
+    put32(data + 24, _nodes[0].first);
+    put32(data + 28, _nodes[0].length);
+    _writeBlock(0, data);
+    fflush(_fp);
+}
+
+///// DIRECTORY TREE ////////////////////////////////////////////////////
+
+std::string ImageVfs::Resolve(const std::string& path)
+{
+    std::string in = (!path.empty() && path[0] == '/') ? path : _cwd + "/" + path;
+    std::vector<std::string> parts;
+    size_t start = 0;
+    while (start <= in.size())
+    {
+        size_t end = in.find('/', start);
+        if (end == std::string::npos)
+            end = in.size();
+        std::string part = in.substr(start, end - start);
+        if (part == "..")
+        {
+            if (!parts.empty())
+                parts.pop_back();
+        }
+        else if (!part.empty() && part != ".")
+            parts.push_back(part);
+        start = end + 1;
+    }
+    std::string full;
+    for (auto& part : parts)
+        full += "/" + part;
+    return full.empty() ? "/" : full;
+}
+
+std::string ImageVfs::_path(int node)
+{
+    if (_nodes[node].parent < 0)
+        return "/";
+    std::string parent = _path(_nodes[node].parent);
+    return (parent == "/" ? parent : parent + "/") + _nodes[node].name;
+}
+
+int ImageVfs::_find(const std::string& path)
+{
+    auto it = _index.find(Resolve(path));
+    return it == _index.end() ? -1 : it->second;
+}
+
+void ImageVfs::_loadFolder(int node, std::vector<bool>& claimed, int depth)
+{
+    DWord cur_index = 0, cur_block = 0;
+    Byte e[DIRENT_SIZE];
+    for (DWord pos = 0; pos + DIRENT_SIZE <= _nodes[node].length; pos += DIRENT_SIZE)
+    {
+        if (_io(node, pos, e, DIRENT_SIZE, false, cur_index, cur_block) != DIRENT_SIZE)
+            break;
+        Byte type = e[DIRENT_NAME];
+        if (type != DT_FILE && type != DT_FOLDER)
+            continue;
+        NODE child;
+        child.name.assign((const char*)e, strnlen((const char*)e, DIRENT_NAME - 1));
+        child.folder = (type == DT_FOLDER);
+        child.first = get32(e + 56);
+        child.length = get32(e + 60);
+        child.parent = node;
+        child.slot = pos;
+        if ((child.folder && depth >= DISK_FOLDER_DEPTH) || !_claimChain(child.first, child.length, claimed))
+            continue;
+        int id = (int)_nodes.size();
+        _nodes.push_back(child);
+        _nodes[node].children.push_back(id);
+        _index[_path(id)] = id;
+        if (child.folder)
+            _loadFolder(id, claimed, depth + 1);
+    }
+}
+
+// the blocks that hold length bytes from first, if they are all data blocks that no
+// other entry has claimed (which also stops a chain or folder that loops back on itself)
+bool ImageVfs::_claimChain(DWord first, DWord length, std::vector<bool>& claimed)
+{
+    if (!first)
+        return length == 0;
+    QWord count = std::max<QWord>(1, ((QWord)length + DISK_BLOCK_SIZE - 1) / DISK_BLOCK_SIZE);
+    if (count > _block_count)
+        return false;
+    std::vector<DWord> blocks;
+    DWord b = first;
+    for (QWord t = 0; t < count; t++)
+    {
+        if (!_isData(b) || claimed[b])
+        {
+            for (DWord c : blocks)
+                claimed[c] = false;
+            return false;
+        }
+        claimed[b] = true;
+        blocks.push_back(b);
+        b = _fat[b];
+    }
+    return true;
+}
+
+int ImageVfs::_create(const std::string& path, bool folder)
+{
+    std::string full = Resolve(path);
+    size_t cut = full.rfind('/');
+    std::string name = full.substr(cut + 1);
+    auto it = _index.find(cut ? full.substr(0, cut) : "/");
+    if (name.empty() || name.size() >= DIRENT_NAME || it == _index.end() || !_nodes[it->second].folder)
+        return -1;
+
+    // a new entry at the end of its folder
+    int parent = it->second;
+    NODE n;
+    n.name = name;
+    n.folder = folder;
+    n.parent = parent;
+    n.slot = _nodes[parent].length;
+    int id = (int)_nodes.size();
+    _nodes.push_back(n);
+    if (!_saveEntry(id))
+    {
+        _nodes.pop_back();      // the image is full
+        return -1;
+    }
+    _nodes[parent].children.push_back(id);
+    _index[full] = id;
+    _saveEntry(parent);         // its new length
+    return id;
+}
+
+bool ImageVfs::_saveEntry(int node)
+{
+    const NODE& n = _nodes[node];
+    if (n.parent < 0)
+        return true;
+    Byte e[DIRENT_SIZE] = {};
+    memcpy(e, n.name.data(), n.name.size());
+    e[DIRENT_NAME] = n.folder ? DT_FOLDER : DT_FILE;
+    put32(e + 56, n.first);
+    put32(e + 60, n.length);
+    DWord cur_index = 0, cur_block = 0;
+    return _io(n.parent, n.slot, e, DIRENT_SIZE, true, cur_index, cur_block) == DIRENT_SIZE;
+}
+
+void ImageVfs::_truncate(int node)
+{
+    DWord b = _nodes[node].first;
+    while (_isData(b))
+    {
+        DWord next = _fat[b];
+        _setFat(b, 0);
+        _next_free = std::min(_next_free, b);
+        b = next;
+    }
+    _nodes[node].first = 0;
+    _nodes[node].length = 0;
+    _saveEntry(node);
+}
+
+///// Vfs ///////////////////////////////////////////////////////////////
+
+std::unique_ptr<VfsFile> ImageVfs::Open(const std::string& path, const char* mode)
+{
+    bool writing = (mode[0] != 'r');
+    int node = _find(path);
+    if (node < 0 && writing)
+        node = _create(path, false);
+    if (node < 0 || _nodes[node].folder)
+        return nullptr;
+    if (mode[0] == 'w')
+        _truncate(node);
+    return std::make_unique<ImageFile>(*this, node, writing, mode[0] == 'a');
+}
+
+bool ImageVfs::Stat(const std::string& path, bool& folder, DWord& length)
+{
+    int node = _find(path);
+    if (node < 0)
+        return false;
+    folder = _nodes[node].folder;
+    length = folder ? 0 : _nodes[node].length;
+    return true;
+}
+
+bool ImageVfs::MakeDir(const std::string& path)
+{
+    if (_find(path) >= 0 || _create(path, true) < 0)
+        return false;
+    Flush();
+    return true;
+}
+
+bool ImageVfs::ChangeDir(const std::string& path)
+{
+    int node = _find(path);
+    if (node < 0 || !_nodes[node].folder)
+        return false;
+    _cwd = _path(node);
+    return true;
+}
+
+bool ImageVfs::OpenDir(const std::string& path)
+{
+    int node = _find(path);
+    _list_node = (node >= 0 && _nodes[node].folder) ? node : -1;
+    _list_pos = 0;
+    return _list_node >= 0;
+}
+
+bool ImageVfs::NextEntry(std::string& name, bool& folder)
+{
+    if (_list_node < 0 || _list_pos >= _nodes[_list_node].children.size())
+        return false;
+    const NODE& n = _nodes[_nodes[_list_node].children[_list_pos++]];
+    name = n.name;
+    folder = n.folder;
+    return true;
+}
+
+///// BLOCKS ////////////////////////////////////////////////////////////
+
+// bytes of a file or folder, through the block cache
+DWord ImageVfs::_io(int node, DWord pos, Byte* buf, DWord len, bool write, DWord& cur_index, DWord& cur_block)
+{
+    if (!write)
+    {
+        DWord length = _nodes[node].length;
+        len = (pos < length) ? std::min(len, length - pos) : 0;
+    }
+    DWord done = 0;
+    while (done < len)
+    {
+        DWord block = _chain(node, (pos + done) / DISK_BLOCK_SIZE, cur_index, cur_block, write);
+        if (!block)
+            break;      // the image is full
+        DWord ofs = (pos + done) % DISK_BLOCK_SIZE;
+        DWord n = std::min(len - done, DISK_BLOCK_SIZE - ofs);
+        Byte* data = _block(block, write);
+        if (write)
+            memcpy(data + ofs, buf + done, n);
+        else
+            memcpy(buf + done, data + ofs, n);
+        done += n;
+    }
+    if (write && pos + done > _nodes[node].length)
+        _nodes[node].length = pos + done;
+    return done;
+}
+
+// the block at index along a chain, grown to reach it when writing (0 if it cannot)
+DWord ImageVfs::_chain(int node, DWord index, DWord& cur_index, DWord& cur_block, bool grow)
+{
+    NODE& n = _nodes[node];
+    if (n.first && !_isData(n.first))
+        return 0;
+    if (!n.first)
+    {
+        if (!grow || !(n.first = _alloc()))
+            return 0;
+        cur_block = 0;
+    }
+    DWord i = 0, b = n.first;
+    if (cur_block && cur_index <= index)
+    {
+        i = cur_index;
+        b = cur_block;
+    }
+    while (i < index)
+    {
+        DWord next = _fat[b];
+        if (!_isData(next))
+        {
+            if (!grow || !(next = _alloc()))
+                return 0;
+            _setFat(b, next);
+        }
+        b = next;
+        i++;
+    }
+    cur_index = i;
+    cur_block = b;
+    return b;
+}
+
+DWord ImageVfs::_alloc()
+{
+    for (DWord t = 0; t < _block_count; t++)
+    {
+        DWord b = (_next_free + t) % _block_count;
+        if (_fat[b] == 0)
+        {
+            _setFat(b, FAT_END);
+            _next_free = b + 1;
+            _block(b, true, true);
+            return b;
+        }
+    }
+    return 0;
+}
+
+void ImageVfs::_setFat(DWord block, DWord next)
+{
+    _fat[block] = next;
+    _fat_dirty[block / FAT_PER_BLOCK] = true;
+}
+
+Byte* ImageVfs::_block(DWord block, bool write, bool fresh)
+{
+    auto it = _cache.find(block);
+    if (it != _cache.end())
+    {
+        _stats.hits++;
+        _lru.splice(_lru.begin(), _lru, it->second.lru);
+    }
+    else
+    {
+        _stats.misses++;
+        // make room from the least recently used end, dirty blocks stay
+        // unless they can be written back
+        auto victim = _lru.end();
+        while (_cache.size() >= DISK_CACHE_BLOCKS && victim != _lru.begin())
+        {
+            --victim;
+            BLOCK& v = _cache[*victim];
+            if (v.dirty && (!_write_back || !_writeBlock(*victim, v.data.data())))
+                continue;
+            _cache.erase(*victim);
+            victim = _lru.erase(victim);
+        }
+        it = _cache.emplace(block, BLOCK()).first;
+        BLOCK& b = it->second;
+        _lru.push_front(block);
+        b.lru = _lru.begin();
+        if (fresh || !_fp || fseek(_fp, (long)block * DISK_BLOCK_SIZE, SEEK_SET) != 0 ||
+            fread(b.data.data(), 1, DISK_BLOCK_SIZE, _fp) != DISK_BLOCK_SIZE)
+            b.data.fill(0);
+    }
+    if (write)
+        it->second.dirty = true;
+    return it->second.data.data();
+}
+
+bool ImageVfs::_writeBlock(DWord block, const Byte* data)
+{
+    if (!_fp || fseek(_fp, (long)block * DISK_BLOCK_SIZE, SEEK_SET) != 0)
+        return false;
+    _stats.flushes++;
+    return fwrite(data, 1, DISK_BLOCK_SIZE, _fp) == DISK_BLOCK_SIZE;
+}
@@ -0,0 +1,300 @@
+// *************************************************
+// *
+// * Dma.cpp
+// *
+// ***********************************
+
+#include <cstring>
+#include "Bus.hpp"
+#include "Dma.hpp"
+#include "C6809.hpp"
+#include "Gfx.hpp"
+#include "Memory.hpp"
+#include "MemBank.hpp"
+
+Byte Dma::read(Word offset, bool debug)
+{
+    Byte data = IDevice::read(offset);
+    // printf("%s::read($%04X) = $%02X\n", Name().c_str(), offset,  data);
+
+    CHANNEL& c = _channels[_channel];
+    switch (offset)
+    {
+        case DMA_CHANNEL:       data = _channel;    break;
+        case DMA_CONTROL:
+            data = c.control & ~CTRL_START;
+            if (_busy_mask & (1<<_channel))     data |= CTRL_START;
+            break;
+        case DMA_STATUS:        data = (_busy_mask << 4) | _status;    break;
+        case DMA_SRC_TYPE:      data = c.src_type;  break;
+        case DMA_SRC_PAGE:      data = c.src_page;  break;
+        case DMA_SRC_ADDR+0:    data = (c.src_addr>>8) & 0xFF;  break;
+        case DMA_SRC_ADDR+1:    data = (c.src_addr>>0) & 0xFF;  break;
+        case DMA_DST_TYPE:      data = c.dst_type;  break;
+        case DMA_DST_PAGE:      data = c.dst_page;  break;
+        case DMA_DST_ADDR+0:    data = (c.dst_addr>>8) & 0xFF;  break;
+        case DMA_DST_ADDR+1:    data = (c.dst_addr>>0) & 0xFF;  break;
+        case DMA_LENGTH+0:      data = (c.length>>8) & 0xFF;    break;
+        case DMA_LENGTH+1:      data = (c.length>>0) & 0xFF;    break;
+    }
+
+    IDevice::write(offset,data);   // update any internal changes too
+    return data;
+}
+
+void Dma::write(Word offset, Byte data, bool debug)
+{
+    // printf("%s::write($%04X, $%02X)\n", Name().c_str(), offset, data);
+
+    CHANNEL& c = _channels[_channel];
+    switch (offset)
+    {
+        case DMA_CHANNEL:       _channel = data % DMA_CHANNELS;  data = _channel;    break;
+        case DMA_CONTROL:
+        {
+            c.control = data;
+            if (data & CTRL_START)
+                _start(_channel);
+            else if (_busy_mask & (1<<_channel))
+            {
+                // abort the transfer in progress
+                _busy_mask &= ~(1<<_channel);
+                _steal_mask &= ~(1<<_channel);
+                c.buffer.clear();
+            }
+            break;
+        }
+        case DMA_STATUS:        _status &= ~(data & 0x0F);  break;     // acknowledge
+        case DMA_SRC_TYPE:      c.src_type = (data < TARGET_MAX) ? data : TARGET_CPU;  break;
+        case DMA_SRC_PAGE:      c.src_page = data;  break;
+        case DMA_SRC_ADDR+0:    c.src_addr = (c.src_addr & 0x00FF) | (data << 8);  break;
+        case DMA_SRC_ADDR+1:    c.src_addr = (c.src_addr & 0xFF00) | (data << 0);  break;
+        case DMA_DST_TYPE:      c.dst_type = (data < TARGET_MAX) ? data : TARGET_CPU;  break;
+        case DMA_DST_PAGE:      c.dst_page = data;  break;
+        case DMA_DST_ADDR+0:    c.dst_addr = (c.dst_addr & 0x00FF) | (data << 8);  break;
+        case DMA_DST_ADDR+1:    c.dst_addr = (c.dst_addr & 0xFF00) | (data << 0);  break;
+        case DMA_LENGTH+0:      c.length = (c.length & 0x00FF) | (data << 8);  break;
+        case DMA_LENGTH+1:      c.length = (c.length & 0xFF00) | (data << 0);  break;
+    }
+
+    IDevice::write(offset,data);   // update any internal changes too
+}
+
+Word Dma::OnAttach(Word nextAddr)
+{
+    // printf("%s::OnAttach()\n", Name().c_str());
+    Word old_addr = nextAddr;
+    Byte enumID = 0;
+
+    DisplayEnum("", 0,                          "DMA Controller Hardware Registers");
+    DisplayEnum("DMA_BEGIN",        nextAddr,   "Start of DMA Controller Hardware Registers");
+    DisplayEnum("DMA_CHANNEL",      nextAddr,   "(Byte) selects the active DMA channel (0-3)");  nextAddr++;
+    DisplayEnum("DMA_CONTROL",      nextAddr,   "(Byte) control register for the active channel"); nextAddr++;
+	DisplayEnum("",                         0,  "     bit 7:    write 1=start transfer, read 1=busy");
+	DisplayEnum("",                         0,  "     bit 6:    1=raise an interrupt on completion");
+	DisplayEnum("",                         0,  "     bit 5:    interrupt type: 0=IRQ, 1=FIRQ");
+	DisplayEnum("",                         0,  "     bit 4:    0=instant, 1=cycle-stealing");
+	DisplayEnum("",                         0,  "     bits 0-3: reserved");
+    DisplayEnum("DMA_STATUS",       nextAddr,   "(Byte) channel status flags");                  nextAddr++;
+	DisplayEnum("",                         0,  "     bits 4-7: channel busy (read only)");
+	DisplayEnum("",                         0,  "     bits 0-3: channel complete (write 1 to acknowledge)");
+    DisplayEnum("DMA_SRC_TYPE",     nextAddr,   "(Byte) source type");                           nextAddr++;
+	DisplayEnum("DMA_TYPE_CPU",     enumID++,   "     CPU address space");
+	DisplayEnum("DMA_TYPE_EXT",     enumID++,   "     extended memory");
+	DisplayEnum("DMA_TYPE_BANK",    enumID++,   "     banked memory page");
+	DisplayEnum("DMA_TYPE_PALETTE", enumID++,   "     color palette (two bytes per color)");
+	DisplayEnum("DMA_TYPE_GLYPH",   enumID++,   "     glyph table (eight bytes per glyph)");
+    DisplayEnum("DMA_SRC_PAGE",     nextAddr,   "(Byte) source page (DMA_TYPE_BANK)");           nextAddr++;
+    DisplayEnum("DMA_SRC_ADDR",     nextAddr,   "(Word) source address");                        nextAddr+=2;
+    DisplayEnum("DMA_DST_TYPE",     nextAddr,   "(Byte) destination type");                      nextAddr++;
+    DisplayEnum("DMA_DST_PAGE",     nextAddr,   "(Byte) destination page (DMA_TYPE_BANK)");      nextAddr++;
+    DisplayEnum("DMA_DST_ADDR",     nextAddr,   "(Word) destination address");                   nextAddr+=2;
+    DisplayEnum("DMA_LENGTH",       nextAddr,   "(Word) number of bytes to transfer");           nextAddr+=2;
+    DisplayEnum("DMA_END", nextAddr,            "End of DMA Controller Hardware Registers");
+    DisplayEnum("", 0, "");
+
+    return nextAddr - old_addr;
+}
+
+void Dma::OnInit()
+{
+    // printf("%s::OnInit()\n", Name().c_str());
+    for (auto& c : _channels)
+        c = CHANNEL();
+    _channel = 0;
+    _status = 0;
+    _busy_mask = 0;
+    _steal_mask = 0;
+}
+
+void Dma::OnQuit()
+{
+    // printf("%s::OnQuit()\n", Name().c_str());
+
+    // drop any transfers still in flight
+    for (auto& c : _channels)
+        c.buffer.clear();
+    _busy_mask = 0;
+    _steal_mask = 0;
+}
+
+
+// latch the source block and either complete the transfer now
+// or hand it to the cycle-stealing scheduler
+void Dma::_start(int ch)
+{
+    CHANNEL& c = _channels[ch];
+    c.pos = 0;
+    c.buffer.resize(c.length);
+    read_block(c.src_type, c.src_page, c.src_addr, c.buffer.data(), c.length);
+    _status &= ~(1<<ch);
+    _busy_mask |= (1<<ch);
+    if ((c.control & CTRL_STEAL) && c.length > 0)
+    {
+        _steal_mask |= (1<<ch);
+        return;
+    }
+    write_block(c.dst_type, c.dst_page, c.dst_addr, c.buffer.data(), c.length);
+    c.pos = c.length;
+    _complete(ch);
+}
+
+void Dma::_complete(int ch)
+{
+    CHANNEL& c = _channels[ch];
+    c.buffer.clear();
+    _busy_mask &= ~(1<<ch);
+    _steal_mask &= ~(1<<ch);
+    _status |= (1<<ch);     // the interrupt is raised by _hold_interrupts()
+}
+
+// assert the interrupt line of every completed channel not yet acknowledged
+void Dma::_hold_interrupts()
+{
+    C6809* cpu = Bus::GetC6809();
+    if (!cpu)
+        return;
+    for (int ch = 0; ch < DMA_CHANNELS; ch++)
+    {
+        Byte control = _channels[ch].control;
+        if (!(_status & (1<<ch)) || !(control & CTRL_INT))
+            continue;
+        if (control & CTRL_FIRQ)
+            cpu->firq();
+        else
+            cpu->irq();
+    }
+}
+
+// move one byte for the highest priority cycle-stealing channel
+bool Dma::_steal_cycle()
+{
+    for (int ch = 0; ch < DMA_CHANNELS; ch++)
+    {
+        if (!(_steal_mask & (1<<ch)))
+            continue;
+        CHANNEL& c = _channels[ch];
+        // banked pages may be file backed... commit those as one block at the end
+        if (c.dst_type != TARGET_BANK)
+            write_block(c.dst_type, c.dst_page, c.dst_addr + c.pos, &c.buffer[c.pos], 1);
+        if (++c.pos >= c.length)
+        {
+            if (c.dst_type == TARGET_BANK)
+                write_block(c.dst_type, c.dst_page, c.dst_addr, c.buffer.data(), c.length);
+            _complete(ch);
+        }
+        return true;
+    }
+    return false;
+}
+
+void Dma::read_block(Byte type, Byte page, Word addr, Byte* buf, DWord len)
+{
+    switch (type)
+    {
+        case TARGET_CPU:
+            for (DWord t=0; t<len; t++)
+                buf[t] = Bus::Read((Word)(addr + t));
+            break;
+        case TARGET_EXT:
+        {
+            Memory* mem = Bus::GetMemory();
+            for (DWord t=0; t<len; t++)
+                buf[t] = mem->ext_memory[(Word)(addr + t)];
+            break;
+        }
+        case TARGET_BANK:
+            Bus::GetMemBank()->read_block((DWord)page * PAGED_MEMORY_BANKSIZE + addr, buf, len);
+            break;
+        case TARGET_PALETTE:
+        {
+            Gfx* gfx = Bus::GetGfx();
+            DWord size = gfx->_palette.size() * 2;
+            if (size == 0)  { memset(buf, 0, len);  break; }
+            for (DWord t=0; t<len; t++)
+            {
+                DWord ofs = (addr + t) % size;
+                Word color = gfx->_palette[ofs >> 1].color;
+                buf[t] = (ofs & 1) ? (color & 0xFF) : (color >> 8);
+            }
+            break;
+        }
+        case TARGET_GLYPH:
+        {
+            Gfx* gfx = Bus::GetGfx();
+            for (DWord t=0; t<len; t++)
+            {
+                Word ofs = (addr + t) & 0x07FF;
+                buf[t] = gfx->_gfx_glyph_data[ofs >> 3][ofs & 7];
+            }
+            break;
+        }
+    }
+}
+
+void Dma::write_block(Byte type, Byte page, Word addr, const Byte* buf, DWord len)
+{
+    switch (type)
+    {
+        case TARGET_CPU:
+            for (DWord t=0; t<len; t++)
+                Bus::Write((Word)(addr + t), buf[t]);
+            break;
+        case TARGET_EXT:
+        {
+            Memory* mem = Bus::GetMemory();
+            for (DWord t=0; t<len; t++)
+                mem->ext_memory[(Word)(addr + t)] = buf[t];
+            break;
+        }
+        case TARGET_BANK:
+            Bus::GetMemBank()->write_block((DWord)page * PAGED_MEMORY_BANKSIZE + addr, buf, len);
+            break;
+        case TARGET_PALETTE:
+        {
+            Gfx* gfx = Bus::GetGfx();
+            DWord size = gfx->_palette.size() * 2;
+            if (size == 0)  break;
+            for (DWord t=0; t<len; t++)
+            {
+                DWord ofs = (addr + t) % size;
+                Word& color = gfx->_palette[ofs >> 1].color;
+                if (ofs & 1)
+                    color = (color & 0xFF00) | buf[t];
+                else
+                    color = (color & 0x00FF) | ((Word)buf[t] << 8);
+            }
+            break;
+        }
+        case TARGET_GLYPH:
+        {
+            Gfx* gfx = Bus::GetGfx();
+            for (DWord t=0; t<len; t++)
+            {
+                Word ofs = (addr + t) & 0x07FF;
+                gfx->_gfx_glyph_data[ofs >> 3][ofs & 7] = buf[t];
+            }
+            break;
+        }
+    }
+}
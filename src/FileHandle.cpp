@@ -0,0 +1,259 @@
+// *************************************************
+// *
+// * FileHandle.cpp
+// *
+// ***********************************
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#ifdef __linux__
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+#include "FileHandle.hpp"
+
+bool FileHandle::Open(const std::string& path, const char* mode)
+{
+    Close();
+    _fp = fopen(path.c_str(), mode);
+    if (!_fp)
+        return false;
+    _path = path;
+    _writing = (mode[0] != 'r');
+    _append = (mode[0] == 'a');
+    _eof = false;
+    _pos = 0;
+    _buf_start = 0;
+    _buf_len = 0;
+
+    #ifdef __linux__
+    if (FILE_MMAP_READS && !_writing)
+    {
+        struct stat st;
+        if (fstat(fileno(_fp), &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 && st.st_size <= 0xFFFFFFFF)
+        {
+            void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fileno(_fp), 0);
+            if (p != MAP_FAILED)
+            {
+                _map = (const Byte*)p;
+                _map_len = (DWord)st.st_size;
+                _stats.mapped++;
+            }
+        }
+    }
+    #endif
+
+    // the handle does its own buffering
+    if (!_map)
+    {
+        setvbuf(_fp, nullptr, _IONBF, 0);
+        _buf.resize(_writing ? FILE_WRITE_BEHIND : FILE_READ_AHEAD);
+    }
+    return true;
+}
+
+void FileHandle::Close()
+{
+    if (!_fp)
+        return;
+    _flush();
+    #ifdef __linux__
+    if (_map)
+        munmap((void*)_map, _map_len);
+    #endif
+    _map = nullptr;
+    _map_len = 0;
+    fclose(_fp);
+    _fp = nullptr;
+    std::vector<Byte>().swap(_buf);
+    // the length it cached before the writes is stale now
+    if (_writing && _stat_cache)
+        _stat_cache->Invalidate(_path);
+}
+
+int VfsFile::GetC()
+{
+    Byte c;
+    return Read(&c, 1) == 1 ? c : EOF;
+}
+
+int VfsFile::PutC(Byte c)
+{
+    return Write(&c, 1) == 1 ? c : EOF;
+}
+
+DWord FileHandle::Read(Byte* buf, DWord len)
+{
+    if (!_fp || _writing)
+        return 0;
+    DWord done = 0;
+    if (_map)
+    {
+        DWord mapped = _mapped();
+        done = (_pos < mapped) ? std::min(len, mapped - _pos) : 0;
+        memcpy(buf, _map + _pos, done);
+        _pos += done;
+        _stats.hits++;
+    }
+    else
+    {
+        bool missed = false;
+        while (done < len)
+        {
+            // outside the read-ahead window
+            if (_pos < _buf_start || _pos >= _buf_start + _buf_len)
+            {
+                missed = true;
+                if (!_fill())
+                    break;
+            }
+            DWord n = std::min(len - done, _buf_start + _buf_len - _pos);
+            memcpy(buf + done, _buf.data() + (_pos - _buf_start), n);
+            _pos += n;
+            done += n;
+        }
+        if (missed)
+            _stats.misses++;
+        else
+            _stats.hits++;
+    }
+    _eof = (done < len);
+    return done;
+}
+
+DWord FileHandle::Write(const Byte* buf, DWord len)
+{
+    if (!_fp || !_writing)
+        return 0;
+    bool missed = false;
+    DWord done = 0;
+    while (done < len)
+    {
+        // appends always land at the end of the file
+        if (_append)
+            _pos = _buf_len ? _buf_start + _buf_len : _length();
+        // the window only grows at its end
+        if (_buf_len && (_pos != _buf_start + _buf_len || _buf_len == _buf.size()))
+        {
+            missed = true;
+            if (!_flush())
+                break;
+        }
+        if (!_buf_len)
+            _buf_start = _pos;
+        DWord n = std::min(len - done, (DWord)_buf.size() - _buf_len);
+        memcpy(_buf.data() + _buf_len, buf + done, n);
+        _buf_len += n;
+        _pos += n;
+        done += n;
+    }
+    if (missed)
+        _stats.misses++;
+    else
+        _stats.hits++;
+    return done;
+}
+
+bool FileHandle::Seek(long offset, int whence)
+{
+    if (!_fp)
+        return false;
+    long target = offset;
+    if (whence == SEEK_END)
+        target += _length();
+    if (target < 0)
+        return false;
+    _pos = (DWord)target;
+    _eof = false;
+    return true;
+}
+
+bool FileHandle::_fill()
+{
+    _buf_start = _pos;
+    #ifdef __linux__
+    ssize_t n = pread(fileno(_fp), _buf.data(), _buf.size(), _pos);
+    _buf_len = (n > 0) ? (DWord)n : 0;
+    #else
+    fseek(_fp, _pos, SEEK_SET);
+    _buf_len = fread(_buf.data(), 1, _buf.size(), _fp);
+    #endif
+    return _buf_len > 0;
+}
+
+bool FileHandle::_flush()
+{
+    if (!_writing || !_buf_len)
+        return true;
+    fseek(_fp, _buf_start, SEEK_SET);
+    DWord n = fwrite(_buf.data(), 1, _buf_len, _fp);
+    bool ok = (n == _buf_len);
+    _buf_len = 0;
+    _stats.flushes++;
+    return ok;
+}
+
+DWord FileHandle::_length()
+{
+    if (_map)
+        return _mapped();
+    fseek(_fp, 0, SEEK_END);
+    DWord length = ftell(_fp);
+    if (_writing && _buf_len)
+        length = std::max(length, _buf_start + _buf_len);
+    return length;
+}
+
+DWord FileHandle::_mapped()
+{
+    #ifdef __linux__
+    // the file may have been truncated since it was mapped
+    struct stat st;
+    if (fstat(fileno(_fp), &st) != 0)
+        return 0;
+    if ((QWord)st.st_size < _map_len)
+        return (DWord)st.st_size;
+    #endif
+    return _map_len;
+}
+
+///// FileStatCache /////////////////////////////////////////////////////
+
+bool FileStatCache::Exists(const std::string& path)
+{
+    return _lookup(path).exists;
+}
+
+bool FileStatCache::Stat(const std::string& path, bool& folder, DWord& length)
+{
+    const ENTRY& e = _lookup(path);
+    folder = e.folder;
+    length = e.length;
+    return e.exists;
+}
+
+const FileStatCache::ENTRY& FileStatCache::_lookup(const std::string& path)
+{
+    auto now = std::chrono::steady_clock::now();
+    auto it = _cache.find(path);
+    if (it != _cache.end() && now - it->second.when < std::chrono::milliseconds(FILE_STAT_TTL))
+    {
+        _stats.stat_hits++;
+        return it->second;
+    }
+    _stats.stat_misses++;
+    ENTRY e;
+    e.when = now;
+    std::error_code ec;
+    auto status = std::filesystem::status(path, ec);
+    e.exists = !ec && std::filesystem::exists(status);
+    e.folder = e.exists && std::filesystem::is_directory(status);
+    if (e.exists && std::filesystem::is_regular_file(status))
+    {
+        auto size = std::filesystem::file_size(path, ec);
+        e.length = ec ? 0 : (DWord)size;
+    }
+    return _cache[path] = e;
+}
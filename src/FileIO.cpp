@@ -10,13 +10,19 @@
 #include <filesystem>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <algorithm>
+#include <thread>
 
 #include "C6809.hpp"
 #include "Bus.hpp"
 #include "FileIO.hpp"
+#include "Dma.hpp"
+#include "MemBank.hpp"
+#include "DiskImage.hpp"
+#include "Loader.hpp"
 
 
 
@@ -25,6 +31,10 @@ Byte FileIO::read(Word offset, bool debug)
     Byte data = IDevice::read(offset);
     // printf("%s::read($%04X) = $%02X\n", Name().c_str(), offset,  data);
 
+    // the registers belong to a queued command until it completes
+    if (_busy && offset != FIO_STATUS && offset != FIO_COMMAND)
+        return 0;
+
     switch (offset)
     {
         case FIO_ERROR: 
@@ -33,7 +43,7 @@ Byte FileIO::read(Word offset, bool debug)
             fio_error_code = FILE_ERROR::FE_NOERROR;
             break;
         }
-        case FIO_PATH_LEN:  data = dir_data.size(); break;
+        case FIO_PATH_LEN:  data = filePath.size(); break;
         case FIO_PATH_POS:  
         {
             data = path_char_pos;
@@ -49,33 +59,20 @@ Byte FileIO::read(Word offset, bool debug)
             if (filePath.size() > 0)
             {
                 if (path_char_pos < filePath.size())
-                {
-                    data = (Byte)filePath.substr(path_char_pos, 1).at(0);
-                    if (path_char_pos <= filePath.size())
-                        path_char_pos++;
-                }
+                    data = (Byte)filePath[path_char_pos++];
                 else
-                {
-                    filePath = "";
-                    data = 0;
-                }
+                    filePath.clear();   // keeps its capacity
             }
             break;
         }
         case FIO_DIR_DATA: // (Byte) a series of $0a--terminated filenames
         {
+            // the listing is formatted a line at a time as it is read
+            if (dir_data_pos >= (int)dir_data.size())
+                _dirNextLine();
             data = 0;
             if (dir_data_pos < (int)dir_data.size())
-            {
-                data = (Byte)dir_data.substr(dir_data_pos, 1).at(0);
-                if (dir_data_pos <= (int)dir_data.size())
-                    dir_data_pos++;
-            }
-            else
-            {
-                dir_data = "";
-                data = 0;
-            }
+                data = (Byte)dir_data[dir_data_pos++];
             break;
         }
         case FIO_COMMAND:   data = IDevice::read(offset);   break;
@@ -85,6 +82,17 @@ Byte FileIO::read(Word offset, bool debug)
         case FIO_SEEKPOS+2: data = (_seek_pos>>16) & 0xFF;  break;
         case FIO_SEEKPOS+3: data = (_seek_pos>>24) & 0xFF;  break;
         case FIO_IODATA:    data = _io_data;                break;
+        case FIO_BLK_TYPE:  data = _blk_type;               break;
+        case FIO_BLK_PAGE:  data = _blk_page;               break;
+        case FIO_BLK_ADDR+0: data = (_blk_addr>>8) & 0xFF;  break;
+        case FIO_BLK_ADDR+1: data = (_blk_addr>>0) & 0xFF;  break;
+        case FIO_BLK_LEN+0: data = (_blk_len>>8) & 0xFF;    break;
+        case FIO_BLK_LEN+1: data = (_blk_len>>0) & 0xFF;    break;
+        case FIO_BLK_COUNT+0: data = (_blk_count>>24) & 0xFF;  break;
+        case FIO_BLK_COUNT+1: data = (_blk_count>>16) & 0xFF;  break;
+        case FIO_BLK_COUNT+2: data = (_blk_count>> 8) & 0xFF;  break;
+        case FIO_BLK_COUNT+3: data = (_blk_count>> 0) & 0xFF;  break;
+        case FIO_STATUS:    data = _status | (_busy ? STAT_BUSY : 0);  break;
     }
     IDevice::write(offset,data);   // update any internal changes too
     return data;
@@ -94,6 +102,10 @@ void FileIO::write(Word offset, Byte data, bool debug)
 {
     // printf("%s::write($%04X, $%02X)\n", Name().c_str(), offset, data);    
 
+    // the registers belong to a queued command until it completes
+    if (_busy && offset != FIO_STATUS && offset != FIO_COMMAND)
+        return;
+
     switch (offset)
     {
         case FIO_ERROR: fio_error_code = (FILE_ERROR)data; break;
@@ -104,55 +116,24 @@ void FileIO::write(Word offset, Byte data, bool debug)
             break;
         case FIO_PATH_DATA:
         {
-            if (path_char_pos == 0)
-            {
-                filePath = "";
-                path_char_pos = 0;
-
-                filePath += data;
-                path_char_pos++;
-            }
-            else
-            {
-                filePath = filePath.substr(0, path_char_pos);
-                filePath += data;
-                path_char_pos++;
-            }
+            // truncate at the cursor and append, within the reserved capacity
+            if (path_char_pos < filePath.size())
+                filePath.resize(path_char_pos);
+            filePath += data;
+            path_char_pos++;
             break;
         }
         case FIO_COMMAND:
         {
-            switch (data)
-            {                
-                case FC_RESET:      _cmd_reset();                         break;
-                case FC_SHUTDOWN:   _cmd_system_shutdown();               break;
-                case FC_COMPDATE:   _cmd_system_load_comilation_date();   break;
-                case FC_FILEEXISTS: _cmd_does_file_exist();               break;
-                case FC_OPENREAD:   _cmd_open_read();                     break;
-                case FC_OPENWRITE:  _cmd_open_write();                    break;
-                case FC_OPENAPPEND: _cmd_open_append();                   break;
-                case FC_CLOSEFILE:  _cmd_close_file();                    break;    
-                case FC_READBYTE:   _cmd_read_byte();                     break;    
-                case FC_WRITEBYTE:  _cmd_write_byte();                    break;
-                case FC_LOADHEX:    _cmd_load_hex_file();                 break;    
-                case FC_GETLENGTH:  _cmd_get_file_length();               break;        
-                case FC_LISTDIR:    _cmd_list_directory();                break;    
-                case FC_MAKEDIR:    _cmd_make_directory();                break;        
-                case FC_CHANGEDIR:  _cmd_change_directory();              break;
-                case FC_GETPATH:    _cmd_get_current_path();              break;
-                case FC_REN_DIR:    _cmd_rename_directory();              break;
-                case FC_DEL_DIR:    _cmd_remove_directory();              break;    
-                case FC_DEL_FILE:   _cmd_delete_file();                   break;
-                case FC_REN_FILE:   _cmd_rename_file();                   break;
-                case FC_COPYFILE:   _cmd_copy_file();                     break;
-                case FC_SEEKSTART:  _cmd_seek_start();                    break;    
-                case FC_SEEKEND:    _cmd_seek_end();                      break;
-                case FC_SET_SEEK:   _cmd_set_seek_position();             break;    
-                case FC_GET_SEEK:   _cmd_get_seek_position();             break;    
-                default:
-                    data = fio_error_code = FILE_ERROR::FE_BAD_CMD;    // invalid command
-                    break;
-            }
+            // FC_RESET and FC_SHUTDOWN act on the CPU, so they never wait
+            bool now = data == FC_RESET || data == FC_SHUTDOWN;
+            // one command at a time: the next one waits for the last to complete
+            if (!now)
+                _waitCommand();
+            if ((_status & STAT_ASYNC) && !now)
+                _queueCommand(data);
+            else if (!_run(data))
+                data = fio_error_code;      // invalid command
             break;
         }
         case FIO_HANDLE:    _fileHandle = data; break;
@@ -161,11 +142,210 @@ void FileIO::write(Word offset, Byte data, bool debug)
         case FIO_SEEKPOS+2: _seek_pos = (_seek_pos & 0xFF00FFFF) | (data<<16);  break;
         case FIO_SEEKPOS+3: _seek_pos = (_seek_pos & 0x00FFFFFF) | (data<<24);  break;
         case FIO_IODATA:    _io_data = data; break;
+        case FIO_BLK_TYPE:  _blk_type = (data < Dma::TARGET_MAX) ? data : Dma::TARGET_CPU;  data = _blk_type;  break;
+        case FIO_BLK_PAGE:  _blk_page = data; break;
+        case FIO_BLK_ADDR+0: _blk_addr = (_blk_addr & 0x00FF) | (data << 8);  break;
+        case FIO_BLK_ADDR+1: _blk_addr = (_blk_addr & 0xFF00) | (data << 0);  break;
+        case FIO_BLK_LEN+0: _blk_len = (_blk_len & 0x00FF) | (data << 8);  break;
+        case FIO_BLK_LEN+1: _blk_len = (_blk_len & 0xFF00) | (data << 0);  break;
+        case FIO_BLK_COUNT+0: case FIO_BLK_COUNT+1:
+        case FIO_BLK_COUNT+2: case FIO_BLK_COUNT+3:
+            return;     // read only
+        case FIO_STATUS:
+            _status = (_status & ~(data & STAT_DONE)) & STAT_DONE;     // acknowledge
+            _status |= data & (STAT_ASYNC | STAT_INT | STAT_FIRQ);
+            data = _status;
+            break;
     }
     IDevice::write(offset,data);   // update any internal changes too
 }
 
 
+// run a file command and apply its results now, on the CPU thread
+bool FileIO::_run(Byte cmd)
+{
+    _fetch(cmd);
+    bool valid = _command(cmd);
+    _apply();
+    return valid;
+}
+
+// the host side of a file command, on either thread: it reads and writes only
+// the FileIO's own state, and leaves memory and Math results for _apply()
+bool FileIO::_command(Byte cmd)
+{
+    switch (cmd)
+    {
+        case FC_RESET:      _cmd_reset();                         break;
+        case FC_SHUTDOWN:   _cmd_system_shutdown();               break;
+        case FC_COMPDATE:   _cmd_system_load_comilation_date();   break;
+        case FC_FILEEXISTS: _cmd_does_file_exist();               break;
+        case FC_OPENREAD:   _cmd_open_read();                     break;
+        case FC_OPENWRITE:  _cmd_open_write();                    break;
+        case FC_OPENAPPEND: _cmd_open_append();                   break;
+        case FC_CLOSEFILE:  _cmd_close_file();                    break;    
+        case FC_READBYTE:   _cmd_read_byte();                     break;    
+        case FC_WRITEBYTE:  _cmd_write_byte();                    break;
+        case FC_LOADHEX:    _cmd_load_hex_file();                 break;    
+        case FC_GETLENGTH:  _cmd_get_file_length();               break;        
+        case FC_LISTDIR:    _cmd_list_directory();                break;    
+        case FC_MAKEDIR:    _cmd_make_directory();                break;        
+        case FC_CHANGEDIR:  _cmd_change_directory();              break;
+        case FC_GETPATH:    _cmd_get_current_path();              break;
+        case FC_REN_DIR:    _cmd_rename_directory();              break;
+        case FC_DEL_DIR:    _cmd_remove_directory();              break;    
+        case FC_DEL_FILE:   _cmd_delete_file();                   break;
+        case FC_REN_FILE:   _cmd_rename_file();                   break;
+        case FC_COPYFILE:   _cmd_copy_file();                     break;
+        case FC_SEEKSTART:  _cmd_seek_start();                    break;    
+        case FC_SEEKEND:    _cmd_seek_end();                      break;
+        case FC_SET_SEEK:   _cmd_set_seek_position();             break;    
+        case FC_GET_SEEK:   _cmd_get_seek_position();             break;    
+        case FC_READBLOCK:  _cmd_read_block();                    break;
+        case FC_WRITEBLOCK: _cmd_write_block();                   break;
+        case FC_LOADBIN:    _cmd_load_binary();                   break;
+        case FC_SAVEBIN:    _cmd_save_binary();                   break;
+        case FC_READDIR:    _cmd_read_directory();                break;
+        default:
+            fio_error_code = FILE_ERROR::FE_BAD_CMD;
+            return false;
+    }
+    return true;
+}
+
+// CPU thread: latch the memory a command writes out, and the room it may fill
+void FileIO::_fetch(Byte cmd)
+{
+    switch (cmd)
+    {
+        case FC_WRITEBLOCK:
+        {
+            DWord len = (_blk_len == 0 || _blk_len > 256) ? 256 : _blk_len;
+            _xfer.resize(len);
+            Bus::GetDma()->read_block(_blk_type, _blk_page, _blk_addr, _xfer.data(), len);
+            break;
+        }
+        case FC_SAVEBIN:
+        {
+            DWord len = std::min(_blk_len ? (DWord)_blk_len : 0x10000, _blkCapacity());
+            _xfer.resize(len);
+            Bus::GetDma()->read_block(_blk_type, _blk_page, _blk_addr, _xfer.data(), len);
+            break;
+        }
+        case FC_LOADBIN:
+            _xfer_cap = _blkCapacity();
+            break;
+    }
+}
+
+// CPU thread: store what the last command left for memory and the Math registers
+void FileIO::_apply()
+{
+    if (_xfer_store)
+        Bus::GetDma()->write_block(_xfer_type, _xfer_page, _xfer_addr, _xfer.data(), (DWord)_xfer.size());
+    if (_acr_store)
+        Bus::Write_DWord(MATH_ACR_INT, _acr);
+    if (_loader_store)
+    {
+        _loader.Store();
+        _loader = Loader();
+    }
+    _xfer.clear();
+    _xfer_store = _acr_store = _loader_store = false;
+}
+
+// the bytes in _xfer are stored to memory by _apply()
+void FileIO::_storeXfer(Byte type, Byte page, Word addr)
+{
+    _xfer_type = type;
+    _xfer_page = page;
+    _xfer_addr = addr;
+    _xfer_store = true;
+}
+
+///// ASYNCHRONOUS COMMANDS /////////////////////////////////////////////
+
+void FileIO::_waitCommand()
+{
+    if (!_busy)
+        return;
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait(lock, [this] { return _finished.load() || !_bWorkerRunning; });
+    }
+    Complete();
+}
+
+void FileIO::_queueCommand(Byte cmd)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_bWorkerRunning)
+    {
+        _run(cmd);
+        return;
+    }
+    _fetch(cmd);
+    _status &= ~STAT_DONE;
+    _busy = true;
+    _queued = cmd;
+    _bQueued = true;
+    _cv.notify_all();
+}
+
+void FileIO::_complete()
+{
+    _apply();
+    _finished = false;
+    _busy = false;
+    _status |= STAT_DONE;
+}
+
+void FileIO::_hold_interrupt()
+{
+    C6809* cpu = Bus::GetC6809();
+    if (!cpu)
+        return;
+    if (_status & STAT_FIRQ)
+        cpu->firq();
+    else
+        cpu->irq();
+}
+
+void FileIO::_workerProc()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true)
+    {
+        _cv.wait(lock, [this] { return _bQueued || !_bWorkerRunning; });
+        if (!_bQueued)
+            break;
+        Byte cmd = _queued;
+        _bQueued = false;
+        lock.unlock();
+        _command(cmd);
+        lock.lock();
+        _finished = true;
+        _cv.notify_all();
+    }
+}
+
+void FileIO::_stopWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _bWorkerRunning = false;
+        _cv.notify_all();
+    }
+    if (_worker.joinable())
+        _worker.join();
+    _busy = false;
+    _finished = false;
+    // an unfinished command's results are dropped
+    _xfer.clear();
+    _xfer_store = _acr_store = _loader_store = false;
+}
+
+
 void FileIO::_cmd_reset()
 {
     // printf("FileIO: RESET Command Received\n");
@@ -188,13 +368,14 @@ bool FileIO::_bFileExists(const char* file)
 {
     if (file)
     {
-        FILE* fp = fopen(file, "rb");
-        if (!fp)
+        // answered from the stat cache (or the disk index) instead of opening the file
+        bool folder;
+        DWord length;
+        if (!_vfs->Stat(file, folder, length))
         {
-            Bus::Write(FIO_ERROR, FILE_ERROR::FE_NOTFOUND);
+            fio_error_code = FILE_ERROR::FE_NOTFOUND;
             return false;
         }
-        fclose(fp);
         return true;            
     }    
     return false;
@@ -204,10 +385,14 @@ void FileIO::_openFile(const char* mode)
 {
     // if (!_bFileExists(filePath.c_str())) { return; }
 	_fileHandle = _FindOpenFileSlot();
-    _vecFileStreams[_fileHandle] = fopen(filePath.c_str(), mode);
-    if (!_vecFileStreams[_fileHandle])
+    if (_fileHandle == 0)
+        return;
+    auto fh = _vfs->Open(filePath.c_str(), mode);
+    if (fh)
+        _vecFileStreams[_fileHandle] = std::move(fh);
+    else
     {
-        Bus::Write(FIO_ERROR, FE_NOTOPEN);
+        fio_error_code = FILE_ERROR::FE_NOTOPEN;
         return;
     } 
 }
@@ -232,81 +417,59 @@ void FileIO::_cmd_open_append()
 void FileIO::_cmd_close_file()
 {
     printf("%s::_cmd_close_file()\n", Name().c_str());
-    Byte handle = Bus::Read(FIO_HANDLE);
+    Byte handle = _fileHandle;
     if (handle==0 || _vecFileStreams[handle] == nullptr)
     {
-        Bus::Write(FIO_ERROR, FE_NOTOPEN);
+        fio_error_code = FILE_ERROR::FE_NOTOPEN;
         return;
     }
-    fclose(_vecFileStreams[handle]);
-    _vecFileStreams[handle] = nullptr;
+    _vecFileStreams[handle] = nullptr;     // closes (and flushes) the handle
 }
 
 void FileIO::_cmd_read_byte()
 {
     // printf("%s::_cmd_read_byte()\n", Name().c_str());
-    Byte handle = Bus::Read(FIO_HANDLE);
+    Byte handle = _fileHandle;
     if (handle == 0 || _vecFileStreams[handle] == nullptr)
     {   
-        Bus::Write(FIO_ERROR, FILE_ERROR::FE_NOTOPEN);
+        fio_error_code = FILE_ERROR::FE_NOTOPEN;
         return;
     }
-    Byte data = (Byte)fgetc(_vecFileStreams[handle]);
-    if (feof(_vecFileStreams[handle]))
+    Byte data = (Byte)_vecFileStreams[handle]->GetC();
+    if (_vecFileStreams[handle]->Eof())
     {
-        Bus::Write(FIO_ERROR, FILE_ERROR::FE_OVERRUN);
+        fio_error_code = FILE_ERROR::FE_OVERRUN;
         // _cmd_close_file();
         return;
     }
-    Bus::Write(FIO_IODATA, data);    
+    _io_data = data;
 }
 
 void FileIO::_cmd_write_byte()
 {
     // printf("%s::_cmd_write_byte()\n", Name().c_str());
-    Byte handle = Bus::Read(FIO_HANDLE);
+    Byte handle = _fileHandle;
     if (handle == 0 || _vecFileStreams[handle] == nullptr)
     {
-        Bus::Write(FIO_ERROR, FILE_ERROR::FE_NOTOPEN);
+        fio_error_code = FILE_ERROR::FE_NOTOPEN;
         return;
     }
-    Byte data = (Byte)fputc(_io_data, _vecFileStreams[handle]);
-    Bus::Write(FIO_IODATA, data);
+    _io_data = (Byte)_vecFileStreams[handle]->PutC(_io_data);
 }
 
 bool FileIO::_cmd_does_file_exist()
 {
     bool exists = _bFileExists(filePath.c_str());
-    Bus::Write(FIO_IODATA, (Byte)exists);
+    _io_data = (Byte)exists;
     if (!exists)
     {
-        Bus::Write(FIO_ERROR, FILE_ERROR::FE_NOTFOUND);
+        fio_error_code = FILE_ERROR::FE_NOTFOUND;
         return false;
     }
     return true;
 }
 
 
-// load_hex helpers
-Byte FileIO::_fread_hex_byte(std::ifstream& ifs)
-{
-    char str[3];
-    long l;
-    ifs.get(str[0]);
-    ifs.get(str[1]);
-    str[2] = '\0';
-    l = strtol(str, NULL, 16);
-    return (Byte)(l & 0xff);
-}
-Word FileIO::_fread_hex_word(std::ifstream& ifs)
-{
-    Word ret;
-    ret = _fread_hex_byte(ifs);
-    ret <<= 8;
-    ret |= _fread_hex_byte(ifs);
-    return ret;
-}
-
 void FileIO::_cmd_load_hex_file()
 {
     // // lambda to convert integer to hex string
@@ -328,84 +491,60 @@ void FileIO::_cmd_load_hex_file()
     path_char_pos=0;
 
 
-    std::ifstream ifs(filePath);
     std::filesystem::path f{ filePath.c_str()};
-    if (!std::filesystem::exists(f))
+    bool folder;
+    DWord length;
+    if (!_vfs->Stat(filePath.c_str(), folder, length))
     {
         // printf("File '%s' Not Found\n", f.filename().string().c_str());
-        Bus::Write(FIO_ERROR, FILE_ERROR::FE_NOTFOUND);
-        ifs.close();
+        fio_error_code = FILE_ERROR::FE_NOTFOUND;
         return;
     }
-    // does this have a .hex extenion?
+    // does this have a .hex (or S-record) extension?
     // (wrong file type)
     std::string strExt = f.filename().extension().string();
-    if (strExt != ".hex" && strExt != ".hex ")
+    Loader::FORMAT format = Loader::Format(filePath.c_str());
+    if (strExt != ".hex" && strExt != ".hex " && format != Loader::FMT_SREC)
     {
         // printf("EXTENSION: %s\n", strExt.c_str());
-        Bus::Write(FIO_ERROR, FILE_ERROR::FE_WRONGTYPE);
-        ifs.close();
+        fio_error_code = FILE_ERROR::FE_WRONGTYPE;
         return;
     }
  
-    if (!ifs.is_open())
+    // the whole file, read through the Vfs
+    auto fh = _vfs->Open(filePath.c_str(), "rb");
+    if (!fh)
     {
         // printf("UNABLE TO OPEN FILE '%s'\n", f.filename().string().c_str());
-        Bus::Write(FIO_ERROR, FILE_ERROR::FE_NOTOPEN);
-        ifs.close();
+        fio_error_code = FILE_ERROR::FE_NOTOPEN;
         return;
     }
-    bool done = false;
-    char c;
+    std::vector<Byte> data(length);
+    data.resize(fh->Read(data.data(), length));
+    fh = nullptr;
 
-    while (!done)
+    // every record is checked before any of them is stored (by _apply)
+    if (!_loader.Parse(data.data(), (DWord)data.size(), format))
     {
-        Byte n, t;
-        Word addr;
-        Byte b;
-        ifs.get(c);	
-        if (c != ':')
-        {
-            ifs.close();
-            Bus::Write(FIO_ERROR, FILE_ERROR::FE_WRONGTYPE);
-            return;
-        }
-        n = _fread_hex_byte(ifs);		// byte count for this line
-        addr = _fread_hex_word(ifs);	// fetch the begin address		
-        t = _fread_hex_byte(ifs);		// record type
-        if (t == 0x00)
-        {
-            while (n--)
-            {
-                b = _fread_hex_byte(ifs);
-                Bus::Write(addr, b, true);
-                ++addr;
-            }
-            // Read and discard checksum byte
-            (void)_fread_hex_byte(ifs);
-            // skip the junk at the end of the line	
-            if (ifs.peek() == '\r')	ifs.get(c);
-            if (ifs.peek() == '\n')	ifs.get(c);
-        }
-        else if (t == 0x01)
-            done = true;
+        fio_error_code = FILE_ERROR::FE_WRONGTYPE;
+        return;
     }
-    // close and return
-    ifs.close();
+    _loader_store = true;
 }
 
 void FileIO::_cmd_get_file_length()
 {
     // printf("%s::_cmd_get_file_length()\n", Name().c_str());
-    std::filesystem::path arg1 = filePath;
-    if (!std::filesystem::exists(arg1))
+    DWord file_size = 0;
+    bool folder;
+    _acr_store = true;
+    if (!_vfs->Stat(filePath.c_str(), folder, file_size))
     {
-        Bus::Write(FIO_ERROR, FILE_ERROR::FE_NOTFOUND);  
-        Bus::Write(MATH_ACR_INT, 0);
+        fio_error_code = FILE_ERROR::FE_NOTFOUND;  
+        _acr = 0;
         return;
     }
-    Uint32 file_size = std::filesystem::file_size(arg1);
-    Bus::Write_DWord(MATH_ACR_INT, file_size);
+    _acr = file_size;
 }
 
 
@@ -413,111 +552,120 @@ void FileIO::_cmd_list_directory()
 {
     printf("%s::_cmd_list_directory()\n", Name().c_str());
 
-    std::string current_path = std::filesystem::current_path().generic_string();
-    std::vector<std::string> _files;
-
     // initial error checking
-    if (current_path[0] == -1)   current_path = "";
     if (filePath[0] == -1)    
     {
         filePath="";
         path_char_pos = 0;
     }
-    std::string seach_folder = "";
-    std::filesystem::path arg1 = filePath;    
-    std::string app_str = arg1.generic_string().c_str();   
-    if (arg1=="") 
+    std::string seach_folder = filePath.c_str();
+    bool folder = true;
+    DWord length;
+    if (seach_folder.empty() || (_vfs->Stat(seach_folder, folder, length) && folder))
     {
-        arg1=std::filesystem::current_path().generic_string();
-        app_str = current_path;   
+        // is folder
+        _dir_filter = false;
     }
     else
-        app_str = current_path + "/" + arg1.generic_string().c_str();   
-    std::string filename = arg1.filename().generic_string().c_str();
-    std::string stem = arg1.stem().generic_string().c_str();
-    std::string extension = arg1.extension().generic_string().c_str();
-
-
-    if (std::filesystem::is_directory(app_str))
-        arg1 = app_str;
-
-    try
-    {    
-        // is folder
-        if (std::filesystem::is_directory(arg1))
-        {
-            seach_folder = arg1.generic_string().c_str();          
-            for (const auto& entry : std::filesystem::directory_iterator(arg1.generic_string().c_str()))
-            {
-                std::stringstream ssFile;
-                std::string entry_filename = entry.path().filename().generic_string().c_str();
-                if (entry.is_directory())
-                {
-                    ssFile << "  [" << entry_filename << "]";
-                    _files.push_back(ssFile.str());
-                }
-                else
-                {
-                    ssFile << "    " << entry_filename;
-                    _files.push_back(ssFile.str());
-                }                
-            }
-        }
+    {
         // is file and/or wildcards
-        else
-        {            
-            std::string parent = std::filesystem::path(arg1).parent_path().generic_string().c_str();
-            app_str = current_path + "/" + parent;
-            seach_folder = app_str.c_str();      
-            for (const auto& entry : std::filesystem::directory_iterator(app_str.c_str()))
-            {
-                if (entry.is_regular_file())
-                {
-                    std::stringstream ssFile;
-                    std::string file_stem = entry.path().stem().generic_string().c_str();
-                    std::string file_ext = entry.path().extension().generic_string().c_str();
-                    std::string entry_filename = entry.path().filename().generic_string().c_str();
-
-                    bool bAllWild = false;
-                    if (stem == "*" && extension == ".*")
-                        bAllWild = true;
-                        
-                    if (entry_filename == arg1.filename().generic_string().c_str() || bAllWild)
-                    {
-                        ssFile << "    " << entry_filename;
-                        _files.push_back(ssFile.str());
-                    }
-                    else if (file_stem == stem && extension == ".*")
-                    {
-                        ssFile << "    " << entry_filename;
-                        _files.push_back(ssFile.str());
-                    }                    
-                    else if (file_ext == extension && stem == "*")
-                    {
-                        ssFile << "    " << entry_filename;
-                        _files.push_back(ssFile.str());
-                    }
-                }
-            }
-        }
+        std::filesystem::path arg1 = seach_folder;
+        seach_folder = arg1.parent_path().generic_string();
+        _dir_filter = true;
+        _dir_name = arg1.filename().generic_string();
+        _dir_stem = arg1.stem().generic_string();
+        _dir_ext = arg1.extension().generic_string();
     }
-    catch (const std::exception& e)
+    seach_folder = _vfs->Resolve(seach_folder);
+
+    // the entries are read from the folder as the listing is read (_dirNextLine)
+    _dir_open = false;
+    dir_data.clear();
+    dir_data_pos = 0;
+    if (!_vfs->OpenDir(seach_folder))
     {
         dir_data = "Error: No such folder!\n";
-        dir_data_pos = 0; 
         return;
     }
+    _dir_open = true;
+
     // clear the FIO_BUFFER
-    for (int i = FIO_BUFFER; i <= FIO_BFR_END; i++)
-        Bus::Write(i, 0);
+    _xfer.assign(FIO_BFR_END - FIO_BUFFER + 1, 0);
+    _storeXfer(Dma::TARGET_CPU, 0, FIO_BUFFER);
 
-    // build the result
+    // the listing starts with the folder being listed
     dir_data = seach_folder;
     dir_data += "\n";
-    std::sort(_files.begin(), _files.end());
-    for (auto& f : _files)
-        dir_data += (f+"\n");
-    dir_data_pos = 0;      
+}
+
+// the next line of the directory listing into dir_data, empty at the end
+void FileIO::_dirNextLine()
+{
+    dir_data.clear();
+    dir_data_pos = 0;
+    bool folder;
+    while (_dir_open && _vfs->NextEntry(_dir_entry, folder))
+    {
+        if (_dirFormat(_dir_entry, folder))
+            return;
+    }
+    _dir_open = false;
+}
+
+// format one entry into dir_data, false if the listing skips it
+bool FileIO::_dirFormat(const std::string& name, bool folder)
+{
+    if (_dir_filter && folder)
+        return false;
+
+    if (_dir_filter)
+    {
+        std::string_view file_name(name);
+        size_t dot = file_name.rfind('.');
+        if (dot == std::string_view::npos || dot == 0)
+            dot = file_name.size();
+        std::string_view file_stem = file_name.substr(0, dot);
+        std::string_view file_ext = file_name.substr(dot);
+
+        bool bAllWild = (_dir_stem == "*" && _dir_ext == ".*");
+        bool match = (file_name == _dir_name || bAllWild) ||
+                     (file_stem == _dir_stem && _dir_ext == ".*") ||
+                     (file_ext == _dir_ext && _dir_stem == "*");
+        if (!match)
+            return false;
+    }
+    dir_data = (!_dir_filter && folder) ? "  [" : "    ";
+    dir_data += name;
+    if (folder)
+        dir_data += "]";
+    dir_data += "\n";
+    return true;
+}
+
+void FileIO::_cmd_read_directory()
+{
+    // the next stretch of the listing, null-terminated, into FIO_BUFFER
+    _xfer.resize(256);
+    DWord n = 0;
+    while (n < 255)
+    {
+        if (dir_data_pos >= (int)dir_data.size())
+        {
+            _dirNextLine();
+            if (dir_data.empty())
+                break;
+        }
+        DWord len = std::min<DWord>(255 - n, dir_data.size() - dir_data_pos);
+        memcpy(_xfer.data() + n, dir_data.data() + dir_data_pos, len);
+        n += len;
+        dir_data_pos += len;
+    }
+    _xfer[n] = 0;
+    _xfer.resize(n + 1);
+    _blk_count = n;
+    _storeXfer(Dma::TARGET_CPU, 0, FIO_BUFFER);
+    if (n < 255)
+        fio_error_code = FILE_ERROR::FE_EOF;
 }
 
 void FileIO::_cmd_change_directory()
@@ -525,26 +673,21 @@ void FileIO::_cmd_change_directory()
     // printf("Change Directory To: %s\n", filePath.c_str());
     if (filePath.size() == 0)   return;
 
-    std::string chdir = filePath;    
-    if (std::filesystem::exists(chdir))
-        std::filesystem::current_path(chdir);
-    else
-        Bus::Write(FIO_ERROR, FILE_ERROR::FE_NOTFOUND);
+    if (!_vfs->ChangeDir(filePath.c_str()))
+        fio_error_code = FILE_ERROR::FE_NOTFOUND;
 }
 
 void FileIO::_cmd_get_current_path()
 {
     // printf("FileIO::_cmd_get_current_path()\n");
     path_char_pos = 0;
-    filePath = std::filesystem::current_path().string() + "\n";
+    filePath = _vfs->CurrentDir() + "\n";
     // printf("%s\n", filePath.c_str());
 }
 
 void FileIO::_cmd_make_directory()
 {
-    std::string current_path = std::filesystem::current_path().generic_string();
-    std::filesystem::path arg1 = filePath;    
-    std::filesystem::create_directory(arg1);    
+    _vfs->MakeDir(filePath.c_str());
 }
 
 void FileIO::_cmd_remove_directory()
@@ -584,28 +727,119 @@ void FileIO::_cmd_copy_file()
 
 void FileIO::_cmd_seek_start()
 {
-    printf("FileIO::_cmd_seek_start()\n");
-    // https://en.cppreference.com/w/cpp/io/c/fseek
+    VfsFile* fh = _handleStream();
+    if (fh)
+        fh->Seek(0, SEEK_SET);
 }
 
 void FileIO::_cmd_seek_end()
 {
-    printf("FileIO::_cmd_seek_end()\n");
-    // https://en.cppreference.com/w/cpp/io/c/fseek
+    VfsFile* fh = _handleStream();
+    if (fh)
+        fh->Seek(0, SEEK_END);
 }
 
 void FileIO::_cmd_set_seek_position()
 {
-    printf("FileIO::_cmd_set_seek_position()\n");
-    // https://en.cppreference.com/w/cpp/io/c/fsetpos
+    VfsFile* fh = _handleStream();
+    if (fh && !fh->Seek(_seek_pos, SEEK_SET))
+        fio_error_code = FILE_ERROR::FE_BADSTREAM;
 }
 
 void FileIO::_cmd_get_seek_position()
 {
-    printf("FileIO::_cmd_get_seek_position()\n");
-    // https://en.cppreference.com/w/cpp/io/c/fgetpos
+    VfsFile* fh = _handleStream();
+    if (fh)
+        _seek_pos = fh->Tell();
+}
+
+
+void FileIO::_cmd_read_block()
+{
+    _blk_count = 0;
+    VfsFile* fh = _handleStream();
+    if (!fh)    return;
+    DWord len = (_blk_len == 0 || _blk_len > 256) ? 256 : _blk_len;
+    _xfer.resize(len);
+    _blk_count = fh->Read(_xfer.data(), len);
+    _xfer.resize(_blk_count);
+    _storeXfer(_blk_type, _blk_page, _blk_addr);
+    if (_blk_count < len)
+        fio_error_code = FILE_ERROR::FE_EOF;
+}
+
+void FileIO::_cmd_write_block()
+{
+    _blk_count = 0;
+    VfsFile* fh = _handleStream();
+    if (!fh)    return;
+    // the block was read from memory when the command was issued (_fetch)
+    DWord len = (DWord)_xfer.size();
+    _blk_count = fh->Write(_xfer.data(), len);
+    if (_blk_count < len)
+        fio_error_code = FILE_ERROR::FE_BADSTREAM;
+}
+
+void FileIO::_cmd_load_binary()
+{
+    _blk_count = 0;
+    auto fh = _vfs->Open(filePath.c_str(), "rb");
+    if (!fh)
+    {
+        fio_error_code = FILE_ERROR::FE_NOTFOUND;
+        return;
+    }
+    fh->Seek(0, SEEK_END);
+    DWord size = fh->Tell();
+    fh->Seek(0, SEEK_SET);
+    DWord len = std::min(size, _xfer_cap);
+    _xfer.resize(len);
+    _blk_count = fh->Read(_xfer.data(), len);
+    _xfer.resize(_blk_count);
+    _storeXfer(_blk_type, _blk_page, _blk_addr);
+    if (_blk_count < size)
+        fio_error_code = FILE_ERROR::FE_OVERRUN;
+}
+
+void FileIO::_cmd_save_binary()
+{
+    _blk_count = 0;
+    // the block was read from memory when the command was issued (_fetch)
+    DWord len = (DWord)_xfer.size();
+    auto fh = _vfs->Open(filePath.c_str(), "wb");
+    if (!fh)
+    {
+        fio_error_code = FILE_ERROR::FE_NOTOPEN;
+        return;
+    }
+    _blk_count = fh->Write(_xfer.data(), len);
+    if (_blk_count < len)
+        fio_error_code = FILE_ERROR::FE_BADSTREAM;
+}
+
+// helper: the stream of the current FIO_HANDLE
+VfsFile* FileIO::_handleStream()
+{
+    if (_fileHandle == 0 || _vecFileStreams[_fileHandle] == nullptr)
+    {
+        fio_error_code = FILE_ERROR::FE_NOTOPEN;
+        return nullptr;
+    }
+    return _vecFileStreams[_fileHandle].get();
 }
 
+// helper: bytes from FIO_BLK_ADDR to the end of the block memory type
+DWord FileIO::_blkCapacity()
+{
+    if (_blk_type == Dma::TARGET_BANK)
+    {
+        // nothing fits past the last page
+        DWord size = Bus::GetMemBank()->PageCount() * PAGED_MEMORY_BANKSIZE;
+        DWord start = (DWord)_blk_page * PAGED_MEMORY_BANKSIZE + _blk_addr;
+        return (start < size) ? size - start : 0;
+    }
+    return 0x10000 - _blk_addr;
+}
 
 // helper: return a handle to an open file stream slot
 int FileIO::_FindOpenFileSlot()
@@ -623,10 +857,10 @@ int FileIO::_FindOpenFileSlot()
 	// too many file handles?
 	if (found == 0)
 	{
-		Bus::Write(FIO_ERROR, FILE_ERROR::FE_BADSTREAM);
+		fio_error_code = FILE_ERROR::FE_BADSTREAM;
 		return 0;
 	}
-	Bus::Write(FIO_HANDLE, found);
+	_fileHandle = found;
 	return found;
 }
 
@@ -684,6 +918,11 @@ Word FileIO::OnAttach(Word nextAddr)
     DisplayEnum("FC_SEEKEND",   enumID++, "     * Seek End");
     DisplayEnum("FC_SET_SEEK",  enumID++, "     * Set Seek Position (from FIO_IOWORD)");
     DisplayEnum("FC_GET_SEEK",  enumID++, "     * Get Seek Position (into FIO_IOWORD)");
+    DisplayEnum("FC_READBLOCK", enumID++, "       Read Block (FIO_HANDLE into FIO_BLK_ADDR)");
+    DisplayEnum("FC_WRITEBLOCK",enumID++, "       Write Block (FIO_BLK_ADDR into FIO_HANDLE)");
+    DisplayEnum("FC_LOADBIN",   enumID++, "       Load Binary File (into FIO_BLK_ADDR)");
+    DisplayEnum("FC_SAVEBIN",   enumID++, "       Save Binary File (from FIO_BLK_ADDR)");
+    DisplayEnum("FC_READDIR",   enumID++, "       Read Directory Listing (into FIO_BUFFER)");
     DisplayEnum("", 0, "End FIO_COMMANDS");
     DisplayEnum("", 0, "");
 
@@ -710,6 +949,30 @@ Word FileIO::OnAttach(Word nextAddr)
     DisplayEnum("", 0, "            List Directory command. The read-position is automatically ");
     DisplayEnum("", 0, "            advanced on read from this register. Each filename is ");
     DisplayEnum("", 0, "            $0a-terminated. The list itself is null-terminated.");
+    nextAddr += 1;
+
+    DisplayEnum("FIO_BLK_TYPE", nextAddr, "(Byte) block transfer memory type (DMA_TYPE_<type>)");
+    nextAddr += 1;
+
+    DisplayEnum("FIO_BLK_PAGE", nextAddr, "(Byte) block transfer page (DMA_TYPE_BANK)");
+    nextAddr += 1;
+
+    DisplayEnum("FIO_BLK_ADDR", nextAddr, "(Word) block transfer address (FIO_BUFFER on reset)");
+    nextAddr += 2;
+
+    DisplayEnum("FIO_BLK_LEN", nextAddr, "(Word) bytes to transfer (0: the command maximum)");
+    nextAddr += 2;
+
+    DisplayEnum("FIO_BLK_COUNT", nextAddr, "(DWord) bytes moved by the last block command");
+    nextAddr += 4;
+
+    DisplayEnum("FIO_STATUS", nextAddr, "(Byte) asynchronous command status");
+    DisplayEnum("", 0, "     bit 7:    1=a queued command is busy (read only)");
+    DisplayEnum("", 0, "     bit 6:    1=done, write 1 to acknowledge");
+    DisplayEnum("", 0, "     bits 3-5: reserved");
+    DisplayEnum("", 0, "     bit 2:    1=queue commands to the I/O thread");
+    DisplayEnum("", 0, "     bit 1:    1=raise an interrupt on completion");
+    DisplayEnum("", 0, "     bit 0:    interrupt type: 0=IRQ, 1=FIRQ");
     nextAddr += 1;
 
 	DisplayEnum("FIO_END", nextAddr, "End of the FileIO register space");
@@ -722,26 +985,57 @@ void FileIO::OnInit()
 {
     // printf("%s::OnInit()\n", Name().c_str());    
 
+    _blk_addr = FIO_BUFFER;
+
+    // the port strings are read and written in place
+    filePath.reserve(256);
+    dir_data.reserve(256);
+
+    // the I/O thread for asynchronous commands
+    _bWorkerRunning = true;
+    _worker = std::thread(&FileIO::_workerProc, this);
+
     // create a block of null file stream devices
-    for (int i = 0; i < FILEHANDLESMAX; i++)
-    {
-        FILE* ifs = nullptr;
-        _vecFileStreams.push_back(ifs);
-    }
+    _vecFileStreams.resize(FILEHANDLESMAX);
+
+    // the host folders, or the disk image named in types.hpp
+    if (!Mount(DISK_IMAGE_FILENAME))
+        Mount("");
 }
 
 void FileIO::OnQuit() 
 {
     // printf("%s::OnQuit()\n", Name().c_str());    
 
+    // let a queued command finish before its streams go away
+    _stopWorker();
+
     // close and and all open file streams
-    for (auto* fs : _vecFileStreams)
+    for (auto& fs : _vecFileStreams)
+        fs = nullptr;
+    _vfs = nullptr;     // writes back a mounted disk image
+}
+
+bool FileIO::Mount(const std::string& image, bool write_back)
+{
+    // the open files belong to the file system they came from
+    _waitCommand();
+    for (auto& fs : _vecFileStreams)
+        fs = nullptr;
+    _dir_open = false;
+
+    if (image.empty())
     {
-        if (fs != nullptr)
-        {
-            fclose(fs);
-            fs = nullptr;
-        }
+        _vfs = std::make_unique<HostVfs>(_stats);
+        return true;
     }
+    auto disk = std::make_unique<ImageVfs>(_stats);
+    if (!disk->Mount(image, write_back))
+    {
+        printf("%s: unable to mount the disk image '%s'\n", Name().c_str(), image.c_str());
+        return false;
+    }
+    _vfs = std::move(disk);
+    return true;
 }
 
@@ -4,23 +4,34 @@
 // *
 // ***********************************
 
+#include <algorithm>
 #include <sstream>
 #include "Gfx.hpp"
 #include "Debug.hpp"
 #include "Bus.hpp"
 #include "C6809.hpp"
+#include "Capture.hpp"
 #include "font8x8_system.hpp"
 #include "Memory.hpp"
 #include "MemBank.hpp"
 
+Uint32 Gfx::GetWindowID()
+{
+    return SDL_GetWindowID(Bus::GetGfx()->sdl_window);
+}
+SDL_Window* Gfx::GetSDLWindow()
+{
+    return Bus::GetGfx()->sdl_window;
+}
+
 Byte Gfx::read(Word offset, bool debug)
 {
     Byte data = IDevice::read(offset);
     // printf("%s::read($%04X) = $%02X\n", Name().c_str(), offset,  data);
     switch (offset)
     {
-        case GFX_MODE:          data = s_gfx_mode; Bus::Write(MEM_DSP_FLAGS, Bus::Read(MEM_DSP_FLAGS)); break;
-        case GFX_EMU:           data = s_gfx_emu; break;
+        case GFX_MODE:          data = _gfx_mode; Bus::Write(MEM_DSP_FLAGS, Bus::Read(MEM_DSP_FLAGS)); break;
+        case GFX_EMU:           data = _gfx_emu; break;
 
 		case GFX_VID_END + 0: 	data = (gfx_vid_end >> 8) & 0xFF; break;
 		case GFX_VID_END + 1: 	data = gfx_vid_end & 0xFF; break;
@@ -28,7 +39,7 @@ Byte Gfx::read(Word offset, bool debug)
 		case GFX_HRES + 0: 	
         {
             Word width = res_width;
-            if (!(s_gfx_mode & 0x80)) // text mode
+            if (!(_gfx_mode & 0x80)) // text mode
                 width /= 8;
             data = (width >> 8) & 0xFF; 
             break;
@@ -36,7 +47,7 @@ Byte Gfx::read(Word offset, bool debug)
 		case GFX_HRES + 1: 	
         {
             Word width = res_width;
-            if (!(s_gfx_mode & 0x80)) // text mode
+            if (!(_gfx_mode & 0x80)) // text mode
                 width /= 8;
             data = width & 0xFF; 
             break;
@@ -44,7 +55,7 @@ Byte Gfx::read(Word offset, bool debug)
 		case GFX_VRES + 0: 	
         {
             Word height = res_height;
-            if (!(s_gfx_mode & 0x80)) // text mode
+            if (!(_gfx_mode & 0x80)) // text mode
                 height /= 8;
             data = (height >> 8) & 0xFF; 
             break;
@@ -52,7 +63,7 @@ Byte Gfx::read(Word offset, bool debug)
 		case GFX_VRES + 1: 	
         {
             Word height = res_height;
-            if (!(s_gfx_mode & 0x80)) // text mode
+            if (!(_gfx_mode & 0x80)) // text mode
                 height /= 8;
             data = height & 0xFF; 
             break;
@@ -73,6 +84,17 @@ Byte Gfx::read(Word offset, bool debug)
         case GFX_GLYPH_DATA+6:  data = _gfx_glyph_data[_gfx_glyph_idx][6]; break;
 		case GFX_GLYPH_DATA+7:  data = _gfx_glyph_data[_gfx_glyph_idx][7]; break;
 
+        // raster interrupt registers
+        case GFX_IRQ_CTRL:      data = _irq_ctrl; break;
+        case GFX_IRQ_STATUS:
+            data = _irq_status;
+            if (_raster_line >= _raster_visible)    data |= 0x01;
+            break;
+        case GFX_RASTER_CMP+0:  data = (_raster_cmp >> 8) & 0xFF; break;
+        case GFX_RASTER_CMP+1:  data = _raster_cmp & 0xFF; break;
+        case GFX_SCANLINE+0:    data = (_raster_line >> 8) & 0xFF; break;
+        case GFX_SCANLINE+1:    data = _raster_line & 0xFF; break;
+
         default:
             break;
     }
@@ -88,18 +110,21 @@ void Gfx::write(Word offset, Byte data, bool debug)
     switch (offset)
     {
         case GFX_MODE:
-            if (data != s_gfx_mode)
+            if (data != _gfx_mode)
             {
                 // ToDo: Only change data if valid GMODE
                 if (VerifyGmode(data))
-                    s_gfx_mode = data;
+                    _gfx_mode = data;
                 Bus::IsDirty(true);
+                // no window to reactivate headless
+                if (Bus::IsHeadless())
+                    _decode_resolution(_gfx_mode);
             }
             break;
         case GFX_EMU:
-            if (data != s_gfx_emu)
+            if (data != _gfx_emu)
             {
-                s_gfx_emu = data;
+                _gfx_emu = data;
                 Bus::IsDirty(true);
             }
             break;
@@ -128,7 +153,15 @@ void Gfx::write(Word offset, Byte data, bool debug)
         case GFX_GLYPH_DATA+4:  _gfx_glyph_data[_gfx_glyph_idx][4] = data; break;
         case GFX_GLYPH_DATA+5:  _gfx_glyph_data[_gfx_glyph_idx][5] = data; break;
         case GFX_GLYPH_DATA+6:  _gfx_glyph_data[_gfx_glyph_idx][6] = data; break;
-        case GFX_GLYPH_DATA+7:  _gfx_glyph_data[_gfx_glyph_idx][7] = data; break; 		
+        case GFX_GLYPH_DATA+7:  _gfx_glyph_data[_gfx_glyph_idx][7] = data; break; 
+
+        // raster interrupt registers
+        case GFX_IRQ_CTRL:      _irq_ctrl = data & 0xF0; data = _irq_ctrl; break;
+        case GFX_IRQ_STATUS:    _irq_status &= ~(data & 0xC0); data = _irq_status; break;
+        case GFX_RASTER_CMP+0:  _raster_cmp = (_raster_cmp & 0x00FF) | (data << 8); break;
+        case GFX_RASTER_CMP+1:  _raster_cmp = (_raster_cmp & 0xFF00) | data; break;
+        case GFX_SCANLINE+0:    break;  // read only
+        case GFX_SCANLINE+1:    break;  // read only		
 
     }
 
@@ -205,6 +238,34 @@ Word Gfx::OnAttach(Word nextAddr)
     DisplayEnum("", 0, "");
     nextAddr += 8;
 
+    DisplayEnum("GFX_IRQ_CTRL", nextAddr, " (Byte) Raster Interrupt Control");
+	DisplayEnum("", 0, "\t     - bit 7     = 1:interrupt at the start of vertical blank");
+	DisplayEnum("", 0, "\t     - bit 6     = 1:interrupt when GFX_SCANLINE == GFX_RASTER_CMP");
+	DisplayEnum("", 0, "\t     - bit 5     = vertical blank 0:IRQ, 1:FIRQ");
+	DisplayEnum("", 0, "\t     - bit 4     = raster line 0:IRQ, 1:FIRQ");
+    DisplayEnum("", 0, "");
+    nextAddr += 1;
+
+    DisplayEnum("GFX_IRQ_STATUS", nextAddr, " (Byte) Raster Interrupt Status");
+	DisplayEnum("", 0, "\t     - bit 7     = vertical blank interrupt pending");
+	DisplayEnum("", 0, "\t     - bit 6     = raster line interrupt pending");
+	DisplayEnum("", 0, "\t     - bit 0     = 1:beam is in the vertical blank (read only)");
+    DisplayEnum("", 0, "Note: Write a 1 to bits 6 or 7 to acknowledge the interrupt. The ");
+    DisplayEnum("", 0, "    interrupt line is held until it has been acknowledged.");
+    DisplayEnum("", 0, "");
+    nextAddr += 1;
+
+    DisplayEnum("GFX_RASTER_CMP", nextAddr, " (Word) Raster Line Interrupt Compare");
+    DisplayEnum("", 0, "");
+    nextAddr += 2;
+
+    DisplayEnum("GFX_SCANLINE", nextAddr, " (Word Read Only) Current Raster Line");
+    DisplayEnum("", 0, "Note: Lines 0 to VRES-1 are visible pixel rows, the rest of the frame");
+    DisplayEnum("", 0, "    is vertical blank. The beam is timed by the CPU clock at 60 frames");
+    DisplayEnum("", 0, "    per emulated second.");
+    DisplayEnum("", 0, "");
+    nextAddr += 2;
+
     DisplayEnum("GFX_END", nextAddr, " End of Graphics Hardware Registers");
     DisplayEnum("", 0, "");
 
@@ -324,7 +385,11 @@ void Gfx::OnInit()
             _gfx_glyph_data[i][r] = font8x8_system[i][r];
 
     // set the default monitor
-    s_gfx_emu |= (MAIN_MONITOR & 0x07);
+    _gfx_emu |= (MAIN_MONITOR & 0x07);
+
+    // headless machines never reach OnActivate()
+    if (Bus::IsHeadless())
+        _decode_resolution(_gfx_mode);
 
     // save the default palette
     SaveGimpPalette("retro_6809.gpl", "Retro 6809");
@@ -340,8 +405,8 @@ void Gfx::OnActivate()
     // printf("%s::OnActivate()\n", Name().c_str());
     _decode_gmode();
 
-    // s_gfx_emu
-    int MainMonitor = s_gfx_emu & 0x07;
+    // _gfx_emu
+    int MainMonitor = _gfx_emu & 0x07;
     // printf("MainMonitor: %d\n", MainMonitor);
 
     // TESTING,,,
@@ -502,6 +567,8 @@ void Gfx::OnEvent(SDL_Event* evnt)
 void Gfx::OnUpdate(float fElapsedTime)
 {
     // printf("%s::OnUpdate()\n", Name().c_str());
+    if (Bus::IsHeadless())
+        return;     // nothing to present
     SDL_SetRenderTarget(sdl_renderer, sdl_target_texture);
 
     SDL_SetRenderDrawColor(sdl_renderer, 0,0,0,0);
@@ -570,39 +637,93 @@ void Gfx::OnRender()
 bool Gfx::VerifyGmode(Byte gmode)
 {
     // Verify Graphics Mode
-    int bp_size = (res_width * res_height) / 8;
-    bits_per_pixel = 1<<((gmode & 0x60)>>5);
-    bIsBitmapMode = false;
-    if (gmode & 0x80)
-    {
-        bIsBitmapMode = true;
-        // single bit plane size is too big to fit in video memory
-        if (bp_size > VID_BUFFER_SIZE)
-        {
-            gmode &= 0x7f;  // clear the graphics mode bit
-            bIsBitmapMode = false;
-        }
-        else
-        {
-            // correct bits_per_pixel
-            if (bits_per_pixel > 1)
-            {
-                while (bp_size * bits_per_pixel > VID_BUFFER_SIZE)
-                {
-                    gmode -= 0x20;
-                    bits_per_pixel = 1<<((gmode & 0x60)>>5);
-                }
-            }
-        }
+    bool bBitmap = (gmode & 0x80);
+    gmode = _fitGmode(gmode, res_width, res_height);
+    bIsBitmapMode = (gmode & 0x80);
+    bits_per_pixel = _gmodeBpp(gmode);
+    if (bBitmap)
         IDevice::write(GFX_MODE, gmode);
-    }
-    if (!(gmode & 0x80))
-        bits_per_pixel = 0; // text only   
     if (gmode == Bus::Read(GFX_MODE))    
         return false;
     return true;
 }
 
+// the mode gmode falls back to at width x height: a bitmap mode whose bit planes do
+// not fit in the video buffer loses bits per pixel, or becomes a text mode
+Byte Gfx::_fitGmode(Byte gmode, int width, int height)
+{
+    if (!(gmode & 0x80))
+        return gmode;
+    int bp_size = (width * height) / 8;
+    // single bit plane size is too big to fit in video memory
+    if (bp_size > VID_BUFFER_SIZE)
+        return gmode & 0x7f;    // clear the graphics mode bit
+    // correct bits_per_pixel
+    while (bp_size * _gmodeBpp(gmode) > VID_BUFFER_SIZE)
+        gmode -= 0x20;
+    return gmode;
+}
+
+// draw the display as it would look in gmode, without SDL, into ARGB4444 pixels
+// (Capture hashes these on the CPU thread)
+void Gfx::RenderFrame(Byte gmode, std::vector<Uint16>& pixels, Word& width, Word& height)
+{
+    width = vec_gmodes[gmode & 0x1f].Res_Width;
+    height = vec_gmodes[gmode & 0x1f].Res_Height;
+    gmode = _fitGmode(gmode, width, height);
+    int pitch = width * sizeof(Uint16);
+    pixels.assign(width * height, 0);
+
+    Byte dsp_flags = Bus::Read(MEM_DSP_FLAGS);
+    if (dsp_flags & 0x80)
+        _drawExtendedBitmapScreen(pixels.data(), pitch, width, height);
+    else
+    {
+        //               ARGB 
+        Uint16 color = 0xF000 | (red(0)<<8) | (grn(0)<<4) | blu(0);
+        std::fill(pixels.begin(), pixels.end(), color);
+    }
+
+    // is standard display enabled?
+    if (dsp_flags & 0x40)
+    {
+        if (gmode & 0x80)
+            _drawBitmapScreen(pixels.data(), pitch, width, height, _gmodeBpp(gmode));
+        else
+            _drawTextScreen(pixels.data(), pitch, width, height);
+    }
+}
+
+
+// advance the raster beam by one CPU clock (called from the CPU thread)
+void Gfx::RasterClock()
+{
+    // lines per second over clocks per second
+    _raster_acc += _raster_lines * 60;
+    int rate = Bus::GetC6809()->ClockRate();
+    while (_raster_acc >= rate)
+    {
+        _raster_acc -= rate;
+        if (++_raster_line >= _raster_lines)
+        {
+            _raster_line = 0;
+            _raster_frame++;
+            Bus::GetCapture()->RasterFrame();
+        }
+        if (_raster_line == _raster_visible)
+            _irq_status |= 0x80;        // entering the vertical blank
+        if (_raster_line == _raster_cmp)
+            _irq_status |= 0x40;        // raster line match
+    }
+    // hold the interrupt line until acknowledged
+    Byte pending = _irq_status & _irq_ctrl & 0xC0;
+    if (pending)
+    {
+        C6809* cpu = Bus::GetC6809();
+        if (pending & 0x80)     (_irq_ctrl & 0x20) ? cpu->firq() : cpu->irq();
+        if (pending & 0x40)     (_irq_ctrl & 0x10) ? cpu->firq() : cpu->irq();
+    }
+}
 
 Word Gfx::GetTimingWidth()   
 { return vec_timings[vec_gmodes[Bus::Read(GFX_MODE) & 0x1f].Timing_index].Width;  }
@@ -620,9 +741,8 @@ void Gfx::_decode_gmode()
     auto desktop_width = DM.w;
     auto desktop_height = DM.h;
 
-    // texture size
-    res_width = vec_gmodes[gmode & 0x1f].Res_Width;
-    res_height = vec_gmodes[gmode & 0x1f].Res_Height;
+    // texture size, raster timing and video buffer
+    _decode_resolution(gmode);
     float aspect = (float)vec_timings[vec_gmodes[gmode & 0x1f].Timing_index].Width / 
                     (float)vec_timings[vec_gmodes[gmode & 0x1f].Timing_index].Height;
 
@@ -653,15 +773,6 @@ void Gfx::_decode_gmode()
 	if (gmode & 0x40)
 		sdl_renderer_flags = SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE | SDL_RENDERER_PRESENTVSYNC;
 
-    // Verify Graphics Mode
-    VerifyGmode(gmode);
-
-    // Video Buffer Size
-    gfx_vid_end = VIDEO_START + ((res_width * res_height)/8)*bits_per_pixel;
-    if (gfx_vid_end == VIDEO_START) // is a text mode
-        gfx_vid_end = VIDEO_START + ((res_width/8)*(res_height/8))*2;
-    gfx_vid_end--;  // prevent off by one errors        
-
     // VSYNC
     SDL_RenderSetVSync(sdl_renderer, (gemu & 0x40));
 
@@ -693,6 +804,29 @@ void Gfx::_decode_gmode()
     }
 }
 
+// the parts of a graphics mode that need no window (all a headless machine gets)
+void Gfx::_decode_resolution(Byte gmode)
+{
+    // texture size
+    res_width = vec_gmodes[gmode & 0x1f].Res_Width;
+    res_height = vec_gmodes[gmode & 0x1f].Res_Height;
+
+    // raster frame: visible rows plus a 525/480 proportioned vertical blank
+    _raster_visible = res_height;
+    _raster_lines = res_height + (res_height * 45 + 479) / 480;
+    if (_raster_line >= _raster_lines)
+        _raster_line = 0;
+
+    // Verify Graphics Mode
+    VerifyGmode(gmode);
+
+    // Video Buffer Size
+    gfx_vid_end = VIDEO_START + ((res_width * res_height)/8)*bits_per_pixel;
+    if (gfx_vid_end == VIDEO_START) // is a text mode
+        gfx_vid_end = VIDEO_START + ((res_width/8)*(res_height/8))*2;
+    gfx_vid_end--;  // prevent off by one errors        
+}
+
 void Gfx::_init_gmodes()
 {
     // Timings
@@ -760,72 +894,13 @@ void Gfx::_init_gmodes()
 
 void Gfx::_updateBitmapScreen()
 {
-    bool ignore_alpha = true;
-    if (Bus::Read(MEM_DSP_FLAGS) & 0x80) 
-        ignore_alpha = false;
-
-    Word pixel_index = VIDEO_START;
     void *pixels;
     int pitch;
     if (SDL_LockTexture(sdl_target_texture, NULL, &pixels, &pitch) < 0)
         Bus::Error("Failed to lock texture: ");	
     else
     {
-        for (int y = 0; y < res_height; y++)
-        {
-            for (int x = 0; x < res_width; )
-            {
-                // 256 color mode
-                if (bits_per_pixel == 8)
-                {
-                    Byte index = Bus::Read(pixel_index++);
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha);   
-                }
-                // 16 color mode
-                else if (bits_per_pixel == 4)
-                {
-                    Byte data = Bus::Read(pixel_index++);
-                    Byte index = (data >> 4);
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha);   
-                    index = (data & 0x0f);
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha);   
-                }
-                // 4 color mode
-                else if (bits_per_pixel == 2)
-                {
-                    Byte data = Bus::Read(pixel_index++);
-                    Byte index = (data >> 6) & 0x03;
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha);   
-                    index = (data >> 4) & 0x03;
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha);   
-                    index = (data >> 2) & 0x03;
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha);   
-                    index = (data >> 0) & 0x03;
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha);   
-                }
-                // 2 color mode
-                else if (bits_per_pixel == 1)
-                {
-                    Byte data = Bus::Read(pixel_index++);
-                    Byte index = (data >> 7) & 1;
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha); 
-                    index = (data >> 6) & 1;
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha);   
-                    index = (data >> 5) & 1;
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha);   
-                    index = (data >> 4) & 1;
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha);   
-                    index = (data >> 3) & 1;
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha);   
-                    index = (data >> 2) & 1;
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha);   
-                    index = (data >> 1) & 1;
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha);   
-                    index = (data >> 0) & 1;
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha);   
-                }
-            }
-        }
+        _drawBitmapScreen(pixels, pitch, res_width, res_height, bits_per_pixel);
         SDL_UnlockTexture(sdl_target_texture); 
     }
 
@@ -833,14 +908,75 @@ void Gfx::_updateBitmapScreen()
     SDL_RenderCopy(sdl_renderer, sdl_target_texture, NULL, NULL);		
 }
 
-
-
-void Gfx::_updateTextScreen() 
+// the standard bitmap display, drawn into width x height ARGB4444 pixels
+void Gfx::_drawBitmapScreen(void* pixels, int pitch, int width, int height, Byte bpp)
 {
     bool ignore_alpha = true;
     if (Bus::Read(MEM_DSP_FLAGS) & 0x80) 
         ignore_alpha = false;
 
+    Word pixel_index = VIDEO_START;
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; )
+        {
+            // 256 color mode
+            if (bpp == 8)
+            {
+                Byte index = Bus::Read(pixel_index++);
+                _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha);   
+            }
+            // 16 color mode
+            else if (bpp == 4)
+            {
+                Byte data = Bus::Read(pixel_index++);
+                Byte index = (data >> 4);
+                _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha);   
+                index = (data & 0x0f);
+                _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha);   
+            }
+            // 4 color mode
+            else if (bpp == 2)
+            {
+                Byte data = Bus::Read(pixel_index++);
+                Byte index = (data >> 6) & 0x03;
+                _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha);   
+                index = (data >> 4) & 0x03;
+                _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha);   
+                index = (data >> 2) & 0x03;
+                _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha);   
+                index = (data >> 0) & 0x03;
+                _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha);   
+            }
+            // 2 color mode
+            else if (bpp == 1)
+            {
+                Byte data = Bus::Read(pixel_index++);
+                Byte index = (data >> 7) & 1;
+                _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha); 
+                index = (data >> 6) & 1;
+                _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha);   
+                index = (data >> 5) & 1;
+                _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha);   
+                index = (data >> 4) & 1;
+                _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha);   
+                index = (data >> 3) & 1;
+                _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha);   
+                index = (data >> 2) & 1;
+                _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha);   
+                index = (data >> 1) & 1;
+                _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha);   
+                index = (data >> 0) & 1;
+                _setPixel_unlocked(pixels, pitch, x++, y, index, ignore_alpha);   
+            }
+        }
+    }
+}
+
+
+
+void Gfx::_updateTextScreen() 
+{
     void *pixels;
     int pitch;
 
@@ -850,38 +986,48 @@ void Gfx::_updateTextScreen()
     }
     else
     {
-        Byte col = res_height / 8;
-        Byte row = res_width / 8;
-        Word end = ((col*row)*2) + VIDEO_START;
-        // Word end  = VIDEO_START+128;
-		Word addr = VIDEO_START;
-		for (; addr < end; addr += 2)
+        _drawTextScreen(pixels, pitch, res_width, res_height);
+        SDL_UnlockTexture(sdl_target_texture); 
+    }
+} 
+
+// the text display, drawn into width x height ARGB4444 pixels
+void Gfx::_drawTextScreen(void* pixels, int pitch, int width, int height)
+{
+    bool ignore_alpha = true;
+    if (Bus::Read(MEM_DSP_FLAGS) & 0x80) 
+        ignore_alpha = false;
+
+    Byte col = height / 8;
+    Byte row = width / 8;
+    Word end = ((col*row)*2) + VIDEO_START;
+    // Word end  = VIDEO_START+128;
+	Word addr = VIDEO_START;
+	for (; addr < end; addr += 2)
+	{
+		Byte ch = Bus::Read(addr, true);
+		Byte at = Bus::Read(addr + 1, true);
+		Byte fg = at >> 4;
+		Byte bg = at & 0x0f;
+		Word index = addr - VIDEO_START;
+		Byte cols = width / 8;
+		int x = ((index / 2) % cols) * 8;
+		int y = ((index / 2) / cols) * 8;
+		for (int v = 0; v < 8; v++)
 		{
-			Byte ch = Bus::Read(addr, true);
-			Byte at = Bus::Read(addr + 1, true);
-			Byte fg = at >> 4;
-			Byte bg = at & 0x0f;
-			Word index = addr - VIDEO_START;
-			Byte width = res_width / 8;
-			int x = ((index / 2) % width) * 8;
-			int y = ((index / 2) / width) * 8;
-			for (int v = 0; v < 8; v++)
+			for (int h = 0; h < 8; h++)
 			{
-				for (int h = 0; h < 8; h++)
-				{
-					int color = bg;
-					// if (_gfx_glyph_data[ch][v] & (1 << 7 - h))
-                    Byte gd = Gfx::GetGlyphData(ch, v);
-					if (gd & (1 << (7 - h)))
-						color = fg;
-					// _setPixel_unlocked(pixels, pitch, x + h, y + v, 15);
-					_setPixel_unlocked(pixels, pitch, x + h, y + v, color, ignore_alpha);
-				}
+				int color = bg;
+				// if (_gfx_glyph_data[ch][v] & (1 << 7 - h))
+                Byte gd = GetGlyphData(ch, v);
+				if (gd & (1 << (7 - h)))
+					color = fg;
+				// _setPixel_unlocked(pixels, pitch, x + h, y + v, 15);
+				_setPixel_unlocked(pixels, pitch, x + h, y + v, color, ignore_alpha);
 			}
 		}
-        SDL_UnlockTexture(sdl_target_texture); 
-    }
-} 
+	}
+}
 
 void Gfx::_setPixel(int x, int y, Byte color_index, 
 						SDL_Texture* _texture, bool bIgnoreAlpha)
@@ -975,6 +1121,24 @@ void Gfx::_setPixel_unlocked(void* pixels, int pitch, int x, int y, Byte color_i
 
 
 void Gfx::_updateExtendedBitmapScreen()
+{
+    // display the extended bitmap buffer
+    void *pixels;
+    int pitch;
+    if (SDL_LockTexture(sdl_target_texture, NULL, &pixels, &pitch) < 0)
+        Bus::Error("Failed to lock texture: ");	
+    else
+    {
+        _drawExtendedBitmapScreen(pixels, pitch, res_width, res_height);
+        SDL_UnlockTexture(sdl_target_texture); 
+    }
+
+    // SDL_SetRenderTarget(_renderer, _render_target);
+    SDL_RenderCopy(sdl_renderer, sdl_target_texture, NULL, NULL);		
+}
+
+// the extended bitmap buffer, drawn into width x height ARGB4444 pixels
+void Gfx::_drawExtendedBitmapScreen(void* pixels, int pitch, int width, int height)
 {
     Memory* mm = Bus::GetMemory();
 
@@ -994,79 +1158,66 @@ void Gfx::_updateExtendedBitmapScreen()
     // printf("BPP:%d  SIZE:$%04X\n", bpp, size);
 	//
 
-
-    // display the extended bitmap buffer
     Word pixel_index = 0x0000;
-    void *pixels;
-    int pitch;
-    if (SDL_LockTexture(sdl_target_texture, NULL, &pixels, &pitch) < 0)
-        Bus::Error("Failed to lock texture: ");	
-    else
+    for (int y = 0; y < height; y++)
     {
-        for (int y = 0; y < res_height; y++)
+        for (int x = 0; x < width; )
         {
-            for (int x = 0; x < res_width; )
+            // 256 color mode
+            if (bpp == 8)
             {
-                // 256 color mode
-                if (bpp == 8)
-                {
 // printf("256-colors\n");
-                    Byte index = mm->ext_memory[pixel_index++];
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                }
-                // 16 color mode
-                else if (bpp == 4)
-                {
+                Byte index = mm->ext_memory[pixel_index++];
+                _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
+            }
+            // 16 color mode
+            else if (bpp == 4)
+            {
 // printf("16-colors\n");
-                    Byte data = mm->ext_memory[pixel_index++];
-                    Byte index = (data >> 4);
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                    index = (data & 0x0f);
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                }
-                // 4 color mode
-                else if (bpp == 2)
-                {
+                Byte data = mm->ext_memory[pixel_index++];
+                Byte index = (data >> 4);
+                _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
+                index = (data & 0x0f);
+                _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
+            }
+            // 4 color mode
+            else if (bpp == 2)
+            {
 // printf("4-colors\n");
-                    Byte data = mm->ext_memory[pixel_index++];
-                    Byte index = (data >> 6) & 0x03;
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                    index = (data >> 4) & 0x03;
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                    index = (data >> 2) & 0x03;
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                    index = (data >> 0) & 0x03;
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                }
-                // 2 color mode
-                else if (bpp == 1)
-                {
+                Byte data = mm->ext_memory[pixel_index++];
+                Byte index = (data >> 6) & 0x03;
+                _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
+                index = (data >> 4) & 0x03;
+                _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
+                index = (data >> 2) & 0x03;
+                _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
+                index = (data >> 0) & 0x03;
+                _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
+            }
+            // 2 color mode
+            else if (bpp == 1)
+            {
 // printf("2-colors\n");
-                    Byte data = mm->ext_memory[pixel_index++];
-                    Byte index = (data >> 7) & 1;
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, true); 
-                    index = (data >> 6) & 1;
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                    index = (data >> 5) & 1;
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                    index = (data >> 4) & 1;
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                    index = (data >> 3) & 1;
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                    index = (data >> 2) & 1;
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                    index = (data >> 1) & 1;
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                    index = (data >> 0) & 1;
-                    _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                }
+                Byte data = mm->ext_memory[pixel_index++];
+                Byte index = (data >> 7) & 1;
+                _setPixel_unlocked(pixels, pitch, x++, y, index, true); 
+                index = (data >> 6) & 1;
+                _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
+                index = (data >> 5) & 1;
+                _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
+                index = (data >> 4) & 1;
+                _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
+                index = (data >> 3) & 1;
+                _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
+                index = (data >> 2) & 1;
+                _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
+                index = (data >> 1) & 1;
+                _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
+                index = (data >> 0) & 1;
+                _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
             }
         }
-        SDL_UnlockTexture(sdl_target_texture); 
     }
-
-    // SDL_SetRenderTarget(_renderer, _render_target);
-    SDL_RenderCopy(sdl_renderer, sdl_target_texture, NULL, NULL);		
 }
 
 
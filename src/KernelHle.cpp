@@ -0,0 +1,280 @@
+/**************************
+* KernelHle.cpp
+*
+* High level emulation of the kernel ROM routines (CPU_KERNEL_HLE)
+*
+* Copyright (C) 2023 by Jay Faries
+**************************************/
+
+#include <algorithm>
+
+#include "types.hpp"
+#include "Bus.hpp"
+#include "C6809.hpp"
+#include "Debug.hpp"
+
+// kernel software vectors and zero page variables (kernel_header.asm)
+enum KERNEL_ABI : Word {
+	VEC_CLS			= 0x0010,
+	VEC_CHROUT		= 0x0012,
+	VEC_NEWLINE		= 0x0014,
+	VEC_LINEOUT		= 0x0016,
+	VEC_CSRPOS		= 0x0018,
+	VEC_SCROLL		= 0x001A,
+	VEC_CMPSTR		= 0x0024,
+	VEC_TBLSEARCH	= 0x0028,
+	_CURSOR_COL		= 0x005A,
+	_CURSOR_ROW		= 0x005B,
+	_ATTRIB			= 0x005C,
+	_ANCHOR_ROW		= 0x005E,
+};
+
+///// TRAPS /////////////////////////////////////////////////////////////
+
+// Each KRNL_ entry point in the ROM is a 'jmp [VEC_]' whose default target,
+// the STUB_ routine, follows it directly. The entry points are found by
+// their instruction rather than by address, so a reassembled kernel keeps
+// its traps.
+void C6809::hle_scan()
+{
+	using C = C6809;
+	constexpr Word self[HLE_MAX] = {
+		1 << HLE_CLS, 1 << HLE_CHROUT, 1 << HLE_NEWLINE, 1 << HLE_LINEOUT,
+		1 << HLE_CSRPOS, 1 << HLE_SCROLL, 1 << HLE_CMPSTR, 1 << HLE_TBLSEARCH };
+	const Word chrout = self[HLE_CHROUT] | self[HLE_CSRPOS] | self[HLE_NEWLINE] | self[HLE_SCROLL];
+	_hle[HLE_CLS]		= { VEC_CLS,		self[HLE_CLS],							&C::hle_cls };
+	_hle[HLE_CHROUT]	= { VEC_CHROUT,		chrout,									&C::hle_chrout };
+	_hle[HLE_NEWLINE]	= { VEC_NEWLINE,	self[HLE_NEWLINE] | self[HLE_SCROLL],	&C::hle_newline };
+	_hle[HLE_LINEOUT]	= { VEC_LINEOUT,	self[HLE_LINEOUT] | chrout,				&C::hle_lineout };
+	_hle[HLE_CSRPOS]	= { VEC_CSRPOS,		self[HLE_CSRPOS],						&C::hle_csrpos };
+	_hle[HLE_SCROLL]	= { VEC_SCROLL,		self[HLE_SCROLL],						&C::hle_scroll };
+	_hle[HLE_CMPSTR]	= { VEC_CMPSTR,		self[HLE_CMPSTR],						&C::hle_cmpstr };
+	_hle[HLE_TBLSEARCH]	= { VEC_TBLSEARCH,	self[HLE_TBLSEARCH] | self[HLE_CMPSTR],	&C::hle_tblsearch };
+
+	_hle_lo = 0xffff;
+	_hle_hi = 0x0000;
+	for (DWord a = KERNEL_ROM; a < 0xfffc; a++)
+	{
+		if (m_bus->read(a, true) != 0x6e || m_bus->read(a + 1, true) != 0x9f)
+			continue;
+		Word vector = (m_bus->read(a + 2, true) << 8) | m_bus->read(a + 3, true);
+		for (auto& t : _hle)
+		{
+			if (t.vector == vector && t.entry == 0)
+			{
+				t.entry = a;
+				_hle_lo = std::min(_hle_lo, (Word)a);
+				_hle_hi = std::max(_hle_hi, (Word)a);
+			}
+		}
+	}
+	// a routine whose callees are missing is left to the ROM
+	for (auto& t : _hle)
+		for (int d = 0; d < HLE_MAX; d++)
+			if ((t.deps & (1 << d)) && _hle[d].entry == 0)
+				t.deps = 0;
+}
+
+bool C6809::hle_trap()
+{
+	// the debugger steps through the ROM code
+	if (m_bus->_debug->IsActive())
+		return false;
+	for (auto& t : _hle)
+	{
+		if (t.entry != PC || t.deps == 0)
+			continue;
+		for (int d = 0; d < HLE_MAX; d++)
+			if ((t.deps & (1 << d)) && !hle_default(d))
+				return false;
+		(this->*t.call)();
+		do_pul(S, PC);		// the routine's RTS
+		cycles = _hle_cycles;
+		return true;
+	}
+	return false;
+}
+
+///// SHARED BODIES /////////////////////////////////////////////////////
+
+// STUB_CSRPOS: the video address of the cursor
+Word C6809::do_csrpos()
+{
+	Byte row = read(_CURSOR_ROW);
+	Byte cols = read(GFX_HRES + 1) << 1;
+	Word x = VIDEO_START + row * cols;
+	x += (Byte)(read(_CURSOR_COL) << 1);
+	return x;
+}
+
+// STUB_CHROUT without its register saves
+void C6809::do_chrout(Byte a)
+{
+	Byte b = read(_ATTRIB);
+	if (a == 0)
+		return;
+	if (a == 0x0a)
+	{
+		hle_newline();
+		return;
+	}
+	write_word(do_csrpos(), (a << 8) | b);
+	write(_CURSOR_COL, read(_CURSOR_COL) + 1);
+	if ((Sint8)read(_CURSOR_COL) < (Sint8)read(GFX_HRES + 1))
+		return;
+	hle_newline();
+}
+
+// STUB_SCROLL
+void C6809::do_scroll()
+{
+	Word end = read_word(GFX_VID_END);
+	Word x = VIDEO_START;
+	Word u = x + (Byte)(read(GFX_HRES + 1) << 1);
+	do {
+		write_word(x, read_word(u));
+		x += 2;
+		u += 2;
+	} while ((Sint16)u < (Sint16)end);
+	do {
+		write(x, ' ');
+		x += 2;
+	} while ((Sint16)x < (Sint16)end);
+	set_flags(LAZY_CMP16, x, end, x - end);
+	Byte edit = read(EDT_ENABLE);
+	set_flags(LAZY_LOGIC8, 0, 0, edit);
+	if (edit)
+	{
+		Byte row = read(_ANCHOR_ROW);
+		do_dec(row);
+		write(_ANCHOR_ROW, row);
+	}
+}
+
+// STUB_CMPSTR: -1, 0 or 1 as string 1 is less than, equal to or greater
+// than string 2, with X and Y left where the ROM leaves them
+int C6809::do_cmpstr(Word& x, Word& y)
+{
+	while (true)
+	{
+		if (read(x) == 0)
+			return read(y) ? -1 : 0;
+		if (read(y) == 0)
+			return 1;
+		Byte a = read(x++) | 0x20;
+		Byte m = read(y++);
+		if ((Sint8)a < (Sint8)m)
+			return -1;
+		if ((Sint8)a > (Sint8)m)
+			return 1;
+	}
+}
+
+///// ROUTINES //////////////////////////////////////////////////////////
+
+void C6809::hle_cls()
+{
+	Word end = read_word(GFX_VID_END);
+	Word x = VIDEO_START;
+	do {
+		write_word(x, D);
+		x += 2;
+	} while ((Sint16)x < (Sint16)end);
+	Byte zero;
+	do_clr(zero);
+	write(_CURSOR_COL, zero);
+	write(_CURSOR_ROW, zero);
+}
+void C6809::hle_chrout()
+{
+	Byte cc = getCC();
+	do_chrout(A);
+	setCC(cc);
+}
+void C6809::hle_newline()
+{
+	write(_CURSOR_COL, 0);
+	write(_CURSOR_ROW, read(_CURSOR_ROW) + 1);
+	Byte row = read(_CURSOR_ROW);
+	Byte rows = read(GFX_VRES + 1);
+	set_flags(LAZY_SUB8, row, rows, (row - rows) & 0xffff);
+	if ((Sint8)row < (Sint8)rows)
+		return;
+	write(_CURSOR_ROW, read(_CURSOR_ROW) - 1);
+	do_scroll();
+}
+void C6809::hle_lineout()
+{
+	Word u = X;
+	Word x = X;
+	hle_csrpos();		// called for its flags, as the ROM does
+	X = x;
+	Byte c;
+	while ((c = read(u++)) && !(c & 0x80))
+	{
+		// STUB_CHROUT restores CC, so a newline or wrap leaves C alone
+		Byte cc = getCC();
+		do_chrout(c);
+		setCC(cc);
+	}
+	set_flags(LAZY_LOGIC8, 0, 0, c);
+}
+void C6809::hle_csrpos()
+{
+	X = do_csrpos();
+	Byte zero;
+	do_clr(zero);
+	CC.bit.Z = !X;
+}
+void C6809::hle_scroll()
+{
+	do_scroll();
+}
+void C6809::hle_cmpstr()
+{
+	int r = do_cmpstr(X, Y);
+	Byte a = r < 0 ? 1 : r > 0 ? 2 : 0;
+	Byte m = r < 0 ? 2 : r > 0 ? 1 : 0;
+	set_flags(LAZY_SUB8, a, m, (a - m) & 0xffff);
+}
+void C6809::hle_tblsearch()
+{
+	Word u = X;
+	Word y = Y;
+	Byte index = 0;
+	while (true)
+	{
+		X = u;
+		if (do_cmpstr(X, y) == 0)
+			break;
+		index++;
+		Byte b;
+		do {
+			b = read(y++);
+		} while (b != 0xff && b != 0);
+		if (b == 0xff)
+		{
+			index = 0xff;
+			break;
+		}
+	}
+	A = index;
+}
+
+
+/**** NOTES *******************************************************************************
+ *
+ *  When the CPU reaches a KRNL_ entry point at an instruction boundary, the routine runs
+ *      here instead, the return address is pulled as the ROM's RTS would, and the call
+ *      is charged HleCycles() cycles. Registers, condition codes and memory above S end
+ *      up as the ROM code leaves them; the scratch bytes it pushes below S are not
+ *      written.
+ *
+ *  A routine is only trapped while its VEC_ software vector, and the vectors of every
+ *      routine it calls through them, still point at the ROM defaults. A program that
+ *      replaces VEC_SCROLL therefore also gets the interpreted KRNL_CHROUT, so its own
+ *      scroll routine is still called.
+ *
+ *  The traps are off while the debugger is open, so the ROM code can be stepped.
+ *
+ **** NOTES *******************************************************************************/
@@ -464,6 +464,17 @@ void Keyboard::OnEvent(SDL_Event* evnt)
 }
 
 
+void Keyboard::OnUpdate(float fElapsedTime)
+{
+	// type the next scripted key once the last one has been taken
+	if (_typed.empty() || !charQueue.empty())
+		return;
+	Byte key = _typed.front();
+	_typed.pop_front();
+	_doEditBuffer(key);
+	charQueue.push(key);
+}
+
 void Keyboard::_doEditBuffer(char xkey)
 {
 	// basic keyboard buffer character line editor
@@ -582,6 +593,11 @@ Byte Keyboard::charPopQueue() {
 	return ret;
 }
 
+void Keyboard::Type(const std::string& text) {
+	for (char c : text)
+		_typed.push_back(c == '\n' ? 0x0d : (Byte)c);
+}
+
 XKey::XK Keyboard::TranslateSDLtoXKey(SDL_Scancode k)
 {
 	for (auto& a : keyMap)
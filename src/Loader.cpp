@@ -0,0 +1,176 @@
+// *************************************************
+// *
+// * Loader.cpp
+// *
+// ***********************************
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdio>
+#include "Loader.hpp"
+#include "Bus.hpp"
+
+// hex digit values, -1 for anything else
+static constexpr std::array<Sint8, 256> hex_table()
+{
+    std::array<Sint8, 256> table{};
+    for (int c = 0; c < 256; c++)
+        table[c] = -1;
+    for (int c = 0; c < 10; c++)
+        table['0' + c] = c;
+    for (int c = 0; c < 6; c++)
+        table['A' + c] = table['a' + c] = 10 + c;
+    return table;
+}
+static constexpr std::array<Sint8, 256> s_hex = hex_table();
+
+// the record bytes of one line, false if it is not all hex digit pairs
+static bool hex_bytes(const Byte*& p, const Byte* end, std::vector<Byte>& out)
+{
+    out.clear();
+    while (p < end && *p != '\r' && *p != '\n')
+    {
+        if (end - p < 2 || s_hex[p[0]] < 0 || s_hex[p[1]] < 0)
+            return false;
+        out.push_back((s_hex[p[0]] << 4) | s_hex[p[1]]);
+        p += 2;
+    }
+    return true;
+}
+
+Loader::FORMAT Loader::Format(const std::string& filename)
+{
+    std::string ext = filename.substr(std::min(filename.rfind('.'), filename.size()));
+    while (!ext.empty() && ext.back() == ' ')
+        ext.pop_back();
+    for (auto& c : ext)
+        c = tolower(c);
+    if (ext == ".s19" || ext == ".s28" || ext == ".s37" || ext == ".srec" || ext == ".mot")
+        return FMT_SREC;
+    if (ext == ".bin")
+        return FMT_BIN;
+    return FMT_HEX;
+}
+
+bool Loader::ReadFile(const std::string& filename, std::vector<Byte>& data)
+{
+    FILE* fp = fopen(filename.c_str(), "rb");
+    if (!fp)
+        return false;
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    data.resize(size > 0 ? size : 0);
+    data.resize(fread(data.data(), 1, data.size(), fp));
+    fclose(fp);
+    return true;
+}
+
+bool Loader::Parse(const Byte* data, DWord len, FORMAT format, Word bin_addr)
+{
+    _runs.clear();
+    _bytes.clear();
+    bool ok = true;
+    if (format == FMT_BIN)
+        _add(bin_addr, data, len);
+    else if (format == FMT_SREC)
+        ok = _srec(data, len);
+    else
+        ok = _hex(data, len);
+    if (!ok)
+    {
+        _runs.clear();
+        _bytes.clear();
+    }
+    return ok;
+}
+
+void Loader::Store()
+{
+    Bus& bus = Bus::Inst();
+    for (auto& run : _runs)
+        bus.write_block(run.addr, _bytes.data() + run.start, run.length);
+}
+
+void Loader::_add(Word addr, const Byte* data, DWord len)
+{
+    // joined onto the run it follows on from
+    if (_runs.empty() || (Word)(_runs.back().addr + _runs.back().length) != addr ||
+        _runs.back().length + len > 0x10000)
+        _runs.push_back({ addr, (DWord)_bytes.size(), 0 });
+    _runs.back().length += len;
+    _bytes.insert(_bytes.end(), data, data + len);
+}
+
+bool Loader::_hex(const Byte* p, DWord len)
+{
+    const Byte* end = p + len;
+    std::vector<Byte> rec;
+    while (p < end)
+    {
+        if (isspace(*p))
+        {
+            p++;
+            continue;
+        }
+        if (*p++ != ':' || !hex_bytes(p, end, rec) || rec.size() < 5 || rec.size() != 5u + rec[0])
+            return false;
+        Byte sum = 0;
+        for (Byte b : rec)
+            sum += b;
+        if (sum != 0)
+            return false;
+        Byte type = rec[3];
+        if (type == 0x00)
+            _add((rec[1] << 8) | rec[2], rec.data() + 4, rec[0]);
+        else if (type == 0x01)
+            return true;
+        else if (type > 0x05)
+            return false;
+    }
+    return true;
+}
+
+bool Loader::_srec(const Byte* p, DWord len)
+{
+    const Byte* end = p + len;
+    std::vector<Byte> rec;
+    while (p < end)
+    {
+        if (isspace(*p))
+        {
+            p++;
+            continue;
+        }
+        if (end - p < 2 || p[0] != 'S' || !isdigit(p[1]))
+            return false;
+        int type = p[1] - '0';
+        p += 2;
+        if (!hex_bytes(p, end, rec) || rec.size() < 3 || rec.size() != 1u + rec[0])
+            return false;
+        Byte sum = 0;
+        for (Byte b : rec)
+            sum += b;
+        if (sum != 0xff)
+            return false;
+        if (type >= 1 && type <= 3)
+        {
+            int alen = type + 1;
+            if (rec[0] < alen + 1)
+                return false;
+            DWord addr = 0;
+            for (int t = 0; t < alen; t++)
+                addr = (addr << 8) | rec[1 + t];
+            DWord n = rec[0] - alen - 1;
+            if (addr + n > 0x10000)
+                return false;
+            _add((Word)addr, rec.data() + 1 + alen, n);
+        }
+        else if (type >= 7)
+            return true;
+        else if (type == 4)
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,82 @@
+// *************************************************
+// *
+// * Machine.cpp
+// *
+// ***********************************
+
+#include "Machine.hpp"
+#include "C6809.hpp"
+#include "Gfx.hpp"
+#include "FileIO.hpp"
+#include "Keyboard.hpp"
+#include "Capture.hpp"
+
+Machine::Machine(const std::string& paged_file)
+{
+    // builds (and binds to this thread) a bus with no window and no CPU thread
+    _bus = new Bus(true, paged_file);
+}
+
+Machine::~Machine()
+{
+    // close down all of the attached devices, as Bus::Run() does on exit
+    _bus->OnQuit();
+    delete _bus;
+    _bus = nullptr;
+}
+
+void Machine::LoadHex(const std::string& filename, Word bin_addr)
+{
+    _bus->load_hex(filename.c_str(), bin_addr);
+}
+
+bool Machine::MountDisk(const std::string& image, bool write_back)
+{
+    return _bus->_fileio->Mount(image, write_back);
+}
+
+void Machine::Reset()
+{
+    _bus->_c6809->reset();
+}
+
+QWord Machine::Run(QWord clocks)
+{
+    C6809* cpu = _bus->_c6809;
+    QWord count = 0;
+    while (count < clocks && _bus->_bIsRunning)
+    {
+        cpu->clock_input();
+        _bus->_clockHeadless();
+        count++;
+    }
+    return count;
+}
+
+DWord Machine::RunFrames(DWord frames)
+{
+    C6809* cpu = _bus->_c6809;
+    Gfx* gfx = _bus->_gfx;
+    DWord start = gfx->GetRasterFrame();
+    while (gfx->GetRasterFrame() - start < frames && _bus->_bIsRunning)
+    {
+        cpu->clock_input();
+        _bus->_clockHeadless();
+    }
+    return gfx->GetRasterFrame() - start;
+}
+
+QWord Machine::Cycles()
+{
+    return _bus->_c6809->getCycleCount();
+}
+
+void Machine::Type(const std::string& text)
+{
+    _bus->_keyboard->Type(text);
+}
+
+QWord Machine::FrameHash(Byte gmode)
+{
+    return _bus->_capture->FrameHash(gmode);
+}
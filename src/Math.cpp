@@ -7,7 +7,9 @@
 #include "Bus.hpp"
 #include "Math.hpp"
 #include <cfloat>
+#include <charconv>
 #include <cmath>
+#include <cstring>
 #include <time.h>		// for srand()
 
 Byte Math::read(Word offset, bool debug) 
@@ -18,20 +20,17 @@ Byte Math::read(Word offset, bool debug)
     // read ACA
     if (offset >= MATH_ACA_POS && offset <= MATH_ACA_INT+4)
     {
-        data = _read_acc(offset, MATH_ACA_POS,
-            aca_pos, aca_float, aca_string, aca_raw, aca_int);
+        data = _read_acc(offset, MATH_ACA_POS, aca);
     }
     // read ACB
     if (offset >= MATH_ACB_POS && offset <= MATH_ACB_INT+4)
     {
-        data = _read_acc(offset, MATH_ACB_POS,
-            acb_pos, acb_float, acb_string, acb_raw, acb_int);
+        data = _read_acc(offset, MATH_ACB_POS, acb);
     }
     // read ACR
     if (offset >= MATH_ACR_POS && offset <= MATH_ACR_INT+4)
     {
-        data = _read_acc(offset, MATH_ACR_POS,
-            acr_pos, acr_float, acr_string, acr_raw, acr_int);
+        data = _read_acc(offset, MATH_ACR_POS, acr);
     }    
     // read the last math operation used
     if (offset == MATH_OPERATION)
@@ -47,20 +46,17 @@ void Math::write(Word offset, Byte data, bool debug)
     // write ACB
     if (offset >= MATH_ACA_POS && offset <= MATH_ACA_INT+4)
     {
-        data = _write_acc(offset, data, MATH_ACA_POS, 
-            aca_pos, aca_float, aca_string, aca_raw, aca_int);
+        data = _write_acc(offset, data, MATH_ACA_POS, aca);
     }
     // write ACB
     if (offset >= MATH_ACB_POS && offset <= MATH_ACB_INT+4)
     {
-        data = _write_acc(offset, data, MATH_ACB_POS,
-            acb_pos, acb_float, acb_string, acb_raw, acb_int);
+        data = _write_acc(offset, data, MATH_ACB_POS, acb);
     }
     // write ACR
     if (offset >= MATH_ACR_POS && offset <= MATH_ACR_INT+4)
     {
-        data = _write_acc(offset, data, MATH_ACR_POS,
-            acr_pos, acr_float, acr_string, acr_raw, acr_int);
+        data = _write_acc(offset, data, MATH_ACR_POS, acr);
     }
     // write and execute the math operation
     if (offset == MATH_OPERATION)
@@ -73,178 +69,131 @@ void Math::write(Word offset, Byte data, bool debug)
                 srand(math_random_seed);
                 math_random_seed = rand();
 
-                _update_regs_from_float(((float)rand() / (RAND_MAX)),
-                    aca_float, aca_pos, aca_string, aca_raw, aca_int);
-                aca_int = rand() << 16 | rand();
-                _update_regs_from_float(((float)rand() / (RAND_MAX)),
-                    acb_float, acb_pos, acb_string, acb_raw, acb_int);
-                acb_int = rand() << 16 | rand();
-                _update_regs_from_float(((float)rand() / (RAND_MAX)),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int);
+                _update_regs_from_float(((float)rand() / (RAND_MAX)), aca);
+                aca.integer = rand() << 16 | rand();
+                _update_regs_from_float(((float)rand() / (RAND_MAX)), acb);
+                acb.integer = rand() << 16 | rand();
+                _update_regs_from_float(((float)rand() / (RAND_MAX)), acr);
 
-                acr_int = rand() << 16 | rand();
+                acr.integer = rand() << 16 | rand();
                 break;
             }
             case MOP_RND_SEED:
             {
-                math_random_seed = aca_int;
+                math_random_seed = aca.integer;
                 srand(math_random_seed);
                 break;
             }
-            case MOP_IS_EQUAL:      { acr_int = (bool)(aca_float == acb_float); break; }
-            case MOP_IS_NOT_EQUAL:  { acr_int = (bool)(aca_float != acb_float); break; }
-            case MOP_IS_LESS:       { acr_int = (bool)(aca_float < acb_float); break; }
-            case MOP_IS_GREATER:    { acr_int = (bool)(aca_float > acb_float); break; }
-            case MOP_IS_LTE:        { acr_int = (bool)(aca_float <= acb_float); break; }
-            case MOP_IS_GTE:        { acr_int = (bool)(aca_float >= acb_float); break; }
+            case MOP_IS_EQUAL:      { acr.integer = (bool)(aca.value == acb.value); break; }
+            case MOP_IS_NOT_EQUAL:  { acr.integer = (bool)(aca.value != acb.value); break; }
+            case MOP_IS_LESS:       { acr.integer = (bool)(aca.value < acb.value); break; }
+            case MOP_IS_GREATER:    { acr.integer = (bool)(aca.value > acb.value); break; }
+            case MOP_IS_LTE:        { acr.integer = (bool)(aca.value <= acb.value); break; }
+            case MOP_IS_GTE:        { acr.integer = (bool)(aca.value >= acb.value); break; }
 
-            case MOP_IS_FINITE:     { acr_int = (bool)(std::isfinite(aca_float)); break; }
-            case MOP_IS_INF:        { acr_int = (bool)(std::isinf(aca_float)); break; }
-            case MOP_IS_NAN:        { acr_int = (bool)(std::isnan(aca_float)); break; }
-            case MOP_IS_NORMAL:     { acr_int = (bool)(std::isnormal(aca_float)); break; }
-            case MOP_SIGNBIT:       { acr_int = (bool)(std::signbit(aca_float)); break; }
+            case MOP_IS_FINITE:     { acr.integer = (bool)(std::isfinite(aca.value)); break; }
+            case MOP_IS_INF:        { acr.integer = (bool)(std::isinf(aca.value)); break; }
+            case MOP_IS_NAN:        { acr.integer = (bool)(std::isnan(aca.value)); break; }
+            case MOP_IS_NORMAL:     { acr.integer = (bool)(std::isnormal(aca.value)); break; }
+            case MOP_SIGNBIT:       { acr.integer = (bool)(std::signbit(aca.value)); break; }
 
             case MOP_SUBTRACT: {
-                _update_regs_from_float((aca_float - acb_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float((aca.value - acb.value), acr); break; }
             case MOP_ADD: {
-                _update_regs_from_float((aca_float + acb_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float((aca.value + acb.value), acr); break; }
             case MOP_MULTIPLY: {
-                _update_regs_from_float((aca_float * acb_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int);  break; }
+                _update_regs_from_float((aca.value * acb.value), acr);  break; }
             case MOP_DIVIDE: {
-                _update_regs_from_float((aca_float / acb_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float((aca.value / acb.value), acr); break; }
             case MOP_FMOD: {
-                _update_regs_from_float(std::fmod(aca_float, acb_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::fmod(aca.value, acb.value), acr); break; }
             case MOP_REMAINDER: {
-                _update_regs_from_float(std::remainder(aca_float, acb_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::remainder(aca.value, acb.value), acr); break; }
             case MOP_FMAX: {
-                _update_regs_from_float(std::fmax(aca_float, acb_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::fmax(aca.value, acb.value), acr); break; }
             case MOP_FMIN: {
-                _update_regs_from_float(std::fmin(aca_float, acb_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::fmin(aca.value, acb.value), acr); break; }
             case MOP_FDIM: {
-                _update_regs_from_float(std::fdim(aca_float, acb_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::fdim(aca.value, acb.value), acr); break; }
             case MOP_EXP: {
-                _update_regs_from_float(std::exp(aca_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::exp(aca.value), acr); break; }
             case MOP_EXP2: {
-                _update_regs_from_float(std::exp2(aca_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::exp2(aca.value), acr); break; }
             case MOP_EXPM1: {
-                _update_regs_from_float(std::expm1(aca_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::expm1(aca.value), acr); break; }
             case MOP_LOG: {
-                _update_regs_from_float(std::log(aca_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::log(aca.value), acr); break; }
             case MOP_LOG10: {
-                _update_regs_from_float(std::log10(aca_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::log10(aca.value), acr); break; }
             case MOP_LOG2: {
-                _update_regs_from_float(std::log2(aca_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::log2(aca.value), acr); break; }
             case MOP_LOG1P: {
-                _update_regs_from_float(std::log1p(aca_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::log1p(aca.value), acr); break; }
             case MOP_SQRT: {
-                _update_regs_from_float(std::sqrt(aca_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::sqrt(aca.value), acr); break; }
             case MOP_CBRT: {
-                _update_regs_from_float(std::cbrt(aca_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::cbrt(aca.value), acr); break; }
             case MOP_HYPOT: {
-                _update_regs_from_float(std::hypot(aca_float, acb_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::hypot(aca.value, acb.value), acr); break; }
             case MOP_POW: {
-                _update_regs_from_float(std::pow(aca_float, acb_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::pow(aca.value, acb.value), acr); break; }
             case MOP_SIN: {
-                _update_regs_from_float(std::sin(aca_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::sin(aca.value), acr); break; }
             case MOP_COS: {
-                _update_regs_from_float(std::cos(aca_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::cos(aca.value), acr); break; }
             case MOP_TAN: {
-                _update_regs_from_float(std::tan(aca_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::tan(aca.value), acr); break; }
             case MOP_ASIN: {
-                _update_regs_from_float(std::asin(aca_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::asin(aca.value), acr); break; }
             case MOP_ACOS: {
-                _update_regs_from_float(std::acos(aca_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::acos(aca.value), acr); break; }
             case MOP_ATAN: {
-                _update_regs_from_float(std::atan(aca_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::atan(aca.value), acr); break; }
             case MOP_ATAN2: {
-                _update_regs_from_float(std::atan2(aca_float, acb_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::atan2(aca.value, acb.value), acr); break; }
             case MOP_COSH: {
-                _update_regs_from_float(std::acosh(aca_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::acosh(aca.value), acr); break; }
             case MOP_ATANH: {
-                _update_regs_from_float(std::atanh(aca_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::atanh(aca.value), acr); break; }
             case MOP_ERF: {
-                _update_regs_from_float(std::erf(aca_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::erf(aca.value), acr); break; }
             case MOP_ERFC: {
-                _update_regs_from_float(std::erfc(aca_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::erfc(aca.value), acr); break; }
             case MOP_LGAMMA: {
-                _update_regs_from_float(std::lgamma(aca_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::lgamma(aca.value), acr); break; }
             case MOP_TGAMMA: {
-                _update_regs_from_float(std::tgamma(aca_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::tgamma(aca.value), acr); break; }
             case MOP_CEIL: {
-                _update_regs_from_float(std::ceil(aca_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::ceil(aca.value), acr); break; }
             case MOP_FLOOR: {
-                _update_regs_from_float(std::floor(aca_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::floor(aca.value), acr); break; }
             case MOP_TRUNC: {
-                _update_regs_from_float(std::trunc(aca_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::trunc(aca.value), acr); break; }
             case MOP_ROUND: {
-                _update_regs_from_float(std::round(aca_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::round(aca.value), acr); break; }
             case MOP_LROUND: {
-                _update_regs_from_float(std::lround(aca_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::lround(aca.value), acr); break; }
             case MOP_NEARBYINT: {
-                _update_regs_from_float(std::nearbyint(aca_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::nearbyint(aca.value), acr); break; }
             case MOP_ILOGB: {
-                _update_regs_from_float(std::ilogb(aca_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::ilogb(aca.value), acr); break; }
             case MOP_LOGB: {
-                _update_regs_from_float(std::logb(aca_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::logb(aca.value), acr); break; }
             case MOP_NEXTAFTER: {
-                _update_regs_from_float(std::nextafter(aca_float, acb_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::nextafter(aca.value, acb.value), acr); break; }
             case MOP_COPYSIGN: {
-                _update_regs_from_float(std::copysign(aca_float, acb_float),
-                    acr_float, acr_pos, acr_string, acr_raw, acr_int); break; }
+                _update_regs_from_float(std::copysign(aca.value, acb.value), acr); break; }
         }
 // // WORK AROUND
-// aca_raw = *reinterpret_cast<DWord*>(&aca_float);
-// acb_raw = *reinterpret_cast<DWord*>(&acb_float);
-// acr_raw = *reinterpret_cast<DWord*>(&acr_float);
+// aca_raw = *reinterpret_cast<DWord*>(&aca.value);
+// acb_raw = *reinterpret_cast<DWord*>(&acb.value);
+// acr_raw = *reinterpret_cast<DWord*>(&acr.value);
     } // END if (offset == MATH_OPERATION)
     IDevice::write(offset,data);   // update any internal changes too
 }
 
 
-Byte Math::_read_acc(Word offset, Word reg, Byte& _pos, 
-        float& _float, std::string& _string, DWord& _raw, DWord& _int)
+Byte Math::_read_acc(Word offset, Word reg, ACCUMULATOR& acc)
 {
     Byte data = 0xCC;
     // bounds checking
@@ -252,148 +201,160 @@ Byte Math::_read_acc(Word offset, Word reg, Byte& _pos,
 
     if (offset == reg)              // MATH_ACx_POS
     {
-        data = _pos;
-        if (data >= _string.size())
-            data = _string.size() - 1;
-        if (_string.size() == 0)
+        _string_from_float(acc);
+        data = acc.pos;
+        if (data >= acc.length)
+            data = acc.length - 1;
+        if (acc.length == 0)
             data = 0;
     }
     else if (offset == reg + 1)     // MATH_ACx_DATA
     {
+        _string_from_float(acc);
         data = 0;
-        if (_string.size() > 0)
+        if (acc.length > 0)
         {
-            if (_pos < _string.size())
+            if (acc.pos < acc.length)
             {
-                data = (Byte)_string.substr(_pos, 1).at(0);
-                if (_pos <= _string.size())
-                    _pos++;
+                data = (Byte)acc.string[acc.pos];
+                acc.pos++;
             }
             else
             {
-                _string = "";
+                acc.length = 0;
+                acc.string[0] = 0;
                 data = 0;
             }
         }
     }
     // MATH_ACx_RAW
-    else if (offset == reg + 2) { data = (_raw >> 24) & 0xff; }
-    else if (offset == reg + 3) { data = (_raw >> 16) & 0xff; }
-    else if (offset == reg + 4) { data = (_raw >>  8) & 0xff; }
-    else if (offset == reg + 5) { data = (_raw >>  0) & 0xff; }
+    else if (offset == reg + 2) { data = (acc.raw >> 24) & 0xff; }
+    else if (offset == reg + 3) { data = (acc.raw >> 16) & 0xff; }
+    else if (offset == reg + 4) { data = (acc.raw >>  8) & 0xff; }
+    else if (offset == reg + 5) { data = (acc.raw >>  0) & 0xff; }
     // MATH_ACx_INT
-    else if (offset == reg + 6) { data = (_int >> 24) & 0xff; }
-    else if (offset == reg + 7) { data = (_int >> 16) & 0xff; }
-    else if (offset == reg + 8) { data = (_int >>  8) & 0xff; }
-    else if (offset == reg + 9) { data = (_int >>  0) & 0xff; }
+    else if (offset == reg + 6) { data = (acc.integer >> 24) & 0xff; }
+    else if (offset == reg + 7) { data = (acc.integer >> 16) & 0xff; }
+    else if (offset == reg + 8) { data = (acc.integer >>  8) & 0xff; }
+    else if (offset == reg + 9) { data = (acc.integer >>  0) & 0xff; }
 
     return data;
 }   // END Math::_read_acc()
 
 
-Byte Math::_write_acc(Word offset, Byte data, Word reg, Byte& _pos, 
-        float& _float, std::string& _string, DWord& _raw, DWord& _int)
+Byte Math::_write_acc(Word offset, Byte data, Word reg, ACCUMULATOR& acc)
 {
     // position within the string
     if (offset == reg + 0)              // MATH_ACx_POS
     {
-        if (data > _string.size())
-            data = _string.size() - 1;
-        _pos = data;
+        _string_from_float(acc);
+        if (data > acc.length)
+            data = acc.length - 1;
+        acc.pos = data;
     }
     // update the string itself
     if (offset == reg + 1)              // MATH_ACx_DATA
     {
-        std::string valid_chars = ".-+0123456789eE";
-        int found = valid_chars.find((char)data);
-        if (found < 0)
+        if (!strchr(".-+0123456789eE", data) || data == 0)
             return IDevice::read(offset);
 
+        _string_from_float(acc);
         // at the beginning of the string?
-        if (_pos == 0)  
+        if (acc.pos == 0)  
         {
             if (data == 'e' || data == 'E' || data == '+')
                 return IDevice::read(offset);
-            _string = "";
-            _pos = 0;
+            acc.length = 0;
+            acc.string[acc.length++] = data;
             if (data == '-')
-            {
-                _string += data;
-                _string += "0";
-                _pos++;
-            }
-            else
-            {
-                _string += data;
-                _pos++;
-            }
+                acc.string[acc.length++] = '0';
+            acc.pos++;
         }
         else // within the string
         {
-            _string = _string.substr(0, _pos);
-            _string += data;
-            _pos++;
+            acc.length = std::min<Byte>(acc.pos, acc.length);
+            if (acc.length < sizeof(acc.string) - 1)
+                acc.string[acc.length++] = data;
+            acc.pos++;
         }
+        acc.string[acc.length] = 0;
         // convert string to float
-        _float = std::stof(_string);    
+        acc.value = strtof(acc.string, nullptr);
         // update MATH_ACx_RAW
-        _raw = *reinterpret_cast<DWord*>(&_float);
+        memcpy(&acc.raw, &acc.value, sizeof(DWord));
         // update MATH_ACx_INT
-        _int = (DWord)_float;
-        // update the string
+        acc.integer = (DWord)acc.value;
+        // the string is shown as the float it now holds, unless it is partway
+        // through an exponent or a sign
         if (data != 'e' && data != 'E' && data != '-')
-            _string = std::to_string(_float);
+            acc.stale = true;
     }
     // MATH_ACx_RAW
     if (offset >= reg + 2 && offset <= reg + 5)
     {
         if (offset == reg + 2)
-            _raw = (_raw & ~0xff000000) | (data << 24);
+            acc.raw = (acc.raw & ~0xff000000) | (data << 24);
         if (offset == reg + 3)
-            _raw = (_raw & ~0x00ff0000) | (data << 16);
+            acc.raw = (acc.raw & ~0x00ff0000) | (data << 16);
         if (offset == reg + 4)
-            _raw = (_raw & ~0x0000ff00) | (data <<  8);
+            acc.raw = (acc.raw & ~0x0000ff00) | (data <<  8);
         if (offset == reg + 5)
-            _raw = (_raw & ~0x000000ff) | (data <<  0);
+            acc.raw = (acc.raw & ~0x000000ff) | (data <<  0);
         // update the internal float
-        _float = *reinterpret_cast<float*>(&_raw);
+        memcpy(&acc.value, &acc.raw, sizeof(float));
         // update the internal int
-        _int = (DWord)_float;
-        // update the string
-        _string = std::to_string(_float);
+        acc.integer = (DWord)acc.value;
+        // the string follows when it is next used
+        acc.stale = true;
     }
     // MATH_ACx_INT
     if (offset >= reg + 6 && offset <= reg + 9)
     {
         if (offset == reg + 6)
-            _int = (_int & ~0xff000000) | (data << 24);
+            acc.integer = (acc.integer & ~0xff000000) | (data << 24);
         if (offset == reg + 7)
-            _int = (_int & ~0x00ff0000) | (data << 16);
+            acc.integer = (acc.integer & ~0x00ff0000) | (data << 16);
         if (offset == reg + 8)
-            _int = (_int & ~0x0000ff00) | (data << 8);
+            acc.integer = (acc.integer & ~0x0000ff00) | (data << 8);
         if (offset == reg + 9)
-            _int = (_int & ~0x000000ff) | (data << 0);
+            acc.integer = (acc.integer & ~0x000000ff) | (data << 0);
         // update the internal float
-        _float = (float)_int;
+        acc.value = (float)acc.integer;
         // update the internal raw
-        _raw = *reinterpret_cast<DWord*>(&_float);
-        // update the string
-        _string = std::to_string(_float);
+        memcpy(&acc.raw, &acc.value, sizeof(DWord));
+        // the string follows when it is next used
+        acc.stale = true;
     }
-    // printf("MATH_ACx_RAW ---> _float:%f    _raw: $%08X    _int: $%08X    _string:%s\n", _float, _raw, _int, _string.c_str());            
+    // printf("MATH_ACx_RAW ---> _float:%f    _raw: $%08X    _int: $%08X    _string:%s\n", acc.value, acc.raw, acc.integer, acc.string);            
 
     return data;
 }
 
 
-void Math::_update_regs_from_float(float f_data, float& _float,
-    Byte& _pos, std::string& _string, DWord& _raw, DWord& _int)
+void Math::_update_regs_from_float(float f_data, ACCUMULATOR& acc)
+{
+    acc.pos = 0;
+    acc.value = f_data;
+    acc.stale = true;
+    memcpy(&acc.raw, &acc.value, sizeof(DWord));
+    acc.integer = (DWord)acc.value;
+}
+
+// the "%f" form of the value, as std::to_string() gave it
+void Math::_string_from_float(ACCUMULATOR& acc)
 {
-    _pos = 0;
-    _float = f_data;
-    _string = std::to_string(_float);
-    _raw = *reinterpret_cast<DWord*>(&_float);
-    _int = (DWord)_float;
+    if (!acc.stale)
+        return;
+    acc.stale = false;
+#if defined(__cpp_lib_to_chars)
+    auto result = std::to_chars(acc.string, acc.string + sizeof(acc.string) - 1,
+        acc.value, std::chars_format::fixed, 6);
+    acc.length = (result.ec == std::errc()) ? (Byte)(result.ptr - acc.string) : 0;
+#else
+    int len = snprintf(acc.string, sizeof(acc.string), "%f", acc.value);
+    acc.length = (len > 0 && len < (int)sizeof(acc.string)) ? (Byte)len : 0;
+#endif
+    acc.string[acc.length] = 0;
 }
 
 
@@ -4,10 +4,127 @@
 // *
 // ***********************************
 
+#include <cstring>
+#include <filesystem>
 #include <sstream>
+#if defined(_WIN32)
+    #include <io.h>
+    #define fsync _commit
+#else
+    #include <unistd.h>
+#endif
 #include "Bus.hpp"
 #include "MemBank.hpp"
 
+// pages are stored run length encoded: a control byte $00-$7F is followed by 1 to 128
+// literal bytes, $80-$FF by a byte repeated 3 to 130 times. Returns the packed length,
+// or 0 if it would not be shorter than max.
+static DWord rle_pack(const Byte* in, DWord len, Byte* out, DWord max)
+{
+    DWord i = 0, o = 0;
+    while (i < len)
+    {
+        DWord run = 1;
+        while (i + run < len && run < 130 && in[i + run] == in[i])
+            run++;
+        if (run >= 3)
+        {
+            if (o + 2 >= max)
+                return 0;
+            out[o++] = 0x80 | (run - 3);
+            out[o++] = in[i];
+            i += run;
+            continue;
+        }
+        DWord start = i, n = 0;
+        while (i < len && n < 128)
+        {
+            if (i + 2 < len && in[i] == in[i + 1] && in[i] == in[i + 2])
+                break;
+            i++;
+            n++;
+        }
+        if (o + 1 + n >= max)
+            return 0;
+        out[o++] = n - 1;
+        memcpy(out + o, in + start, n);
+        o += n;
+    }
+    return o;
+}
+
+// returns the unpacked length
+static DWord rle_unpack(const Byte* in, DWord len, Byte* out, DWord max)
+{
+    DWord i = 0, o = 0;
+    while (i < len)
+    {
+        Byte c = in[i++];
+        if (c & 0x80)
+        {
+            DWord n = (c & 0x7f) + 3;
+            if (i >= len || o + n > max)
+                break;
+            memset(out + o, in[i++], n);
+            o += n;
+        }
+        else
+        {
+            DWord n = c + 1;
+            if (i + n > len || o + n > max)
+                break;
+            memcpy(out + o, in + i, n);
+            i += n;
+            o += n;
+        }
+    }
+    return o;
+}
+
+// a whole page from its slot. A slot starts with the page's stored length: 0 (or past
+// the end of the file) for a page of zeros, PAGED_MEMORY_BANKSIZE when it is raw and
+// less when it is packed
+static bool read_slot(FILE* fp, DWord pos, Byte* page)
+{
+    DWord stored = 0;
+    DWord size = 0;
+    if (fp && fseek(fp, pos, SEEK_SET) == 0 && fread(&stored, sizeof(DWord), 1, fp) == 1)
+    {
+        if (stored == PAGED_MEMORY_BANKSIZE)
+            size = fread(page, sizeof(Byte), PAGED_MEMORY_BANKSIZE, fp);
+        else if (stored > 0 && stored < PAGED_MEMORY_BANKSIZE)
+        {
+            Byte packed[PAGED_MEMORY_BANKSIZE];
+            DWord size_read = fread(packed, sizeof(Byte), stored, fp);
+            size = rle_unpack(packed, size_read, page, PAGED_MEMORY_BANKSIZE);
+        }
+    }
+    memset(page + size, 0, PAGED_MEMORY_BANKSIZE - size);
+    return stored == 0 || size == PAGED_MEMORY_BANKSIZE;
+}
+
+// a whole page into its slot, packed when that is shorter
+static bool write_slot(FILE* fp, DWord pos, const Byte* page)
+{
+    if (!fp || fseek(fp, pos, SEEK_SET) != 0)
+        return false;
+
+    // a page of zeros is only its length
+    Byte packed[sizeof(DWord) + PAGED_MEMORY_BANKSIZE];
+    DWord stored = 0;
+    bool zeros = page[0] == 0 && memcmp(page, page + 1, PAGED_MEMORY_BANKSIZE - 1) == 0;
+    if (!zeros && MEMBANK_COMPRESS)
+        stored = rle_pack(page, PAGED_MEMORY_BANKSIZE, packed + sizeof(DWord), PAGED_MEMORY_BANKSIZE);
+    if (!zeros && stored == 0)
+    {
+        stored = PAGED_MEMORY_BANKSIZE;
+        memcpy(packed + sizeof(DWord), page, PAGED_MEMORY_BANKSIZE);
+    }
+    memcpy(packed, &stored, sizeof(DWord));
+    DWord size = sizeof(DWord) + stored;
+    return fwrite(packed, sizeof(Byte), size, fp) == size;
+}
+
 Byte MemBank::read(Word offset, bool debug) 
 {
     // printf("%s::read($%04X) = $%02X\n", Name().c_str(), offset,  data);
@@ -19,13 +136,19 @@ void MemBank::write(Word offset, Byte data, bool debug)
 
     // BANK ONE = $B000-$CFFF
     if (offset >= 0xB000 && offset <= 0xCFFF)
-        if (_bank_header.bank_node[_bank_header.bank_1_index].type != BANK_TYPE::READ_ONLY)
+        if (_bank_nodes[_bank_header.bank_1_index].type != BANK_TYPE::READ_ONLY)
+        {
             IDevice::write(offset,data);
+            _bank_dirty[0] = true;
+        }
 
     // BANK TWO = $D000-$EFFF    
     if (offset >= 0xD000 && offset <= 0xEFFF)
-        if (_bank_header.bank_node[_bank_header.bank_2_index].type != BANK_TYPE::READ_ONLY)
+        if (_bank_nodes[_bank_header.bank_2_index].type != BANK_TYPE::READ_ONLY)
+        {
             IDevice::write(offset,data);
+            _bank_dirty[1] = true;
+        }
     // IDevice::write(offset,data);   // update any internal changes too
 }
 
@@ -53,84 +176,172 @@ void MemBank::OnInit()
 {
     // printf("%s::OnInit()\n", Name().c_str());   
 
+    // no file at all: every page lives in the cache until OnQuit()
+    if (_filename.empty())
+    {
+        _addPages(PAGED_MEMORY_BANKS);
+        for (int bank = 0; bank < 2; bank++)
+            _bank_dirty[bank] = false;
+        return;
+    }
+
     // create a new default 'paged.mem' file if one does not yet exist
     _newDefaultFile();
 
-    // load the 'paged.mem' header info
-    _loadHeader();
+    // the file stays open until OnQuit()
+    _fp = _fopen(_filename);
+
+    // load the 'paged.mem' header info, converting a file of an older layout
+    if (_loadHeader() && _bank_header.version < PAGED_VERSION)
+        _upgradeFile();
+
+    // a larger PAGED_MEMORY_BANKS adds pages to an existing file
+    if (_bank_nodes.size() < PAGED_MEMORY_BANKS)
+        _addPages(PAGED_MEMORY_BANKS);
+    for (int bank = 0; bank < 2; bank++)
+        if (_bankIndex(bank) >= _bank_nodes.size())
+            _bankIndex(bank) = bank;
 
     // load the current banked memory pages from the 'paged.mem' file
-    if ((_bank_header.bank_node[_bank_header.bank_1_index].type != BANK_TYPE::RANDOM_ACCESS) ||
-        (_bank_header.bank_node[_bank_header.bank_2_index].type != BANK_TYPE::RANDOM_ACCESS))
+    for (int bank = 0; bank < 2; bank++)
     {
-        FILE* fp = _fopen(PAGED_MEMORY_FILENAME);
-        if (fp)
-        {
-            // load bank one        
-            int addr = 0xB000;
-            int seek_pos = 0;
-            if (_bank_header.bank_node[_bank_header.bank_1_index].type != BANK_TYPE::RANDOM_ACCESS)
-            {
-                seek_pos = _bank_header.bank_node[_bank_header.bank_1_index].seek_pos;
-                fseek(fp, seek_pos, SEEK_SET);        
-                for (DWord t=addr; t<addr+PAGED_MEMORY_BANKSIZE; t++)
-                    IDevice::write(t, fgetc(fp));        // Bus::Write(t, fgetc(fp));
-            }
-            // load bank two
-            if (_bank_header.bank_node[_bank_header.bank_2_index].type != BANK_TYPE::RANDOM_ACCESS)
-            {
-                addr = 0xD000;
-                seek_pos = _bank_header.bank_node[_bank_header.bank_2_index].seek_pos;
-                fseek(fp, seek_pos, SEEK_SET);
-                for (DWord t=addr; t<addr+PAGED_MEMORY_BANKSIZE; t++)
-                    IDevice::write(t, fgetc(fp));        // Bus::Write(t, fgetc(fp));
-            }
-            fclose(fp);
-        }
+        if (_bank_nodes[_bankIndex(bank)].type != BANK_TYPE::RANDOM_ACCESS)
+            _readPage(_bankIndex(bank), _bank(bank), 0, PAGED_MEMORY_BANKSIZE);
+        _bank_dirty[bank] = false;
     }
+
+    // start the write-back thread
+    _bFlusherRunning = true;
+    _flusher = std::thread(&MemBank::_flusherProc, this);
 }
 void MemBank::OnQuit() 
 {
     // printf("%s::OnQuit()\n", Name().c_str());    
 
-    // save the 'paged.mem' header info
-    _saveHeader();
+    _stopFlusher();
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (!_fp)
+    {
+        _cache.clear();
+        _lru.clear();
+        return;
+    }
 
     // save the current banked memory pages to the 'paged.mem' file
-    set_bank_1_page(_bank_header.bank_1_index);
-    set_bank_2_page(_bank_header.bank_2_index);
+    for (int bank = 0; bank < 2; bank++)
+    {
+        if (_bank_dirty[bank] && _bank_nodes[_bankIndex(bank)].type != BANK_TYPE::RANDOM_ACCESS)
+            _writePage(_bankIndex(bank), _bank(bank), 0, PAGED_MEMORY_BANKSIZE);
+        _bank_dirty[bank] = false;
+    }
+
+    // then the cached pages and the header info, with the current bank indices
+    _header_dirty = true;
+    _flush(lock);
+    fclose(_fp);
+    _fp = nullptr;
+    _cache.clear();
+    _lru.clear();
 }
 
 // create a new 'paged.mem' bank file if one does not already exist
 // returns false on failure
 bool MemBank::_newDefaultFile()
 {
-    if (!_fileExists(PAGED_MEMORY_FILENAME))
+    if (!_fileExists(_filename))
     {
-        FILE* fp = fopen(PAGED_MEMORY_FILENAME.c_str(), "wb");
+        FILE* fp = fopen(_filename.c_str(), "wb");
         if (fp==nullptr)        
         {
             std::stringstream ss;
-            ss << "Error creating the paged memory file: \n" << PAGED_MEMORY_FILENAME << std::endl;
+            ss << "Error creating the paged memory file: \n" << _filename << std::endl;
             Bus::Error(ss.str());
             return false;
         }
-        // write the blank default header
-        DWord seek_pos = sizeof(BANK_HEADER);
-        for (int t=0; t<256; t++) {
-            _bank_header.bank_node[t].seek_pos = seek_pos;
-            seek_pos += PAGED_MEMORY_BANKSIZE;
-        }
+        // write the blank default header. OnInit() adds the pages to it, and they are
+        // not written at all: past the end of the file they read as zeros, and later
+        // writes leave holes before them
+        _bank_header.version = PAGED_VERSION;
         fwrite((void *)&_bank_header, sizeof(Byte), sizeof(_bank_header), fp);
-        // write the paged data (2 Mbytes)
-        DWord buffer_size = 256*PAGED_MEMORY_BANKSIZE;
-        for (DWord t=0; t<buffer_size; t++)
-            fputc(0,fp);    // initially all zeroes
         fclose(fp);
     }    
     return true;
 }
 
+// rewrite a version 0 file (every page stored raw) or a version 1 file in the current
+// layout, through a temporary file that replaces it once it is complete
+bool MemBank::_upgradeFile()
+{
+    BANK_HEADER_V1 old;
+    fseek(_fp, 0, SEEK_SET);
+    if (fread((void *)&old, sizeof(Byte), sizeof(BANK_HEADER_V1), _fp) != sizeof(BANK_HEADER_V1))
+    {
+        Bus::Error("MemBank::Error() -- Load Error");
+        return false;
+    }
+    std::string tmp = _filename + ".new";
+    FILE* out = fopen(tmp.c_str(), "wb");
+    if (!out)
+    {
+        std::stringstream ss;
+        ss << "Unable to convert the paged memory file: \n" << _filename << std::endl;
+        Bus::Error(ss.str());
+        return false;
+    }
+    _bank_header = BANK_HEADER();
+    _bank_header.version = PAGED_VERSION;
+    _bank_header.bank_1_index = old.bank_1_index;
+    _bank_header.bank_2_index = old.bank_2_index;
+    _bank_header.exec_vector = old.exec_vector;
+    _bank_header.page_count = 256;
+    _bank_nodes.resize(256);
+    for (int t=0; t<256; t++)
+        _bank_nodes[t] = { old.bank_node[t].type, _slotPos(t) };
+    fwrite((void *)&_bank_header, sizeof(Byte), sizeof(BANK_HEADER), out);
+    fwrite((void *)_bank_nodes.data(), sizeof(BANK_NODE), _bank_nodes.size(), out);
+
+    std::vector<Byte> page(PAGED_MEMORY_BANKSIZE);
+    for (int t=0; t<256; t++)
+    {
+        if (old.version < 1.0f)
+        {
+            fseek(_fp, old.bank_node[t].seek_pos, SEEK_SET);
+            size_t size_read = fread(page.data(), sizeof(Byte), PAGED_MEMORY_BANKSIZE, _fp);
+            memset(page.data() + size_read, 0, PAGED_MEMORY_BANKSIZE - size_read);
+        }
+        else
+            read_slot(_fp, old.bank_node[t].seek_pos, page.data());
+        if (page[0] == 0 && memcmp(page.data(), page.data() + 1, PAGED_MEMORY_BANKSIZE - 1) == 0)
+            continue;   // left as a hole
+        write_slot(out, _bank_nodes[t].seek_pos, page.data());
+    }
+    fflush(out);
+    fsync(fileno(out));
+    fclose(out);
+    fclose(_fp);
+
+    std::error_code ec;
+    std::filesystem::rename(tmp, _filename, ec);
+    if (ec)
+    {
+        std::stringstream ss;
+        ss << "Unable to replace the paged memory file: \n" << _filename << std::endl;
+        Bus::Error(ss.str());
+    }
+    _fp = _fopen(_filename);
+    return !ec;
+}
+
+void MemBank::_addPages(DWord count)
+{
+    for (DWord t = (DWord)_bank_nodes.size(); t < count; t++)
+        _bank_nodes.push_back({ BANK_TYPE::PERSISTANT, _slotPos(t) });
+    _bank_header.page_count = count;
+    _nodes_dirty = true;
+    _header_dirty = true;
+}
+
 // returns true if the file exists
 bool MemBank::_fileExists(const std::string& filename)
 {
@@ -144,126 +355,349 @@ bool MemBank::_fileExists(const std::string& filename)
 
 bool MemBank::_loadHeader()
 {
-    FILE *fp = _fopen(PAGED_MEMORY_FILENAME);
-    if (fp)
+    if (!_fp)
+        return false;
+    // load the header info from the 'paged.mem' file
+    fseek(_fp, 0, SEEK_SET);     // seek the beginning of the file
+    size_t size_read = fread((void *)&_bank_header, sizeof(Byte), sizeof(BANK_HEADER), _fp);
+    if (size_read != sizeof(BANK_HEADER))
     {
-        // load the header info from the 'paged.mem' file
-        fseek(fp, 0, SEEK_SET);     // seek the beginning of the file
-        size_t size_read = fread((void *)&_bank_header, sizeof(Byte), sizeof(BANK_HEADER), fp);
-        if (size_read != sizeof(BANK_HEADER))
-        {
-            Bus::Error("MemBank::Error() -- Load Error");
-            fclose(fp);
-            return false;
-        }
-        // close the file
-        fclose(fp);
+        Bus::Error("MemBank::Error() -- Load Error");
+        return false;
+    }
+    // the older layouts are read by _upgradeFile()
+    if (_bank_header.version < PAGED_VERSION)
         return true;
+    if (_bank_header.page_count > PAGED_MAX_PAGES)
+    {
+        Bus::Error("MemBank::Error() -- Bad page count");
+        return false;
+    }
+    _bank_nodes.resize(_bank_header.page_count);
+    size_read = fread((void *)_bank_nodes.data(), sizeof(BANK_NODE), _bank_nodes.size(), _fp);
+    if (size_read != _bank_nodes.size())
+    {
+        Bus::Error("MemBank::Error() -- Load Error");
+        return false;
     }
-    return false;
+    return true;
 }
 
-bool MemBank::_saveHeader()
+// (_file_mutex held)
+bool MemBank::_saveHeader(const BANK_HEADER& header, const std::vector<BANK_NODE>* nodes)
 {
-    FILE *fp = _fopen(PAGED_MEMORY_FILENAME);
-    if (fp)
+    if (!_fp)
+        return false;
+    // the pages' BANK_NODEs first, synced before the header that counts them
+    if (nodes)
     {
-        // save the header info to the 'paged.mem' file
-        fseek(fp, 0, SEEK_SET);     // seek the beginning of the file
-        fwrite((void *)&_bank_header, sizeof(Byte), sizeof(BANK_HEADER), fp);
-        // close the file
-        fclose(fp);
-        return true;
+        fseek(_fp, sizeof(BANK_HEADER), SEEK_SET);
+        fwrite((void *)nodes->data(), sizeof(BANK_NODE), nodes->size(), _fp);
+        fflush(_fp);
+        fsync(fileno(_fp));
     }
-    return false;
+    // save the header info to the 'paged.mem' file, in a single write
+    fseek(_fp, 0, SEEK_SET);     // seek the beginning of the file
+    return fwrite((void *)&header, sizeof(Byte), sizeof(BANK_HEADER), _fp) == sizeof(BANK_HEADER);
 }
 
 FILE* MemBank::_fopen(const std::string filename)
 {
-    if (!_fileExists(PAGED_MEMORY_FILENAME)) {
+    if (!_fileExists(_filename)) {
         std::stringstream ss;
-        ss << "Unable to find the paged memory file: \n" << PAGED_MEMORY_FILENAME << std::endl;
+        ss << "Unable to find the paged memory file: \n" << _filename << std::endl;
         Bus::Error(ss.str());
         return nullptr;
     }
-    FILE* fp = fopen(PAGED_MEMORY_FILENAME.c_str(), "rb+");
+    FILE* fp = fopen(_filename.c_str(), "rb+");
     if (!fp) {
         std::stringstream ss;
-        ss << "Unable to open the paged memory file: \n" << PAGED_MEMORY_FILENAME << std::endl;
+        ss << "Unable to open the paged memory file: \n" << _filename << std::endl;
         Bus::Error(ss.str());
         return nullptr;
     }
     return fp;
 }
 
-void MemBank::set_bank_1_page(Byte idx)
+void MemBank::set_bank_1_page(Word idx)
+{
+    _setBankPage(0, idx);
+}
+
+void MemBank::set_bank_2_page(Word idx)
+{
+    _setBankPage(1, idx);
+}
+
+void MemBank::_setBankPage(int bank, Word idx)
 {
-    FILE* fp = _fopen(PAGED_MEMORY_FILENAME);
-    if (fp)
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (idx >= _bank_nodes.size())
+        return;     // no such page, the bank keeps the one it has
+    Byte* buffer = _bank(bank);
+
+    // the page being switched out goes into the cache, to be written back later
+    // if it was changed
+    Word& index = _bankIndex(bank);
+    if (_bank_nodes[index].type != BANK_TYPE::RANDOM_ACCESS)
+        _storePage(index, buffer, _bank_dirty[bank]);
+    _bank_dirty[bank] = false;
+
+    // the header is saved with the new index later (see the NOTES in MemBank.hpp)
+    index = idx;
+
+    // load the new page, from the cache if it is there
+    if (_bank_nodes[idx].type != BANK_TYPE::RANDOM_ACCESS)
     {
-        // save the current bank to file
-        int addr = 0xB000;
-        int seek_pos = _bank_header.bank_node[_bank_header.bank_1_index].seek_pos;
-        if (_bank_header.bank_node[_bank_header.bank_1_index].type != BANK_TYPE::RANDOM_ACCESS)
+        auto it = _cache.find(idx);
+        if (it != _cache.end())
         {
-            fseek(fp, seek_pos, SEEK_SET);
-            for (DWord t=addr; t<addr+PAGED_MEMORY_BANKSIZE; t++)
-                fputc(Bus::Read(t),fp);
+            memcpy(buffer, it->second.data.data(), PAGED_MEMORY_BANKSIZE);
+            _bank_dirty[bank] = it->second.dirty;
+            _lru.erase(it->second.lru);
+            _cache.erase(it);
         }
-        
-        // update header with the new index
-        _bank_header.bank_1_index = idx;
-        fseek(fp, 0, SEEK_SET);     // seek the beginning of the file
-        fwrite((void *)&_bank_header, sizeof(Byte), sizeof(BANK_HEADER), fp);
-
-        // load the new bank from file
-        seek_pos = _bank_header.bank_node[_bank_header.bank_1_index].seek_pos;
-        if (_bank_header.bank_node[_bank_header.bank_1_index].type != BANK_TYPE::RANDOM_ACCESS)
+        else
+            _readPage(idx, buffer, 0, PAGED_MEMORY_BANKSIZE);
+    }
+}
+
+void MemBank::_setBankType(int bank, BANK_TYPE type)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _bank_nodes[_bankIndex(bank)].type = type;
+    _nodes_dirty = true;
+    _header_dirty = true;
+}
+
+void MemBank::Touched(Word offset, DWord len)
+{
+    DWord end = offset + len;
+    if (offset < 0xD000 && end > 0xB000)    _bank_dirty[0] = true;
+    if (offset < 0xF000 && end > 0xD000)    _bank_dirty[1] = true;
+}
+
+// keep a copy of a page that is no longer mapped, making room for it by writing back
+// the least recently used page (_mutex held)
+void MemBank::_storePage(Word page, const Byte* data, bool dirty)
+{
+    auto it = _cache.find(page);
+    if (it == _cache.end())
+    {
+        if (_cache.size() >= MEMBANK_CACHE_PAGES && !_filename.empty())
         {
-            fseek(fp, seek_pos, SEEK_SET);
-            for (DWord t=addr; t<addr+PAGED_MEMORY_BANKSIZE; t++)
-                IDevice::write(t, fgetc(fp));        // Bus::Write(t, fgetc(fp));
+            if (_cache.empty())
+            {
+                // no cache at all
+                if (dirty)
+                    _writePage(page, data, 0, PAGED_MEMORY_BANKSIZE);
+                return;
+            }
+            Word oldest = _lru.back();
+            PAGE& old = _cache[oldest];
+            if (old.dirty)
+                _writePage(oldest, old.data.data(), 0, PAGED_MEMORY_BANKSIZE);
+            _lru.pop_back();
+            _cache.erase(oldest);
         }
-        // close the file
-        fclose(fp);
+        it = _cache.emplace(page, PAGE()).first;
+        it->second.data.resize(PAGED_MEMORY_BANKSIZE);
     }
+    else
+        _lru.erase(it->second.lru);
+    _lru.push_front(page);
+    it->second.lru = _lru.begin();
+    memcpy(it->second.data.data(), data, PAGED_MEMORY_BANKSIZE);
+    it->second.dirty |= dirty;
+}
+
+// part of a page from the 'paged.mem' file (_mutex held)
+bool MemBank::_readPage(Word page, Byte* buf, DWord ofs, DWord len)
+{
+    std::lock_guard<std::mutex> io(_file_mutex);
+    if (ofs == 0 && len == PAGED_MEMORY_BANKSIZE)
+        return read_slot(_fp, _bank_nodes[page].seek_pos, buf);
+    Byte temp[PAGED_MEMORY_BANKSIZE];
+    bool ok = read_slot(_fp, _bank_nodes[page].seek_pos, temp);
+    memcpy(buf, temp + ofs, len);
+    return ok;
 }
 
-void MemBank::set_bank_2_page(Byte idx)
+// part of a page to the 'paged.mem' file (_mutex held)
+bool MemBank::_writePage(Word page, const Byte* buf, DWord ofs, DWord len)
 {
-    FILE* fp = _fopen(PAGED_MEMORY_FILENAME);
-    if (fp)
+    if (_filename.empty())
     {
-        // save the current bank to file
-        int addr = 0xD000;
-        int seek_pos = _bank_header.bank_node[_bank_header.bank_2_index].seek_pos;
-        if (_bank_header.bank_node[_bank_header.bank_2_index].type != BANK_TYPE::RANDOM_ACCESS)
+        // no file: the page joins the cache, starting from zeros
+        auto it = _cache.find(page);
+        if (it == _cache.end())
         {
-            fseek(fp, seek_pos, SEEK_SET);
-            for (DWord t=addr; t<addr+PAGED_MEMORY_BANKSIZE; t++)
-                fputc(Bus::Read(t),fp);
+            it = _cache.emplace(page, PAGE()).first;
+            it->second.data.resize(PAGED_MEMORY_BANKSIZE);
+            _lru.push_front(page);
+            it->second.lru = _lru.begin();
         }
-        
-        // update header with the new index
-        _bank_header.bank_2_index = idx;
-        fseek(fp, 0, SEEK_SET);     // seek the beginning of the file
-        fwrite((void *)&_bank_header, sizeof(Byte), sizeof(BANK_HEADER), fp);
-
-        // load the new bank from file
-        seek_pos = _bank_header.bank_node[_bank_header.bank_2_index].seek_pos;
-        if (_bank_header.bank_node[_bank_header.bank_2_index].type != BANK_TYPE::RANDOM_ACCESS)
+        memcpy(it->second.data.data() + ofs, buf, len);
+        return true;
+    }
+    std::lock_guard<std::mutex> io(_file_mutex);
+    if (ofs == 0 && len == PAGED_MEMORY_BANKSIZE)
+        return write_slot(_fp, _bank_nodes[page].seek_pos, buf);
+    Byte temp[PAGED_MEMORY_BANKSIZE];
+    read_slot(_fp, _bank_nodes[page].seek_pos, temp);
+    memcpy(temp + ofs, buf, len);
+    return write_slot(_fp, _bank_nodes[page].seek_pos, temp);
+}
+
+// write back every dirty cached page, sync them to disk, then write and sync the header.
+// Both are copied under _mutex (held on entry and on return), and written without it
+void MemBank::_flush(std::unique_lock<std::mutex>& lock)
+{
+    if (!_fp)
+        return;
+    struct DIRTY_PAGE {
+        DWord seek_pos;
+        std::vector<Byte> data;
+    };
+    std::vector<DIRTY_PAGE> pages;
+    for (auto& c : _cache)
+    {
+        if (!c.second.dirty)
+            continue;
+        pages.push_back({ _bank_nodes[c.first].seek_pos, c.second.data });
+        c.second.dirty = false;
+    }
+    bool header_dirty = _header_dirty || _nodes_dirty;
+    BANK_HEADER header = _bank_header;
+    std::vector<BANK_NODE> nodes;
+    if (_nodes_dirty)
+        nodes = _bank_nodes;
+    bool nodes_dirty = _nodes_dirty;
+    _header_dirty = false;
+    _nodes_dirty = false;
+    if (pages.empty() && !header_dirty)
+        return;
+
+    // the file is taken before the cache is let go, so a page marked clean above
+    // cannot be read back from the file before it has been written
+    std::unique_lock<std::mutex> io(_file_mutex);
+    lock.unlock();
+    for (auto& page : pages)
+        write_slot(_fp, page.seek_pos, page.data.data());
+    if (!pages.empty())
+    {
+        fflush(_fp);
+        fsync(fileno(_fp));
+    }
+    if (header_dirty)
+    {
+        _saveHeader(header, nodes_dirty ? &nodes : nullptr);
+        fflush(_fp);
+        fsync(fileno(_fp));
+    }
+    io.unlock();
+    lock.lock();
+}
+
+void MemBank::_flusherProc()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (_bFlusherRunning)
+    {
+        _cv.wait_for(lock, std::chrono::milliseconds(MEMBANK_FLUSH_MS), [this] { return !_bFlusherRunning; });
+        _flush(lock);
+    }
+}
+
+void MemBank::_stopFlusher()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _bFlusherRunning = false;
+    }
+    _cv.notify_all();
+    if (_flusher.joinable())
+        _flusher.join();
+}
+
+// returns the CPU address a page is currently mapped to, or 0 if it is not mapped
+Word MemBank::_mappedAddress(Word page)
+{
+    if (page == _bank_header.bank_1_index)  return 0xB000;
+    if (page == _bank_header.bank_2_index)  return 0xD000;
+    return 0;
+}
+
+// copy a block from any page. Mapped pages are read from the bank buffers,
+// cached pages from the cache and all others from the 'paged.mem' file
+void MemBank::read_block(DWord linear, Byte* buf, DWord len)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    while (len)
+    {
+        linear %= PageCount() * PAGED_MEMORY_BANKSIZE;
+        Word page = linear / PAGED_MEMORY_BANKSIZE;
+        DWord ofs = linear % PAGED_MEMORY_BANKSIZE;
+        DWord count = PAGED_MEMORY_BANKSIZE - ofs;
+        if (count > len)    count = len;
+        Word addr = _mappedAddress(page);
+        auto it = _cache.find(page);
+        if (addr)
+            memcpy(buf, _data() + addr - Base() + ofs, count);
+        else if (it != _cache.end())
+            memcpy(buf, it->second.data.data() + ofs, count);
+        else
+            _readPage(page, buf, ofs, count);
+        buf += count;
+        linear += count;
+        len -= count;
+    }
+}
+
+// copy a block to any page. Mapped pages are written to the bank buffers,
+// cached pages to the cache and all others straight to the 'paged.mem' file.
+// READ_ONLY pages are skipped.
+void MemBank::write_block(DWord linear, const Byte* buf, DWord len)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    while (len)
+    {
+        linear %= PageCount() * PAGED_MEMORY_BANKSIZE;
+        Word page = linear / PAGED_MEMORY_BANKSIZE;
+        DWord ofs = linear % PAGED_MEMORY_BANKSIZE;
+        DWord count = PAGED_MEMORY_BANKSIZE - ofs;
+        if (count > len)    count = len;
+        if (_bank_nodes[page].type != BANK_TYPE::READ_ONLY)
         {
-            fseek(fp, seek_pos, SEEK_SET);
-            for (DWord t=addr; t<addr+PAGED_MEMORY_BANKSIZE; t++)
-                IDevice::write(t, fgetc(fp));        // Bus::Write(t, fgetc(fp));
+            Word addr = _mappedAddress(page);
+            auto it = _cache.find(page);
+            if (addr)
+            {
+                // both banks may be showing the same page
+                for (int bank = 0; bank < 2; bank++)
+                {
+                    if (_bankIndex(bank) != page)
+                        continue;
+                    memcpy(_bank(bank) + ofs, buf, count);
+                    _bank_dirty[bank] = true;
+                }
+            }
+            else if (it != _cache.end())
+            {
+                memcpy(it->second.data.data() + ofs, buf, count);
+                it->second.dirty = true;
+            }
+            else
+                _writePage(page, buf, ofs, count);
         }
-        // close the file
-        fclose(fp);
+        buf += count;
+        linear += count;
+        len -= count;
     }
 }
 
 
-// void MemBank::OnActivate() 
+// void MemBank::OnActivate()
 // {
 //     // printf("%s::OnActivate()\n", Name().c_str());    
 // }
@@ -19,10 +19,17 @@ Byte Memory::read(Word offset, bool debug)
     MemBank* mb = Bus::GetMemBank();    // fetch a pointer to the MemBank device
     switch (offset)
     {
-        case MEM_BANK1_SELECT:  data = mb->get_bank_1_page();   break; 
-        case MEM_BANK2_SELECT:  data = mb->get_bank_2_page();   break;  
+        case MEM_BANK1_SELECT:  data = mb->get_bank_1_page() & 0xFF;    break; 
+        case MEM_BANK2_SELECT:  data = mb->get_bank_2_page() & 0xFF;    break;  
         case MEM_BANK1_TYPE:    data = mb->get_bank_1_type();   break; 
         case MEM_BANK2_TYPE:    data = mb->get_bank_2_type();   break;
+        // the MSB as written, until the LSB selects the page
+        case MEM_BANK1_PAGE+0:  data = (reg_bank_page[0]>>8) & 0xFF;  break;
+        case MEM_BANK1_PAGE+1:  data = (mb->get_bank_1_page()>>0) & 0xFF;  break;
+        case MEM_BANK2_PAGE+0:  data = (reg_bank_page[1]>>8) & 0xFF;  break;
+        case MEM_BANK2_PAGE+1:  data = (mb->get_bank_2_page()>>0) & 0xFF;  break;
+        case MEM_BANK_MAX+0:    data = ((mb->PageCount()-1)>>8) & 0xFF;    break;
+        case MEM_BANK_MAX+1:    data = ((mb->PageCount()-1)>>0) & 0xFF;    break;
 
         case MEM_DSP_FLAGS:     data = reg_dsp_flags;           break;
         case MEM_DSPLY_SIZE+0:  data =  (memory_btm>>8) & 0xFF;     break; 
@@ -65,14 +72,34 @@ void Memory::write(Word offset, Byte data, bool debug)
     {
         case MEM_BANK1_SELECT:  { 
             mb->set_bank_1_page(data);
-            data = mb->get_bank_1_page();
+            data = mb->get_bank_1_page() & 0xFF;
+            _latchBankPages();
             break; 
         }
         case MEM_BANK2_SELECT:  { 
             mb->set_bank_2_page(data);
-            data = mb->get_bank_2_page();
+            data = mb->get_bank_2_page() & 0xFF;
+            _latchBankPages();
             break; 
         }
+        case MEM_BANK1_PAGE+0:  reg_bank_page[0] = (reg_bank_page[0] & 0x00FF) | (data << 8); break;
+        case MEM_BANK1_PAGE+1:  {
+            reg_bank_page[0] = (reg_bank_page[0] & 0xFF00) | (data << 0);
+            mb->set_bank_1_page(reg_bank_page[0]);
+            data = mb->get_bank_1_page() & 0xFF;
+            _latchBankPages();      // a rejected page leaves the bank (and the MSB) as it was
+            break;
+        }
+        case MEM_BANK2_PAGE+0:  reg_bank_page[1] = (reg_bank_page[1] & 0x00FF) | (data << 8); break;
+        case MEM_BANK2_PAGE+1:  {
+            reg_bank_page[1] = (reg_bank_page[1] & 0xFF00) | (data << 0);
+            mb->set_bank_2_page(reg_bank_page[1]);
+            data = mb->get_bank_2_page() & 0xFF;
+            _latchBankPages();
+            break;
+        }
+        case MEM_BANK_MAX+0:    break;      // READ ONLY
+        case MEM_BANK_MAX+1:    break;      // READ ONLY
         case MEM_BANK1_TYPE:    { 
             mb->set_bank_1_type((MemBank::BANK_TYPE)data);
             data = mb->get_bank_1_type();
@@ -116,12 +143,16 @@ void Memory::write(Word offset, Byte data, bool debug)
         case MEM_EXT_WIDTH+1:       reg_width = (reg_width & 0xFF00) | (data << 0); break; 
         case MEM_EXT_DATA:      
         {
-            static Word s_width = reg_width+1;
+            if (!_bExtWidthInit)
+            {
+                _ext_width = reg_width+1;
+                _bExtWidthInit = true;
+            }
             ext_memory[reg_addr] = data;
             reg_addr++;
-            if (--s_width==0)
+            if (--_ext_width==0)
             {
-                s_width = reg_width;
+                _ext_width = reg_width;
                 reg_addr += (reg_pitch - reg_width);
             }
             // printf("Memory::MEM_EXT_DATA($%04x, $%02X)\n", reg_addr, data);
@@ -163,6 +194,13 @@ Word Memory::OnAttach(Word nextAddr)
 	DisplayEnum("MEM_TYPE_RAM",     enumID++,   "     random access memory (RAM)");
 	DisplayEnum("MEM_TYPE_PERSIST", enumID++,   "     persistent memory (saved RAM)");
 	DisplayEnum("MEM_TYPE_ROM",     enumID++,   "     read only memory (ROM)");
+    DisplayEnum("MEM_BANK1_PAGE",   nextAddr,   "(Word) select 8k page for bank 1 (0-65535)");  nextAddr+=2;
+    DisplayEnum("MEM_BANK2_PAGE",   nextAddr,   "(Word) select 8k page for bank 2 (0-65535)");  nextAddr+=2;
+	DisplayEnum("",                         0,  "     Notes: The page is selected when the ");
+	DisplayEnum("",                         0,  "            least-significant byte is written.");
+	DisplayEnum("",                         0,  "            The MSB reads back as written until then.");
+	DisplayEnum("",                         0,  "            A page past MEM_BANK_MAX is ignored.");
+    DisplayEnum("MEM_BANK_MAX",     nextAddr,   "(Word) highest page number (read only)");      nextAddr+=2;
     DisplayEnum("", 0, "");
     DisplayEnum("MEM_DSP_FLAGS",    nextAddr,   "(Byte) Extended Graphics Display Flags");      nextAddr++;
 	DisplayEnum("",                         0,  "     bit 7:    1=extended bitmap enabled, 0=disabled ");
@@ -196,8 +234,7 @@ Word Memory::OnAttach(Word nextAddr)
 Word Memory::_findFirstBlockOfSize(Word p_size)
 {
     int addr = 0xFFFF;
-    static int s_lastAddr = addr;
-    // s_lastAddr = addr;
+    // _lastAddr = addr;
     int gap = 0;
     int size = 0;
     
@@ -207,18 +244,18 @@ Word Memory::_findFirstBlockOfSize(Word p_size)
         addr = itr->first;
         size = itr->second;
         if (addr-size < MemAvailable())  return 0;       // out of memory error
-        gap = s_lastAddr - addr;
-        // printf("GAP of %d at $%04X\n", gap, s_lastAddr);
-        // if (s_lastAddr <= memory_btm)   break;       // out of memory error
+        gap = _lastAddr - addr;
+        // printf("GAP of %d at $%04X\n", gap, _lastAddr);
+        // if (_lastAddr <= memory_btm)   break;       // out of memory error
         if (gap >= p_size)
         {
-            // printf("GAP of %d at $%04X\n", gap, s_lastAddr);
-            return s_lastAddr;
+            // printf("GAP of %d at $%04X\n", gap, _lastAddr);
+            return _lastAddr;
         }
-        s_lastAddr = addr-size;       
+        _lastAddr = addr-size;       
         // printf("[$%04X].size=%d\n", addr, size);
     }
-    addr = s_lastAddr;
+    addr = _lastAddr;
     // if ((addr - p_size) < memory_btm)    return 0;      // out of memory error
     // printf("FALL THROUGH: $%04X\n", addr);
     return addr;
@@ -291,12 +328,23 @@ Word Memory::MemAvailable()
 
 void Memory::OnInit() 
 {
+    // MemBank has restored the pages the banks had at the last OnQuit()
+    _latchBankPages();
+
     // BEGIN: Testing bitmap load into extended memory
         LoadBMP(TESTING_BITMAP,8);
     // END: Testing bitmap load into extended memory
 
 }
 
+// the MEM_BANKx_PAGE registers start again from the pages the banks hold
+void Memory::_latchBankPages()
+{
+    MemBank* mb = Bus::GetMemBank();
+    reg_bank_page[0] = mb->get_bank_1_page();
+    reg_bank_page[1] = mb->get_bank_2_page();
+}
+
 void Memory::OnQuit() 
 {
     // ...
@@ -356,6 +404,7 @@ bool Memory::LoadBMP(const std::string& file, Byte bits_per_pixel, bool updatePa
     }
     else
     {
+        Byte data = 0;      // pixels packed so far
         for(int y = 0; y < image->h; y++)
         {
             for(int x = 0; x < image->w; x++)
@@ -363,7 +412,6 @@ bool Memory::LoadBMP(const std::string& file, Byte bits_per_pixel, bool updatePa
                 Byte clr = pixels[(image->pitch * y) + (x * bpp)];
                 if (bits_per_pixel==4)
                 {
-                    static Byte data=0;
                     if (!(x & 1))
                         data = (clr << 4);
                     else
@@ -374,7 +422,6 @@ bool Memory::LoadBMP(const std::string& file, Byte bits_per_pixel, bool updatePa
                 }
                 else if (bits_per_pixel==2)
                 {
-                    static Byte data=0;
                     if ((x % 4)==0)
                         data = (clr << 6);
                     else if ((x % 4)==1)
@@ -389,7 +436,6 @@ bool Memory::LoadBMP(const std::string& file, Byte bits_per_pixel, bool updatePa
                 }
                 else if (bits_per_pixel==1)
                 {
-                     static Byte data=0;
                     if ((x % 8)==0)
                         data = (clr << 7);
                     else if ((x % 8)==1)
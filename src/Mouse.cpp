@@ -124,7 +124,9 @@ void Mouse::OnInit()
 {
     // printf("%s::OnInit()\n", Name().c_str());    
 
-    _show_SDL_cursor(ENABLE_SDL_MOUSE_CURSOR);
+    if (!Bus::IsHeadless())
+        _show_SDL_cursor(ENABLE_SDL_MOUSE_CURSOR);
+    _bCsrWasShown = (button_flags & 0x80);
     _render_csr_buffer();
     // copy the rest of the palette from Gfx into the local one
     Gfx* gfx = Bus::GetGfx();
@@ -182,8 +184,6 @@ void Mouse::OnEvent(SDL_Event* evnt)
 {
     // printf("%s::OnEvent()\n", Name().c_str());   
 
-    static bool s_bCsr = (button_flags & 0x80); // cursor state
-    
     switch (evnt->type)
     {
         case SDL_WINDOWEVENT:
@@ -194,7 +194,7 @@ void Mouse::OnEvent(SDL_Event* evnt)
                     if (evnt->window.windowID == Gfx::GetWindowID())
                     {   // leaving the main window
                         // printf("EVENT: leaving the main window\n");
-                        s_bCsr = (button_flags & 0x80);
+                        _bCsrWasShown = (button_flags & 0x80);
                         _show_SDL_cursor(false);
                     }
                     else if (evnt->window.windowID == Debug::GetWindowID())
@@ -206,7 +206,7 @@ void Mouse::OnEvent(SDL_Event* evnt)
                     if (evnt->window.windowID == Gfx::GetWindowID())
                     {   // entering the main window
                         // printf("EVENT: entering the main window\n");
-                        _show_SDL_cursor(s_bCsr);
+                        _show_SDL_cursor(_bCsrWasShown);
                     }
                     else if (evnt->window.windowID == Debug::GetWindowID())
                     {   // entering the debug window
@@ -260,21 +260,20 @@ void Mouse::OnEvent(SDL_Event* evnt)
             //       bits 7:   cursor enable   
 
             // update the button flags
-            static Byte s_buttons = 0;
             Byte data = Bus::Read(CSR_FLAGS);
             data &= 0x80;       // mask out all but the cursor enable bit
             int button_mask = (1 << ((evnt->button.button % 7) - 1));
             // clear the button bit
             if (evnt->type == SDL_MOUSEBUTTONUP)
-                s_buttons &= ~button_mask;
+                _buttons &= ~button_mask;
             // set the button bit
             if (evnt->type == SDL_MOUSEBUTTONDOWN)
             {
-                s_buttons |= button_mask;
+                _buttons |= button_mask;
                 // update the number of clicks
                 data |= (evnt->button.clicks & 0x03) << 5;
                 // update the temporary register data
-                data |= s_buttons;
+                data |= _buttons;
             }
             // finally update the hardware register
             Bus::Write(CSR_FLAGS, data);
@@ -286,6 +285,8 @@ void Mouse::OnEvent(SDL_Event* evnt)
 void Mouse::OnUpdate(float fElapsedTime) 
 {
     // printf("%s::OnUpdate()\n", Name().c_str());    
+    if (Bus::IsHeadless())
+        return;     // no cursor texture to draw into
     _display_SDL_cursor();
 }
 
@@ -323,18 +324,17 @@ void Mouse::_display_SDL_cursor()
     }
     else
     {
-        static bool b_wasCleared = false;
-        if (b_wasCleared == false)
+        if (_bCsrWasCleared == false)
         {
             // start with a clear texture (pixel streaming version)
             for (int ty=0; ty<gfx->res_height; ty++)
                 for (int tx=0; tx<gfx->res_width; tx++)
                     gfx->_setPixel_unlocked(pixels, pitch, tx, ty, 0, true);    
-            b_wasCleared = true;
+            _bCsrWasCleared = true;
         }
         if (read(CSR_FLAGS) & 0x80)
         {
-            b_wasCleared = false;
+            _bCsrWasCleared = false;
             // render the cursor
             int x = (Sint16)Bus::Read_Word(CSR_XPOS) + (Sint8)Bus::Read(CSR_XOFS);
             int y = (Sint16)Bus::Read_Word(CSR_YPOS) + (Sint8)Bus::Read(CSR_YOFS);   
@@ -0,0 +1,228 @@
+/**************************
+* OpMix.cpp
+*
+* Instruction mix profile and fused instruction pairs (CPU_FUSE_PAIRS)
+*
+* Copyright (C) 2023 by Jay Faries
+**************************************/
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+
+#include "types.hpp"
+#include "Bus.hpp"
+#include "C6809.hpp"
+#include "Debug.hpp"
+
+// what may follow an instruction in the same dispatch
+enum FUSE : Byte {
+	FUSE_BRANCH	= 0x01,		// any short branch
+	FUSE_STA	= 0x02,		// STA direct, indexed or extended
+	FUSE_STB	= 0x04,		// STB direct, indexed or extended
+	FUSE_STD	= 0x08,		// STD direct, indexed or extended
+};
+
+// The pairs are the hot ones in the kernel's instruction mix (SaveProfile):
+// a compare, test or load ahead of a short branch, and a load ahead of a
+// store of the same register.
+static constexpr std::array<Byte, 256> fuse_table()
+{
+	std::array<Byte, 256> table{};
+	for (int mode = 0x00; mode <= 0x30; mode += 0x10)
+	{
+		table[0x81 + mode] = FUSE_BRANCH;				// CMPA
+		table[0xc1 + mode] = FUSE_BRANCH;				// CMPB
+		table[0x8c + mode] = FUSE_BRANCH;				// CMPX
+		table[0x85 + mode] = FUSE_BRANCH;				// BITA
+		table[0xc5 + mode] = FUSE_BRANCH;				// BITB
+		table[0x86 + mode] = FUSE_BRANCH | FUSE_STA;	// LDA
+		table[0xc6 + mode] = FUSE_BRANCH | FUSE_STB;	// LDB
+		table[0xcc + mode] = FUSE_BRANCH | FUSE_STD;	// LDD
+	}
+	for (int tst : { 0x0d, 0x4d, 0x5d, 0x6d, 0x7d })
+		table[tst] = FUSE_BRANCH;						// TST TSTA TSTB
+	return table;
+}
+static constexpr std::array<Byte, 256> s_fuse = fuse_table();
+
+///// FUSED PAIRS ///////////////////////////////////////////////////////
+
+void C6809::fuse_pair()
+{
+	// the page 2 and 3 compares (CMPD CMPY CMPU CMPS) pair with branches
+	Byte kind;
+	if (opcode >> 8)
+		kind = ((opcode & 0xc0) == 0x80 && ((opcode & 0x0f) == 0x03 || (opcode & 0x0f) == 0x0c)) ? FUSE_BRANCH : 0;
+	else
+		kind = s_fuse[opcode];
+	if (!kind)
+		return;
+	// nothing may need the boundary between the two: an interrupt that could be
+	// taken there (NMI is never masked, so an edge the first one raised counts),
+	// the debugger, a breakpoint, a pending step or the profile
+	Debug* debug = m_bus->_debug;
+	if (!CC.bit.I || !CC.bit.F || (!NMI && nmi_previous))
+		return;
+	if (waiting_cwai || waiting_sync || _steps > 0 || _run_until >= 0 || _profile)
+		return;
+	if (debug->IsActive() || debug->IsStepping() || debug->IsBreakpoint(PC))
+		return;
+
+	Byte next = m_bus->read(PC, true);
+	if ((kind & FUSE_BRANCH) && (next & 0xf0) == 0x20)
+	{
+		// the branch itself, without a dispatch of its own
+		Sint8 ofs = read(PC + 1);
+		PC += 2;
+		if (branch_taken(next))
+			PC += ofs;
+		cycles += 3;		// taken or not
+		return;
+	}
+	Byte store = next & 0xcf;
+	if (((kind & FUSE_STA) && store == 0x87 && next != 0x87) ||
+		((kind & FUSE_STB) && store == 0xc7 && next != 0xc7) ||
+		((kind & FUSE_STD) && store == 0xcd && next != 0xcd))
+	{
+		DWord first = cycles;
+		opcode = next;
+		PC++;
+		if (CPU_SWITCH_CORE)
+			switch_core();
+		else
+			table_core();
+		cycles += first;
+	}
+}
+
+bool C6809::branch_taken(Byte op)
+{
+	cc_sync();
+	auto& f = CC.bit;
+	switch (op)
+	{
+		case 0x20: return true;						// BRA
+		case 0x21: return false;					// BRN
+		case 0x22: return !f.C && !f.Z;				// BHI
+		case 0x23: return f.C || f.Z;				// BLS
+		case 0x24: return !f.C;						// BCC
+		case 0x25: return f.C;						// BCS
+		case 0x26: return !f.Z;						// BNE
+		case 0x27: return f.Z;						// BEQ
+		case 0x28: return !f.V;						// BVC
+		case 0x29: return f.V;						// BVS
+		case 0x2a: return !f.N;						// BPL
+		case 0x2b: return f.N;						// BMI
+		case 0x2c: return f.N == f.V;				// BGE
+		case 0x2d: return f.N != f.V;				// BLT
+		case 0x2e: return !f.Z && f.N == f.V;		// BGT
+		case 0x2f: return f.Z || f.N != f.V;		// BLE
+	}
+	return false;
+}
+
+///// PROFILE ///////////////////////////////////////////////////////////
+
+void C6809::Profile(bool enable)
+{
+	if (enable)
+	{
+		_mix.assign(MIX_OPS, 0);
+		_mix_pairs.assign(MIX_OPS * MIX_OPS, 0);
+		_mix_last = -1;
+	}
+	_profile = enable;
+}
+
+void C6809::profile_op()
+{
+	int index = mix_index(opcode);
+	_mix[index]++;
+	if (_mix_last >= 0)
+		_mix_pairs[_mix_last * MIX_OPS + index]++;
+	_mix_last = index;
+}
+
+QWord C6809::ProfileCount(Word op)
+{
+	return _mix.empty() ? 0 : _mix[mix_index(op)];
+}
+
+QWord C6809::ProfileCount(Word first, Word second)
+{
+	return _mix_pairs.empty() ? 0 : _mix_pairs[mix_index(first) * MIX_OPS + mix_index(second)];
+}
+
+bool C6809::SaveProfile(const std::string& filename)
+{
+	FILE* fp = fopen(filename.c_str(), "w");
+	if (!fp)
+		return false;
+	auto op_of = [](int index) -> Word {
+		return index < 0x100 ? index : ((index >> 8) + 0x0f) << 8 | (index & 0xff);
+	};
+	auto name = [&](int index) {
+		auto it = opMap.find(op_of(index));
+		return it == opMap.end() ? std::string("???") : it->second.mnem;
+	};
+	QWord total = 0;
+	std::vector<int> order;
+	for (int t = 0; t < (int)_mix.size(); t++)
+	{
+		total += _mix[t];
+		if (_mix[t])
+			order.push_back(t);
+	}
+	auto by_count = [](const std::vector<QWord>& v) {
+		return [&v](int a, int b) { return v[a] > v[b]; };
+	};
+	std::stable_sort(order.begin(), order.end(), by_count(_mix));
+	fprintf(fp, "opcode,mnemonic,count,percent\n");
+	for (int t : order)
+		fprintf(fp, "%04X,%s,%llu,%.3f\n", op_of(t), name(t).c_str(),
+			(unsigned long long)_mix[t], 100.0 * _mix[t] / total);
+
+	order.clear();
+	for (int t = 0; t < (int)_mix_pairs.size(); t++)
+		if (_mix_pairs[t])
+			order.push_back(t);
+	std::stable_sort(order.begin(), order.end(), by_count(_mix_pairs));
+	fprintf(fp, "\nfirst,second,mnemonics,count,percent\n");
+	for (int t : order)
+	{
+		int a = t / MIX_OPS, b = t % MIX_OPS;
+		fprintf(fp, "%04X,%04X,%s %s,%llu,%.3f\n", op_of(a), op_of(b), name(a).c_str(), name(b).c_str(),
+			(unsigned long long)_mix_pairs[t], 100.0 * _mix_pairs[t] / total);
+	}
+	fclose(fp);
+	return true;
+}
+
+
+/**** NOTES *******************************************************************************
+ *
+ *  Profile(true) counts every instruction the interpreter runs, by opcode and by the
+ *      opcode that ran just before it, until Profile(false). SaveProfile() writes both
+ *      tables as CSV, most frequent first, with each count also as a percentage of all
+ *      of the instructions run. In the emulator Alt+P starts a profile and a second
+ *      Alt+P saves it to PROFILE_FILENAME. Start or clear a profile only while the CPU
+ *      is paused; Machine owners can call these between Run() slices.
+ *
+ *  While the profile runs, fused pairs and block loops (BlockLoops.cpp) stand aside so
+ *      the counts are the program's own instructions. Kernel calls taken by the HLE
+ *      traps are not counted.
+ *
+ *  A fusable instruction (s_fuse) runs the instruction after it in the same dispatch:
+ *      a short branch is evaluated in place, and a store of the register just loaded
+ *      goes through the core directly. The pair is charged the sum of both instruction
+ *      cycles, so timing is unchanged.
+ *
+ *  Pairs are only fused when nothing could happen at the boundary between them: IRQ
+ *      and FIRQ are both masked, no NMI edge is pending (the first instruction may
+ *      have raised one), the debugger is closed and not stepping, no breakpoint
+ *      sits on the second instruction and the CPU control API is not counting
+ *      steps or waiting for an address. The kernel runs with interrupts
+ *      masked, which is where the measured pairs come from.
+ *
+ **** NOTES *******************************************************************************/
@@ -0,0 +1,91 @@
+// *************************************************
+// *
+// * Vfs.cpp
+// *
+// ***********************************
+
+#include "Vfs.hpp"
+
+HostVfs::HostVfs(FILE_STATS& stats) : _stats(stats), _stat_cache(stats)
+{
+    std::error_code ec;
+    _cwd = std::filesystem::current_path(ec).generic_string();
+}
+
+std::string HostVfs::Resolve(const std::string& path)
+{
+    std::filesystem::path p = path;
+    if (!p.is_absolute())
+        p = std::filesystem::path(_cwd) / p;
+    std::string full = p.lexically_normal().generic_string();
+    while (full.size() > 1 && full.back() == '/')
+        full.pop_back();
+    return full;
+}
+
+std::unique_ptr<VfsFile> HostVfs::Open(const std::string& path, const char* mode)
+{
+    std::string full = Resolve(path);
+    FileStatCache* stat_cache = nullptr;
+    if (mode[0] != 'r')
+    {
+        _stat_cache.Invalidate(full);
+        stat_cache = &_stat_cache;
+    }
+    auto fh = std::make_unique<FileHandle>(_stats, stat_cache);
+    if (!fh->Open(full, mode))
+        return nullptr;
+    return fh;
+}
+
+bool HostVfs::Stat(const std::string& path, bool& folder, DWord& length)
+{
+    return _stat_cache.Stat(Resolve(path), folder, length);
+}
+
+bool HostVfs::MakeDir(const std::string& path)
+{
+    std::string full = Resolve(path);
+    _stat_cache.Invalidate(full);
+    std::error_code ec;
+    return std::filesystem::create_directory(full, ec);
+}
+
+bool HostVfs::ChangeDir(const std::string& path)
+{
+    std::string full = Resolve(path);
+    std::error_code ec;
+    if (!std::filesystem::is_directory(full, ec))
+        return false;
+    _cwd = full;
+    return true;
+}
+
+bool HostVfs::OpenDir(const std::string& path)
+{
+    std::error_code ec;
+    _dir_it = std::filesystem::directory_iterator(Resolve(path), ec);
+    return !ec;
+}
+
+bool HostVfs::NextEntry(std::string& name, bool& folder)
+{
+    std::error_code ec;
+    if (_dir_it == std::filesystem::directory_iterator())
+        return false;
+    folder = _dir_it->is_directory(ec);
+
+    // the file name, copied straight out of the entry's own path string
+    const auto& native = _dir_it->path().native();
+    size_t start = native.size();
+    while (start > 0 && native[start - 1] != '/' && native[start - 1] != std::filesystem::path::preferred_separator)
+        start--;
+    name.clear();
+    for (size_t t = start; t < native.size(); t++)
+        name += (char)native[t];
+
+    _dir_it.increment(ec);
+    if (ec)
+        _dir_it = std::filesystem::directory_iterator();
+    return true;
+}
@@ -85,12 +85,32 @@ GFX_GLYPH_DATA      equ   $FE0C    ;  (8-Bytes) Text Glyph Pixel Data Array
           ;     array represents the top line of 8 pixels. Each array entry represents
           ;     a row of 8 pixels. 
         
-GFX_END             equ   $FE14    ;  End of Graphics Hardware Registers
+GFX_IRQ_CTRL        equ   $FE14    ;  (Byte) Raster Interrupt Control
+          ;          - bit 7     = 1:interrupt at the start of vertical blank
+          ;          - bit 6     = 1:interrupt when GFX_SCANLINE == GFX_RASTER_CMP
+          ;          - bit 5     = vertical blank 0:IRQ, 1:FIRQ
+          ;          - bit 4     = raster line 0:IRQ, 1:FIRQ
+        
+GFX_IRQ_STATUS      equ   $FE15    ;  (Byte) Raster Interrupt Status
+          ;          - bit 7     = vertical blank interrupt pending
+          ;          - bit 6     = raster line interrupt pending
+          ;          - bit 0     = 1:beam is in the vertical blank (read only)
+          ; Note: Write a 1 to bits 6 or 7 to acknowledge the interrupt. The 
+          ;     interrupt line is held until it has been acknowledged.
+        
+GFX_RASTER_CMP      equ   $FE16    ;  (Word) Raster Line Interrupt Compare
+        
+GFX_SCANLINE        equ   $FE18    ;  (Word Read Only) Current Raster Line
+          ; Note: Lines 0 to VRES-1 are visible pixel rows, the rest of the frame
+          ;     is vertical blank. The beam is timed by the CPU clock at 60 frames
+          ;     per emulated second.
+        
+GFX_END             equ   $FE1A    ;  End of Graphics Hardware Registers
         
           ; System Hardware Registers:
         
-SYS_BEGIN           equ   $FE14    ;  Start of System Hardware Registers
-SYS_STATE           equ   $FE14    ;  (Byte) System State Register
+SYS_BEGIN           equ   $FE1A    ;  Start of System Hardware Registers
+SYS_STATE           equ   $FE1A    ;  (Byte) System State Register
           ; SYS_STATE: ABCD.SSSS
           ;      A:0   = Error: Standard Buffer Overflow 
           ;      B:0   = Error: Extended Buffer Overflow 
@@ -113,8 +133,8 @@ SYS_STATE           equ   $FE14    ;  (Byte) System State Register
           ;      S:$E  = CPU Clock 5.0 mhz.
           ;      S:$F  = CPU Clock ~10.0 mhz. (unmetered)
         
-SYS_SPEED           equ   $FE15    ;  (Word) Approx. Average CPU Clock Speed
-SYS_CLOCK_DIV       equ   $FE17    ;  (Byte) 60 hz Clock Divider Register (Read Only) 
+SYS_SPEED           equ   $FE1B    ;  (Word) Approx. Average CPU Clock Speed
+SYS_CLOCK_DIV       equ   $FE1D    ;  (Byte) 60 hz Clock Divider Register (Read Only) 
           ; SYS_CLOCK_DIV:
           ;      bit 7: 0.46875 hz
           ;      bit 6: 0.9375 hz
@@ -125,13 +145,13 @@ SYS_CLOCK_DIV       equ   $FE17    ;  (Byte) 60 hz Clock Divider Register (Read
           ;      bit 1: 30.0 hz
           ;      bit 0: 60.0 hz
         
-SYS_TIMER           equ   $FE18    ;  (Word) Increments at 0.46875 hz
-SYS_END             equ   $FE1A    ;  End of System Hardware Registers
+SYS_TIMER           equ   $FE1E    ;  (Word) Increments at 0.46875 hz
+SYS_END             equ   $FE20    ;  End of System Hardware Registers
         
           ; Debug Hardware Registers:
-DBG_BEGIN           equ   $FE1A    ;  start of debugger hardware registers
-DBG_BRK_ADDR        equ   $FE1A    ;    (Word) Address of current breakpoint
-DBG_FLAGS           equ   $FE1C    ;    (Byte) Debug Specific Hardware Flags:
+DBG_BEGIN           equ   $FE20    ;  start of debugger hardware registers
+DBG_BRK_ADDR        equ   $FE20    ;    (Word) Address of current breakpoint
+DBG_FLAGS           equ   $FE22    ;    (Byte) Debug Specific Hardware Flags:
           ;     bit 7: Debug Enable
           ;     bit 6: Single Step Enable
           ;     bit 5: Clear All Breakpoints
@@ -140,59 +160,59 @@ DBG_FLAGS           equ   $FE1C    ;    (Byte) Debug Specific Hardware Flags:
           ;     bit 2: IRQ   (on low to high edge)
           ;     bit 1: NMI   (on low to high edge)
           ;     bit 0: RESET (on low to high edge)
-DBG_END             equ   $FE1D    ; End Debug Registers
+DBG_END             equ   $FE23    ; End Debug Registers
         
           ; Mouse Cursor Hardware Registers:
-CSR_BEGIN           equ   $FE1D    ;  Start of Mouse Cursor Hardware Registers
-CSR_XPOS            equ   $FE1D    ;  (Word) horizontal mouse cursor coordinate
-CSR_YPOS            equ   $FE1F    ;  (Word) vertical mouse cursor coordinate
-CSR_XOFS            equ   $FE21    ;  (Byte) horizontal mouse cursor offset
-CSR_YOFS            equ   $FE22    ;  (Byte) vertical mouse cursor offset
-CSR_SCROLL          equ   $FE23    ;  (Signed) MouseWheel Scroll: -1, 0, 1
-CSR_FLAGS           equ   $FE24    ;  (Byte) mouse button flags:
+CSR_BEGIN           equ   $FE23    ;  Start of Mouse Cursor Hardware Registers
+CSR_XPOS            equ   $FE23    ;  (Word) horizontal mouse cursor coordinate
+CSR_YPOS            equ   $FE25    ;  (Word) vertical mouse cursor coordinate
+CSR_XOFS            equ   $FE27    ;  (Byte) horizontal mouse cursor offset
+CSR_YOFS            equ   $FE28    ;  (Byte) vertical mouse cursor offset
+CSR_SCROLL          equ   $FE29    ;  (Signed) MouseWheel Scroll: -1, 0, 1
+CSR_FLAGS           equ   $FE2A    ;  (Byte) mouse button flags:
           ;  CSR_FLAGS:
           ;       bits 0-4: button states
           ;       bits 5-6: number of clicks
           ;       bits 7:   cursor enable
-CSR_BMP_INDX        equ   $FE25    ;  (Byte) mouse cursor bitmap pixel offset
-CSR_BMP_DATA        equ   $FE26    ;  (Byte) mouse cursor bitmap pixel index color
-CSR_PAL_INDX        equ   $FE27    ;  (Byte) mouse cursor color palette index (0-15)
-CSR_PAL_DATA        equ   $FE28    ;  (Word) mouse cursor color palette data RGBA4444
-CSR_END             equ   $FE2A    ; End Mouse Registers
+CSR_BMP_INDX        equ   $FE2B    ;  (Byte) mouse cursor bitmap pixel offset
+CSR_BMP_DATA        equ   $FE2C    ;  (Byte) mouse cursor bitmap pixel index color
+CSR_PAL_INDX        equ   $FE2D    ;  (Byte) mouse cursor color palette index (0-15)
+CSR_PAL_DATA        equ   $FE2E    ;  (Word) mouse cursor color palette data RGBA4444
+CSR_END             equ   $FE30    ; End Mouse Registers
         
           ; Keyboard Hardware Registers:
-KEY_BEGIN           equ   $FE2A    ; Start of the Keyboard Register space
-CHAR_Q_LEN          equ   $FE2A    ;   (Byte) # of characters waiting in queue        (Read Only)
-CHAR_SCAN           equ   $FE2B    ;   (Byte) read next character in queue (not popped when read)
-CHAR_POP            equ   $FE2C    ;   (Byte) read next character in queue (popped when read)
-XKEY_BUFFER         equ   $FE2D    ;   (128 bits) 16 bytes for XK_KEY data buffer     (Read Only)
-EDT_BFR_CSR         equ   $FE3D    ;   (Byte) cursor position within edit buffer     (Read/Write)
-EDT_ENABLE          equ   $FE3E    ;   (Byte) line editor enable flag                 (Read/Write)
-EDT_BFR_LEN         equ   $FE3F    ;   (Byte) Limit the line editor to this length   (Read/Write)
-EDT_BUFFER          equ   $FE40    ;   line editing character buffer                 (Read Only)
-KEY_END             equ   $FF40    ; End of the Keyboard Register space
-        
-JOYS_BEGIN          equ   $FF40    ; Start of the Game Controller Register space
-JOYS_1_BTN          equ   $FF40    ;   (Word) button bits: room for up to 16 buttons  (realtime)
-JOYS_1_DBND         equ   $FF42    ;   (Byte) PAD 1 analog deadband; default is 5   (read/write)
-JOYS_1_LTX          equ   $FF43    ;   (char) PAD 1 LThumb-X position (-128 _ +127)   (realtime)
-JOYS_1_LTY          equ   $FF44    ;   (char) PAD 1 LThumb-Y position (-128 _ +127)   (realtime)
-JOYS_1_RTX          equ   $FF45    ;   (char) PAD 1 RThumb-X position (-128 _ +127)   (realtime)
-JOYS_1_RTY          equ   $FF46    ;   (char) PAD 1 RThumb-Y position (-128 _ +127)   (realtime)
-JOYS_1_Z1           equ   $FF47    ;   (char) PAD 1 left analog trigger (0 - 127)     (realtime)
-JOYS_1_Z2           equ   $FF48    ;   (char) PAD 1 right analog trigger (0 - 127)    (realtime)
-JOYS_2_BTN          equ   $FF49    ;   (Word) button bits: room for up to 16 buttons  (realtime)
-JOYS_2_DBND         equ   $FF4B    ;   (Byte) PAD 2 analog deadband; default is 5   (read/write)
-JOYS_2_LTX          equ   $FF4C    ;   (char) PAD 2 LThumb-X position (-128 _ +127)   (realtime)
-JOYS_2_LTY          equ   $FF4D    ;   (char) PAD 2 LThumb-Y position (-128 _ +127)   (realtime)
-JOYS_2_RTX          equ   $FF4E    ;   (char) PAD 2 RThumb-X position (-128 _ +127)   (realtime)
-JOYS_2_RTY          equ   $FF4F    ;   (char) PAD 2 RThumb-Y position (-128 _ +127)   (realtime)
-JOYS_2_Z1           equ   $FF50    ;   (char) PAD 2 left analog trigger (0 - 127)     (realtime)
-JOYS_2_Z2           equ   $FF51    ;   (char) PAD 2 right analog trigger (0 - 127)    (realtime)
-JOYS_END            equ   $FF52    ; End of the Game Controller Register space
-        
-FIO_BEGIN           equ   $FF52    ; Start of the FileIO register space
-FIO_ERROR           equ   $FF52    ; (Byte) FILE_ERROR enumeration result
+KEY_BEGIN           equ   $FE30    ; Start of the Keyboard Register space
+CHAR_Q_LEN          equ   $FE30    ;   (Byte) # of characters waiting in queue        (Read Only)
+CHAR_SCAN           equ   $FE31    ;   (Byte) read next character in queue (not popped when read)
+CHAR_POP            equ   $FE32    ;   (Byte) read next character in queue (popped when read)
+XKEY_BUFFER         equ   $FE33    ;   (128 bits) 16 bytes for XK_KEY data buffer     (Read Only)
+EDT_BFR_CSR         equ   $FE43    ;   (Byte) cursor position within edit buffer     (Read/Write)
+EDT_ENABLE          equ   $FE44    ;   (Byte) line editor enable flag                 (Read/Write)
+EDT_BFR_LEN         equ   $FE45    ;   (Byte) Limit the line editor to this length   (Read/Write)
+EDT_BUFFER          equ   $FE46    ;   line editing character buffer                 (Read Only)
+KEY_END             equ   $FF46    ; End of the Keyboard Register space
+        
+JOYS_BEGIN          equ   $FF46    ; Start of the Game Controller Register space
+JOYS_1_BTN          equ   $FF46    ;   (Word) button bits: room for up to 16 buttons  (realtime)
+JOYS_1_DBND         equ   $FF48    ;   (Byte) PAD 1 analog deadband; default is 5   (read/write)
+JOYS_1_LTX          equ   $FF49    ;   (char) PAD 1 LThumb-X position (-128 _ +127)   (realtime)
+JOYS_1_LTY          equ   $FF4A    ;   (char) PAD 1 LThumb-Y position (-128 _ +127)   (realtime)
+JOYS_1_RTX          equ   $FF4B    ;   (char) PAD 1 RThumb-X position (-128 _ +127)   (realtime)
+JOYS_1_RTY          equ   $FF4C    ;   (char) PAD 1 RThumb-Y position (-128 _ +127)   (realtime)
+JOYS_1_Z1           equ   $FF4D    ;   (char) PAD 1 left analog trigger (0 - 127)     (realtime)
+JOYS_1_Z2           equ   $FF4E    ;   (char) PAD 1 right analog trigger (0 - 127)    (realtime)
+JOYS_2_BTN          equ   $FF4F    ;   (Word) button bits: room for up to 16 buttons  (realtime)
+JOYS_2_DBND         equ   $FF51    ;   (Byte) PAD 2 analog deadband; default is 5   (read/write)
+JOYS_2_LTX          equ   $FF52    ;   (char) PAD 2 LThumb-X position (-128 _ +127)   (realtime)
+JOYS_2_LTY          equ   $FF53    ;   (char) PAD 2 LThumb-Y position (-128 _ +127)   (realtime)
+JOYS_2_RTX          equ   $FF54    ;   (char) PAD 2 RThumb-X position (-128 _ +127)   (realtime)
+JOYS_2_RTY          equ   $FF55    ;   (char) PAD 2 RThumb-Y position (-128 _ +127)   (realtime)
+JOYS_2_Z1           equ   $FF56    ;   (char) PAD 2 left analog trigger (0 - 127)     (realtime)
+JOYS_2_Z2           equ   $FF57    ;   (char) PAD 2 right analog trigger (0 - 127)    (realtime)
+JOYS_END            equ   $FF58    ; End of the Game Controller Register space
+        
+FIO_BEGIN           equ   $FF58    ; Start of the FileIO register space
+FIO_ERROR           equ   $FF58    ; (Byte) FILE_ERROR enumeration result
           ; Begin FILE_ERROR enumeration
 FE_NOERROR          equ   $0000    ;      $00: no error, condition normal
 FE_NOTFOUND         equ   $0001    ;      $01: file or folder not found
@@ -204,7 +224,7 @@ FE_BAD_CMD          equ   $0006    ;      $06: invalid command
 FE_BADSTREAM        equ   $0007    ;      $07: invalid file stream
           ; End FILE_ERROR enumeration
         
-FIO_COMMAND         equ   $FF53    ; (Byte) OnWrite, execute a file command (FC_<cmd>)
+FIO_COMMAND         equ   $FF59    ; (Byte) OnWrite, execute a file command (FC_<cmd>)
           ; Begin FIO_COMMANDS
 FC_RESET            equ   $0000    ;        Reset
 FC_SHUTDOWN         equ   $0001    ;        SYSTEM: Shutdown
@@ -231,36 +251,53 @@ FC_SEEKSTART        equ   $0015    ;      * Seek Start
 FC_SEEKEND          equ   $0016    ;      * Seek End
 FC_SET_SEEK         equ   $0017    ;      * Set Seek Position (from FIO_IOWORD)
 FC_GET_SEEK         equ   $0018    ;      * Get Seek Position (into FIO_IOWORD)
+FC_READBLOCK        equ   $0019    ;        Read Block (FIO_HANDLE into FIO_BLK_ADDR)
+FC_WRITEBLOCK       equ   $001A    ;        Write Block (FIO_BLK_ADDR into FIO_HANDLE)
+FC_LOADBIN          equ   $001B    ;        Load Binary File (into FIO_BLK_ADDR)
+FC_SAVEBIN          equ   $001C    ;        Save Binary File (from FIO_BLK_ADDR)
+FC_READDIR          equ   $001D    ;        Read Directory Listing (into FIO_BUFFER)
           ; End FIO_COMMANDS
         
-FIO_HANDLE          equ   $FF54    ; (Byte) current file stream HANDLE 0=NONE
-FIO_SEEKPOS         equ   $FF55    ; (DWord) file seek position
-FIO_IODATA          equ   $FF59    ; (Byte) input / output character
-FIO_PATH_LEN        equ   $FF5A    ; (Byte) length of the filepath
-FIO_PATH_POS        equ   $FF5B    ; (Byte) character position within the filepath
-FIO_PATH_DATA       equ   $FF5C    ; (Byte) data at the character position of the path
-FIO_DIR_DATA        equ   $FF5D    ; (Byte) a series of null-terminated filenames
+FIO_HANDLE          equ   $FF5A    ; (Byte) current file stream HANDLE 0=NONE
+FIO_SEEKPOS         equ   $FF5B    ; (DWord) file seek position
+FIO_IODATA          equ   $FF5F    ; (Byte) input / output character
+FIO_PATH_LEN        equ   $FF60    ; (Byte) length of the filepath
+FIO_PATH_POS        equ   $FF61    ; (Byte) character position within the filepath
+FIO_PATH_DATA       equ   $FF62    ; (Byte) data at the character position of the path
+FIO_DIR_DATA        equ   $FF63    ; (Byte) a series of null-terminated filenames
           ;     NOTES: Current read-position is reset to the beginning following a 
           ;             List Directory command. The read-position is automatically 
           ;             advanced on read from this register. Each filename is 
           ;             $0a-terminated. The list itself is null-terminated.
-FIO_END             equ   $FF5E    ; End of the FileIO register space
+FIO_BLK_TYPE        equ   $FF64    ; (Byte) block transfer memory type (DMA_TYPE_<type>)
+FIO_BLK_PAGE        equ   $FF65    ; (Byte) block transfer page (DMA_TYPE_BANK)
+FIO_BLK_ADDR        equ   $FF66    ; (Word) block transfer address (FIO_BUFFER on reset)
+FIO_BLK_LEN         equ   $FF68    ; (Word) bytes to transfer (0: the command maximum)
+FIO_BLK_COUNT       equ   $FF6A    ; (DWord) bytes moved by the last block command
+FIO_STATUS          equ   $FF6E    ; (Byte) asynchronous command status
+          ;      bit 7:    1=a queued command is busy (read only)
+          ;      bit 6:    1=done, write 1 to acknowledge
+          ;      bits 3-5: reserved
+          ;      bit 2:    1=queue commands to the I/O thread
+          ;      bit 1:    1=raise an interrupt on completion
+          ;      bit 0:    interrupt type: 0=IRQ, 1=FIRQ
+FIO_END             equ   $FF6F    ; End of the FileIO register space
         
           ; Math Co-Processor Hardware Registers:
-MATH_BEGIN          equ   $FF5E    ;  start of math co-processor  hardware registers
-MATH_ACA_POS        equ   $FF5E    ;  (Byte) character position within the ACA float string
-MATH_ACA_DATA       equ   $FF5F    ;  (Byte) ACA float string character port
-MATH_ACA_RAW        equ   $FF60    ;  (4-Bytes) ACA raw float data
-MATH_ACA_INT        equ   $FF64    ;  (4-Bytes) ACA integer data
-MATH_ACB_POS        equ   $FF68    ;  (Byte) character position within the ACB float string
-MATH_ACB_DATA       equ   $FF69    ;  (Byte) ACB float string character port
-MATH_ACB_RAW        equ   $FF6A    ;  (4-Bytes) ACB raw float data
-MATH_ACB_INT        equ   $FF6E    ;  (4-Bytes) ACB integer data
-MATH_ACR_POS        equ   $FF72    ;  (Byte) character position within the ACR float string
-MATH_ACR_DATA       equ   $FF73    ;  (Byte) ACR float string character port
-MATH_ACR_RAW        equ   $FF74    ;  (4-Bytes) ACR raw float data
-MATH_ACR_INT        equ   $FF78    ;  (4-Bytes) ACR integer data
-MATH_OPERATION      equ   $FF7C    ;  (Byte) Operation 'command' to be issued
+MATH_BEGIN          equ   $FF6F    ;  start of math co-processor  hardware registers
+MATH_ACA_POS        equ   $FF6F    ;  (Byte) character position within the ACA float string
+MATH_ACA_DATA       equ   $FF70    ;  (Byte) ACA float string character port
+MATH_ACA_RAW        equ   $FF71    ;  (4-Bytes) ACA raw float data
+MATH_ACA_INT        equ   $FF75    ;  (4-Bytes) ACA integer data
+MATH_ACB_POS        equ   $FF79    ;  (Byte) character position within the ACB float string
+MATH_ACB_DATA       equ   $FF7A    ;  (Byte) ACB float string character port
+MATH_ACB_RAW        equ   $FF7B    ;  (4-Bytes) ACB raw float data
+MATH_ACB_INT        equ   $FF7F    ;  (4-Bytes) ACB integer data
+MATH_ACR_POS        equ   $FF83    ;  (Byte) character position within the ACR float string
+MATH_ACR_DATA       equ   $FF84    ;  (Byte) ACR float string character port
+MATH_ACR_RAW        equ   $FF85    ;  (4-Bytes) ACR raw float data
+MATH_ACR_INT        equ   $FF89    ;  (4-Bytes) ACR integer data
+MATH_OPERATION      equ   $FF8D    ;  (Byte) Operation 'command' to be issued
           ; Begin MATH_OPERATION's (MOPS)
 MOP_RANDOM          equ   $0000    ;        ACA, ACB, and ACR are set to randomized values
 MOP_RND_SEED        equ   $0001    ;        MATH_ACA_INT seeds the pseudo-random number generator
@@ -321,44 +358,92 @@ MOP_NEXTAFTER       equ   $0037    ;        ACR = std::nextafter(ACA, ACB);
 MOP_COPYSIGN        equ   $0038    ;        ACR = std::copysign(ACA, ACB);
 MOP_LASTOP          equ   $0038    ;        last implemented math operation 
           ; End MATH_OPERATION's (MOPS)
-MATH_END            equ   $FF7D    ; end of math co-processor registers
+MATH_END            equ   $FF8E    ; end of math co-processor registers
         
           ; Memory Device Hardware Registers
-MEM_BEGIN           equ   $FF7D    ; Start of Memory Device Hardware Registers
-MEM_BANK1_SELECT    equ   $FF7E    ; (Byte) select 8k page for bank 1 (0-255)
-MEM_BANK2_SELECT    equ   $FF7F    ; (Byte) select 8k page for bank 2 (0-255)
-MEM_BANK1_TYPE      equ   $FF80    ; (Byte) memory bank 1 type
-MEM_BANK2_TYPE      equ   $FF81    ; (Byte) memory bank 2 type
+MEM_BEGIN           equ   $FF8E    ; Start of Memory Device Hardware Registers
+MEM_BANK1_SELECT    equ   $FF8F    ; (Byte) select 8k page for bank 1 (0-255)
+MEM_BANK2_SELECT    equ   $FF90    ; (Byte) select 8k page for bank 2 (0-255)
+MEM_BANK1_TYPE      equ   $FF91    ; (Byte) memory bank 1 type
+MEM_BANK2_TYPE      equ   $FF92    ; (Byte) memory bank 2 type
 MEM_TYPE_RAM        equ   $0000    ;      random access memory (RAM)
 MEM_TYPE_PERSIST    equ   $0001    ;      persistent memory (saved RAM)
 MEM_TYPE_ROM        equ   $0002    ;      read only memory (ROM)
+MEM_BANK1_PAGE      equ   $FF93    ; (Word) select 8k page for bank 1 (0-65535)
+MEM_BANK2_PAGE      equ   $FF95    ; (Word) select 8k page for bank 2 (0-65535)
+          ;      Notes: The page is selected when the 
+          ;             least-significant byte is written.
+          ;             The MSB reads back as written until then.
+          ;             A page past MEM_BANK_MAX is ignored.
+MEM_BANK_MAX        equ   $FF97    ; (Word) highest page number (read only)
         
-MEM_DSP_FLAGS       equ   $FF82    ; (Byte) Extended Graphics Display Flags
+MEM_DSP_FLAGS       equ   $FF99    ; (Byte) Extended Graphics Display Flags
           ;      bit 7:    1=extended bitmap enabled, 0=disabled 
           ;      bit 6:    1=standard modes enabled,  0=disabled
           ;      bits 2-5: reserved (possibly for tilemap/sprites)
           ;      bits 0-1: extended bitmap color depth:  
           ;                0:2-color, 1:4-color, 2:16-color, 3:256-color
-MEM_DSPLY_SIZE      equ   $FF83    ; (Word) Extended Graphics Buffer Size
+MEM_DSPLY_SIZE      equ   $FF9A    ; (Word) Extended Graphics Buffer Size
         
-MEM_EXT_ADDR        equ   $FF85    ; (Word) Extended Memory Address Port
-MEM_EXT_PITCH       equ   $FF87    ; (Word) number of bytes per line
-MEM_EXT_WIDTH       equ   $FF89    ; (Word) width before skipping to next line
-MEM_EXT_DATA        equ   $FF8B    ; (Byte) External Memory Data Port
+MEM_EXT_ADDR        equ   $FF9C    ; (Word) Extended Memory Address Port
+MEM_EXT_PITCH       equ   $FF9E    ; (Word) number of bytes per line
+MEM_EXT_WIDTH       equ   $FFA0    ; (Word) width before skipping to next line
+MEM_EXT_DATA        equ   $FFA2    ; (Byte) External Memory Data Port
         
-MEM_DYN_SIZE        equ   $FF8C    ; (Word) dynamic memory block size
+MEM_DYN_SIZE        equ   $FFA3    ; (Word) dynamic memory block size
           ;      Notes: Memory allocation occurs when the 
           ;             least-significant byte is written.
           ;             Reads as total number of bytes allocated
           ;             or freed. When $0000 is written to this 
           ;             port, memory node at MEM_DYN_ADDR is freed.
-MEM_DYN_ADDR        equ   $FF8E    ; (Word) address of a dynamic memory node
-MEM_DYN_AVAIL       equ   $FF90    ; (Word) number of non-allocated bytes
-MEM_END             equ   $FF92    ; End of Memory Device Hardware Registers
+MEM_DYN_ADDR        equ   $FFA5    ; (Word) address of a dynamic memory node
+MEM_DYN_AVAIL       equ   $FFA7    ; (Word) number of non-allocated bytes
+MEM_END             equ   $FFA9    ; End of Memory Device Hardware Registers
+        
+          ; DMA Controller Hardware Registers
+DMA_BEGIN           equ   $FFA9    ; Start of DMA Controller Hardware Registers
+DMA_CHANNEL         equ   $FFA9    ; (Byte) selects the active DMA channel (0-3)
+DMA_CONTROL         equ   $FFAA    ; (Byte) control register for the active channel
+          ;      bit 7:    write 1=start transfer, read 1=busy
+          ;      bit 6:    1=raise an interrupt on completion
+          ;      bit 5:    interrupt type: 0=IRQ, 1=FIRQ
+          ;      bit 4:    0=instant, 1=cycle-stealing
+          ;      bits 0-3: reserved
+DMA_STATUS          equ   $FFAB    ; (Byte) channel status flags
+          ;      bits 4-7: channel busy (read only)
+          ;      bits 0-3: channel complete (write 1 to acknowledge)
+DMA_SRC_TYPE        equ   $FFAC    ; (Byte) source type
+DMA_TYPE_CPU        equ   $0000    ;      CPU address space
+DMA_TYPE_EXT        equ   $0001    ;      extended memory
+DMA_TYPE_BANK       equ   $0002    ;      banked memory page
+DMA_TYPE_PALETTE    equ   $0003    ;      color palette (two bytes per color)
+DMA_TYPE_GLYPH      equ   $0004    ;      glyph table (eight bytes per glyph)
+DMA_SRC_PAGE        equ   $FFAD    ; (Byte) source page (DMA_TYPE_BANK)
+DMA_SRC_ADDR        equ   $FFAE    ; (Word) source address
+DMA_DST_TYPE        equ   $FFB0    ; (Byte) destination type
+DMA_DST_PAGE        equ   $FFB1    ; (Byte) destination page (DMA_TYPE_BANK)
+DMA_DST_ADDR        equ   $FFB2    ; (Word) destination address
+DMA_LENGTH          equ   $FFB4    ; (Word) number of bytes to transfer
+DMA_END             equ   $FFB6    ; End of DMA Controller Hardware Registers
+        
+          ; Frame Capture Hardware Registers
+CAP_BEGIN           equ   $FFB6    ; Start of Frame Capture Hardware Registers
+CAP_CTRL            equ   $FFB6    ; (Byte) frame capture control
+          ;      bit 7:    write 1=capture the next frame, read 1=pending
+          ;      bit 6:    1=stream every frame, 0=stream closed
+          ;      bit 5:    still image format: 0=PPM, 1=PNG
+          ;      bit 4:    stream format: 0=raw RGB24, 1=Y4M
+          ;      bit 3:    1=hash every frame, check against the golden log
+          ;      bits 0-2: reserved
+CAP_INTERVAL        equ   $FFB7    ; (Byte) capture a still every N frames (0=off)
+CAP_FRAMES          equ   $FFB8    ; (Word Read Only) frames written
+CAP_DROPPED         equ   $FFBA    ; (Word Read Only) frames dropped (queue full)
+CAP_MISMATCH        equ   $FFBC    ; (Word Read Only) hashed frames that differ from golden
+CAP_END             equ   $FFBE    ; End of Frame Capture Hardware Registers
         
           ; Reserved for Future Hardware Devices
-RSRVD_DEVICE_MEM    equ   $FF92  
-          ; 94 bytes in reserve
+RSRVD_DEVICE_MEM    equ   $FFBE  
+          ; 50 bytes in reserve
         
           ; Hardware Interrupt Vectors:
 ROM_VECTS           equ   $FFF0  
@@ -0,0 +1,147 @@
+// *************************************************
+// *
+// * golden_frames.cpp
+// *
+// *    Runs scripted programs on headless Machines and checks the display,
+// *    hashed in every graphics mode at fixed emulated cycle counts, against
+// *    the hashes in golden_frames.txt. Run it from the source folder, as
+// *    boot_snapshot is, so that Memory finds TESTING_BITMAP and its palette.
+// *
+// *    usage: golden_frames <golden_frames.txt> [--update]
+// *
+// ***********************************
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include "Machine.hpp"
+#include "Gfx.hpp"
+
+// a program and the commands typed to run it
+struct SCENARIO {
+    std::string name;
+    std::string hex;                    // loaded after the boot, "" for none
+    std::vector<std::string> steps;     // typed one step per checkpoint
+};
+
+// each scenario starts by clearing the boot banner, which carries the build date
+static const std::vector<SCENARIO> s_scenarios = {
+    { "boot",       "",                     { "cls\n", "help\n", "dir\n" } },
+    { "test",       "./build/test.hex",     { "cls\n", "exec\n" } },
+    { "filetest",   "./build/filetest.hex", { "cls\n", "exec\n", "dir\n" } },
+};
+
+static constexpr QWord BOOT_CLOCKS = 1000000;      // the kernel boots well within this
+static constexpr QWord STEP_CLOCKS = 2000000;      // from one checkpoint to the next
+
+// a disk image that is never written: mounting it formats a blank one in memory,
+// so no run depends on the host folders
+static const std::string BLANK_IMAGE = "./golden_frames_blank.img";
+
+using KEY = std::pair<std::string, std::pair<QWord, int>>;     // scenario, cycles, gmode
+
+// runs every scenario and hashes each graphics mode at each checkpoint
+static void run(std::map<KEY, QWord>& hashes)
+{
+    for (auto& sc : s_scenarios)
+    {
+        Machine m("");
+        if (!m.MountDisk(BLANK_IMAGE, false))
+            printf("golden_frames: %s: unable to mount a blank disk\n", sc.name.c_str());
+        m.Run(BOOT_CLOCKS);
+        if (!sc.hex.empty())
+            m.LoadHex(sc.hex);
+        QWord cycles = BOOT_CLOCKS;
+        for (auto& step : sc.steps)
+        {
+            m.Type(step);
+            cycles += STEP_CLOCKS;
+            m.Run(cycles - m.Cycles());
+            // every mode as text, then as a bitmap at each depth (Gfx fits
+            // the depth to the video buffer)
+            Gfx* gfx = Bus::GetGfx();
+            for (Byte bitmap : { 0x00, 0x80, 0xA0, 0xC0, 0xE0 })
+            {
+                for (DWord index = 0; index < gfx->GmodeCount(); index++)
+                {
+                    Byte gmode = bitmap | index;
+                    hashes[{ sc.name, { cycles, gmode } }] = m.FrameHash(gmode);
+                }
+            }
+        }
+        m.Stop();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        printf("usage: golden_frames <golden_frames.txt> [--update]\n");
+        return 1;
+    }
+    std::string golden_file = argv[1];
+    bool bUpdate = (argc > 2 && strcmp(argv[2], "--update") == 0);
+
+    std::map<KEY, QWord> hashes;
+    run(hashes);
+
+    if (bUpdate)
+    {
+        FILE* fp = fopen(golden_file.c_str(), "w");
+        if (!fp)
+        {
+            printf("golden_frames: unable to write %s\n", golden_file.c_str());
+            return 1;
+        }
+        fprintf(fp, "# <scenario> <cycles> <gfx mode> <hash>, written by golden_frames --update\n");
+        for (auto& h : hashes)
+            fprintf(fp, "%s %llu %02X %016llX\n", h.first.first.c_str(),
+                (unsigned long long)h.first.second.first, h.first.second.second, (unsigned long long)h.second);
+        fclose(fp);
+        printf("golden_frames: wrote %zu hashes to %s\n", hashes.size(), golden_file.c_str());
+        return 0;
+    }
+
+    std::map<KEY, QWord> golden;
+    FILE* fp = fopen(golden_file.c_str(), "r");
+    if (!fp)
+    {
+        printf("golden_frames: unable to read %s\n", golden_file.c_str());
+        return 1;
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), fp))
+    {
+        char name[64];
+        unsigned long long cycles, hash;
+        unsigned int gmode;
+        if (line[0] != '#' && sscanf(line, "%63s %llu %x %llx", name, &cycles, &gmode, &hash) == 4)
+            golden[{ name, { (QWord)cycles, (int)gmode } }] = hash;
+    }
+    fclose(fp);
+
+    int failed = 0;
+    for (auto& h : hashes)
+    {
+        auto itr = golden.find(h.first);
+        if (itr != golden.end() && itr->second == h.second)
+            continue;
+        char expected[20] = "none";
+        if (itr != golden.end())
+            snprintf(expected, sizeof(expected), "%016llX", (unsigned long long)itr->second);
+        printf("golden_frames: %s at %llu cycles, mode $%02X: %016llX, expected %s\n",
+            h.first.first.c_str(), (unsigned long long)h.first.second.first, h.first.second.second,
+            (unsigned long long)h.second, expected);
+        failed++;
+    }
+    if (golden.size() != hashes.size())
+    {
+        printf("golden_frames: %zu golden hashes for %zu frames\n", golden.size(), hashes.size());
+        failed++;
+    }
+    printf("golden_frames: %zu frames, %d failed\n", hashes.size(), failed);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,118 @@
+// *************************************************
+// *
+// * held_interrupts.cpp
+// *
+// *    Checks that a device holds its completion interrupt until the program
+// *    acknowledges it: the device completes while CC.I masks the IRQ, and
+// *    the IRQ must still be taken, exactly once, after CC unmasks it.
+// *    Run it from the source folder, as golden_frames is.
+// *
+// *    usage: held_interrupts
+// *
+// ***********************************
+
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+#include "Machine.hpp"
+#include "C6809.hpp"
+#include "Dma.hpp"
+#include "FileIO.hpp"
+
+// a device that completes with its IRQ enabled, and how its handler acknowledges it
+struct SCENARIO {
+    std::string name;
+    std::function<void(Machine&)> start;    // completes (or queues) the work
+    Word ack_reg;                           // the handler writes ack_val here
+    Byte ack_val;
+    Word status_reg;                        // ack_val is clear here afterward
+};
+
+static const std::vector<SCENARIO> s_scenarios = {
+    { "dma", [](Machine& m) {
+            // an instant copy of 16 bytes on channel 2
+            m.Write(DMA_CHANNEL, 2);
+            m.Write(DMA_SRC_TYPE, Dma::TARGET_CPU);
+            m.Write(DMA_SRC_ADDR+0, 0x40);  m.Write(DMA_SRC_ADDR+1, 0x00);
+            m.Write(DMA_DST_TYPE, Dma::TARGET_CPU);
+            m.Write(DMA_DST_ADDR+0, 0x50);  m.Write(DMA_DST_ADDR+1, 0x00);
+            m.Write(DMA_LENGTH+0, 0x00);    m.Write(DMA_LENGTH+1, 0x10);
+            m.Write(DMA_CONTROL, Dma::CTRL_START | Dma::CTRL_INT);
+        }, DMA_STATUS, 0x04, DMA_STATUS },
+    { "fileio", [](Machine& m) {
+            // queue a command to the I/O thread, then issue a second one without
+            // STAT_ASYNC: it waits for the first to complete before it runs
+            m.Write(FIO_STATUS, FileIO::STAT_ASYNC | FileIO::STAT_INT);
+            m.Write(FIO_COMMAND, FC_COMPDATE);
+            m.Write(FIO_STATUS, FileIO::STAT_INT);
+            m.Write(FIO_COMMAND, FC_COMPDATE);
+        }, FIO_STATUS, FileIO::STAT_DONE, FIO_STATUS },
+};
+
+static constexpr QWord BOOT_CLOCKS = 1000000;      // the kernel boots well within this
+static constexpr QWord MASKED_CLOCKS = 16000;      // well inside the masked delay loop
+static constexpr QWord UNMASKED_CLOCKS = 100000;   // the loop ends and the IRQ is taken
+
+static constexpr Word MAIN = 0x3000;
+static constexpr Word HANDLER = 0x3100;
+static constexpr Word COUNTER = 0x3200;
+
+static bool run(const SCENARIO& sc)
+{
+    Machine m("");
+    m.Run(BOOT_CLOCKS);
+
+    // spin about 32K clocks with the IRQ masked, then unmask it and wait
+    //      ldx #$1000 / leax -1,x / bne * -2 / andcc #$ef / bra *
+    const Byte main[] = { 0x8E,0x10,0x00, 0x30,0x1F, 0x26,0xFC, 0x1C,0xEF, 0x20,0xFE };
+    // count the IRQ and acknowledge it
+    //      inc COUNTER / lda #ack_val / sta ack_reg / rti
+    const Byte handler[] = { 0x7C,(Byte)(COUNTER>>8),(Byte)COUNTER, 0x86,sc.ack_val,
+            0xB7,(Byte)(sc.ack_reg>>8),(Byte)sc.ack_reg, 0x3B };
+    for (Word i = 0; i < sizeof(main); i++)
+        m.Write(MAIN + i, main[i]);
+    for (Word i = 0; i < sizeof(handler); i++)
+        m.Write(HANDLER + i, handler[i]);
+    m.Write(COUNTER, 0);
+    m.Write(SOFT_IRQ+0, HANDLER >> 8);
+    m.Write(SOFT_IRQ+1, HANDLER & 0xFF);
+
+    C6809* cpu = m.GetC6809();
+    cpu->setPC(MAIN);
+    cpu->setS(0x2F00);
+    cpu->setCC(0x50);           // IRQ and FIRQ masked
+    sc.start(m);
+
+    bool ok = true;
+    m.Run(MASKED_CLOCKS);
+    if (m.Read(COUNTER) != 0)
+    {
+        printf("held_interrupts: %s: IRQ taken while masked\n", sc.name.c_str());
+        ok = false;
+    }
+    m.Run(UNMASKED_CLOCKS);
+    if (m.Read(COUNTER) != 1)
+    {
+        printf("held_interrupts: %s: %d IRQs taken after unmasking, expected 1\n",
+                sc.name.c_str(), m.Read(COUNTER));
+        ok = false;
+    }
+    if (m.Read(sc.status_reg) & sc.ack_val)
+    {
+        printf("held_interrupts: %s: still pending after the acknowledge\n", sc.name.c_str());
+        ok = false;
+    }
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    int failed = 0;
+    for (auto& sc : s_scenarios)
+        if (!run(sc))
+            failed++;
+    printf("held_interrupts: %d of %d scenarios passed\n",
+            (int)s_scenarios.size() - failed, (int)s_scenarios.size());
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,192 @@
+// *************************************************
+// *
+// * kernel_hle.cpp
+// *
+// *    Calls each kernel routine that CPU_KERNEL_HLE runs natively with random
+// *    arguments, cursor positions and strings, once through the ROM and once
+// *    natively on a second Machine, and checks that both leave the same
+// *    registers, condition codes, cursor and screen behind.
+// *    Run it from the source folder, as golden_frames is.
+// *
+// *    usage: kernel_hle [cases] [seed]
+// *
+// ***********************************
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "Machine.hpp"
+#include "C6809.hpp"
+
+// a trapped routine, by its software vector (kernel_header.asm)
+struct ROUTINE {
+    const char* name;
+    Byte vector;
+};
+
+static const ROUTINE s_routines[] = {
+    { "CLS",       0x10 },
+    { "CHROUT",    0x12 },
+    { "NEWLINE",   0x14 },
+    { "LINEOUT",   0x16 },
+    { "CSRPOS",    0x18 },
+    { "SCROLL",    0x1A },
+    { "CMPSTR",    0x24 },
+    { "TBLSEARCH", 0x28 },
+};
+static constexpr int ROUTINES = sizeof(s_routines) / sizeof(s_routines[0]);
+
+static const char* s_words[] = { "cls", "color", "load", "exec", "reset", "dir", "cd", "CLS", "Dir", "" };
+static constexpr int WORDS = sizeof(s_words) / sizeof(s_words[0]);
+
+static constexpr QWord BOOT_CLOCKS = 1000000;      // the kernel boots well within this
+static constexpr QWord CALL_CLOCKS = 2000000;      // no routine takes anywhere near this
+
+static constexpr Word RETURN = 0x5000;     // bra * to come back to
+static constexpr Word TEXT = 0x6000;       // X: the string, or string 1
+static constexpr Word TEXT2 = 0x6100;      // Y: string 2
+static constexpr Word TABLE = 0x6200;      // Y: the TBLSEARCH table
+static constexpr Word CURSOR_COL = 0x005A;
+static constexpr Word CURSOR_ROW = 0x005B;
+static constexpr Word ATTRIB = 0x005C;
+
+// what a call leaves behind
+struct RESULT {
+    int routine;
+    Word d, x, y, u, s;
+    Byte cc;
+    QWord memory;       // hash of the cursor variables and the screen
+    bool returned;
+};
+
+static void put(Machine& m, Word addr, const std::string& s)
+{
+    for (size_t i = 0; i < s.size(); i++)
+        m.Write(addr + i, s[i]);
+    m.Write(addr + s.size(), 0);
+}
+
+// console text: printable characters and newlines, now and then a high bit
+// terminator, and for LINEOUT always at least one newline
+static std::string text(std::mt19937& rng, bool newline)
+{
+    std::string s;
+    int len = rng() % 100;
+    for (int i = 0; i < len; i++)
+    {
+        int r = rng() % 16;
+        s += (r == 0) ? '\n' : (r == 1 && rng() % 4 == 0) ? (char)(0x80 | rng()) : (char)(0x20 + rng() % 0x5F);
+    }
+    if (newline)
+        s.insert(s.begin() + rng() % (s.size() + 1), '\n');
+    return s;
+}
+
+// every routine called cases times in turn on one Machine, HLE on or off
+static std::vector<RESULT> run(bool hle, int cases, unsigned seed)
+{
+    std::vector<RESULT> results;
+    Machine m("");
+    m.Run(BOOT_CLOCKS);
+    C6809* cpu = m.GetC6809();
+    cpu->Hle(hle);
+
+    // the KRNL_ entry points are the jmp [VEC_] instructions in the ROM
+    Word entry[ROUTINES] = {};
+    for (DWord a = KERNEL_ROM; a < 0xfffc; a++)
+        for (int r = 0; r < ROUTINES; r++)
+            if (m.Read(a) == 0x6e && m.Read(a + 1) == 0x9f && m.Read(a + 2) == 0 && m.Read(a + 3) == s_routines[r].vector)
+                entry[r] = a;
+
+    m.Write(RETURN + 0, 0x20);
+    m.Write(RETURN + 1, 0xfe);
+    std::string table;
+    for (auto w : s_words)
+        if (*w)
+            table += std::string(w) + '\0';
+    table += '\xff';
+    for (size_t i = 0; i < table.size(); i++)
+        m.Write(TABLE + i, table[i]);
+
+    std::mt19937 rng(seed);
+    for (int c = 0; c < cases; c++)
+    {
+        int r = c % ROUTINES;
+        Byte vector = s_routines[r].vector;
+        if (vector == 0x24 || vector == 0x28)
+        {
+            put(m, TEXT, s_words[rng() % WORDS]);
+            put(m, TEXT2, s_words[rng() % WORDS]);
+        }
+        else
+            put(m, TEXT, text(rng, vector == 0x16));
+        if (rng() % 2)
+        {
+            m.Write(CURSOR_COL, rng() % 40);
+            m.Write(CURSOR_ROW, rng() % 25);
+        }
+        m.Write(ATTRIB, rng());
+        m.Write(EDT_ENABLE, rng() % 2);
+
+        // call it with a return address on the stack
+        Word s = 0x0300 + (rng() % 0x40) * 2;
+        m.Write(s - 2, RETURN >> 8);
+        m.Write(s - 1, RETURN & 0xff);
+        cpu->setS(s - 2);
+        cpu->setX(TEXT);
+        cpu->setY(vector == 0x28 ? TABLE : TEXT2);
+        cpu->setU(rng());
+        Word d = rng();
+        if (vector == 0x12)
+            d = (d & 0x00ff) | (rng() % 8 ? 0x20 + rng() % 0x5F : (rng() % 2 ? '\n' : 0)) << 8;
+        cpu->setD(d);
+        cpu->setCC((rng() & 0xff) | 0x50);      // IRQ and FIRQ masked
+        cpu->setPC(entry[r]);
+
+        RESULT res = { r };
+        QWord clocks = 0;
+        while (!(cpu->getCycles() == 0 && cpu->getPC() == RETURN) && clocks < CALL_CLOCKS)
+            clocks += m.Run(1);
+        res.returned = clocks < CALL_CLOCKS;
+        res.d = cpu->getD();    res.x = cpu->getX();    res.y = cpu->getY();
+        res.u = cpu->getU();    res.s = cpu->getS();    res.cc = cpu->getCC();
+        res.memory = 0xcbf29ce484222325ull;
+        auto mix = [&](Byte v) { res.memory = (res.memory ^ v) * 0x100000001b3ull; };
+        for (Word a = CURSOR_COL; a <= ATTRIB; a++)
+            mix(m.Read(a));
+        for (Word a = VIDEO_START; a < 0x4000; a++)
+            mix(m.Read(a));
+        results.push_back(res);
+    }
+    return results;
+}
+
+int main(int argc, char* argv[])
+{
+    int cases = (argc > 1) ? atoi(argv[1]) : 800;
+    unsigned seed = (argc > 2) ? (unsigned)atoi(argv[2]) : 6809;
+
+    std::vector<RESULT> rom = run(false, cases, seed);
+    std::vector<RESULT> hle = run(true, cases, seed);
+
+    int failed = 0;
+    for (int c = 0; c < cases; c++)
+    {
+        const RESULT& a = rom[c];
+        const RESULT& b = hle[c];
+        if (a.returned && b.returned && a.d == b.d && a.x == b.x && a.y == b.y && a.u == b.u &&
+            a.s == b.s && a.cc == b.cc && a.memory == b.memory)
+            continue;
+        if (failed++ < 8)
+            printf("kernel_hle: case %d %s: rom D=%04X X=%04X Y=%04X U=%04X S=%04X CC=%02X%s, "
+                   "hle D=%04X X=%04X Y=%04X U=%04X S=%04X CC=%02X%s%s\n",
+                   c, s_routines[a.routine].name,
+                   a.d, a.x, a.y, a.u, a.s, a.cc, a.returned ? "" : " (no return)",
+                   b.d, b.x, b.y, b.u, b.s, b.cc, b.returned ? "" : " (no return)",
+                   a.memory == b.memory ? "" : " (memory differs)");
+    }
+    printf("kernel_hle: %d of %d calls matched the ROM\n", cases - failed, cases);
+    return failed ? 1 : 0;
+}
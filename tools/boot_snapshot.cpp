@@ -0,0 +1,124 @@
+// *************************************************
+// *
+// * boot_snapshot.cpp
+// *
+// *    boot_snapshot <header>
+// *
+// *    Boots a headless Machine up to the kernel's line editor and writes the
+// *    CPU registers, the RAM and the device writes of the boot into <header>
+// *    for Bus::restore_boot() (cmake -DKERNEL_BOOT_SNAPSHOT=ON).
+// *
+// ***********************************
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Machine.hpp"
+#include "C6809.hpp"
+
+// boots a Machine and writes the header, 0 on success
+static int snapshot(const std::string& out)
+{
+    Machine m("");      // banked memory with no 'paged.mem'
+    Bus& bus = m.GetBus();
+    C6809* cpu = m.GetC6809();
+
+    // KRNL_LINEEDIT: jmp [VEC_LINEEDIT]
+    Word entry = 0;
+    for (DWord a = KERNEL_ROM; a < 0xfffc; a++)
+        if (m.Read(a) == 0x6e && m.Read(a + 1) == 0x9f && m.Read(a + 2) == 0x00 && m.Read(a + 3) == 0x1c)
+            entry = (Word)a;
+    if (entry == 0)
+    {
+        printf("boot_snapshot: KRNL_LINEEDIT was not found in the kernel ROM\n");
+        return 1;
+    }
+
+    std::vector<std::pair<Word, Byte>> writes;
+    bus.LogWrites(&writes);
+    QWord clocks = 0;
+    while (clocks < 100000000)
+    {
+        clocks += m.Run(1);
+        if (cpu->getCycles() == 0 && cpu->getPC() == entry)
+            break;
+    }
+    bus.LogWrites(nullptr);
+    if (cpu->getPC() != entry)
+    {
+        printf("boot_snapshot: the kernel did not reach KRNL_LINEEDIT\n");
+        return 1;
+    }
+
+    // the RAM that is not zero, in runs (short gaps of zeros within one RAM device are kept in a run)
+    std::vector<std::pair<Word, Word>> runs;
+    std::vector<Byte> data;
+    for (DWord a = 0; a < 0x10000; )
+    {
+        Word len = 1;
+        Byte* ram = bus.MemPtr(a, len, true);
+        if (ram)
+        {
+            for (Word t = 0; t < len; t++)
+            {
+                if (ram[t] == 0)
+                    continue;
+                Word addr = (Word)(a + t);
+                if (!runs.empty() && runs.back().first >= a &&
+                    addr - (runs.back().first + runs.back().second) < 16)
+                {
+                    while (runs.back().first + runs.back().second < addr)
+                    {
+                        data.push_back(0);
+                        runs.back().second++;
+                    }
+                }
+                else
+                    runs.push_back({ addr, 0 });
+                data.push_back(ram[t]);
+                runs.back().second++;
+            }
+        }
+        a += len;
+    }
+
+    FILE* fp = fopen(out.c_str(), "w");
+    if (!fp)
+    {
+        printf("boot_snapshot: unable to write %s\n", out.c_str());
+        return 1;
+    }
+    C6809::REGS r = cpu->getRegs();
+    fprintf(fp, "// generated by tools/boot_snapshot.cpp: the kernel booted to KRNL_LINEEDIT ($%04X)\n", entry);
+    fprintf(fp, "// in %llu clocks\n#pragma once\n#include \"types.hpp\"\n\n", (unsigned long long)clocks);
+    fprintf(fp, "// pc, u, s, x, y, d, w, v, dp, cc, md\n");
+    fprintf(fp, "constexpr Word BOOT_SNAPSHOT_REGS[] = { 0x%04x, 0x%04x, 0x%04x, 0x%04x, 0x%04x, 0x%04x, 0x%04x, 0x%04x, 0x%02x, 0x%02x, 0x%02x };\n\n",
+        r.pc, r.u, r.s, r.x, r.y, r.d, r.w, r.v, r.dp, r.cc, r.md);
+    fprintf(fp, "// device writes, in the order the kernel made them\n");
+    fprintf(fp, "constexpr Word BOOT_SNAPSHOT_WRITES[][2] = {");
+    for (size_t t = 0; t < writes.size(); t++)
+        fprintf(fp, "%s{ 0x%04x, 0x%02x },", (t % 6) ? " " : "\n    ", writes[t].first, writes[t].second);
+    fprintf(fp, "\n};\n\n// RAM runs { address, length }, their bytes follow one another in BOOT_SNAPSHOT_RAM\n");
+    fprintf(fp, "constexpr Word BOOT_SNAPSHOT_RAM_RUNS[][2] = {");
+    for (size_t t = 0; t < runs.size(); t++)
+        fprintf(fp, "%s{ 0x%04x, %u },", (t % 6) ? " " : "\n    ", runs[t].first, runs[t].second);
+    fprintf(fp, "\n};\nconstexpr Byte BOOT_SNAPSHOT_RAM[] = {");
+    for (size_t t = 0; t < data.size(); t++)
+        fprintf(fp, "%s0x%02x,", (t % 16) ? " " : "\n    ", data[t]);
+    fprintf(fp, "\n};\n");
+    fclose(fp);
+    printf("boot_snapshot: %s, %zu writes, %zu bytes of RAM in %zu runs\n",
+        out.c_str(), writes.size(), data.size(), runs.size());
+    m.Stop();
+    return (writes.empty() || runs.empty()) ? 1 : 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        printf("usage: boot_snapshot <header>\n");
+        return 1;
+    }
+    return snapshot(argv[1]);
+}
@@ -0,0 +1,72 @@
+# *************************************************
+# *
+# * embed_kernel.cmake
+# *
+# *     cmake -DHEX=<kernel .hex> -DOUT=<header> -P embed_kernel.cmake
+# *
+# *     The kernel ROM as constexpr arrays for Bus::load_kernel() (KERNEL_ROM_EMBEDDED):
+# *     the bytes of every data record, and the runs of contiguous addresses they fill.
+# *
+# ***********************************
+
+file(STRINGS "${HEX}" records NO_HEX_CONVERSION)  # file(STRINGS) would decode the records itself
+set(data "")
+set(runs "")
+set(run_addr 0)
+set(run_len 0)
+set(next -1)
+foreach(record IN LISTS records)
+    string(STRIP "${record}" record)
+    if(NOT record MATCHES "^:([0-9A-Fa-f][0-9A-Fa-f])([0-9A-Fa-f][0-9A-Fa-f][0-9A-Fa-f][0-9A-Fa-f])([0-9A-Fa-f][0-9A-Fa-f])")
+        continue()
+    endif()
+    math(EXPR count "0x${CMAKE_MATCH_1}")
+    math(EXPR addr "0x${CMAKE_MATCH_2}")
+    set(type "${CMAKE_MATCH_3}")
+
+    # every byte of a record, its checksum included, adds up to zero
+    string(SUBSTRING "${record}" 1 -1 body)
+    string(REGEX MATCHALL ".." pairs "${body}")
+    set(sum 0)
+    foreach(pair IN LISTS pairs)
+        math(EXPR sum "(${sum} + 0x${pair}) & 255")
+    endforeach()
+    if(NOT sum EQUAL 0)
+        message(FATAL_ERROR "${HEX}: bad checksum in ${record}")
+    endif()
+
+    if(type STREQUAL "01")
+        break()
+    endif()
+    if(NOT type STREQUAL "00")
+        continue()
+    endif()
+    math(EXPR chars "${count} * 2")
+    string(SUBSTRING "${record}" 9 ${chars} bytes)
+    string(REGEX REPLACE "(..)" "0x\\1," bytes "${bytes}")
+    string(APPEND data "    ${bytes}\n")
+
+    # records that follow on from the one before join its run
+    if(addr EQUAL next)
+        math(EXPR run_len "${run_len} + ${count}")
+    else()
+        if(run_len GREATER 0)
+            string(APPEND runs "    { ${run_addr}, ${run_len} },\n")
+        endif()
+        set(run_addr ${addr})
+        set(run_len ${count})
+    endif()
+    math(EXPR next "${addr} + ${count}")
+endforeach()
+if(run_len GREATER 0)
+    string(APPEND runs "    { ${run_addr}, ${run_len} },\n")
+endif()
+
+get_filename_component(hex_name "${HEX}" NAME)
+file(WRITE "${OUT}"
+    "// generated from ${hex_name} by tools/embed_kernel.cmake, do not edit\n"
+    "#pragma once\n\n"
+    "#include \"types.hpp\"\n\n"
+    "constexpr Byte KERNEL_ROM_DATA[] = {\n${data}};\n\n"
+    "// { address, length } of each run, their bytes follow one another in KERNEL_ROM_DATA\n"
+    "constexpr Word KERNEL_ROM_RUNS[][2] = {\n${runs}};\n")